@@ -0,0 +1,109 @@
+// Tests that the TTL monitor's worker pool processes every TTL index in a pass, that each index is
+// handled in its own batched pass, and that the per-index backlog is reported through the "ttl"
+// serverStatus section.
+(function() {
+    "use strict";
+
+    // Fewer worker threads than there are TTL indexes, and batches smaller than the number of
+    // expired documents of each index. The sleep interval leaves time to look at the statistics of
+    // a pass before the next one overwrites them.
+    const conn = MongoRunner.runMongod({
+        setParameter: {
+            ttlMonitorEnabled: false,
+            ttlMonitorSleepSecs: 5,
+            ttlMonitorMaxConcurrency: 2,
+            ttlMonitorBatchDeleteSize: 10,
+        }
+    });
+    assert.neq(null, conn, "mongod failed to start");
+    const db = conn.getDB("test");
+
+    const kNumExpired = 25;
+    const kNumLive = 5;
+    const expiredDate = new Date(Date.now() - 3600 * 1000);
+    const liveDate = new Date(Date.now() + 3600 * 1000);
+
+    // Three collections with a single TTL index each.
+    const singleIndexColls = ["ttl_pool_a", "ttl_pool_b", "ttl_pool_c"];
+    for (let name of singleIndexColls) {
+        const coll = db[name];
+        assert.commandWorked(coll.createIndex({x: 1}, {expireAfterSeconds: 0}));
+        const bulk = coll.initializeUnorderedBulkOp();
+        for (let i = 0; i < kNumExpired; ++i) {
+            bulk.insert({x: expiredDate});
+        }
+        for (let i = 0; i < kNumLive; ++i) {
+            bulk.insert({x: liveDate});
+        }
+        assert.writeOK(bulk.execute());
+    }
+
+    // One collection with two TTL indexes, each of which expires a different set of documents.
+    const multiIndexColl = db.ttl_pool_multi;
+    assert.commandWorked(multiIndexColl.createIndex({x: 1}, {expireAfterSeconds: 0}));
+    assert.commandWorked(multiIndexColl.createIndex({y: 1}, {expireAfterSeconds: 0}));
+    const multiBulk = multiIndexColl.initializeUnorderedBulkOp();
+    for (let i = 0; i < kNumExpired; ++i) {
+        multiBulk.insert({x: expiredDate, y: liveDate});
+        multiBulk.insert({x: liveDate, y: expiredDate});
+    }
+    for (let i = 0; i < kNumLive; ++i) {
+        multiBulk.insert({x: liveDate, y: liveDate});
+    }
+    assert.writeOK(multiBulk.execute());
+
+    const passesBefore = db.serverStatus().metrics.ttl.passes;
+    assert.commandWorked(db.adminCommand({setParameter: 1, ttlMonitorEnabled: true}));
+
+    // Wait for the pass which deleted the expired documents to report them.
+    const expectedIndexes = singleIndexColls.map(name => ({ns: "test." + name, index: "x_1"}))
+                                .concat([
+                                    {ns: multiIndexColl.getFullName(), index: "x_1"},
+                                    {ns: multiIndexColl.getFullName(), index: "y_1"}
+                                ]);
+    let ttlStats;
+    assert.soon(function() {
+        ttlStats = db.serverStatus({ttl: 1}).ttl;
+        return expectedIndexes.every(function(expected) {
+            const nsStats = ttlStats[expected.ns];
+            return nsStats && nsStats[expected.index] &&
+                nsStats[expected.index].deletedLastPass === kNumExpired;
+        });
+    }, () => "TTL pass did not report the expected deletions: " + tojson(ttlStats));
+
+    // Each index was processed in a single pass, which reported how long its oldest document had
+    // been expired for when the pass started.
+    for (let expected of expectedIndexes) {
+        const indexStats = ttlStats[expected.ns][expected.index];
+        assert.eq(kNumExpired, indexStats.totalDeleted, tojson(indexStats));
+        assert.gte(indexStats.lagSecs, 3600 - 60, tojson(indexStats));
+        assert.gte(indexStats.lastPassMillis, 0, tojson(indexStats));
+    }
+    assert.gt(db.serverStatus().metrics.ttl.passes, passesBefore);
+    assert.gte(db.serverStatus().metrics.ttl.deletedDocuments,
+               expectedIndexes.length * kNumExpired);
+
+    for (let name of singleIndexColls) {
+        assert.eq(kNumLive, db[name].count(), name);
+    }
+    assert.eq(kNumLive, multiIndexColl.count());
+
+    // Once the backlog is gone, later passes report no lag and no deletions, and keep the totals.
+    assert.soon(function() {
+        ttlStats = db.serverStatus({ttl: 1}).ttl;
+        const indexStats = ttlStats[multiIndexColl.getFullName()].x_1;
+        return indexStats.deletedLastPass === 0;
+    }, () => "No TTL pass after the deletions: " + tojson(ttlStats));
+    const indexStats = ttlStats[multiIndexColl.getFullName()].x_1;
+    assert.eq(0, indexStats.lagSecs, tojson(indexStats));
+    assert.eq(kNumExpired, indexStats.totalDeleted, tojson(indexStats));
+
+    // Dropping an index removes it from the statistics after the next pass.
+    assert.commandWorked(multiIndexColl.dropIndex({y: 1}));
+    assert.soon(function() {
+        ttlStats = db.serverStatus({ttl: 1}).ttl;
+        return !ttlStats[multiIndexColl.getFullName()].hasOwnProperty("y_1");
+    }, () => "Dropped TTL index is still reported: " + tojson(ttlStats));
+
+    MongoRunner.stopMongod(conn);
+})();
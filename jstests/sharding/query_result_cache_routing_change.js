@@ -0,0 +1,96 @@
+// Tests that results cached by mongos are invalidated when the routing table of the collection
+// they were read from changes, and that disabling the cache at runtime releases its entries.
+(function() {
+    "use strict";
+
+    const st = new ShardingTest({shards: 2, mongos: 1});
+
+    const mongosDB = st.s.getDB(jsTestName());
+    const mongosColl = mongosDB.coll;
+
+    assert.commandWorked(mongosDB.adminCommand({enableSharding: mongosDB.getName()}));
+    st.ensurePrimaryShard(mongosDB.getName(), st.shard0.shardName);
+    assert.commandWorked(
+        mongosDB.adminCommand({shardCollection: mongosColl.getFullName(), key: {x: 1}}));
+    assert.commandWorked(mongosDB.adminCommand({split: mongosColl.getFullName(), middle: {x: 0}}));
+
+    for (let i = -5; i < 5; ++i) {
+        assert.writeOK(mongosColl.insert({x: i}));
+    }
+
+    // Writes do not invalidate cached results, so use a staleness bound which does not expire them
+    // while the test runs. Only a routing change can then make mongos read the collection again.
+    assert.commandWorked(mongosDB.adminCommand(
+        {setParameter: 1, clusterQueryResultCacheSizeBytes: 16 * 1024 * 1024}));
+    assert.commandWorked(mongosDB.adminCommand(
+        {setParameter: 1, clusterQueryResultCacheMaxStalenessMS: 60 * 60 * 1000}));
+
+    function getCacheStats() {
+        const serverStatus = assert.commandWorked(mongosDB.adminCommand({serverStatus: 1}));
+        return serverStatus.shardingStatistics.queryResultCache;
+    }
+
+    function runFind() {
+        return mongosColl.find({}, {_id: 0}).sort({x: 1}).toArray();
+    }
+
+    function runAggregate() {
+        return mongosColl.aggregate([{$sort: {x: 1}}, {$project: {_id: 0}}]).toArray();
+    }
+
+    // The first reads populate the cache and the second ones are served from it.
+    assert.eq(10, runFind().length);
+    assert.eq(10, runAggregate().length);
+    let stats = getCacheStats();
+    assert.eq(2, stats.numInserted, tojson(stats));
+    assert.eq(2, stats.numEntries, tojson(stats));
+
+    assert.eq(10, runFind().length);
+    assert.eq(10, runAggregate().length);
+    stats = getCacheStats();
+    assert.eq(2, stats.numHits, tojson(stats));
+
+    // The cached results do not see the new document until the routing table changes.
+    assert.writeOK(mongosColl.insert({x: 10}));
+    assert.eq(10, runFind().length);
+    assert.eq(10, runAggregate().length);
+    stats = getCacheStats();
+    assert.eq(4, stats.numHits, tojson(stats));
+    assert.eq(0, stats.numStaleVersion, tojson(stats));
+
+    // Moving a chunk bumps the collection version, which invalidates both entries.
+    assert.commandWorked(mongosDB.adminCommand({
+        moveChunk: mongosColl.getFullName(),
+        find: {x: 0},
+        to: st.shard1.shardName,
+        _waitForDelete: true
+    }));
+
+    assert.eq(11, runFind().length);
+    assert.eq(11, runAggregate().length);
+    stats = getCacheStats();
+    assert.eq(4, stats.numHits, tojson(stats));
+    assert.eq(2, stats.numStaleVersion, tojson(stats));
+    assert.eq(4, stats.numInserted, tojson(stats));
+    assert.eq(2, stats.numEntries, tojson(stats));
+
+    // Entries read at the new version are served from the cache again.
+    assert.eq(11, runFind().length);
+    assert.eq(11, runAggregate().length);
+    stats = getCacheStats();
+    assert.eq(6, stats.numHits, tojson(stats));
+
+    // Disabling the cache releases the cached results right away.
+    assert.commandWorked(
+        mongosDB.adminCommand({setParameter: 1, clusterQueryResultCacheSizeBytes: 0}));
+    stats = getCacheStats();
+    assert.eq(0, stats.numEntries, tojson(stats));
+    assert.eq(0, stats.totalSizeBytes, tojson(stats));
+
+    assert.eq(11, runFind().length);
+    stats = getCacheStats();
+    assert.eq(0, stats.numEntries, tojson(stats));
+    assert.eq(6, stats.numHits, tojson(stats));
+
+    st.stop();
+})();
@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/time_support.h"
@@ -94,6 +96,17 @@ public:
         return findHostWithMaxWait(readPref, Milliseconds::zero());
     }
 
+    /**
+     * Returns the hosts, other than 'excludedHost', which are currently believed to be up and able
+     * to serve reads with the given read preference. Never blocks or performs networking. Used to
+     * pick a target for a hedged read, so targeters which only know of one host, or which cannot
+     * cheaply decide eligibility for 'readPref', return an empty list.
+     */
+    virtual std::vector<HostAndPort> findAlternateHostsNoWait(const ReadPreferenceSetting& readPref,
+                                                              const HostAndPort& excludedHost) {
+        return {};
+    }
+
     /**
      * Reports to the targeter that a 'status' indicating a not master error was received when
      * communicating with 'host', and so it should update its bookkeeping to avoid giving out the
@@ -65,6 +65,17 @@ StatusWith<HostAndPort> RemoteCommandTargeterMock::findHostWithMaxWait(
     return _findHostReturnValue;
 }
 
+std::vector<HostAndPort> RemoteCommandTargeterMock::findAlternateHostsNoWait(
+    const ReadPreferenceSetting& readPref, const HostAndPort& excludedHost) {
+    std::vector<HostAndPort> hosts;
+    for (const auto& host : _alternateHostsReturnValue) {
+        if (host != excludedHost) {
+            hosts.push_back(host);
+        }
+    }
+    return hosts;
+}
+
 void RemoteCommandTargeterMock::markHostNotMaster(const HostAndPort& host, const Status& status) {}
 
 void RemoteCommandTargeterMock::markHostUnreachable(const HostAndPort& host, const Status& status) {
@@ -78,4 +89,8 @@ void RemoteCommandTargeterMock::setFindHostReturnValue(StatusWith<HostAndPort> r
     _findHostReturnValue = std::move(returnValue);
 }
 
+void RemoteCommandTargeterMock::setAlternateHostsReturnValue(std::vector<HostAndPort> returnValue) {
+    _alternateHostsReturnValue = std::move(returnValue);
+}
+
 }  // namespace mongo
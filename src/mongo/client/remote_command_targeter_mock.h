@@ -62,6 +62,12 @@ public:
     StatusWith<HostAndPort> findHost(OperationContext* opCtx,
                                      const ReadPreferenceSetting& readPref) override;
 
+    /**
+     * Returns the hosts last set by setAlternateHostsReturnValue, excluding 'excludedHost'.
+     */
+    std::vector<HostAndPort> findAlternateHostsNoWait(const ReadPreferenceSetting& readPref,
+                                                      const HostAndPort& excludedHost) override;
+
     /**
      * No-op for the mock.
      */
@@ -82,9 +88,15 @@ public:
      */
     void setFindHostReturnValue(StatusWith<HostAndPort> returnValue);
 
+    /**
+     * Sets the return value for the next call to findAlternateHostsNoWait.
+     */
+    void setAlternateHostsReturnValue(std::vector<HostAndPort> returnValue);
+
 private:
     ConnectionString _connectionStringReturnValue;
     StatusWith<HostAndPort> _findHostReturnValue;
+    std::vector<HostAndPort> _alternateHostsReturnValue;
 };
 
 }  // namespace mongo
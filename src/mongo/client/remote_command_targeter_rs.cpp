@@ -90,6 +90,32 @@ StatusWith<HostAndPort> RemoteCommandTargeterRS::findHost(OperationContext* opCt
     }
 }
 
+std::vector<HostAndPort> RemoteCommandTargeterRS::findAlternateHostsNoWait(
+    const ReadPreferenceSetting& readPref, const HostAndPort& excludedHost) {
+    // Only read preferences which allow any member to be used are supported, because evaluating
+    // tags and staleness bounds requires the replica set monitor's full host selection.
+    if (readPref.pref != ReadPreference::Nearest &&
+        readPref.pref != ReadPreference::SecondaryPreferred) {
+        return {};
+    }
+    if (readPref.tags != TagSet() || readPref.maxStalenessSeconds > Seconds::zero()) {
+        return {};
+    }
+
+    std::vector<HostAndPort> hosts;
+    for (const auto& host : connectionString().getServers()) {
+        if (host == excludedHost || !_rsMonitor->isHostUp(host)) {
+            continue;
+        }
+        if (readPref.pref == ReadPreference::SecondaryPreferred && _rsMonitor->isPrimary(host)) {
+            continue;
+        }
+        hosts.push_back(host);
+    }
+
+    return hosts;
+}
+
 void RemoteCommandTargeterRS::markHostNotMaster(const HostAndPort& host, const Status& status) {
     invariant(_rsMonitor);
 
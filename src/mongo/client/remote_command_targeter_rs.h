@@ -60,6 +60,9 @@ public:
     StatusWith<HostAndPort> findHostWithMaxWait(const ReadPreferenceSetting& readPref,
                                                 Milliseconds maxWait) override;
 
+    std::vector<HostAndPort> findAlternateHostsNoWait(const ReadPreferenceSetting& readPref,
+                                                      const HostAndPort& excludedHost) override;
+
     void markHostNotMaster(const HostAndPort& host, const Status& status) override;
 
     void markHostUnreachable(const HostAndPort& host, const Status& status) override;
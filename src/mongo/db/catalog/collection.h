@@ -228,6 +228,18 @@ public:
                                     bool noWarn,
                                     StoreDeletedDoc storeDeletedDoc) = 0;
 
+        virtual void deleteDocuments(OperationContext* opCtx,
+                                     const std::vector<RecordId>& locs,
+                                     OpDebug* opDebug,
+                                     bool fromMigrate,
+                                     bool noWarn) = 0;
+
+        virtual long long truncateRecordRange(OperationContext* opCtx,
+                                              const RecordId& min,
+                                              const RecordId& max,
+                                              long long maxToDelete,
+                                              bool fromMigrate) = 0;
+
         virtual Status insertDocuments(OperationContext* opCtx,
                                        std::vector<InsertStatement>::const_iterator begin,
                                        std::vector<InsertStatement>::const_iterator end,
@@ -465,6 +477,38 @@ public:
             opCtx, stmtId, loc, opDebug, fromMigrate, noWarn, storeDeletedDoc);
     }
 
+    /**
+     * Deletes the documents with the given RecordIds as deleteDocument() would, but removes their
+     * index keys one index at a time and in key order, which is much cheaper for large batches.
+     * Each deletion is still logged as its own oplog entry, and when the deletes are timestamped,
+     * each document and its index keys are removed at the timestamp of that entry. Must be called
+     * in a WriteUnitOfWork, and 'locs' must have been read in that same unit, so that a write
+     * conflict retry collects them again.
+     */
+    inline void deleteDocuments(OperationContext* const opCtx,
+                                const std::vector<RecordId>& locs,
+                                OpDebug* const opDebug,
+                                const bool fromMigrate = false,
+                                const bool noWarn = false) {
+        return this->_impl().deleteDocuments(opCtx, locs, opDebug, fromMigrate, noWarn);
+    }
+
+    /**
+     * Deletes, in RecordId order, up to 'maxToDelete' documents stored under RecordIds in
+     * [min, max) of a clustered collection, and returns how many were deleted. The documents are
+     * removed by truncating the range they occupy in the record store and in every index, so
+     * every index must be ready and lead with an ascending _id. Each deletion is still logged as
+     * its own oplog entry, but the truncation is a single write, made at the timestamp of the last
+     * of them. Must be called in a WriteUnitOfWork.
+     */
+    inline long long truncateRecordRange(OperationContext* const opCtx,
+                                         const RecordId& min,
+                                         const RecordId& max,
+                                         const long long maxToDelete,
+                                         const bool fromMigrate = false) {
+        return this->_impl().truncateRecordRange(opCtx, min, max, maxToDelete, fromMigrate);
+    }
+
     /*
      * Inserts all documents inside one WUOW.
      * Caller should ensure vector is appropriately sized for this.
@@ -56,15 +56,18 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_build_interceptor.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/op_observer.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/ops/update_request.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
+#include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/session_catalog.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
 #include "mongo/db/storage/record_fetcher.h"
@@ -141,6 +144,26 @@ std::unique_ptr<CollatorInterface> parseCollation(OperationContext* opCtx,
 
     return std::move(collator.getValue());
 }
+
+// Reserves one oplog slot for each of 'count' deletes made in the same WriteUnitOfWork, so that
+// each can be timestamped together with its oplog entry. As for batched inserts, this is only done
+// for doc-locking storage engines and outside of multi-document transactions. Returns no slots if
+// the deletes are not to be timestamped ahead of their oplog entries.
+std::vector<OplogSlot> reserveOplogSlotsForDeletes(OperationContext* opCtx,
+                                                   const NamespaceString& nss,
+                                                   std::size_t count) {
+    if (!supportsDocLocking() ||
+        repl::ReplicationCoordinator::get(opCtx)->isOplogDisabledFor(opCtx, nss)) {
+        return {};
+    }
+
+    auto session = OperationContextSession::get(opCtx);
+    if (session && session->inActiveOrKilledMultiDocumentTransaction()) {
+        return {};
+    }
+
+    return repl::getNextOpTimes(opCtx, count);
+}
 }  // namespace
 
 using std::unique_ptr;
@@ -222,6 +245,11 @@ bool CollectionImpl::requiresIdIndex() const {
         return false;
     }
 
+    if (_recordStore->isClustered()) {
+        // The record store is keyed by _id and enforces its uniqueness.
+        return false;
+    }
+
     if (_ns.isSystem()) {
         StringData shortName = _ns.coll().substr(_ns.coll().find('.') + 1);
         if (shortName == "indexes" || shortName == "namespaces" || shortName == "profile") {
@@ -621,7 +649,141 @@ void CollectionImpl::deleteDocument(OperationContext* opCtx,
     _recordStore->deleteRecord(opCtx, loc);
 
     getGlobalServiceContext()->getOpObserver()->onDelete(
-        opCtx, ns(), uuid(), stmtId, fromMigrate, deletedDoc);
+        opCtx, ns(), uuid(), stmtId, fromMigrate, deletedDoc, OplogSlot());
+}
+
+void CollectionImpl::deleteDocuments(OperationContext* opCtx,
+                                     const std::vector<RecordId>& locs,
+                                     OpDebug* opDebug,
+                                     bool fromMigrate,
+                                     bool noWarn) {
+    if (isCapped()) {
+        log() << "failing remove on a capped ns " << _ns;
+        uasserted(10089, "cannot remove from a capped collection");
+        return;
+    }
+
+    auto opObserver = getGlobalServiceContext()->getOpObserver();
+
+    // When the deletes are timestamped, each document is removed from the record store at the
+    // timestamp of its own oplog entry. The first slot is the earliest, so it is set first and the
+    // index keys removed below may go back to the timestamps of earlier documents.
+    const auto oplogSlots = reserveOplogSlotsForDeletes(opCtx, ns(), locs.size());
+
+    // The index keys of the whole batch are removed at once, after all the documents have been
+    // deleted from the record store, so the documents must outlive that.
+    std::vector<Snapshotted<BSONObj>> docs;
+    docs.reserve(locs.size());
+    for (size_t i = 0; i < locs.size(); ++i) {
+        if (!oplogSlots.empty()) {
+            uassertStatusOK(
+                opCtx->recoveryUnit()->setTimestamp(oplogSlots[i].opTime.getTimestamp()));
+        }
+
+        docs.push_back(docFor(opCtx, locs[i]));
+        const BSONObj& doc = docs.back().value();
+        opObserver->aboutToDelete(opCtx, ns(), doc);
+
+        /* check if any cursors point to us.  if so, advance them. */
+        _cursorManager.invalidateDocument(opCtx, locs[i], INVALIDATION_DELETION);
+
+        _recordStore->deleteRecord(opCtx, locs[i]);
+
+        opObserver->onDelete(opCtx,
+                             ns(),
+                             uuid(),
+                             kUninitializedStmtId,
+                             fromMigrate,
+                             boost::none,
+                             oplogSlots.empty() ? OplogSlot() : oplogSlots[i]);
+    }
+
+    std::vector<BsonRecord> bsonRecords;
+    bsonRecords.reserve(locs.size());
+    for (size_t i = 0; i < locs.size(); ++i) {
+        bsonRecords.push_back(
+            {locs[i],
+             oplogSlots.empty() ? Timestamp() : oplogSlots[i].opTime.getTimestamp(),
+             &docs[i].value()});
+    }
+
+    int64_t keysDeleted;
+    _indexCatalog.unindexRecords(opCtx, bsonRecords, noWarn, &keysDeleted);
+    if (opDebug) {
+        opDebug->additiveMetrics.incrementKeysDeleted(keysDeleted);
+    }
+}
+
+long long CollectionImpl::truncateRecordRange(OperationContext* opCtx,
+                                              const RecordId& min,
+                                              const RecordId& max,
+                                              long long maxToDelete,
+                                              bool fromMigrate) {
+    invariant(_recordStore->isClustered());
+    invariant(maxToDelete > 0);
+
+    auto opObserver = getGlobalServiceContext()->getOpObserver();
+
+    // Read the documents before writing anything, so that an oplog slot can be reserved for each.
+    std::vector<std::pair<RecordId, BSONObj>> records;
+    int64_t dataSize = 0;
+    auto cursor = _recordStore->getCursor(opCtx);
+    for (auto record = cursor->seekNear(min);
+         record && record->id < max && static_cast<long long>(records.size()) < maxToDelete;
+         record = cursor->next()) {
+        dataSize += record->data.size();
+        records.emplace_back(record->id, record->data.toBson().getOwned());
+    }
+    cursor.reset();
+
+    if (records.empty()) {
+        return 0;
+    }
+
+    const long long numDeleted = records.size();
+    const RecordId& first = records.front().first;
+    const RecordId& last = records.back().first;
+    const BSONObj firstIdKey = records.front().second["_id"].wrap("");
+    const BSONObj lastIdKey = records.back().second["_id"].wrap("");
+
+    // The oplog entries are written first, each at the timestamp of its own slot.
+    const auto oplogSlots = reserveOplogSlotsForDeletes(opCtx, ns(), records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        opObserver->aboutToDelete(opCtx, ns(), records[i].second);
+        opObserver->onDelete(opCtx,
+                             ns(),
+                             uuid(),
+                             kUninitializedStmtId,
+                             fromMigrate,
+                             boost::none,
+                             oplogSlots.empty() ? OplogSlot() : oplogSlots[i]);
+    }
+
+    // The range is removed with a single write, which cannot be timestamped along with each of the
+    // oplog entries. It takes the timestamp of the last one, so that no snapshot sees a document
+    // gone before its delete is in the oplog. A snapshot taken in between still sees the documents
+    // whose deletes come earlier, as if the whole batch had been deleted at the last timestamp.
+    if (!oplogSlots.empty()) {
+        const Timestamp timestamp = oplogSlots.back().opTime.getTimestamp();
+        uassertStatusOK(opCtx->recoveryUnit()->setTimestamp(timestamp));
+    }
+
+    for (const auto& record : records) {
+        _cursorManager.invalidateDocument(opCtx, record.first, INVALIDATION_DELETION);
+    }
+
+    _recordStore->truncateRange(opCtx, first, last, numDeleted, dataSize);
+
+    // Since every index leads with _id, the keys of the deleted documents are exactly the keys
+    // whose _id lies between the first and the last deleted _id.
+    IndexCatalog::IndexIterator ii = _indexCatalog.getIndexIterator(opCtx, true);
+    while (ii.more()) {
+        IndexDescriptor* descriptor = ii.next();
+        invariant(descriptor->keyPattern().firstElementFieldName() == StringData("_id"));
+        ii.accessMethod(descriptor)->truncateRange(opCtx, firstIdKey, lastIdKey);
+    }
+
+    return numDeleted;
 }
 
 Counter64 moveCounter;
@@ -695,6 +857,10 @@ RecordId CollectionImpl::updateDocument(OperationContext* opCtx,
             IndexCatalogEntry* entry = ii.catalogEntry(descriptor);
             IndexAccessMethod* iam = ii.accessMethod(descriptor);
 
+            // Indexes being loaded by a hybrid index build are updated through side writes below.
+            if (entry->indexBuildInterceptor())
+                continue;
+
             InsertDeleteOptions options;
             IndexCatalog::prepareInsertDeleteOptions(opCtx, descriptor, &options);
             UpdateTicket* updateTicket = new UpdateTicket();
@@ -725,12 +891,35 @@ RecordId CollectionImpl::updateDocument(OperationContext* opCtx,
         IndexCatalog::IndexIterator ii = _indexCatalog.getIndexIterator(opCtx, true);
         while (ii.more()) {
             IndexDescriptor* descriptor = ii.next();
+            IndexCatalogEntry* entry = ii.catalogEntry(descriptor);
             IndexAccessMethod* iam = ii.accessMethod(descriptor);
 
-            int64_t keysInserted;
-            int64_t keysDeleted;
-            uassertStatusOK(iam->update(
-                opCtx, *updateTickets.mutableMap()[descriptor], &keysInserted, &keysDeleted));
+            int64_t keysInserted = 0;
+            int64_t keysDeleted = 0;
+            if (auto interceptor = entry->indexBuildInterceptor()) {
+                InsertDeleteOptions options;
+                IndexCatalog::prepareInsertDeleteOptions(opCtx, descriptor, &options);
+                uassertStatusOK(interceptor->sideWrite(opCtx,
+                                                       iam,
+                                                       oldDoc.value(),
+                                                       oldLocation,
+                                                       IndexBuildInterceptor::Op::kDelete,
+                                                       options,
+                                                       &keysDeleted));
+                auto filter = entry->getFilterExpression();
+                if (!filter || filter->matchesBSON(newDoc)) {
+                    uassertStatusOK(interceptor->sideWrite(opCtx,
+                                                           iam,
+                                                           newDoc,
+                                                           oldLocation,
+                                                           IndexBuildInterceptor::Op::kInsert,
+                                                           options,
+                                                           &keysInserted));
+                }
+            } else {
+                uassertStatusOK(iam->update(
+                    opCtx, *updateTickets.mutableMap()[descriptor], &keysInserted, &keysDeleted));
+            }
             if (opDebug) {
                 opDebug->additiveMetrics.incrementKeysInserted(keysInserted);
                 opDebug->additiveMetrics.incrementKeysDeleted(keysDeleted);
@@ -156,6 +156,26 @@ public:
         bool noWarn = false,
         Collection::StoreDeletedDoc storeDeletedDoc = Collection::StoreDeletedDoc::Off) final;
 
+    /**
+     * Deletes the documents with the given RecordIds as deleteDocument() would, but removes their
+     * index keys one index at a time and in key order.
+     */
+    void deleteDocuments(OperationContext* opCtx,
+                         const std::vector<RecordId>& locs,
+                         OpDebug* opDebug,
+                         bool fromMigrate = false,
+                         bool noWarn = false) final;
+
+    /**
+     * Deletes up to 'maxToDelete' documents stored under RecordIds in [min, max) of a clustered
+     * collection by truncating their ranges in the record store and every index.
+     */
+    long long truncateRecordRange(OperationContext* opCtx,
+                                  const RecordId& min,
+                                  const RecordId& max,
+                                  long long maxToDelete,
+                                  bool fromMigrate = false) final;
+
     /*
      * Inserts all documents inside one WUOW.
      * Caller should ensure vector is appropriately sized for this.
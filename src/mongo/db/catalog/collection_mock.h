@@ -140,6 +140,22 @@ public:
         std::abort();
     }
 
+    void deleteDocuments(OperationContext* opCtx,
+                         const std::vector<RecordId>& locs,
+                         OpDebug* opDebug,
+                         bool fromMigrate,
+                         bool noWarn) {
+        std::abort();
+    }
+
+    long long truncateRecordRange(OperationContext* opCtx,
+                                  const RecordId& min,
+                                  const RecordId& max,
+                                  long long maxToDelete,
+                                  bool fromMigrate) {
+        std::abort();
+    }
+
     Status insertDocuments(OperationContext* opCtx,
                            std::vector<InsertStatement>::const_iterator begin,
                            std::vector<InsertStatement>::const_iterator end,
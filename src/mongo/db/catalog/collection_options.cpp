@@ -102,6 +102,51 @@ Status checkStorageEngineOptions(const BSONElement& elem) {
     return Status::OK();
 }
 
+Status parseClusteredIndex(const BSONElement& elem) {
+    invariant(elem.fieldNameStringData() == "clusteredIndex");
+
+    // Clustered collections store each document under a RecordId computed from its _id, which
+    // only works for integral _id values. Since that rules out the default ObjectId _id, and
+    // with it inserting documents without an _id, the caller has to opt in explicitly:
+    // {
+    //     ...
+    //     clusteredIndex: {integralIds: true},
+    //     ...
+    // }
+    if (elem.type() == mongo::Bool && !elem.boolean()) {
+        return Status::OK();
+    }
+
+    const Status requiresIntegralIds(
+        ErrorCodes::InvalidOptions,
+        "clustered collections only accept integral _id values between 0 and 2^63 - 2, so "
+        "documents cannot have ObjectId or other _id values, nor be inserted without an _id; "
+        "create the collection with {clusteredIndex: {integralIds: true}} to accept this");
+
+    if (elem.type() != mongo::Object) {
+        return requiresIntegralIds;
+    }
+
+    bool integralIds = false;
+    BSONForEach(option, elem.Obj()) {
+        if (option.fieldNameStringData() != "integralIds") {
+            return {ErrorCodes::InvalidOptions,
+                    str::stream() << "unknown option to clusteredIndex: "
+                                  << option.fieldNameStringData()};
+        }
+        if (option.type() != mongo::Bool) {
+            return {ErrorCodes::TypeMismatch, "'clusteredIndex.integralIds' has to be a boolean."};
+        }
+        integralIds = option.boolean();
+    }
+
+    if (!integralIds) {
+        return requiresIntegralIds;
+    }
+
+    return Status::OK();
+}
+
 }  // namespace
 
 bool CollectionOptions::isView() const {
@@ -185,6 +230,12 @@ Status CollectionOptions::parse(const BSONObj& options, ParseKind kind) {
             flagsSet = true;
         } else if (fieldName == "temp") {
             temp = e.trueValue();
+        } else if (fieldName == "clusteredIndex") {
+            Status status = parseClusteredIndex(e);
+            if (!status.isOK()) {
+                return status;
+            }
+            clusteredIndex = e.isABSONObj();
         } else if (fieldName == "storageEngine") {
             Status status = checkStorageEngineOptions(e);
             if (!status.isOK()) {
@@ -275,6 +326,20 @@ Status CollectionOptions::parse(const BSONObj& options, ParseKind kind) {
         return Status(ErrorCodes::BadValue, "'pipeline' cannot be specified without 'viewOn'");
     }
 
+    if (clusteredIndex) {
+        if (capped) {
+            return Status(ErrorCodes::InvalidOptions,
+                          "'clusteredIndex' cannot be combined with 'capped'");
+        }
+        if (autoIndexId == YES) {
+            return Status(ErrorCodes::InvalidOptions,
+                          "'clusteredIndex' collections do not have a separate _id index");
+        }
+        if (!viewOn.empty()) {
+            return Status(ErrorCodes::InvalidOptions, "views cannot be clustered");
+        }
+    }
+
     return Status::OK();
 }
 
@@ -311,6 +376,9 @@ void CollectionOptions::appendBSON(BSONObjBuilder* builder) const {
     if (temp)
         builder->appendBool("temp", true);
 
+    if (clusteredIndex)
+        builder->append("clusteredIndex", BSON("integralIds" << true));
+
     if (!storageEngine.isEmpty()) {
         builder->append("storageEngine", storageEngine);
     }
@@ -392,6 +460,10 @@ bool CollectionOptions::matchesStorageOptions(const CollectionOptions& other,
         return false;
     }
 
+    if (clusteredIndex != other.clusteredIndex) {
+        return false;
+    }
+
     if (storageEngine.woCompare(other.storageEngine) != 0) {
         return false;
     }
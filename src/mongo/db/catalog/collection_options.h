@@ -133,6 +133,12 @@ struct CollectionOptions {
 
     bool temp = false;
 
+    // Documents are stored keyed by their integral _id instead of a generated RecordId, and the
+    // collection has no separate _id index. Requires a storage engine that supports it. Set with
+    // {clusteredIndex: {integralIds: true}}, since documents with any other _id, including the
+    // ObjectId generated for documents inserted without one, are rejected.
+    bool clusteredIndex = false;
+
     // Storage engine collection options. Always owned or empty.
     BSONObj storageEngine;
 
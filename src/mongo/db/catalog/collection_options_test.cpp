@@ -254,6 +254,44 @@ TEST(CollectionOptions, PipelineFieldRequiresViewOn) {
     ASSERT_NOT_OK(options.parse(fromjson("{pipeline: [{$match: {}}]}")));
 }
 
+TEST(CollectionOptions, ClusteredIndexRoundTrip) {
+    CollectionOptions options;
+    ASSERT_OK(options.parse(fromjson("{clusteredIndex: {integralIds: true}}")));
+    ASSERT_TRUE(options.clusteredIndex);
+    ASSERT_BSONOBJ_EQ(options.toBSON(), fromjson("{clusteredIndex: {integralIds: true}}"));
+
+    CollectionOptions reparsed;
+    ASSERT_OK(reparsed.parse(options.toBSON()));
+    ASSERT_TRUE(reparsed.clusteredIndex);
+}
+
+TEST(CollectionOptions, ClusteredIndexRequiresOptingIntoIntegralIds) {
+    CollectionOptions options;
+    ASSERT_EQ(options.parse(fromjson("{clusteredIndex: true}")), ErrorCodes::InvalidOptions);
+    ASSERT_EQ(options.parse(fromjson("{clusteredIndex: {}}")), ErrorCodes::InvalidOptions);
+    ASSERT_EQ(options.parse(fromjson("{clusteredIndex: {integralIds: false}}")),
+              ErrorCodes::InvalidOptions);
+    ASSERT_EQ(options.parse(fromjson("{clusteredIndex: {integralIds: 1}}")),
+              ErrorCodes::TypeMismatch);
+    ASSERT_EQ(options.parse(fromjson("{clusteredIndex: {integralIds: true, other: 1}}")),
+              ErrorCodes::InvalidOptions);
+
+    CollectionOptions notClustered;
+    ASSERT_OK(notClustered.parse(fromjson("{clusteredIndex: false}")));
+    ASSERT_FALSE(notClustered.clusteredIndex);
+}
+
+TEST(CollectionOptions, ClusteredIndexIncompatibleOptions) {
+    CollectionOptions options;
+    ASSERT_EQ(options.parse(
+                  fromjson("{clusteredIndex: {integralIds: true}, capped: true, size: 1024}")),
+              ErrorCodes::InvalidOptions);
+    ASSERT_EQ(options.parse(fromjson("{clusteredIndex: {integralIds: true}, autoIndexId: true}")),
+              ErrorCodes::InvalidOptions);
+    ASSERT_EQ(options.parse(fromjson("{clusteredIndex: {integralIds: true}, viewOn: 'c'}")),
+              ErrorCodes::InvalidOptions);
+}
+
 TEST(CollectionOptions, UnknownTopLevelOptionFailsToParse) {
     CollectionOptions options;
     auto status = options.parse(fromjson("{invalidOption: 1}"));
@@ -98,9 +98,9 @@ Database* DatabaseHolderImpl::get(OperationContext* opCtx, StringData ns) const
     const StringData db = _todb(ns);
     invariant(opCtx->lockState()->isDbLockedForMode(db, MODE_IS));
 
-    stdx::lock_guard<SimpleMutex> lk(_m);
-    DBs::const_iterator it = _dbs.find(db);
-    if (it != _dbs.end()) {
+    const DBs& dbs = _dbsSnapshot.get(_m, [this] { return std::make_shared<const DBs>(_dbs); });
+    DBs::const_iterator it = dbs.find(db);
+    if (it != dbs.end()) {
         return it->second;
     }
 
@@ -142,6 +142,7 @@ Database* DatabaseHolderImpl::openDb(OperationContext* opCtx, StringData ns, boo
         if (!lk.owns_lock())
             lk.lock();
         _dbs.erase(dbname);
+        _dbsSnapshot.invalidate();
     });
 
     // Check casing in lock to avoid transient duplicates.
@@ -177,6 +178,7 @@ Database* DatabaseHolderImpl::openDb(OperationContext* opCtx, StringData ns, boo
     auto it = _dbs.find(dbname);
     invariant(it != _dbs.end() && it->second == nullptr);
     it->second = newDb.release();
+    _dbsSnapshot.invalidate();
     invariant(_getNamesWithConflictingCasing_inlock(dbname.toString()).empty());
 
     return it->second;
@@ -212,6 +214,7 @@ void DatabaseHolderImpl::close(OperationContext* opCtx, StringData ns, const std
     db = nullptr;
 
     _dbs.erase(it);
+    _dbsSnapshot.invalidate();
 
     getGlobalServiceContext()
         ->getStorageEngine()
@@ -242,6 +245,7 @@ void DatabaseHolderImpl::closeAll(OperationContext* opCtx, const std::string& re
         delete db;
 
         _dbs.erase(name);
+        _dbsSnapshot.invalidate();
 
         getGlobalServiceContext()
             ->getStorageEngine()
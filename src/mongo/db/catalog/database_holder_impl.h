@@ -37,6 +37,7 @@
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/catalog/util/thread_cached_snapshot.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/string_map.h"
@@ -93,5 +94,9 @@ private:
     typedef StringMap<Database*> DBs;
     mutable SimpleMutex _m;
     DBs _dbs;
+
+    // Copy of _dbs for get(), which runs for every operation. Invalidated under _m whenever _dbs
+    // changes.
+    ThreadCachedSnapshot<DBs> _dbsSnapshot;
 };
 }  // namespace mongo
@@ -744,6 +744,15 @@ void DatabaseImpl::_checkCanCreateCollection(OperationContext* opCtx,
 
     uassert(17316, "cannot create a blank collection", nss.coll() > 0);
     uassert(28838, "cannot create a non-capped oplog collection", options.capped || !nss.isOplog());
+    uassert(ErrorCodes::InvalidOptions,
+            str::stream() << "Cannot create collection " << nss.ns()
+                          << " - the storage engine does not support clustered collections.",
+            !options.clusteredIndex ||
+                opCtx->getServiceContext()->getStorageEngine()->supportsClusteredCollections());
+    uassert(ErrorCodes::InvalidOptions,
+            str::stream() << "Cannot create collection " << nss.ns()
+                          << " - system collections cannot be clustered.",
+            !options.clusteredIndex || !nss.isSystem());
     uassert(ErrorCodes::DatabaseDropPending,
             str::stream() << "Cannot create collection " << nss.ns()
                           << " - database is in the process of being dropped.",
@@ -239,6 +239,11 @@ public:
                                    bool noWarn,
                                    int64_t* keysDeletedOut) = 0;
 
+        virtual void unindexRecords(OperationContext* opCtx,
+                                    const std::vector<BsonRecord>& bsonRecords,
+                                    bool noWarn,
+                                    int64_t* keysDeletedOut) = 0;
+
         virtual std::string getAccessMethodName(OperationContext* opCtx,
                                                 const BSONObj& keyPattern) = 0;
 
@@ -529,6 +534,18 @@ public:
         return this->_impl().unindexRecord(opCtx, obj, loc, noWarn, keysDeletedOut);
     }
 
+    /**
+     * Same as unindexRecord() for each of 'bsonRecords', but removes the keys one index at a time
+     * and in key order within each index. The keys of a document are removed at the timestamp of
+     * its BsonRecord, if it has one.
+     */
+    inline void unindexRecords(OperationContext* const opCtx,
+                               const std::vector<BsonRecord>& bsonRecords,
+                               const bool noWarn,
+                               int64_t* const keysDeletedOut) {
+        return this->_impl().unindexRecords(opCtx, bsonRecords, noWarn, keysDeletedOut);
+    }
+
     // ------- temp internal -------
 
     inline std::string getAccessMethodName(OperationContext* const opCtx,
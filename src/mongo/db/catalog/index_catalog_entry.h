@@ -37,6 +37,7 @@
 #include "mongo/base/shim.h"
 #include "mongo/bson/ordering.h"
 #include "mongo/bson/timestamp.h"
+#include "mongo/db/index/index_build_interceptor.h"
 #include "mongo/db/index/multikey_paths.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
@@ -103,6 +104,11 @@ public:
         virtual boost::optional<Timestamp> getMinimumVisibleSnapshot() = 0;
 
         virtual void setMinimumVisibleSnapshot(Timestamp name) = 0;
+
+        virtual IndexBuildInterceptor* indexBuildInterceptor() = 0;
+
+        virtual void setIndexBuildInterceptor(
+            std::unique_ptr<IndexBuildInterceptor> interceptor) = 0;
     };
 
 public:
@@ -245,6 +251,18 @@ public:
         return this->_impl().setMinimumVisibleSnapshot(name);
     }
 
+    /**
+     * If non-null, writes to this index are diverted to the returned interceptor while a hybrid
+     * index build is in progress. See IndexBuildInterceptor.
+     */
+    IndexBuildInterceptor* indexBuildInterceptor() {
+        return this->_impl().indexBuildInterceptor();
+    }
+
+    void setIndexBuildInterceptor(std::unique_ptr<IndexBuildInterceptor> interceptor) {
+        return this->_impl().setIndexBuildInterceptor(std::move(interceptor));
+    }
+
 private:
     // This structure exists to give us a customization point to decide how to force users of this
     // class to depend upon the corresponding `index_catalog_entry.cpp` Translation Unit (TU).  All
@@ -43,6 +43,7 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_build_interceptor.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/expression_parser.h"
@@ -149,6 +150,7 @@ IndexCatalogEntryImpl::IndexCatalogEntryImpl(IndexCatalogEntry* const this_,
 IndexCatalogEntryImpl::~IndexCatalogEntryImpl() {
     _descriptor->_cachedEntry = nullptr;  // defensive
 
+    _indexBuildInterceptor.reset();
     _headManager.reset();
     _descriptor.reset();
 }
@@ -234,6 +236,12 @@ void IndexCatalogEntryImpl::setMinimumVisibleSnapshot(Timestamp newMinimumVisibl
     }
 }
 
+void IndexCatalogEntryImpl::setIndexBuildInterceptor(
+    std::unique_ptr<IndexBuildInterceptor> interceptor) {
+    invariant(!interceptor || !_indexBuildInterceptor);
+    _indexBuildInterceptor = std::move(interceptor);
+}
+
 void IndexCatalogEntryImpl::setIsReady(bool newIsReady) {
     _isReady = newIsReady;
 }
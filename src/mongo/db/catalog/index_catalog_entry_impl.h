@@ -51,6 +51,7 @@ class CollectionCatalogEntry;
 class CollectionInfoCache;
 class HeadManager;
 class IndexAccessMethod;
+class IndexBuildInterceptor;
 class IndexDescriptor;
 class MatchExpression;
 class OperationContext;
@@ -169,6 +170,12 @@ public:
      */
     void setMinimumVisibleSnapshot(Timestamp newMinimumVisibleSnapshot) final;
 
+    IndexBuildInterceptor* indexBuildInterceptor() final {
+        return _indexBuildInterceptor.get();
+    }
+
+    void setIndexBuildInterceptor(std::unique_ptr<IndexBuildInterceptor> interceptor) final;
+
 private:
     class SetMultikeyChange;
     class SetHeadChange;
@@ -203,6 +210,9 @@ private:
     std::unique_ptr<CollatorInterface> _collator;
     std::unique_ptr<MatchExpression> _filterExpression;
 
+    // Non-null only while a hybrid index build is draining side writes into this index.
+    std::unique_ptr<IndexBuildInterceptor> _indexBuildInterceptor;
+
     // cached stuff
 
     Ordering _ordering;  // TODO: this might be b-tree specific
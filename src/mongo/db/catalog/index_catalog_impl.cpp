@@ -51,6 +51,7 @@
 #include "mongo/db/curop.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_build_interceptor.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index_legacy.h"
 #include "mongo/db/index_names.h"
@@ -1446,8 +1447,21 @@ Status IndexCatalogImpl::_indexFilteredRecords(OperationContext* opCtx,
                 return status;
         }
 
-        Status status = index->accessMethod()->insert(
-            opCtx, *bsonRecord.docPtr, bsonRecord.id, options, &inserted);
+        // While a hybrid index build is loading the index, divert the write to the build's side
+        // writes table. It is applied to the index after the bulk load.
+        Status status = Status::OK();
+        if (auto interceptor = index->indexBuildInterceptor()) {
+            status = interceptor->sideWrite(opCtx,
+                                            index->accessMethod(),
+                                            *bsonRecord.docPtr,
+                                            bsonRecord.id,
+                                            IndexBuildInterceptor::Op::kInsert,
+                                            options,
+                                            &inserted);
+        } else {
+            status = index->accessMethod()->insert(
+                opCtx, *bsonRecord.docPtr, bsonRecord.id, options, &inserted);
+        }
         if (!status.isOK())
             return status;
 
@@ -1475,15 +1489,12 @@ Status IndexCatalogImpl::_indexRecords(OperationContext* opCtx,
     return _indexFilteredRecords(opCtx, index, filteredBsonRecords, keysInsertedOut);
 }
 
-Status IndexCatalogImpl::_unindexRecord(OperationContext* opCtx,
-                                        IndexCatalogEntry* index,
-                                        const BSONObj& obj,
-                                        const RecordId& loc,
-                                        bool logIfError,
-                                        int64_t* keysDeletedOut) {
-    InsertDeleteOptions options;
-    prepareInsertDeleteOptions(opCtx, index->descriptor(), &options);
-    options.logIfError = logIfError;
+void IndexCatalogImpl::_prepareUnindexOptions(OperationContext* opCtx,
+                                              IndexCatalogEntry* index,
+                                              bool logIfError,
+                                              InsertDeleteOptions* options) {
+    prepareInsertDeleteOptions(opCtx, index->descriptor(), options);
+    options->logIfError = logIfError;
 
     // On WiredTiger, we do blind unindexing of records for efficiency.  However, when duplicates
     // are allowed in unique indexes, WiredTiger does not do blind unindexing, and instead confirms
@@ -1491,10 +1502,31 @@ Status IndexCatalogImpl::_unindexRecord(OperationContext* opCtx,
     // We need to disable blind-deletes for in-progress indexes, in order to force recordid-matching
     // for unindex operations, since initial sync can build an index over a collection with
     // duplicates. See SERVER-17487 for more details.
-    options.dupsAllowed = options.dupsAllowed || !index->isReady(opCtx);
+    options->dupsAllowed = options->dupsAllowed || !index->isReady(opCtx);
+}
+
+Status IndexCatalogImpl::_unindexRecord(OperationContext* opCtx,
+                                        IndexCatalogEntry* index,
+                                        const BSONObj& obj,
+                                        const RecordId& loc,
+                                        bool logIfError,
+                                        int64_t* keysDeletedOut) {
+    InsertDeleteOptions options;
+    _prepareUnindexOptions(opCtx, index, logIfError, &options);
 
     int64_t removed;
-    Status status = index->accessMethod()->remove(opCtx, obj, loc, options, &removed);
+    Status status = Status::OK();
+    if (auto interceptor = index->indexBuildInterceptor()) {
+        status = interceptor->sideWrite(opCtx,
+                                        index->accessMethod(),
+                                        obj,
+                                        loc,
+                                        IndexBuildInterceptor::Op::kDelete,
+                                        options,
+                                        &removed);
+    } else {
+        status = index->accessMethod()->remove(opCtx, obj, loc, options, &removed);
+    }
 
     if (!status.isOK()) {
         log() << "Couldn't unindex record " << redact(obj) << " from collection "
@@ -1545,6 +1577,46 @@ void IndexCatalogImpl::unindexRecord(OperationContext* opCtx,
     }
 }
 
+void IndexCatalogImpl::unindexRecords(OperationContext* opCtx,
+                                      const std::vector<BsonRecord>& bsonRecords,
+                                      bool noWarn,
+                                      int64_t* keysDeletedOut) {
+    if (keysDeletedOut) {
+        *keysDeletedOut = 0;
+    }
+
+    for (IndexCatalogEntryContainer::const_iterator i = _entries.begin(); i != _entries.end();
+         ++i) {
+        IndexCatalogEntry* entry = i->get();
+
+        // If it's a background index, we DO NOT want to log anything.
+        bool logIfError = entry->isReady(opCtx) ? !noWarn : false;
+
+        if (entry->indexBuildInterceptor()) {
+            // Removals from an index being built are recorded as side writes one document at a
+            // time.
+            for (const auto& bsonRecord : bsonRecords) {
+                if (!bsonRecord.ts.isNull()) {
+                    uassertStatusOK(opCtx->recoveryUnit()->setTimestamp(bsonRecord.ts));
+                }
+                _unindexRecord(
+                    opCtx, entry, *bsonRecord.docPtr, bsonRecord.id, logIfError, keysDeletedOut)
+                    .transitional_ignore();
+            }
+            continue;
+        }
+
+        InsertDeleteOptions options;
+        _prepareUnindexOptions(opCtx, entry, logIfError, &options);
+
+        int64_t removed;
+        entry->accessMethod()->removeMany(opCtx, bsonRecords, options, &removed);
+        if (keysDeletedOut) {
+            *keysDeletedOut += removed;
+        }
+    }
+}
+
 BSONObj IndexCatalogImpl::fixIndexKey(const BSONObj& key) {
     if (IndexDescriptor::isIdIndexPattern(key)) {
         return _idObj;
@@ -353,6 +353,15 @@ public:
                        bool noWarn,
                        int64_t* keysDeletedOut) override;
 
+    /**
+     * Same as unindexRecord() for each of 'bsonRecords', but removes the keys one index at a time
+     * and in key order within each index.
+     */
+    void unindexRecords(OperationContext* opCtx,
+                        const std::vector<BsonRecord>& bsonRecords,
+                        bool noWarn,
+                        int64_t* keysDeletedOut) override;
+
     // ------- temp internal -------
 
     inline std::string getAccessMethodName(OperationContext* opCtx,
@@ -406,6 +415,11 @@ private:
                           bool logIfError,
                           int64_t* keysDeletedOut);
 
+    void _prepareUnindexOptions(OperationContext* opCtx,
+                                IndexCatalogEntry* index,
+                                bool logIfError,
+                                InsertDeleteOptions* options);
+
     inline const IndexCatalogEntryContainer& _getEntries() const override {
         return this->_entries;
     }
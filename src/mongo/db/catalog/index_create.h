@@ -84,6 +84,10 @@ public:
 
         virtual Status doneInserting(std::set<RecordId>* dupsOut = NULL) = 0;
 
+        virtual Status drainBackgroundWrites() = 0;
+
+        virtual Status checkConstraints() = 0;
+
         virtual void commit(stdx::function<void(const BSONObj& spec)> onCreateFn) = 0;
 
         virtual void abortWithoutCleanup() = 0;
@@ -230,6 +234,31 @@ public:
         return this->_impl().doneInserting(dupsOut);
     }
 
+    /**
+     * For hybrid background index builds, applies the writes that concurrent operations made to
+     * the indexes while they were being loaded. Does nothing for other index builds.
+     *
+     * insertAllDocumentsInCollection() drains most writes while holding an intent lock. Callers
+     * must call this again after upgrading to an exclusive lock, so that no writes are left behind
+     * when the indexes are committed.
+     *
+     * Must not be called inside of a WriteUnitOfWork.
+     */
+    inline Status drainBackgroundWrites() {
+        return this->_impl().drainBackgroundWrites();
+    }
+
+    /**
+     * For hybrid background index builds of unique indexes, returns a DuplicateKey error if
+     * applying concurrent writes left a key that maps to more than one document. Does nothing for
+     * other index builds.
+     *
+     * Must be called after drainBackgroundWrites() while holding an exclusive lock.
+     */
+    inline Status checkConstraints() {
+        return this->_impl().checkConstraints();
+    }
+
     /**
      * Marks the index ready for use. Should only be called as the last method after
      * doneInserting() or insertAllDocumentsInCollection() return success.
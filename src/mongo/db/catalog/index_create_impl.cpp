@@ -45,6 +45,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_build_interceptor.h"
 #include "mongo/db/index/multikey_paths.h"
 #include "mongo/db/multi_key_path_tracker.h"
 #include "mongo/db/op_observer.h"
@@ -54,6 +55,7 @@
 #include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -77,6 +79,34 @@ MONGO_FAIL_POINT_DEFINE(hangAfterIndexBuildOf);
 
 AtomicInt32 maxIndexBuildMemoryUsageMegabytes(500);
 
+// When enabled, background index builds bulk load the index from a collection scan and apply
+// concurrent writes afterwards, instead of inserting each document into the live index. Off by
+// default: a build whose concurrent writes outgrow the side writes buffer is failed.
+MONGO_EXPORT_SERVER_PARAMETER(enableHybridIndexBuilds, bool, false);
+
+// Number of threads that generate and sort keys for bulk index builds. 0 picks one thread per
+// available core, up to 16.
+MONGO_EXPORT_SERVER_PARAMETER(indexBuildKeyGenerationThreads, int, 0);
+
+namespace {
+
+// Number of side writes applied per WriteUnitOfWork when draining a hybrid index build.
+const size_t kDrainBatchSize = 1000;
+
+// Upper bound on the number of key generation threads picked by default.
+const size_t kMaxDefaultKeyGenerationThreads = 16;
+
+// Each key generation thread sorts into its own partition of the bulk builders' memory budget.
+// Fewer threads are used rather than giving a partition less than this.
+const size_t kMinKeyGenerationPartitionBytes = 16 * 1024 * 1024;
+
+// Documents queued by the collection scan are handed to the key generation threads in batches of
+// this many documents per thread, or once they take up this many bytes.
+const size_t kKeyGenerationBatchDocsPerThread = 256;
+const size_t kKeyGenerationBatchMaxBytes = 16 * 1024 * 1024;
+
+}  // namespace
+
 MONGO_REGISTER_SHIM(MultiIndexBlock::makeImpl)
 (OperationContext* const opCtx, Collection* const collection, PrivateTo<MultiIndexBlock>)
     ->std::unique_ptr<MultiIndexBlock::Impl> {
@@ -143,6 +173,7 @@ MultiIndexBlockImpl::MultiIndexBlockImpl(OperationContext* opCtx, Collection* co
     : _collection(collection),
       _opCtx(opCtx),
       _buildInBackground(false),
+      _hybrid(false),
       _allowInterruption(false),
       _ignoreUnique(false),
       _needToCleanup(true) {}
@@ -244,6 +275,12 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlockImpl::init(const std::vector<BSO
         _buildInBackground = (_buildInBackground && info["background"].trueValue());
     }
 
+    // Only builds started on a node accepting writes may be hybrid, since only those can report
+    // a side writes overflow back to the user. Builds replicated to a secondary, or restarted at
+    // startup, must not fail, so they always insert into the live index.
+    _hybrid = _buildInBackground && enableHybridIndexBuilds.load() &&
+        repl::ReplicationCoordinator::get(_opCtx)->canAcceptWritesFor(_opCtx, _collection->ns());
+
     std::vector<BSONObj> indexInfoObjs;
     indexInfoObjs.reserve(indexSpecs.size());
     std::size_t eachIndexBuildMaxMemoryUsageBytes = 0;
@@ -252,6 +289,7 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlockImpl::init(const std::vector<BSO
             static_cast<std::size_t>(maxIndexBuildMemoryUsageMegabytes.load()) * 1024 * 1024 /
             indexSpecs.size();
     }
+    _eachIndexBuildMaxMemoryUsageBytes = eachIndexBuildMaxMemoryUsageBytes;
 
     for (size_t i = 0; i < indexSpecs.size(); i++) {
         BSONObj info = indexSpecs[i];
@@ -274,12 +312,19 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlockImpl::init(const std::vector<BSO
         if (!status.isOK())
             return status;
 
-        if (!_buildInBackground) {
-            // Bulk build process requires foreground building as it assumes nothing is changing
-            // under it.
+        if (!_buildInBackground || _hybrid) {
+            // Bulk build process assumes nothing is changing under it. Hybrid background builds
+            // divert concurrent writes to an interceptor until the bulk load is done.
             index.bulk = index.real->initiateBulk(eachIndexBuildMaxMemoryUsageBytes);
         }
 
+        if (_hybrid) {
+            auto entry = index.block->getEntry();
+            entry->setIndexBuildInterceptor(
+                stdx::make_unique<IndexBuildInterceptor>(entry->descriptor()));
+            index.interceptor = entry->indexBuildInterceptor();
+        }
+
         const IndexDescriptor* descriptor = index.block->getEntry()->descriptor();
 
         IndexCatalog::prepareInsertDeleteOptions(_opCtx, descriptor, &index.options);
@@ -373,6 +418,17 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
     auto exec =
         InternalPlanner::collectionScan(_opCtx, _collection->ns().ns(), _collection, yieldPolicy);
 
+    // Bulk builds generate and sort keys on a pool of threads while this thread scans the
+    // collection. The pool must be stopped before returning, as it refers to this object.
+    auto stopKeyGeneration = MakeGuard([this] {
+        if (_keyGenerationPool) {
+            _keyGenerationPool->shutdown();
+            _keyGenerationPool->join();
+            _keyGenerationPool.reset();
+        }
+    });
+    const bool parallelKeyGeneration = _startParallelKeyGeneration();
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -392,6 +448,12 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
                 continue;
             }
 
+            if (_hybrid) {
+                Status overflowStatus = _checkSideWritesOverflow();
+                if (!overflowStatus.isOK())
+                    return overflowStatus;
+            }
+
             // Make sure we are working with the latest version of the document.
             if (objToIndex.snapshotId() != _opCtx->recoveryUnit()->getSnapshotId() &&
                 !_collection->findDoc(_opCtx, loc, &objToIndex)) {
@@ -405,24 +467,32 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
 
             failPointHangDuringBuild(&hangBeforeIndexBuildOf, "before", objToIndex.value());
 
-            WriteUnitOfWork wunit(_opCtx);
-            Status ret = insert(objToIndex.value(), loc);
-            if (_buildInBackground)
-                exec->saveState();
-            if (ret.isOK()) {
-                wunit.commit();
-            } else if (dupsOut && ret.code() == ErrorCodes::DuplicateKey) {
-                // If dupsOut is non-null, we should only fail the specific insert that
-                // led to a DuplicateKey rather than the whole index build.
-                dupsOut->insert(loc);
+            if (parallelKeyGeneration) {
+                // Bulk builders only report duplicates when committed, so there is nothing to
+                // write here and no unit of work is needed.
+                Status ret = _bufferForKeyGeneration(objToIndex.value(), loc);
+                if (!ret.isOK())
+                    return ret;
             } else {
-                // Fail the index build hard.
-                return ret;
-            }
-            if (_buildInBackground) {
-                auto restoreStatus = exec->restoreState();  // Handles any WCEs internally.
-                if (!restoreStatus.isOK()) {
-                    return restoreStatus;
+                WriteUnitOfWork wunit(_opCtx);
+                Status ret = insert(objToIndex.value(), loc);
+                if (_buildInBackground)
+                    exec->saveState();
+                if (ret.isOK()) {
+                    wunit.commit();
+                } else if (dupsOut && ret.code() == ErrorCodes::DuplicateKey) {
+                    // If dupsOut is non-null, we should only fail the specific insert that
+                    // led to a DuplicateKey rather than the whole index build.
+                    dupsOut->insert(loc);
+                } else {
+                    // Fail the index build hard.
+                    return ret;
+                }
+                if (_buildInBackground) {
+                    auto restoreStatus = exec->restoreState();  // Handles any WCEs internally.
+                    if (!restoreStatus.isOK()) {
+                        return restoreStatus;
+                    }
                 }
             }
 
@@ -474,24 +544,161 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
         }
     }
 
+    if (parallelKeyGeneration) {
+        Status ret = _finishParallelKeyGeneration();
+        if (!ret.isOK())
+            return ret;
+    }
+
     progress->finished();
 
     Status ret = doneInserting(dupsOut);
     if (!ret.isOK())
         return ret;
 
+    // Apply the writes that arrived during the scan while still allowing concurrent writers. The
+    // caller drains whatever is left under an exclusive lock.
+    ret = drainBackgroundWrites();
+    if (!ret.isOK())
+        return ret;
+
     log() << "build index done.  scanned " << n << " total records. " << t.seconds() << " secs";
 
     return Status::OK();
 }
 
+bool MultiIndexBlockImpl::_startParallelKeyGeneration() {
+    invariant(!_keyGenerationPool);
+
+    if (_indexes.empty() || !_indexes[0].bulk)
+        return false;
+
+    const int threadsParam = indexBuildKeyGenerationThreads.load();
+    size_t numThreads = threadsParam > 0
+        ? static_cast<size_t>(threadsParam)
+        : std::min<size_t>(ProcessInfo::getNumAvailableCores(), kMaxDefaultKeyGenerationThreads);
+    numThreads = std::min(numThreads,
+                          _eachIndexBuildMaxMemoryUsageBytes / kMinKeyGenerationPartitionBytes);
+    if (numThreads <= 1)
+        return false;
+
+    // Nothing has been inserted into the bulk builders yet, so they can be replaced by ones that
+    // split the memory budget between partitions.
+    const size_t partitionMaxMemoryUsageBytes = _eachIndexBuildMaxMemoryUsageBytes / numThreads;
+    for (auto& index : _indexes) {
+        invariant(index.bulk);
+        index.bulk = index.real->initiateBulk(partitionMaxMemoryUsageBytes);
+        index.bulkPartitions.clear();
+        index.bulkPartitions.push_back(index.bulk.get());
+        for (size_t i = 1; i < numThreads; ++i) {
+            index.bulkPartitions.push_back(index.bulk->addPartition(partitionMaxMemoryUsageBytes));
+        }
+    }
+
+    ThreadPool::Options options;
+    options.poolName = "IndexBuildKeyGeneration";
+    options.threadNamePrefix = "IndexBuildKeyGeneration-";
+    options.minThreads = numThreads;
+    options.maxThreads = numThreads;
+    options.onCreateThread = [](const std::string& threadName) { Client::initThread(threadName); };
+    _keyGenerationPool = stdx::make_unique<ThreadPool>(options);
+    _keyGenerationPool->startup();
+
+    _numKeyGenerationThreads = numThreads;
+    _queuedDocs.reserve(numThreads * kKeyGenerationBatchDocsPerThread);
+
+    LOG(1) << "\t generating index keys on " << numThreads << " threads";
+    return true;
+}
+
+Status MultiIndexBlockImpl::_bufferForKeyGeneration(const BSONObj& doc, const RecordId& loc) {
+    _queuedDocs.emplace_back(doc.getOwned(), loc);
+    _queuedDocsBytes += doc.objsize();
+
+    if (_queuedDocs.size() < _numKeyGenerationThreads * kKeyGenerationBatchDocsPerThread &&
+        _queuedDocsBytes < kKeyGenerationBatchMaxBytes) {
+        return Status::OK();
+    }
+
+    return _dispatchKeyGenerationBatch();
+}
+
+Status MultiIndexBlockImpl::_dispatchKeyGenerationBatch() {
+    _keyGenerationPool->waitForIdle();
+    {
+        stdx::lock_guard<stdx::mutex> lk(_keyGenerationMutex);
+        if (!_keyGenerationStatus.isOK())
+            return _keyGenerationStatus;
+    }
+
+    _dispatchedDocs.clear();
+    std::swap(_dispatchedDocs, _queuedDocs);
+    _queuedDocsBytes = 0;
+
+    if (_dispatchedDocs.empty())
+        return Status::OK();
+
+    for (size_t partition = 0; partition < _numKeyGenerationThreads; ++partition) {
+        Status status =
+            _keyGenerationPool->schedule([this, partition] { _generateKeys(partition); });
+        if (!status.isOK())
+            return status;
+    }
+
+    return Status::OK();
+}
+
+void MultiIndexBlockImpl::_generateKeys(size_t partition) {
+    // Each thread takes a contiguous slice of the batch and inserts into its own partition of every
+    // index's bulk builder, so threads never share a sorter.
+    const size_t begin = _dispatchedDocs.size() * partition / _numKeyGenerationThreads;
+    const size_t end = _dispatchedDocs.size() * (partition + 1) / _numKeyGenerationThreads;
+
+    try {
+        for (size_t i = begin; i < end; ++i) {
+            const BSONObj& doc = _dispatchedDocs[i].first;
+            const RecordId& loc = _dispatchedDocs[i].second;
+            for (auto& index : _indexes) {
+                if (index.filterExpression && !index.filterExpression->matchesBSON(doc)) {
+                    continue;
+                }
+
+                // The OperationContext belongs to the scanning thread. Bulk builders don't use it.
+                int64_t unused = 0;
+                uassertStatusOK(index.bulkPartitions[partition]->insert(
+                    nullptr, doc, loc, index.options, &unused));
+            }
+        }
+    } catch (const DBException& ex) {
+        stdx::lock_guard<stdx::mutex> lk(_keyGenerationMutex);
+        if (_keyGenerationStatus.isOK()) {
+            _keyGenerationStatus = ex.toStatus();
+        }
+    }
+}
+
+Status MultiIndexBlockImpl::_finishParallelKeyGeneration() {
+    Status status = _dispatchKeyGenerationBatch();
+    if (!status.isOK())
+        return status;
+
+    _keyGenerationPool->waitForIdle();
+    _keyGenerationPool->shutdown();
+    _keyGenerationPool->join();
+    _keyGenerationPool.reset();
+    _dispatchedDocs.clear();
+
+    stdx::lock_guard<stdx::mutex> lk(_keyGenerationMutex);
+    return _keyGenerationStatus;
+}
+
 Status MultiIndexBlockImpl::insert(const BSONObj& doc, const RecordId& loc) {
     for (size_t i = 0; i < _indexes.size(); i++) {
         if (_indexes[i].filterExpression && !_indexes[i].filterExpression->matchesBSON(doc)) {
             continue;
         }
 
-        int64_t unused;
+        int64_t unused = 0;
         Status idxStatus(ErrorCodes::InternalError, "");
         if (_indexes[i].bulk) {
             idxStatus = _indexes[i].bulk->insert(_opCtx, doc, loc, _indexes[i].options, &unused);
@@ -512,14 +719,92 @@ Status MultiIndexBlockImpl::doneInserting(std::set<RecordId>* dupsOut) {
             continue;
         LOG(1) << "\t bulk commit starting for index: "
                << _indexes[i].block->getEntry()->descriptor()->indexName();
+
+        // A duplicate seen by the scan of a hybrid build may be resolved by a concurrent write
+        // that has not been applied yet, so unless the caller collects duplicates such keys are
+        // only checked by checkConstraints().
+        BSONObjSet dupKeysInserted = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
         Status status = _indexes[i].real->commitBulk(_opCtx,
                                                      _indexes[i].bulk.get(),
                                                      _allowInterruption,
                                                      _indexes[i].options.dupsAllowed,
-                                                     dupsOut);
+                                                     dupsOut,
+                                                     _hybrid && !dupsOut ? &dupKeysInserted
+                                                                         : nullptr);
         if (!status.isOK()) {
             return status;
         }
+
+        if (!dupKeysInserted.empty()) {
+            _indexes[i].interceptor->addKeysToCheckForDuplicates(dupKeysInserted);
+        }
+    }
+
+    return Status::OK();
+}
+
+Status MultiIndexBlockImpl::_checkSideWritesOverflow() const {
+    for (const auto& index : _indexes) {
+        if (index.interceptor && index.interceptor->hasOverflowed()) {
+            return Status(ErrorCodes::ExceededMemoryLimit,
+                          str::stream() << "Index build on " << _collection->ns().ns()
+                                        << " index: "
+                                        << index.block->getIndexName()
+                                        << " exceeded the memory limit for concurrent writes");
+        }
+    }
+    return Status::OK();
+}
+
+Status MultiIndexBlockImpl::drainBackgroundWrites() {
+    if (!_hybrid)
+        return Status::OK();
+
+    invariant(!_opCtx->lockState()->inAWriteUnitOfWork());
+
+    // As with the collection scan, accumulate multikey updates on the `MultikeyPathTracker` so that
+    // they are written as part of the update that commits the index.
+    auto stopTracker =
+        MakeGuard([this] { MultikeyPathTracker::get(_opCtx).stopTrackingMultikeyPathInfo(); });
+    if (MultikeyPathTracker::get(_opCtx).isTrackingMultikeyPathInfo()) {
+        stopTracker.Dismiss();
+    }
+    MultikeyPathTracker::get(_opCtx).startTrackingMultikeyPathInfo();
+
+    for (auto& index : _indexes) {
+        int64_t totalApplied = 0;
+        int64_t numApplied;
+        do {
+            if (_allowInterruption && !_opCtx->checkForInterruptNoAssert().isOK())
+                return _opCtx->checkForInterruptNoAssert();
+
+            Status status = index.interceptor->drainWritesIntoIndex(
+                _opCtx, index.real, index.options, kDrainBatchSize, &numApplied);
+            if (!status.isOK())
+                return status;
+            totalApplied += numApplied;
+            // A partial batch means the interceptor has caught up with the writers, whose later
+            // writes are left to the next call.
+        } while (numApplied == static_cast<int64_t>(kDrainBatchSize));
+
+        LOG(1) << "\t applied " << totalApplied
+               << " concurrent writes to index: " << index.block->getIndexName();
+    }
+
+    return Status::OK();
+}
+
+Status MultiIndexBlockImpl::checkConstraints() {
+    if (!_hybrid)
+        return Status::OK();
+
+    for (auto& index : _indexes) {
+        if (index.options.dupsAllowed)
+            continue;
+
+        Status status = index.interceptor->checkDuplicateKeyConstraints(_opCtx, index.real);
+        if (!status.isOK())
+            return status;
     }
 
     return Status::OK();
@@ -548,11 +833,34 @@ void MultiIndexBlockImpl::commit(stdx::function<void(const BSONObj& spec)> onCre
 
         // The bulk builder will track multikey information itself. Non-bulk builders re-use the
         // code path that a typical insert/update uses. State is altered on the non-bulk build
-        // path to accumulate the multikey information on the `MultikeyPathTracker`.
+        // path to accumulate the multikey information on the `MultikeyPathTracker`. Hybrid builds
+        // do both, the latter for the concurrent writes they drained.
         if (_indexes[i].bulk) {
             const auto& bulkBuilder = _indexes[i].bulk;
-            if (bulkBuilder->isMultikey()) {
-                _indexes[i].block->getEntry()->setMultikey(_opCtx, bulkBuilder->getMultikeyPaths());
+            bool isMultikey = bulkBuilder->isMultikey();
+            MultikeyPaths multikeyPaths = bulkBuilder->getMultikeyPaths();
+            if (_indexes[i].interceptor) {
+                invariant(_indexes[i].interceptor->areAllWritesApplied());
+                auto drainedMultikeyPaths = MultikeyPathTracker::get(_opCtx).getMultikeyPathInfo(
+                    _collection->ns(), _indexes[i].block->getIndexName());
+                if (drainedMultikeyPaths) {
+                    if (!isMultikey) {
+                        multikeyPaths = *drainedMultikeyPaths;
+                    } else if (multikeyPaths.size() == drainedMultikeyPaths->size()) {
+                        MultikeyPathTracker::mergeMultikeyPaths(&multikeyPaths,
+                                                                *drainedMultikeyPaths);
+                    }
+                    isMultikey = true;
+                }
+
+                // Writes go straight to the index once it is committed.
+                auto entry = _indexes[i].block->getEntry();
+                _opCtx->recoveryUnit()->onCommit([entry](boost::optional<Timestamp>) {
+                    entry->setIndexBuildInterceptor(nullptr);
+                });
+            }
+            if (isMultikey) {
+                _indexes[i].block->getEntry()->setMultikey(_opCtx, multikeyPaths);
             }
         } else {
             auto multikeyPaths =
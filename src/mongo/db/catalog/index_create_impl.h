@@ -43,13 +43,16 @@
 #include "mongo/db/catalog/index_catalog_impl.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/record_id.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 
 class BackgroundOperation;
 class BSONObj;
 class Collection;
+class IndexBuildInterceptor;
 class OperationContext;
+class ThreadPool;
 
 /**
  * Builds one or more indexes.
@@ -159,6 +162,10 @@ public:
      */
     Status doneInserting(std::set<RecordId>* dupsOut = nullptr) override;
 
+    Status drainBackgroundWrites() override;
+
+    Status checkConstraints() override;
+
     /**
      * Marks the index ready for use. Should only be called as the last method after
      * doneInserting() or insertAllDocumentsInCollection() return success.
@@ -194,12 +201,53 @@ private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
 
+    /**
+     * Returns ExceededMemoryLimit if an index's IndexBuildInterceptor dropped writes because it
+     * reached its memory limit.
+     */
+    Status _checkSideWritesOverflow() const;
+
+    /**
+     * Splits each index's bulk builder into one partition per key generation thread and starts
+     * the thread pool that feeds them. Returns false, leaving the build to generate keys on the
+     * calling thread, if that would not help.
+     */
+    bool _startParallelKeyGeneration();
+
+    /**
+     * Queues a copy of 'doc' for key generation, handing the queue to the key generation threads
+     * once it is full.
+     */
+    Status _bufferForKeyGeneration(const BSONObj& doc, const RecordId& loc);
+
+    /**
+     * Waits for the key generation threads to finish the previous batch, then hands them the
+     * queued documents.
+     */
+    Status _dispatchKeyGenerationBatch();
+
+    /**
+     * Generates the keys of the documents in 'partition' of the dispatched batch for every index,
+     * into that partition's bulk builders. Runs on a key generation thread.
+     */
+    void _generateKeys(size_t partition);
+
+    /**
+     * Hands over any remaining queued documents, waits for all key generation to finish and stops
+     * the key generation threads.
+     */
+    Status _finishParallelKeyGeneration();
+
     struct IndexToBuild {
         std::unique_ptr<IndexCatalogImpl::IndexBuildBlock> block;
 
         IndexAccessMethod* real = NULL;           // owned elsewhere
         const MatchExpression* filterExpression;  // might be NULL, owned elsewhere
         std::unique_ptr<IndexAccessMethod::BulkBuilder> bulk;
+        // With parallel key generation, the partition of 'bulk' fed by each key generation
+        // thread. Partition 0 is 'bulk' itself.
+        std::vector<IndexAccessMethod::BulkBuilder*> bulkPartitions;
+        IndexBuildInterceptor* interceptor = nullptr;  // owned by the index catalog entry
 
         InsertDeleteOptions options;
     };
@@ -213,10 +261,28 @@ private:
     OperationContext* _opCtx;
 
     bool _buildInBackground;
+    // Set by init() for background builds that bulk load the indexes and capture concurrent writes
+    // with an IndexBuildInterceptor.
+    bool _hybrid;
     bool _allowInterruption;
     bool _ignoreUnique;
 
     bool _needToCleanup;
+
+    // Memory budget of the bulk builders of each index, split between their partitions.
+    std::size_t _eachIndexBuildMaxMemoryUsageBytes = 0;
+
+    // Parallel key generation state used by insertAllDocumentsInCollection().
+    std::unique_ptr<ThreadPool> _keyGenerationPool;
+    size_t _numKeyGenerationThreads = 1;
+    // Documents queued by the collection scan, and the batch the key generation threads are
+    // working on. The two are swapped on each dispatch, so that scanning overlaps key generation.
+    std::vector<std::pair<BSONObj, RecordId>> _queuedDocs;
+    std::vector<std::pair<BSONObj, RecordId>> _dispatchedDocs;
+    size_t _queuedDocsBytes = 0;
+    // First error hit by a key generation thread.
+    stdx::mutex _keyGenerationMutex;
+    Status _keyGenerationStatus = Status::OK();
 };
 
 }  // namespace mongo
@@ -0,0 +1,183 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/compiler.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+namespace thread_cached_snapshot_detail {
+
+/**
+ * Source of snapshot versions. Versions are unique across all ThreadCachedSnapshot instances, so a
+ * cache entry left behind by a destroyed instance can never be mistaken for a current one, even if
+ * a new instance is later allocated at the same address.
+ */
+inline uint64_t nextVersion() {
+    static AtomicUInt64 versionCounter;
+    return versionCounter.addAndFetch(1);
+}
+
+struct CacheEntry {
+    const void* owner = nullptr;
+    uint64_t version = 0;
+    std::shared_ptr<const void> snapshot;
+};
+
+/**
+ * Per-thread cache of the most recently read snapshot of each ThreadCachedSnapshot. Each owner has
+ * at most one entry, and the whole cache is dropped at the end of every operation (see
+ * releaseThreadCachedSnapshots), so only threads which are running an operation pin snapshots.
+ */
+inline std::array<CacheEntry, 8>& threadCache() {
+    static thread_local std::array<CacheEntry, 8> cache;
+    return cache;
+}
+
+}  // namespace thread_cached_snapshot_detail
+
+/**
+ * Drops every snapshot cached by the calling thread. Called when an operation ends, so that idle
+ * threads do not keep outdated snapshots, and everything they reference, alive.
+ */
+inline void releaseThreadCachedSnapshots() {
+    for (auto& entry : thread_cached_snapshot_detail::threadCache()) {
+        entry = thread_cached_snapshot_detail::CacheEntry();
+    }
+}
+
+/**
+ * Immutable, lazily rebuilt copy of a read-mostly structure which is protected by a mutex owned by
+ * the caller. Readers of an unchanged structure take no lock and write no shared memory: a single
+ * atomic load of the current version validates a snapshot cached by the reading thread.
+ *
+ * Writers modify the underlying structure under its mutex as before and call invalidate() while
+ * still holding it. The first reader to observe the new version takes the mutex and builds the
+ * next snapshot, which is then shared by all readers until the next invalidation. Building lazily
+ * keeps bursts of modifications, such as registering every collection at startup, from copying
+ * the structure once per modification.
+ *
+ * invalidate() drops the instance's own reference to the current snapshot, so an old snapshot is
+ * freed as soon as no thread caches it any more. A thread releases its references when it next
+ * reads the same ThreadCachedSnapshot after an invalidation, and at the latest when its operation
+ * ends.
+ *
+ * Example:
+ *     stdx::mutex _mutex;
+ *     std::map<std::string, int> _map;         // Protected by _mutex.
+ *     ThreadCachedSnapshot<std::map<std::string, int>> _snapshot;
+ *
+ *     // Writer
+ *     stdx::lock_guard<stdx::mutex> lk(_mutex);
+ *     _map[key] = value;
+ *     _snapshot.invalidate();
+ *
+ *     // Reader
+ *     const auto& map = _snapshot.get(_mutex, [&] { return std::make_shared<Map>(_map); });
+ */
+template <typename T>
+class ThreadCachedSnapshot {
+    MONGO_DISALLOW_COPYING(ThreadCachedSnapshot);
+
+public:
+    ThreadCachedSnapshot() : _version(thread_cached_snapshot_detail::nextVersion()) {}
+
+    /**
+     * Marks all existing snapshots as outdated. Must be called with the mutex protecting the
+     * underlying structure held, after modifying it.
+     */
+    void invalidate() {
+        _version.store(thread_cached_snapshot_detail::nextVersion());
+        _snapshot.reset();
+    }
+
+    /**
+     * Returns a snapshot which reflects every modification followed by an invalidate() call that
+     * happened before this call. If no current snapshot exists, 'mutex' is locked and 'build' is
+     * called with it held to produce one; 'build' must return a std::shared_ptr<const T> (or a type
+     * convertible to it) copied from the underlying structure.
+     *
+     * The returned reference remains valid until the calling thread's next call to get() on any
+     * ThreadCachedSnapshot or to releaseThreadCachedSnapshots(), so callers must copy out what they
+     * need rather than hold on to it.
+     */
+    template <typename Mutex, typename BuildFn>
+    const T& get(Mutex& mutex, BuildFn&& build) const {
+        auto& cache = thread_cached_snapshot_detail::threadCache();
+        const uint64_t version = _version.load();
+
+        thread_cached_snapshot_detail::CacheEntry* slot = nullptr;
+        for (auto& entry : cache) {
+            if (entry.owner == this) {
+                if (MONGO_likely(entry.version == version))
+                    return *static_cast<const T*>(entry.snapshot.get());
+                slot = &entry;
+                break;
+            }
+            if (!slot && !entry.owner)
+                slot = &entry;
+        }
+
+        if (!slot) {
+            // Evict entries round-robin. The evicted owner simply takes the slow path next time.
+            static thread_local size_t nextVictim = 0;
+            slot = &cache[nextVictim++ % cache.size()];
+        }
+
+        stdx::lock_guard<Mutex> lk(mutex);
+        const uint64_t currentVersion = _version.load();
+        if (!_snapshot || _snapshotVersion != currentVersion) {
+            _snapshot = build();
+            _snapshotVersion = currentVersion;
+        }
+
+        slot->owner = this;
+        slot->version = _snapshotVersion;
+        slot->snapshot = _snapshot;
+        return *_snapshot;
+    }
+
+private:
+    AtomicUInt64 _version;
+
+    // Protected by the mutex passed to get().
+    mutable std::shared_ptr<const T> _snapshot;
+    mutable uint64_t _snapshotVersion = 0;
+};
+
+}  // namespace mongo
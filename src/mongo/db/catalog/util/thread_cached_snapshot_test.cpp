@@ -0,0 +1,155 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/db/catalog/util/thread_cached_snapshot.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using Map = std::map<std::string, int>;
+
+class SnapshottedMap {
+public:
+    void set(const std::string& key, int value) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _map[key] = value;
+        _snapshot.invalidate();
+    }
+
+    int get(const std::string& key) const {
+        const Map& map = _snapshot.get(_mutex, [this] {
+            ++builds;
+            auto snapshot = std::make_shared<const Map>(_map);
+            lastBuilt = snapshot;
+            return snapshot;
+        });
+        auto it = map.find(key);
+        return it == map.end() ? -1 : it->second;
+    }
+
+    mutable int builds = 0;
+    mutable std::weak_ptr<const Map> lastBuilt;
+
+private:
+    mutable stdx::mutex _mutex;
+    Map _map;
+    ThreadCachedSnapshot<Map> _snapshot;
+};
+
+TEST(ThreadCachedSnapshot, ReadsSeeInvalidatedWrites) {
+    SnapshottedMap map;
+    ASSERT_EQ(map.get("a"), -1);
+    map.set("a", 1);
+    ASSERT_EQ(map.get("a"), 1);
+    map.set("a", 2);
+    map.set("b", 3);
+    ASSERT_EQ(map.get("a"), 2);
+    ASSERT_EQ(map.get("b"), 3);
+}
+
+TEST(ThreadCachedSnapshot, SnapshotIsOnlyRebuiltAfterInvalidation) {
+    SnapshottedMap map;
+    map.set("a", 1);
+    for (int i = 0; i < 10; ++i)
+        ASSERT_EQ(map.get("a"), 1);
+    ASSERT_EQ(map.builds, 1);
+
+    // Several modifications between reads result in a single rebuild.
+    map.set("a", 2);
+    map.set("a", 3);
+    ASSERT_EQ(map.get("a"), 3);
+    ASSERT_EQ(map.builds, 2);
+}
+
+TEST(ThreadCachedSnapshot, OutdatedSnapshotIsFreedOnceReleased) {
+    SnapshottedMap map;
+    map.set("a", 1);
+    ASSERT_EQ(map.get("a"), 1);
+    ASSERT_FALSE(map.lastBuilt.expired());
+
+    // The snapshot stays cached by this thread after it becomes outdated, until the thread reads
+    // again or its operation ends.
+    map.set("a", 2);
+    ASSERT_FALSE(map.lastBuilt.expired());
+    releaseThreadCachedSnapshots();
+    ASSERT_TRUE(map.lastBuilt.expired());
+
+    ASSERT_EQ(map.get("a"), 2);
+    ASSERT_EQ(map.builds, 2);
+}
+
+TEST(ThreadCachedSnapshot, ManyInstancesPerThread) {
+    // More instances than a thread caches snapshots for, to exercise eviction.
+    std::vector<std::unique_ptr<SnapshottedMap>> maps;
+    for (int i = 0; i < 20; ++i) {
+        maps.push_back(stdx::make_unique<SnapshottedMap>());
+        maps.back()->set("key", i);
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 20; ++i)
+            ASSERT_EQ(maps[i]->get("key"), i);
+    }
+}
+
+TEST(ThreadCachedSnapshot, ConcurrentReadersObserveLatestWrite) {
+    SnapshottedMap map;
+    map.set("counter", 0);
+
+    const int kWrites = 1000;
+    std::vector<stdx::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&map] {
+            int last = 0;
+            while (last < kWrites) {
+                int current = map.get("counter");
+                ASSERT_GTE(current, last);
+                last = current;
+            }
+        });
+    }
+
+    for (int i = 1; i <= kWrites; ++i)
+        map.set("counter", i);
+
+    for (auto& reader : readers)
+        reader.join();
+}
+
+}  // namespace
+}  // namespace mongo
@@ -170,6 +170,7 @@ void UUIDCatalog::onCloseCatalog(OperationContext* opCtx) {
     _shadowCatalog.emplace();
     for (auto entry : _catalog)
         _shadowCatalog->insert({entry.first, entry.second->ns()});
+    _lookupSnapshot.invalidate();
 }
 
 void UUIDCatalog::onOpenCatalog(OperationContext* opCtx) {
@@ -177,29 +178,36 @@ void UUIDCatalog::onOpenCatalog(OperationContext* opCtx) {
     stdx::lock_guard<stdx::mutex> lock(_catalogLock);
     invariant(_shadowCatalog);
     _shadowCatalog.reset();
+    _lookupSnapshot.invalidate();
 }
 
 Collection* UUIDCatalog::lookupCollectionByUUID(CollectionUUID uuid) const {
-    stdx::lock_guard<stdx::mutex> lock(_catalogLock);
-    auto foundIt = _catalog.find(uuid);
-    return foundIt == _catalog.end() ? nullptr : foundIt->second;
+    const auto& lookupMap = _getLookupSnapshot();
+    auto foundIt = lookupMap.find(uuid);
+    return foundIt == lookupMap.end() ? nullptr : foundIt->second.collection;
 }
 
 NamespaceString UUIDCatalog::lookupNSSByUUID(CollectionUUID uuid) const {
-    stdx::lock_guard<stdx::mutex> lock(_catalogLock);
-    auto foundIt = _catalog.find(uuid);
-    if (foundIt != _catalog.end())
-        return foundIt->second->ns();
-
-    // Only in the case that the catalog is closed and a UUID is currently unknown, resolve it
-    // using the pre-close state. This ensures that any tasks reloading the catalog can see their
-    // own updates.
-    if (_shadowCatalog) {
-        auto shadowIt = _shadowCatalog->find(uuid);
-        if (shadowIt != _shadowCatalog->end())
-            return shadowIt->second;
-    }
-    return NamespaceString();
+    // Only in the case that the catalog is closed and a UUID is currently unknown, the snapshot
+    // resolves it using the pre-close state. This ensures that any tasks reloading the catalog can
+    // see their own updates.
+    const auto& lookupMap = _getLookupSnapshot();
+    auto foundIt = lookupMap.find(uuid);
+    return foundIt == lookupMap.end() ? NamespaceString() : foundIt->second.nss;
+}
+
+const UUIDCatalog::LookupMap& UUIDCatalog::_getLookupSnapshot() const {
+    return _lookupSnapshot.get(_catalogLock, [this] {
+        auto lookupMap = std::make_shared<LookupMap>();
+        lookupMap->reserve(_catalog.size());
+        for (const auto& entry : _catalog)
+            lookupMap->emplace(entry.first, LookupEntry{entry.second, entry.second->ns()});
+        if (_shadowCatalog) {
+            for (const auto& entry : *_shadowCatalog)
+                lookupMap->emplace(entry.first, LookupEntry{nullptr, entry.second});
+        }
+        return std::shared_ptr<const LookupMap>(std::move(lookupMap));
+    });
 }
 
 Collection* UUIDCatalog::replaceUUIDCatalogEntry(CollectionUUID uuid, Collection* coll) {
@@ -275,6 +283,7 @@ void UUIDCatalog::_registerUUIDCatalogEntry_inlock(CollectionUUID uuid, Collecti
         std::pair<CollectionUUID, Collection*> entry = std::make_pair(uuid, coll);
         LOG(2) << "registering collection " << coll->ns() << " with UUID " << uuid.toString();
         invariant(_catalog.insert(entry).second == true);
+        _lookupSnapshot.invalidate();
     }
 }
 Collection* UUIDCatalog::_removeUUIDCatalogEntry_inlock(CollectionUUID uuid) {
@@ -288,6 +297,7 @@ Collection* UUIDCatalog::_removeUUIDCatalogEntry_inlock(CollectionUUID uuid) {
     auto foundCol = foundIt->second;
     LOG(2) << "unregistering collection " << foundCol->ns() << " with UUID " << uuid.toString();
     _catalog.erase(foundIt);
+    _lookupSnapshot.invalidate();
     return foundCol;
 }
 }  // namespace mongo
@@ -34,6 +34,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/util/thread_cached_snapshot.h"
 #include "mongo/db/op_observer.h"
 #include "mongo/db/service_context.h"
 #include "mongo/stdx/functional.h"
@@ -65,7 +66,8 @@ public:
                   OptionalCollectionUUID uuid,
                   StmtId stmtId,
                   bool fromMigrate,
-                  const boost::optional<BSONObj>& deletedDoc) override {}
+                  const boost::optional<BSONObj>& deletedDoc,
+                  const OplogSlot& oplogSlot) override {}
     void onInternalOpMessage(OperationContext* opCtx,
                              const NamespaceString& nss,
                              const boost::optional<UUID> uuid,
@@ -218,6 +220,19 @@ private:
     void _registerUUIDCatalogEntry_inlock(CollectionUUID uuid, Collection* coll);
     Collection* _removeUUIDCatalogEntry_inlock(CollectionUUID uuid);
 
+    struct LookupEntry {
+        // Null for entries which only exist in the shadow catalog.
+        Collection* collection;
+        NamespaceString nss;
+    };
+    using LookupMap = mongo::stdx::unordered_map<CollectionUUID, LookupEntry, CollectionUUID::Hash>;
+
+    /**
+     * Returns the current lookup snapshot, building it from _catalog and _shadowCatalog if they
+     * changed since it was last built.
+     */
+    const LookupMap& _getLookupSnapshot() const;
+
     mutable mongo::stdx::mutex _catalogLock;
     /**
      * When present, indicates that the catalog is in closed state, and contains a map from UUID
@@ -235,6 +250,14 @@ private:
      */
     StringMap<std::vector<CollectionUUID>> _orderedCollections;
     mongo::stdx::unordered_map<CollectionUUID, Collection*, CollectionUUID::Hash> _catalog;
+
+    /**
+     * Immutable copy of _catalog and _shadowCatalog, which lets lookupCollectionByUUID and
+     * lookupNSSByUUID run without acquiring _catalogLock. Namespaces are copied when the snapshot
+     * is built, so lookups never dereference a Collection that may concurrently be destroyed.
+     * Invalidated under _catalogLock whenever either map changes.
+     */
+    ThreadCachedSnapshot<LookupMap> _lookupSnapshot;
 };
 
 }  // namespace mongo
@@ -49,6 +49,8 @@
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/cursor_server_params.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/query/explain.h"
+#include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/util/background.h"
@@ -127,6 +129,17 @@ void ClientCursor::dispose(OperationContext* opCtx) {
         return;
     }
 
+    if (_queryShapeMetrics) {
+        if (auto cq = _exec->getCanonicalQuery()) {
+            PlanSummaryStats summaryStats;
+            Explain::getSummaryStats(*_exec, &summaryStats);
+            _queryShapeMetrics->keysExamined = summaryStats.totalKeysExamined;
+            _queryShapeMetrics->docsExamined = summaryStats.totalDocsExamined;
+            QueryShapeStats::get(opCtx).record(
+                opCtx, QueryShapeStats::Shape(*cq), *_queryShapeMetrics);
+        }
+    }
+
     _exec->dispose(opCtx, _cursorManager);
     _disposed = true;
 }
@@ -38,6 +38,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/logical_session_id.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/repl/read_concern_level.h"
 #include "mongo/stdx/functional.h"
@@ -189,6 +190,30 @@ public:
         _pos = n;
     }
 
+    //
+    // Query shape statistics.
+    //
+
+    /**
+     * Makes this cursor record its query in the query shape statistics when it is disposed of, as
+     * a single execution made of all the batches it returned. 'firstBatch' holds the latency and
+     * number of results of the batch which created the cursor.
+     */
+    void recordQueryShapeOnDispose(const QueryShapeStats::ExecutionMetrics& firstBatch) {
+        _queryShapeMetrics = firstBatch;
+    }
+
+    /**
+     * Adds a getMore batch which took 'latency' and returned 'nReturned' results to the execution
+     * recorded when this cursor is disposed of. Does nothing if the cursor's query is not recorded.
+     */
+    void incQueryShapeMetrics(Microseconds latency, long long nReturned) {
+        if (_queryShapeMetrics) {
+            _queryShapeMetrics->latency += latency;
+            _queryShapeMetrics->nReturned += nReturned;
+        }
+    }
+
     //
     // Timing.
     //
@@ -312,6 +337,11 @@ private:
     // Unused maxTime budget for this cursor.
     Microseconds _leftoverMaxTimeMicros = Microseconds::max();
 
+    // The metrics of the batches returned so far, if the query is recorded in the query shape
+    // statistics once the cursor is disposed of. Keys and documents examined are taken from the
+    // executor at that point instead, as it counts them for the lifetime of the cursor.
+    boost::optional<QueryShapeStats::ExecutionMetrics> _queryShapeMetrics;
+
     // The underlying query execution machinery. Must be non-null.
     std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> _exec;
 
@@ -418,6 +418,11 @@ public:
             uassert(28552, "collection dropped during index build", db->getCollection(opCtx, ns));
         }
 
+        // Apply the remaining writes made while the indexes were being built, now that the
+        // exclusive lock keeps any more from arriving.
+        uassertStatusOK(indexer.drainBackgroundWrites());
+        uassertStatusOK(indexer.checkConstraints());
+
         writeConflictRetry(opCtx, kCommandName, ns.ns(), [&] {
             WriteUnitOfWork wunit(opCtx);
 
@@ -327,7 +327,7 @@ public:
             // there is no ClientCursor id, and then return.
             const long long numResults = 0;
             const CursorId cursorId = 0;
-            endQueryOp(opCtx, collection, *exec, numResults, cursorId);
+            endQueryOp(opCtx, collection, *exec, numResults, nullptr);
             appendCursorResponseObject(cursorId, nss.ns(), BSONArray(), &result);
             return true;
         }
@@ -400,9 +400,9 @@ public:
             pinnedCursor.getCursor()->setPos(numResults);
 
             // Fill out curop based on the results.
-            endQueryOp(opCtx, collection, *cursorExec, numResults, cursorId);
+            endQueryOp(opCtx, collection, *cursorExec, numResults, pinnedCursor.getCursor());
         } else {
-            endQueryOp(opCtx, collection, *exec, numResults, cursorId);
+            endQueryOp(opCtx, collection, *exec, numResults, nullptr);
         }
 
         // Generate the response object to send to the client.
@@ -455,6 +455,8 @@ public:
             curOp->debug().execStats = execStatsBob.obj();
         }
 
+        cursor->incQueryShapeMetrics(curOp->elapsedTimeExcludingPauses(), numResults);
+
         if (shouldSaveCursorGetMore(state, exec, cursor->isTailable())) {
             respondWithId = request.cursorid;
 
@@ -43,6 +43,10 @@ namespace {
 
 const int kMaxPerfThreads = 16;  // max number of threads to use for lock perf
 
+// Max number of threads for the point operation lock sequences, which are meant to show how intent
+// locking scales well beyond the number of cores.
+const int kMaxPointOpPerfThreads = 128;
+
 
 class DConcurrencyTest : public benchmark::Fixture {
 public:
@@ -168,6 +172,52 @@ BENCHMARK_DEFINE_F(DConcurrencyTest, BM_MMAPv1CollectionExclusiveLock)(benchmark
     }
 }
 
+/**
+ * The locks taken by a point read: the global, database and collection locks in MODE_IS, with
+ * every thread on the same collection.
+ */
+BENCHMARK_DEFINE_F(DConcurrencyTest, BM_PointReadLockSequence)(benchmark::State& state) {
+    std::unique_ptr<ForceSupportsDocLocking> supportDocLocking;
+
+    if (state.thread_index == 0) {
+        makeKClientsWithLockers<DefaultLockerImpl>(state.threads);
+        supportDocLocking = std::make_unique<ForceSupportsDocLocking>(true);
+    }
+
+    for (auto keepRunning : state) {
+        OperationContext* opCtx = clients[state.thread_index].second.get();
+        Lock::DBLock dlk(opCtx, "test", MODE_IS);
+        Lock::CollectionLock clk(opCtx->lockState(), "test.coll", MODE_IS);
+    }
+
+    if (state.thread_index == 0) {
+        clients.clear();
+    }
+}
+
+/**
+ * The locks taken by a point write: the global, database and collection locks in MODE_IX, with
+ * every thread on the same collection.
+ */
+BENCHMARK_DEFINE_F(DConcurrencyTest, BM_PointWriteLockSequence)(benchmark::State& state) {
+    std::unique_ptr<ForceSupportsDocLocking> supportDocLocking;
+
+    if (state.thread_index == 0) {
+        makeKClientsWithLockers<DefaultLockerImpl>(state.threads);
+        supportDocLocking = std::make_unique<ForceSupportsDocLocking>(true);
+    }
+
+    for (auto keepRunning : state) {
+        OperationContext* opCtx = clients[state.thread_index].second.get();
+        Lock::DBLock dlk(opCtx, "test", MODE_IX);
+        Lock::CollectionLock clk(opCtx->lockState(), "test.coll", MODE_IX);
+    }
+
+    if (state.thread_index == 0) {
+        clients.clear();
+    }
+}
+
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_StdMutex)->ThreadRange(1, kMaxPerfThreads);
 
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_ResourceMutexShared)->ThreadRange(1, kMaxPerfThreads);
@@ -178,6 +228,11 @@ BENCHMARK_REGISTER_F(DConcurrencyTest, BM_CollectionIntentSharedLock)
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_CollectionIntentExclusiveLock)
     ->ThreadRange(1, kMaxPerfThreads);
 
+BENCHMARK_REGISTER_F(DConcurrencyTest, BM_PointReadLockSequence)
+    ->ThreadRange(1, kMaxPointOpPerfThreads);
+BENCHMARK_REGISTER_F(DConcurrencyTest, BM_PointWriteLockSequence)
+    ->ThreadRange(1, kMaxPointOpPerfThreads);
+
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_MMAPv1CollectionSharedLock)
     ->ThreadRange(1, kMaxPerfThreads);
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_MMAPv1CollectionExclusiveLock)
@@ -75,6 +75,10 @@ static const int LockConflictsTable[] = {
 // Mask of modes
 const uint64_t intentModes = (1 << MODE_IS) | (1 << MODE_IX);
 
+// How many higher priority requests may be queued ahead of a waiting request. This bounds the
+// extra delay of internal background work to one pass over that many conflicting requests.
+const unsigned kMaxLockQueueBypass = 16;
+
 // Ensure we do not add new modes without updating the conflicts table
 MONGO_STATIC_ASSERT((sizeof(LockConflictsTable) / sizeof(LockConflictsTable[0])) == LockModesCount);
 
@@ -158,6 +162,31 @@ struct LockHead {
 
         conversionsCount = 0;
         compatibleFirstCount = 0;
+
+        fastPathSlot = nullptr;
+    }
+
+    /**
+     * Puts a waiting request on the conflict queue behind all requests of the same or higher
+     * priority. Waiting requests of lower priority are overtaken, unless they were queued at the
+     * front or have already been overtaken kMaxLockQueueBypass times, so that they are delayed
+     * but never starved.
+     */
+    void enqueueByPriority(LockRequest* request) {
+        request->bypassCount = 0;
+
+        LockRequest* position = conflictList._back;
+        while (position && position->priority > request->priority && !position->enqueueAtFront &&
+               position->bypassCount < kMaxLockQueueBypass) {
+            position = position->prev;
+        }
+
+        for (LockRequest* overtaken = position ? position->next : conflictList._front; overtaken;
+             overtaken = overtaken->next) {
+            overtaken->bypassCount++;
+        }
+
+        conflictList.insertAfter(position, request);
     }
 
     /**
@@ -167,6 +196,15 @@ struct LockHead {
         return !partitions.empty();
     }
 
+    /**
+     * Returns the granted modes, including those of requests granted through the FastPathSlot,
+     * which are not on the granted list. Must be used instead of 'grantedModes' when checking for
+     * conflicts.
+     */
+    uint32_t grantedModesWithFastPath() const {
+        return fastPathSlot ? grantedModes | fastPathSlot->heldModes() : grantedModes;
+    }
+
     /**
      * Locates the request corresponding to the particular locker or returns nullptr. Must be called
      * with the bucket holding this lock head locked.
@@ -203,7 +241,7 @@ struct LockHead {
 
         // New lock request. Queue after all granted modes and after any already requested
         // conflicting modes
-        if (conflicts(request->mode, grantedModes) ||
+        if (conflicts(request->mode, grantedModesWithFastPath()) ||
             (!compatibleFirstCount && conflicts(request->mode, conflictModes))) {
             request->status = LockRequest::STATUS_WAITING;
 
@@ -211,7 +249,7 @@ struct LockHead {
             if (request->enqueueAtFront) {
                 conflictList.push_front(request);
             } else {
-                conflictList.push_back(request);
+                enqueueByPriority(request);
             }
 
             incConflictModeCount(request->mode);
@@ -315,6 +353,10 @@ struct LockHead {
     // TODO: Remove this vector and make LockHead a POD
     std::vector<LockManager::Partition*> partitions;
 
+    // The FastPathSlot owned by this resource, if any. Intent mode requests counted in it are not
+    // on the granted list. Protected by the bucket mutex.
+    FastPathSlot* fastPathSlot;
+
     //
     // Conversion
     //
@@ -405,6 +447,29 @@ void LockHead::migratePartitionedLockHeads() {
     }
 }
 
+//
+// FastPathSlot
+//
+
+AtomicWord<int>& FastPathSlot::counter(const LockRequest* request, LockMode mode) {
+    dassert(mode == MODE_IS || mode == MODE_IX);
+    Shard& shard = shards[request->locker->getId() % kNumShards];
+    return shard.counts[mode == MODE_IX ? 1 : 0];
+}
+
+uint32_t FastPathSlot::heldModes() const {
+    uint32_t modes = 0;
+    for (const auto& shard : shards) {
+        if (shard.counts[0].load() > 0) {
+            modes |= modeMask(MODE_IS);
+        }
+        if (shard.counts[1].load() > 0) {
+            modes |= modeMask(MODE_IX);
+        }
+    }
+    return modes;
+}
+
 //
 // LockManager
 //
@@ -419,6 +484,11 @@ const unsigned LockManager::_numPartitions = 32;
 LockManager::LockManager() {
     _lockBuckets = new LockBucket[_numLockBuckets];
     _partitions = new Partition[_numPartitions];
+
+    // Free slots are kept blocked, see _releaseFastPathSlot
+    for (auto& slot : _fastPathSlots) {
+        slot.blocked.store(true);
+    }
 }
 
 LockManager::~LockManager() {
@@ -441,6 +511,11 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
     request->partitioned = (mode == MODE_IX || mode == MODE_IS);
     request->mode = mode;
 
+    // Fastest path for uncontended intent locks, which takes no mutex at all
+    if (request->partitioned && request->fastPathAllowed && _tryFastPathLock(resId, request)) {
+        return LOCK_OK;
+    }
+
     // For intent modes, try the PartitionedLockHead
     if (request->partitioned) {
         Partition* partition = _getPartition(request);
@@ -464,6 +539,18 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
 
     LockHead* lock = bucket->findOrInsert(resId);
 
+    if (!request->partitioned) {
+        // Stop granting intent modes through the fast path. The requests it has already granted
+        // are accounted for by grantedModesWithFastPath(), so this must happen before newRequest.
+        if (lock->fastPathSlot) {
+            lock->fastPathSlot->blocked.store(true);
+        }
+    } else if (request->fastPathAllowed && !lock->fastPathSlot &&
+               !(lock->grantedModes & (~intentModes)) && !lock->conflictModes) {
+        // Let the following intent requests on this resource skip the bucket
+        _claimFastPathSlot(lock);
+    }
+
     // Start a partitioned lock if possible
     if (request->partitioned && !(lock->grantedModes & (~intentModes)) && !lock->conflictModes) {
         Partition* partition = _getPartition(request);
@@ -515,6 +602,14 @@ LockResult LockManager::convert(ResourceId resId, LockRequest* request, LockMode
 
     LockHead* const lock = it->second;
 
+    if (lock->fastPathSlot && !(modeMask(newMode) & intentModes)) {
+        lock->fastPathSlot->blocked.store(true);
+    }
+
+    if (request->fastPathSlot) {
+        _migrateFastPathRequest(lock, request);
+    }
+
     if (lock->partitioned()) {
         lock->migratePartitionedLockHeads();
     }
@@ -533,6 +628,10 @@ LockResult LockManager::convert(ResourceId resId, LockRequest* request, LockMode
         }
     }
 
+    if (lock->fastPathSlot) {
+        grantedModesWithoutCurrentRequest |= lock->fastPathSlot->heldModes();
+    }
+
     // This check favours conversion requests over pending requests. For example:
     //
     // T1 requests lock L in IS
@@ -569,6 +668,15 @@ bool LockManager::unlock(LockRequest* request) {
         return false;
     }
 
+    if (request->fastPathSlot) {
+        // Fast path requests are always granted and only ever counted in their slot
+        invariant(request->status == LockRequest::STATUS_GRANTED);
+        FastPathSlot* slot = request->fastPathSlot;
+        request->fastPathSlot = nullptr;
+        _releaseFastPathCount(slot, slot->counter(request, request->mode));
+        return true;
+    }
+
     if (request->partitioned) {
         // Unlocking a lock that was acquired as partitioned. The lock request may since have
         // moved to the lock head, but there is no safe way to find out without synchronizing
@@ -639,6 +747,19 @@ bool LockManager::unlock(LockRequest* request) {
 }
 
 void LockManager::downgrade(LockRequest* request, LockMode newMode) {
+    if (request->fastPathSlot) {
+        // Only IX -> IS is possible here. The request is counted under its new mode before it
+        // stops being counted under the old one, so that it never appears unlocked.
+        invariant(request->status == LockRequest::STATUS_GRANTED);
+        invariant(newMode == MODE_IS || newMode == MODE_IX);
+        FastPathSlot* slot = request->fastPathSlot;
+        AtomicWord<int>& oldCounter = slot->counter(request, request->mode);
+        slot->counter(request, newMode).fetchAndAdd(1);
+        request->mode = newMode;
+        _releaseFastPathCount(slot, oldCounter);
+        return;
+    }
+
     invariant(request->lock);
     invariant(request->status == LockRequest::STATUS_GRANTED);
     invariant(request->recursiveCount > 0);
@@ -678,7 +799,7 @@ void LockManager::_cleanupUnusedLocksInBucket(LockBucket* bucket) {
             lock->migratePartitionedLockHeads();
         }
 
-        if (lock->grantedModes == 0) {
+        if (lock->grantedModes == 0 && lock->conflictModes == 0 && _releaseFastPathSlot(lock)) {
             invariant(lock->grantedModes == 0);
             invariant(lock->grantedList._front == nullptr);
             invariant(lock->grantedList._back == nullptr);
@@ -698,6 +819,10 @@ void LockManager::_cleanupUnusedLocksInBucket(LockBucket* bucket) {
 }
 
 void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
+    // Requests granted through the fast path are only known by their modes. Their count can only
+    // go down while there are requests to grant, and each release re-evaluates the lock.
+    const uint32_t fastPathModes = lock->fastPathSlot ? lock->fastPathSlot->heldModes() : 0;
+
     // Unblock any converting requests (because conversions are still counted as granted and
     // are on the granted queue).
     for (LockRequest* iter = lock->grantedList._front;
@@ -727,6 +852,7 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
                     grantedModesWithoutCurrentRequest |= modeMask(static_cast<LockMode>(i));
                 }
             }
+            grantedModesWithoutCurrentRequest |= fastPathModes;
 
             if (!conflicts(iter->convertMode, grantedModesWithoutCurrentRequest)) {
                 lock->conversionsCount--;
@@ -767,7 +893,7 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
         // the granted queue.
         iterNext = iter->next;
 
-        if (conflicts(iter->mode, lock->grantedModes)) {
+        if (conflicts(iter->mode, lock->grantedModes | fastPathModes)) {
             // If iter doesn't have a previous pointer, this means that it is at the front of the
             // queue. If we continue scanning the queue beyond this point, we will starve it by
             // granting more and more requests. However, if we newly transition to compatibleFirst
@@ -805,6 +931,14 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
     // with the bitmask on the modes.
     invariant((lock->grantedModes == 0) ^ (lock->grantedList._front != nullptr));
     invariant((lock->conflictModes == 0) ^ (lock->conflictList._front != nullptr));
+
+    // Once only intent modes are left, intent requests may use the fast path again. A pending
+    // conversion may be waiting for the fast path holders to drain, so the slot stays blocked for
+    // it, which also makes each of their releases re-evaluate the lock.
+    if (lock->fastPathSlot && !(lock->grantedModes & (~intentModes)) && !lock->conflictModes &&
+        !lock->conversionsCount) {
+        lock->fastPathSlot->blocked.store(false);
+    }
 }
 
 LockManager::LockBucket* LockManager::_getBucket(ResourceId resId) const {
@@ -815,6 +949,101 @@ LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
     return &_partitions[request->locker->getId() % _numPartitions];
 }
 
+FastPathSlot* LockManager::_getFastPathSlot(ResourceId resId) {
+    return &_fastPathSlots[resId % _numFastPathSlots];
+}
+
+bool LockManager::_tryFastPathLock(ResourceId resId, LockRequest* request) {
+    FastPathSlot* slot = _getFastPathSlot(resId);
+
+    // Don't write to the counters of a slot which can't be used anyway
+    if (slot->resourceId.load() != resId || slot->blocked.load()) {
+        return false;
+    }
+
+    AtomicWord<int>& counter = slot->counter(request, request->mode);
+    counter.fetchAndAdd(1);
+    if (MONGO_unlikely(slot->blocked.load() || slot->resourceId.load() != resId)) {
+        _releaseFastPathCount(slot, counter);
+        return false;
+    }
+
+    request->partitioned = false;
+    request->fastPathSlot = slot;
+    request->status = LockRequest::STATUS_GRANTED;
+    return true;
+}
+
+void LockManager::_releaseFastPathCount(FastPathSlot* slot, AtomicWord<int>& counter) {
+    counter.fetchAndSubtract(1);
+    if (MONGO_likely(!slot->blocked.load())) {
+        return;
+    }
+
+    // A request on the owning LockHead may be waiting for the slot to drain. If the slot has
+    // changed owners in the meantime, nothing was waiting, since a LockHead only gives up its slot
+    // when it has no requests.
+    const uint64_t owner = slot->resourceId.load();
+    if (!owner) {
+        return;
+    }
+
+    LockBucket* bucket = &_lockBuckets[owner % _numLockBuckets];
+    stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+    for (const auto& entry : bucket->data) {
+        if (entry.first == owner) {
+            _onLockModeChanged(entry.second, true);
+            return;
+        }
+    }
+}
+
+void LockManager::_claimFastPathSlot(LockHead* lock) {
+    invariant(!lock->fastPathSlot);
+    FastPathSlot* slot = _getFastPathSlot(lock->resourceId);
+    if (slot->resourceId.compareAndSwap(0, lock->resourceId) != 0) {
+        // Owned by another resource
+        return;
+    }
+
+    lock->fastPathSlot = slot;
+    slot->blocked.store(false);
+}
+
+bool LockManager::_releaseFastPathSlot(LockHead* lock) {
+    FastPathSlot* slot = lock->fastPathSlot;
+    if (!slot) {
+        return true;
+    }
+
+    // Block the slot first, so that any acquisition racing with the check below either shows up in
+    // it or fails. The slot stays blocked once it is free, until the next owner claims it.
+    slot->blocked.store(true);
+    if (slot->heldModes()) {
+        slot->blocked.store(false);
+        return false;
+    }
+
+    slot->resourceId.store(0);
+    lock->fastPathSlot = nullptr;
+    return true;
+}
+
+void LockManager::_migrateFastPathRequest(LockHead* lock, LockRequest* request) {
+    invariant(request->fastPathSlot == lock->fastPathSlot);
+    invariant(request->status == LockRequest::STATUS_GRANTED);
+
+    FastPathSlot* slot = request->fastPathSlot;
+    request->fastPathSlot = nullptr;
+    request->lock = lock;
+    lock->grantedList.push_back(request);
+    lock->incGrantedModeCount(request->mode);
+
+    // The mode is now accounted for on the LockHead, so nothing can have become grantable and
+    // there is no need to re-evaluate the lock.
+    slot->counter(request, request->mode).fetchAndSubtract(1);
+}
+
 void LockManager::dump() const {
     log() << "Dumping LockManager @ " << static_cast<const void*>(this) << '\n';
 
@@ -1172,10 +1401,14 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
 
     lock = nullptr;
     partitionedLock = nullptr;
+    fastPathSlot = nullptr;
     prev = nullptr;
     next = nullptr;
     status = STATUS_NEW;
     partitioned = false;
+    fastPathAllowed = false;
+    priority = OperationPriority::kInteractive;
+    bypassCount = 0;
     mode = MODE_NONE;
     convertMode = MODE_NONE;
 }
@@ -45,9 +45,57 @@
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
+/**
+ * Lets intent mode (IS and IX) requests on a resource be granted without taking its lock bucket's
+ * mutex or looking its LockHead up. Holders are only counted, per mode, in per-shard counters on
+ * separate cache lines, so that concurrent lockers do not write to the same memory either.
+ *
+ * A slot is claimed for a resource by the first intent request which finds the resource's LockHead
+ * without non-intent granted or pending requests, and is released together with the LockHead in
+ * LockManager::cleanupUnusedLocks. When a request for a non-intent mode arrives on the LockHead,
+ * 'blocked' is set and new intent requests go through the LockHead again. The requests already
+ * counted are not on any list, so the LockHead treats modes with non-zero counts as granted until
+ * they drain; every release which observes 'blocked' re-evaluates the LockHead under the bucket
+ * mutex, so the release which drains the slot grants the waiting requests.
+ *
+ * 'resourceId' and 'blocked' are only written under the bucket mutex of the resource owning the
+ * slot. The fast path increments its counter before it reads 'blocked' and 'resourceId', while
+ * the bucket path sets 'blocked' before it reads the counters, so with sequentially consistent
+ * atomics either the bucket path sees the increment or the fast path sees 'blocked'.
+ */
+struct FastPathSlot {
+    static const unsigned kNumShards = 16;
+
+    struct Shard {
+        // Number of holders in MODE_IS and MODE_IX respectively.
+        AtomicWord<int> counts[2];
+    };
+
+    /**
+     * Returns the counter for 'mode', which must be an intent mode, in the shard of 'request'.
+     */
+    AtomicWord<int>& counter(const LockRequest* request, LockMode mode);
+
+    /**
+     * Returns the bitmask of the modes held through this slot. May include requests which are in
+     * the middle of failing to acquire the fast path, which is harmless since they will re-evaluate
+     * the LockHead once they are done.
+     */
+    uint32_t heldModes() const;
+
+    // The uint64_t value of the ResourceId owning this slot, or 0 if the slot is free.
+    AtomicWord<unsigned long long> resourceId;
+
+    // Set while the owning LockHead has granted or pending requests in non-intent modes.
+    AtomicWord<bool> blocked;
+
+    CacheAligned<Shard> shards[kNumShards];
+};
+
 /**
  * Entry point for the lock manager scheduling functionality. Don't use it directly, but
  * instead go through the Locker interface.
@@ -172,6 +220,44 @@ private:
      */
     Partition* _getPartition(LockRequest* request) const;
 
+    /**
+     * Retrieves the FastPathSlot that 'resId' would use. The slot may be free or owned by a
+     * different resource. There is no need to hold a lock when calling this function.
+     */
+    FastPathSlot* _getFastPathSlot(ResourceId resId);
+
+    /**
+     * Attempts to grant 'request', which must be for an intent mode, by counting it in the
+     * resource's FastPathSlot. Takes no locks. Returns false if the resource does not own its slot
+     * or if the slot is blocked, in which case the request must go through the LockHead.
+     */
+    bool _tryFastPathLock(ResourceId resId, LockRequest* request);
+
+    /**
+     * Decrements 'counter', which must belong to 'slot', and re-evaluates the LockHead owning the
+     * slot if requests may be waiting for the slot to drain.
+     */
+    void _releaseFastPathCount(FastPathSlot* slot, AtomicWord<int>& counter);
+
+    /**
+     * Claims the FastPathSlot for 'lock' if it is free. MUST be called under the lock bucket's
+     * mutex, with no non-intent modes granted or pending on 'lock'.
+     */
+    void _claimFastPathSlot(LockHead* lock);
+
+    /**
+     * Gives up the FastPathSlot of 'lock', if it has one, before 'lock' is deleted. Returns false
+     * if intent locks are still held through the slot, in which case 'lock' must be kept. MUST be
+     * called under the lock bucket's mutex, with no requests on 'lock'.
+     */
+    bool _releaseFastPathSlot(LockHead* lock);
+
+    /**
+     * Moves 'request', granted through the FastPathSlot of 'lock', onto the granted list of 'lock'.
+     * Used before conversions and downgrades. MUST be called under the lock bucket's mutex.
+     */
+    void _migrateFastPathRequest(LockHead* lock, LockRequest* request);
+
     /**
      * Prints the contents of a bucket to the log.
      */
@@ -218,6 +304,9 @@ private:
 
     static const unsigned _numPartitions;
     Partition* _partitions;
+
+    static const unsigned _numFastPathSlots = 64;
+    FastPathSlot _fastPathSlots[_numFastPathSlots];
 };
 
 
@@ -37,6 +37,7 @@
 #include "mongo/base/static_assert.h"
 #include "mongo/base/string_data.h"
 #include "mongo/config.h"
+#include "mongo/db/operation_priority.h"
 #include "mongo/platform/hash_namespace.h"
 
 namespace mongo {
@@ -45,6 +46,7 @@ class Locker;
 
 struct LockHead;
 struct PartitionedLockHead;
+struct FastPathSlot;
 
 /**
  * Lock modes.
@@ -367,6 +369,31 @@ struct LockRequest {
     // No synchronization
     bool partitioned;
 
+    // When set, an intent mode request may be granted through the resource's FastPathSlot, which
+    // counts it without putting it on any list. Requests granted that way are not visible to the
+    // DeadlockDetector, so lockers which rely on deadlock detection leave it unset.
+    //
+    // Written at construction time by Locker
+    // Read by LockManager on any thread
+    // No synchronization
+    bool fastPathAllowed;
+
+    // Scheduling class of the operation making the request. A request which cannot be granted
+    // right away is queued ahead of waiting requests of lower priority, each of which may only be
+    // overtaken a bounded number of times.
+    //
+    // Written by Locker on Locker thread
+    // Read by LockManager on any thread
+    // No synchronization
+    OperationPriority priority;
+
+    // Number of higher priority requests which were queued ahead of this one while it waited.
+    //
+    // Written by LockManager on any thread
+    // Read by LockManager on any thread
+    // Protected by LockHead bucket's mutex
+    unsigned bypassCount;
+
     // How many times has LockManager::lock been called for this request. Locks are released when
     // their recursive count drops to zero.
     //
@@ -395,6 +422,15 @@ struct LockRequest {
     // Protected by LockHead bucket's mutex
     PartitionedLockHead* partitionedLock;
 
+    // Pointer to the slot in which this request is counted if it was granted through the fast
+    // path, or null otherwise. At most one of 'lock', 'partitionedLock' and 'fastPathSlot' is
+    // non-NULL, and a request can only move from 'fastPathSlot' to 'lock', on conversion.
+    //
+    // Written by LockManager on Locker thread
+    // Read by LockManager on Locker thread
+    // No synchronization
+    FastPathSlot* fastPathSlot;
+
     // The linked list chain on which this request hangs off the owning lock head. The reason
     // intrusive linked list is used instead of the std::list class is to allow for entries to be
     // removed from the middle of the list in O(1) time, if they are known instead of having to
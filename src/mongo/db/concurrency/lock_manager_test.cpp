@@ -30,6 +30,7 @@
 
 #include "mongo/db/concurrency/lock_manager_defs.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -575,6 +576,59 @@ TEST(LockManager, ConvertUpgrade) {
     ASSERT(lockMgr.unlock(&request2));
 }
 
+TEST(LockManager, ConvertUpgradeWaitsForFastPathHolders) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+    // The first intent request claims the fast path slot, the next ones are counted in it
+    MMAPV1LockerImpl locker1;
+    LockRequestCombo request1(&locker1);
+    request1.fastPathAllowed = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request1, MODE_IX));
+
+    MMAPV1LockerImpl locker2;
+    LockRequestCombo request2(&locker2);
+    request2.fastPathAllowed = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request2, MODE_IX));
+    ASSERT(request2.fastPathSlot);
+
+    MMAPV1LockerImpl locker3;
+    LockRequestCombo request3(&locker3);
+    request3.fastPathAllowed = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request3, MODE_IS));
+    ASSERT(request3.fastPathSlot);
+
+    // Upgrade the IX lock to X, which must wait for both fast path holders
+    ASSERT(LOCK_WAITING == lockMgr.convert(resId, &request1, MODE_X));
+
+    // New intent requests can no longer use the fast path
+    MMAPV1LockerImpl locker4;
+    LockRequestCombo request4(&locker4);
+    request4.fastPathAllowed = true;
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &request4, MODE_IS));
+    ASSERT(!request4.fastPathSlot);
+
+    // Releasing one of the holders is not enough
+    ASSERT(lockMgr.unlock(&request3));
+    ASSERT(request1.numNotifies == 0);
+    ASSERT(request1.status == LockRequest::STATUS_CONVERTING);
+
+    // Releasing the last one grants the conversion
+    ASSERT(lockMgr.unlock(&request2));
+    ASSERT(request1.numNotifies == 1);
+    ASSERT(request1.lastResult == LOCK_OK);
+    ASSERT(request1.mode == MODE_X);
+    ASSERT(request4.numNotifies == 0);
+
+    // The waiting intent request is granted once the X is released
+    ASSERT(!lockMgr.unlock(&request1));
+    ASSERT(lockMgr.unlock(&request1));
+    ASSERT(request4.numNotifies == 1);
+    ASSERT(request4.lastResult == LOCK_OK);
+
+    ASSERT(lockMgr.unlock(&request4));
+}
+
 TEST(LockManager, Downgrade) {
     LockManager lockMgr;
     const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
@@ -687,6 +741,88 @@ TEST(LockManager, EnqueueAtFront) {
     ASSERT(lockMgr.unlock(&requestLow));
 }
 
+TEST(LockManager, HigherPriorityWaitersAreQueuedFirst) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+    MMAPV1LockerImpl lockerX;
+    LockRequestCombo requestX(&lockerX);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestX, MODE_X));
+
+    MMAPV1LockerImpl lockerBackground;
+    LockRequestCombo requestBackground(&lockerBackground);
+    requestBackground.priority = OperationPriority::kBackground;
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestBackground, MODE_X));
+
+    MMAPV1LockerImpl lockerBatch;
+    LockRequestCombo requestBatch(&lockerBatch);
+    requestBatch.priority = OperationPriority::kBatch;
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestBatch, MODE_X));
+
+    MMAPV1LockerImpl lockerInteractive;
+    LockRequestCombo requestInteractive(&lockerInteractive);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestInteractive, MODE_X));
+
+    // Grants follow priority rather than arrival order.
+    ASSERT(lockMgr.unlock(&requestX));
+    ASSERT_EQ(LOCK_OK, requestInteractive.lastResult);
+    ASSERT_EQ(0, requestBatch.numNotifies);
+    ASSERT_EQ(0, requestBackground.numNotifies);
+
+    ASSERT(lockMgr.unlock(&requestInteractive));
+    ASSERT_EQ(LOCK_OK, requestBatch.lastResult);
+    ASSERT_EQ(0, requestBackground.numNotifies);
+
+    ASSERT(lockMgr.unlock(&requestBatch));
+    ASSERT_EQ(LOCK_OK, requestBackground.lastResult);
+
+    ASSERT(lockMgr.unlock(&requestBackground));
+}
+
+TEST(LockManager, LowerPriorityWaitersAreOnlyOvertakenABoundedNumberOfTimes) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+    MMAPV1LockerImpl lockerX;
+    LockRequestCombo requestX(&lockerX);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestX, MODE_X));
+
+    MMAPV1LockerImpl lockerBackground;
+    LockRequestCombo requestBackground(&lockerBackground);
+    requestBackground.priority = OperationPriority::kBackground;
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestBackground, MODE_X));
+
+    // Queue more interactive requests than may overtake the background request.
+    const int kInteractive = 20;
+    std::vector<std::unique_ptr<MMAPV1LockerImpl>> lockers;
+    std::vector<std::unique_ptr<LockRequestCombo>> requests;
+    for (int i = 0; i < kInteractive; ++i) {
+        lockers.push_back(stdx::make_unique<MMAPV1LockerImpl>());
+        requests.push_back(stdx::make_unique<LockRequestCombo>(lockers.back().get()));
+        ASSERT(LOCK_WAITING == lockMgr.lock(resId, requests.back().get(), MODE_X));
+    }
+
+    // Release the exclusive locks one at a time and find when the background request is granted.
+    ASSERT(lockMgr.unlock(&requestX));
+    int grantedBefore = 0;
+    for (auto&& request : requests) {
+        if (requestBackground.numNotifies)
+            break;
+        ASSERT_EQ(LOCK_OK, request->lastResult);
+        ASSERT(lockMgr.unlock(request.get()));
+        grantedBefore++;
+    }
+    ASSERT_EQ(LOCK_OK, requestBackground.lastResult);
+    ASSERT_GT(grantedBefore, 0);
+    ASSERT_LT(grantedBefore, kInteractive);
+
+    ASSERT(lockMgr.unlock(&requestBackground));
+    for (int i = grantedBefore; i < kInteractive; ++i) {
+        ASSERT_EQ(LOCK_OK, requests[i]->lastResult);
+        ASSERT(lockMgr.unlock(requests[i].get()));
+    }
+}
+
 TEST(LockManager, CompatibleFirstImmediateGrant) {
     LockManager lockMgr;
     const ResourceId resId(RESOURCE_GLOBAL, 0);
@@ -77,6 +77,29 @@ public:
         }
     }
 
+    /**
+     * Inserts 'request' right after 'position', which must be on this list, or at the front if
+     * 'position' is null.
+     */
+    void insertAfter(LockRequest* position, LockRequest* request) {
+        if (position == NULL) {
+            push_front(request);
+            return;
+        }
+
+        invariant(request->next == NULL);
+        invariant(request->prev == NULL);
+
+        request->prev = position;
+        request->next = position->next;
+        if (position->next != NULL) {
+            position->next->prev = request;
+        } else {
+            _back = request;
+        }
+        position->next = request;
+    }
+
     void remove(LockRequest* request) {
         if (request->prev != NULL) {
             request->prev->next = request->next;
@@ -34,9 +34,12 @@
 
 #include "mongo/db/concurrency/lock_state.h"
 
+#include <array>
 #include <vector>
 
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_priority.h"
 #include "mongo/db/service_context.h"
 #include "mongo/platform/compiler.h"
 #include "mongo/stdx/new.h"
@@ -109,6 +112,14 @@ private:
 // Global lock manager instance.
 LockManager globalLockManager;
 
+// Instance-wide lock waits by OperationPriority. Only updated when a lock request has to wait.
+std::array<AtomicInt64, kNumOperationPriorities> lockWaitsByPriority;
+std::array<AtomicInt64, kNumOperationPriorities> lockWaitMicrosByPriority;
+
+OperationPriority priorityOf(OperationContext* opCtx) {
+    return opCtx ? getOperationPriority(opCtx) : OperationPriority::kInteractive;
+}
+
 // Global lock. Every server operation, which uses the Locker must acquire this lock at least
 // once. See comments in the header file (begin/endTransaction) for more information.
 const ResourceId resourceIdGlobal = ResourceId(RESOURCE_GLOBAL, ResourceId::SINGLETON_GLOBAL);
@@ -355,9 +366,10 @@ LockResult LockerImpl<IsForMMAPV1>::_acquireTicket(OperationContext* opCtx,
         auto restoreStateOnErrorGuard = MakeGuard([&] { _clientState.store(kInactive); });
 
         OperationContext* interruptible = _uninterruptibleLocksRequested ? nullptr : opCtx;
+        const OperationPriority priority = priorityOf(opCtx);
         if (deadline == Date_t::max()) {
-            holder->waitForTicket(interruptible);
-        } else if (!holder->waitForTicketUntil(interruptible, deadline)) {
+            holder->waitForTicket(interruptible, priority);
+        } else if (!holder->waitForTicketUntil(interruptible, deadline, priority)) {
             return LOCK_TIMEOUT;
         }
         restoreStateOnErrorGuard.Dismiss();
@@ -787,6 +799,10 @@ LockResult LockerImpl<IsForMMAPV1>::lockBegin(OperationContext* opCtx,
         LockRequestsMap::Iterator itNew = _requests.insert(resId);
         itNew->initNew(this, &_notify);
 
+        // MMAP V1 relies on deadlock detection, which does not see intent locks granted through
+        // the lock manager's fast path
+        itNew->fastPathAllowed = !IsForMMAPV1;
+
         request = itNew.objAddr();
     } else {
         request = it.objAddr();
@@ -830,6 +846,8 @@ LockResult LockerImpl<IsForMMAPV1>::lockBegin(OperationContext* opCtx,
         };
     }
 
+    request->priority = priorityOf(opCtx);
+
     // The notification object must be cleared before we invoke the lock manager, because
     // otherwise we might reset state if the lock becomes granted very fast.
     _notify.clear();
@@ -840,6 +858,7 @@ LockResult LockerImpl<IsForMMAPV1>::lockBegin(OperationContext* opCtx,
     if (result == LOCK_WAITING) {
         globalStats.recordWait(_id, resId, mode);
         _stats.recordWait(resId, mode);
+        lockWaitsByPriority[static_cast<int>(request->priority)].fetchAndAdd(1);
     } else if (result == LOCK_OK && opCtx && _uninterruptibleLocksRequested == 0) {
         // Lock acquisitions are not allowed to succeed when opCtx is marked as interrupted, unless
         // the caller requested an uninterruptible lock.
@@ -923,6 +942,8 @@ LockResult LockerImpl<IsForMMAPV1>::lockComplete(
 
         globalStats.recordWaitTime(_id, resId, mode, elapsedTimeMicros);
         _stats.recordWaitTime(resId, mode, elapsedTimeMicros);
+        lockWaitMicrosByPriority[static_cast<int>(priorityOf(opCtx))].fetchAndAdd(
+            elapsedTimeMicros);
 
         if (result == LOCK_OK)
             break;
@@ -1143,6 +1164,15 @@ void reportGlobalLockingStats(SingleThreadedLockStats* outStats) {
     globalStats.report(outStats);
 }
 
+void reportLockWaitsByPriority(BSONObjBuilder* builder) {
+    for (int i = 0; i < kNumOperationPriorities; ++i) {
+        BSONObjBuilder priorityBuilder(
+            builder->subobjStart(toString(static_cast<OperationPriority>(i))));
+        priorityBuilder.append("totalWaits", lockWaitsByPriority[i].load());
+        priorityBuilder.append("totalWaitMicros", lockWaitMicrosByPriority[i].load());
+    }
+}
+
 void resetGlobalLockStats() {
     globalStats.reset();
 }
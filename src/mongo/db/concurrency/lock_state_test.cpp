@@ -119,6 +119,54 @@ TEST(LockerImpl, ConflictUpgradeWithTimeout) {
 }
 
 
+TEST(LockerImpl, IntentLocksOnFastPathConflictWithExclusive) {
+    const ResourceId resId(RESOURCE_COLLECTION, "TestDB.fastPath"_sd);
+
+    // The first intent lock on the resource goes through its LockHead, the second one may be
+    // counted on the fast path
+    DefaultLockerImpl locker1;
+    ASSERT(LOCK_OK == locker1.lockGlobal(MODE_IX));
+    ASSERT(LOCK_OK == locker1.lock(resId, MODE_IX));
+
+    DefaultLockerImpl locker2;
+    ASSERT(LOCK_OK == locker2.lockGlobal(MODE_IS));
+    ASSERT(LOCK_OK == locker2.lock(resId, MODE_IS));
+
+    // S conflicts with locker1's IX and X with both
+    DefaultLockerImpl locker3;
+    ASSERT(LOCK_OK == locker3.lockGlobal(MODE_IX));
+    ASSERT(LOCK_TIMEOUT == locker3.lock(resId, MODE_S, Date_t::now()));
+    ASSERT(LOCK_WAITING == locker3.lockBegin(nullptr, resId, MODE_X));
+
+    // New intent requests queue behind the pending X
+    DefaultLockerImpl locker4;
+    ASSERT(LOCK_OK == locker4.lockGlobal(MODE_IS));
+    ASSERT(LOCK_TIMEOUT == locker4.lock(resId, MODE_IS, Date_t::now()));
+
+    // Releasing the last intent lock grants the X
+    ASSERT(locker1.unlock(resId));
+    ASSERT(LOCK_TIMEOUT ==
+           locker3.lockComplete(resId, MODE_X, Date_t::now() + Milliseconds(1), false));
+    ASSERT(LOCK_WAITING == locker3.lockBegin(nullptr, resId, MODE_X));
+    ASSERT(locker2.unlock(resId));
+    ASSERT(LOCK_OK == locker3.lockComplete(resId, MODE_X, Date_t::now(), false));
+    ASSERT(locker3.getLockMode(resId) == MODE_X);
+
+    // Intent requests are granted again once the X is gone
+    ASSERT(LOCK_TIMEOUT == locker4.lock(resId, MODE_IS, Date_t::now()));
+    ASSERT(locker3.unlock(resId));
+    ASSERT(LOCK_OK == locker4.lock(resId, MODE_IS, Date_t::now()));
+    ASSERT(LOCK_OK == locker1.lock(resId, MODE_IX, Date_t::now()));
+
+    ASSERT(locker1.unlock(resId));
+    ASSERT(locker4.unlock(resId));
+
+    ASSERT(locker1.unlockGlobal());
+    ASSERT(locker2.unlockGlobal());
+    ASSERT(locker3.unlockGlobal());
+    ASSERT(locker4.unlockGlobal());
+}
+
 TEST(LockerImpl, ReadTransaction) {
     DefaultLockerImpl locker;
 
@@ -224,6 +224,12 @@ typedef LockStats<AtomicInt64> AtomicLockStats;
  */
 void reportGlobalLockingStats(SingleThreadedLockStats* outStats);
 
+/**
+ * Appends the instance-wide number of lock waits and the time spent in them for each
+ * OperationPriority.
+ */
+void reportLockWaitsByPriority(BSONObjBuilder* builder);
+
 /**
  * Currently used for testing only.
  */
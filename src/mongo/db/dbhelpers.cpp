@@ -57,6 +57,7 @@
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/clustered_key.h"
 #include "mongo/db/storage/data_protector.h"
 #include "mongo/db/storage/encryption_hooks.h"
 #include "mongo/db/storage/storage_options.h"
@@ -141,6 +142,30 @@ RecordId Helpers::findOne(OperationContext* opCtx,
     return RecordId();
 }
 
+namespace {
+
+/**
+ * Returns the RecordId of the document with the given _id in a clustered collection, or a null
+ * RecordId if there is no such document.
+ */
+RecordId findClusteredById(OperationContext* opCtx,
+                           const Collection* collection,
+                           const BSONElement& id) {
+    auto key = clusteredkey::keyForId(id);
+    if (!key.isOK()) {
+        // Documents whose _id cannot be a clustered key cannot exist in the collection.
+        return RecordId();
+    }
+
+    RecordData unused;
+    if (!collection->getRecordStore()->findRecord(opCtx, key.getValue(), &unused)) {
+        return RecordId();
+    }
+    return key.getValue();
+}
+
+}  // namespace
+
 bool Helpers::findById(OperationContext* opCtx,
                        Database* database,
                        StringData ns,
@@ -158,16 +183,24 @@ bool Helpers::findById(OperationContext* opCtx,
     if (nsFound)
         *nsFound = true;
 
-    IndexCatalog* catalog = collection->getIndexCatalog();
-    const IndexDescriptor* desc = catalog->findIdIndex(opCtx);
+    RecordId loc;
+    if (collection->getRecordStore()->isClustered()) {
+        if (indexFound)
+            *indexFound = 1;
 
-    if (!desc)
-        return false;
+        loc = findClusteredById(opCtx, collection, query["_id"]);
+    } else {
+        IndexCatalog* catalog = collection->getIndexCatalog();
+        const IndexDescriptor* desc = catalog->findIdIndex(opCtx);
+
+        if (!desc)
+            return false;
 
-    if (indexFound)
-        *indexFound = 1;
+        if (indexFound)
+            *indexFound = 1;
 
-    RecordId loc = catalog->getIndex(desc)->findSingle(opCtx, query["_id"].wrap());
+        loc = catalog->getIndex(desc)->findSingle(opCtx, query["_id"].wrap());
+    }
     if (loc.isNull())
         return false;
     result = collection->docFor(opCtx, loc).value();
@@ -178,6 +211,9 @@ RecordId Helpers::findById(OperationContext* opCtx,
                            Collection* collection,
                            const BSONObj& idquery) {
     verify(collection);
+    if (collection->getRecordStore()->isClustered()) {
+        return findClusteredById(opCtx, collection, idquery["_id"]);
+    }
     IndexCatalog* catalog = collection->getIndexCatalog();
     const IndexDescriptor* desc = catalog->findIdIndex(opCtx);
     uassert(13430, "no _id index", desc);
@@ -71,6 +71,8 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
     _specificStats.direction = params.direction;
     _specificStats.maxTs = params.maxTs;
     invariant(!_params.shouldTrackLatestOplogTimestamp || _params.collection->ns().isOplog());
+    invariant((_params.minRecord.isNull() && _params.maxRecord.isNull()) ||
+              (_params.collection->getRecordStore()->isClustered() && !_params.tailable));
 
     if (params.maxTs) {
         _endConditionBSON = BSON("$gte" << *(params.maxTs));
@@ -148,8 +150,13 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
             return PlanStage::NEED_TIME;
         }
 
+        const RecordId& seekBound =
+            _params.direction == CollectionScanParams::FORWARD ? _params.minRecord
+                                                               : _params.maxRecord;
         if (_lastSeenId.isNull() && !_params.start.isNull()) {
             record = _cursor->seekExact(_params.start);
+        } else if (_lastSeenId.isNull() && !seekBound.isNull()) {
+            record = _cursor->seekNear(seekBound);
         } else {
             // See if the record we're about to access is in memory. If not, pass a fetch
             // request up.
@@ -171,6 +178,10 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
         return PlanStage::NEED_YIELD;
     }
 
+    if (record && _isPastEndBound(record->id)) {
+        record = boost::none;
+    }
+
     if (!record) {
         // We just hit EOF. If we are tailable and have already returned data, leave us in a
         // state to pick up where we left off on the next call to work(). Otherwise EOF is
@@ -202,6 +213,13 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
     return returnIfMatches(member, id, out);
 }
 
+bool CollectionScan::_isPastEndBound(const RecordId& id) const {
+    if (_params.direction == CollectionScanParams::FORWARD) {
+        return !_params.maxRecord.isNull() && id > _params.maxRecord;
+    }
+    return !_params.minRecord.isNull() && id < _params.minRecord;
+}
+
 Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
     auto tsElem = record.data.toBson()[repl::OpTime::kTimestampFieldName];
     if (tsElem.type() != BSONType::bsonTimestamp) {
@@ -94,6 +94,12 @@ private:
      */
     Status setLatestOplogEntryTimestamp(const Record& record);
 
+    /**
+     * Returns true if 'id' lies beyond the end of the [minRecord, maxRecord] range in the
+     * direction of the scan.
+     */
+    bool _isPastEndBound(const RecordId& id) const;
+
     // WorkingSet is not owned by us.
     WorkingSet* _workingSet;
 
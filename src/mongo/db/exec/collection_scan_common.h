@@ -51,6 +51,11 @@ struct CollectionScanParams {
     // not being invalidated before the first call to work(...).
     RecordId start;
 
+    // If non-null, the scan only visits records whose ids are within [minRecord, maxRecord]. Only
+    // supported on clustered collections, where it is used to scan a range of _id values.
+    RecordId minRecord;
+    RecordId maxRecord;
+
     // If present, the collection scan will stop and return EOF the first time it sees a document
     // that does not pass the filter and has 'ts' greater than 'maxTs'.
     boost::optional<Timestamp> maxTs;
@@ -40,6 +40,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/exec/working_set_computed_data.h"
 #include "mongo/db/index/btree_access_method.h"
+#include "mongo/db/storage/clustered_key.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 
@@ -63,9 +64,7 @@ IDHackStage::IDHackStage(OperationContext* opCtx,
       _key(query->getQueryObj()["_id"].wrap()),
       _done(false),
       _idBeingPagedIn(WorkingSet::INVALID_ID) {
-    const IndexCatalog* catalog = _collection->getIndexCatalog();
-    _specificStats.indexName = descriptor->indexName();
-    _accessMethod = catalog->getIndex(descriptor);
+    _initAccessMethod(descriptor);
 
     if (NULL != query->getProj()) {
         _addKeyMetadata = query->getProj()->wantIndexKey();
@@ -86,13 +85,24 @@ IDHackStage::IDHackStage(OperationContext* opCtx,
       _done(false),
       _addKeyMetadata(false),
       _idBeingPagedIn(WorkingSet::INVALID_ID) {
+    _initAccessMethod(descriptor);
+}
+
+IDHackStage::~IDHackStage() {}
+
+void IDHackStage::_initAccessMethod(const IndexDescriptor* descriptor) {
+    if (!descriptor) {
+        // Clustered collections have no _id index; the _id determines the RecordId directly.
+        invariant(_collection->getRecordStore()->isClustered());
+        _accessMethod = nullptr;
+        return;
+    }
+
     const IndexCatalog* catalog = _collection->getIndexCatalog();
     _specificStats.indexName = descriptor->indexName();
     _accessMethod = catalog->getIndex(descriptor);
 }
 
-IDHackStage::~IDHackStage() {}
-
 bool IDHackStage::isEOF() {
     if (WorkingSet::INVALID_ID != _idBeingPagedIn) {
         // We asked the parent for a page-in, but still haven't had a chance to return the
@@ -121,8 +131,17 @@ PlanStage::StageState IDHackStage::doWork(WorkingSetID* out) {
 
     WorkingSetID id = WorkingSet::INVALID_ID;
     try {
-        // Look up the key by going directly to the index.
-        RecordId recordId = _accessMethod->findSingle(getOpCtx(), _key);
+        // Look up the key by going directly to the index, or for a clustered collection,
+        // compute it from the _id and let the fetch below probe the record store.
+        RecordId recordId;
+        if (_accessMethod) {
+            recordId = _accessMethod->findSingle(getOpCtx(), _key);
+        } else {
+            auto clusteredKey = clusteredkey::keyForId(_key.firstElement());
+            if (clusteredKey.isOK()) {
+                recordId = clusteredKey.getValue();
+            }
+        }
 
         // Key not found.
         if (recordId.isNull()) {
@@ -96,6 +96,11 @@ private:
      */
     StageState advance(WorkingSetID id, WorkingSetMember* member, WorkingSetID* out);
 
+    /**
+     * Sets up '_accessMethod' for 'descriptor', which is null when '_collection' is clustered.
+     */
+    void _initAccessMethod(const IndexDescriptor* descriptor);
+
     // Not owned here.
     const Collection* _collection;
 
@@ -104,7 +109,7 @@ private:
     // The WorkingSet we annotate with results.  Not owned by us.
     WorkingSet* _workingSet;
 
-    // Not owned here.
+    // Not owned here. Null if the collection is clustered.
     const IndexAccessMethod* _accessMethod;
 
     // The value to match against the _id field.
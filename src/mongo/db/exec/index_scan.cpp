@@ -110,6 +110,7 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
         _startKey = _params.bounds.startKey;
         _endKey = _params.bounds.endKey;
         _indexCursor->setEndPosition(_endKey, _endKeyInclusive);
+        limitKeyFieldsToDecode();
         return _indexCursor->seek(_startKey, _startKeyInclusive);
     } else {
         // For single intervals, we can use an optimized scan which checks against the position
@@ -118,6 +119,7 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
         if (IndexBoundsBuilder::isSingleInterval(
                 _params.bounds, &_startKey, &_startKeyInclusive, &_endKey, &_endKeyInclusive)) {
             _indexCursor->setEndPosition(_endKey, _endKeyInclusive);
+            limitKeyFieldsToDecode();
             return _indexCursor->seek(_startKey, _startKeyInclusive);
         } else {
             _checker.reset(new IndexBoundsChecker(&_params.bounds, _keyPattern, _params.direction));
@@ -130,6 +132,19 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
     }
 }
 
+void IndexScan::limitKeyFieldsToDecode() {
+    // The bounds are enforced by the cursor's end position here, so only the filter and the key
+    // metadata would otherwise look at fields past those the parent reads.
+    invariant(!_checker);
+    if (!_params.numKeyFieldsToDecode || _filter || _params.addKeyMetadata ||
+        _params.numKeyFieldsToDecode >= static_cast<size_t>(_keyPattern.nFields())) {
+        return;
+    }
+
+    _indexCursor->setNumKeyFieldsToDecode(_params.numKeyFieldsToDecode);
+    _decodesKeyPrefix = true;
+}
+
 PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
     // Get the next kv pair from the index, if any.
     boost::optional<IndexKeyEntry> kv;
@@ -154,8 +169,9 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
     }
 
     if (kv) {
-        // In debug mode, check that the cursor isn't lying to us.
-        if (kDebugBuild && !_startKey.isEmpty()) {
+        // In debug mode, check that the cursor isn't lying to us. A key prefix can't be
+        // compared against the bounds.
+        if (kDebugBuild && !_decodesKeyPrefix && !_startKey.isEmpty()) {
             int cmp = kv->key.woCompare(_startKey,
                                         Ordering::make(_params.descriptor->keyPattern()),
                                         /*compareFieldNames*/ false);
@@ -164,7 +180,7 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
             dassert(_forward ? cmp >= 0 : cmp <= 0);
         }
 
-        if (kDebugBuild && !_endKey.isEmpty()) {
+        if (kDebugBuild && !_decodesKeyPrefix && !_endKey.isEmpty()) {
             int cmp = kv->key.woCompare(_endKey,
                                         Ordering::make(_params.descriptor->keyPattern()),
                                         /*compareFieldNames*/ false);
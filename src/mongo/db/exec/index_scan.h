@@ -49,7 +49,12 @@ class WorkingSet;
 
 struct IndexScanParams {
     IndexScanParams()
-        : descriptor(NULL), direction(1), doNotDedup(false), maxScan(0), addKeyMetadata(false) {}
+        : descriptor(NULL),
+          direction(1),
+          doNotDedup(false),
+          maxScan(0),
+          addKeyMetadata(false),
+          numKeyFieldsToDecode(0) {}
 
     const IndexDescriptor* descriptor;
 
@@ -64,6 +69,11 @@ struct IndexScanParams {
 
     // Do we want to add the key as metadata?
     bool addKeyMetadata;
+
+    // If non-zero, the parent stage only reads this many leading fields of each key. The scan
+    // then asks the index cursor to decode only that prefix when it can do so without affecting
+    // which keys are returned. Zero means all fields are needed.
+    size_t numKeyFieldsToDecode;
 };
 
 /**
@@ -121,6 +131,12 @@ private:
      */
     boost::optional<IndexKeyEntry> initIndexScan();
 
+    /**
+     * Limits the index cursor to decoding a prefix of each key if the parent asked for it and no
+     * part of this stage needs the full key.
+     */
+    void limitKeyFieldsToDecode();
+
     // The WorkingSet we fill with results.  Not owned by us.
     WorkingSet* const _workingSet;
 
@@ -176,6 +192,9 @@ private:
     bool _startKeyInclusive;
     // Is the end key included in the range?
     bool _endKeyInclusive;
+
+    // True if the index cursor returns only a prefix of each key. See limitKeyFieldsToDecode().
+    bool _decodesKeyPrefix = false;
 };
 
 }  // namespace mongo
@@ -96,6 +96,7 @@ ProjectionStage::ProjectionStage(OperationContext* opCtx,
                     // If we are including this key field store its field name.
                     _keyFieldNames.push_back(fieldIt->first);
                     _includeKey.push_back(true);
+                    _numKeyFieldsNeeded = _includeKey.size();
                 }
             }
         } else {
@@ -128,6 +129,23 @@ void ProjectionStage::getSimpleInclusionFields(const BSONObj& projObj, FieldSet*
     }
 }
 
+// static
+size_t ProjectionStage::numCoveredKeyFieldsNeeded(const BSONObj& projObj,
+                                                  const BSONObj& coveredKeyObj) {
+    FieldSet includedFields;
+    getSimpleInclusionFields(projObj, &includedFields);
+
+    size_t numNeeded = 0;
+    size_t keyIndex = 0;
+    for (auto&& elt : coveredKeyObj) {
+        ++keyIndex;
+        if (includedFields.count(elt.fieldNameStringData())) {
+            numNeeded = keyIndex;
+        }
+    }
+    return numNeeded;
+}
+
 // static
 void ProjectionStage::transformSimpleInclusion(const BSONObj& in,
                                                const FieldSet& includedFields,
@@ -170,9 +188,10 @@ Status ProjectionStage::transform(WorkingSetMember* member) {
         invariant(1 == member->keyData.size());
         size_t keyIndex = 0;
 
-        // Look at every key element...
+        // Look at every key element up to the last one we include. The index scan may have
+        // decoded only that prefix of the key.
         BSONObjIterator keyIterator(member->keyData[0].keyData);
-        while (keyIterator.more()) {
+        while (keyIndex < _numKeyFieldsNeeded && keyIterator.more()) {
             BSONElement elt = keyIterator.next();
             // If we're supposed to include it...
             if (_includeKey[keyIndex]) {
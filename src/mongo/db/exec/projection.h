@@ -102,6 +102,13 @@ public:
      */
     static void getSimpleInclusionFields(const BSONObj& projObj, FieldSet* includedFields);
 
+    /**
+     * Given a simple inclusion projection 'projObj' covered by the index with key pattern
+     * 'coveredKeyObj', returns the number of leading key fields the projection reads, i.e. one
+     * past the position of the last included key field.
+     */
+    static size_t numCoveredKeyFieldsNeeded(const BSONObj& projObj, const BSONObj& coveredKeyObj);
+
     /**
      * Applies a simple inclusion projection to 'in', including
      * only the fields specified by 'includedFields'.
@@ -146,6 +153,9 @@ private:
 
     // If the i-th entry of _includeKey is true this is the field name for the i-th key field.
     std::vector<StringData> _keyFieldNames;
+
+    // The number of leading key fields we read. Fields after the last included one are skipped.
+    size_t _numKeyFieldsNeeded = 0;
 };
 
 }  // namespace mongo
@@ -37,6 +37,7 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/s/chunk_heat_map.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -54,9 +55,26 @@ const char* ShardFilterStage::kStageType = "SHARDING_FILTER";
 ShardFilterStage::ShardFilterStage(OperationContext* opCtx,
                                    ScopedCollectionMetadata metadata,
                                    WorkingSet* ws,
-                                   PlanStage* child)
-    : PlanStage(kStageType, opCtx), _ws(ws), _metadata(std::move(metadata)) {
+                                   PlanStage* child,
+                                   std::shared_ptr<ChunkHeatMap> chunkHeatMap)
+    : PlanStage(kStageType, opCtx),
+      _ws(ws),
+      _metadata(std::move(metadata)),
+      _chunkHeatMap(std::move(chunkHeatMap)) {
     _children.emplace_back(child);
+
+    if (_metadata->isSharded()) {
+        _shardKeyPattern = make_unique<ShardKeyPattern>(_metadata->getKeyPattern());
+
+        // The operation is sampled once, rather than each of the documents it returns
+        if (_chunkHeatMap) {
+            _chunkHeatSampleWeight = ChunkHeatMap::sampleOperation();
+        }
+    }
+
+    if (!_chunkHeatSampleWeight) {
+        _chunkHeatMap.reset();
+    }
 }
 
 ShardFilterStage::~ShardFilterStage() {}
@@ -78,10 +96,9 @@ PlanStage::StageState ShardFilterStage::doWork(WorkingSetID* out) {
         // including pending documents from in-progress migrations and orphaned documents from
         // aborted migrations
         if (_metadata->isSharded()) {
-            ShardKeyPattern shardKeyPattern(_metadata->getKeyPattern());
             WorkingSetMember* member = _ws->get(*out);
             WorkingSetMatchableDocument matchable(member);
-            BSONObj shardKey = shardKeyPattern.extractShardKeyFromMatchable(matchable);
+            BSONObj shardKey = _shardKeyPattern->extractShardKeyFromMatchable(matchable);
 
             if (shardKey.isEmpty()) {
                 // We can't find a shard key for this document - this should never happen with
@@ -107,11 +124,20 @@ PlanStage::StageState ShardFilterStage::doWork(WorkingSetID* out) {
                           << "document may have been inserted manually into shard";
             }
 
-            if (!_metadata->keyBelongsToMe(shardKey)) {
+            const auto ownedRanges = _metadata->getOwnedRanges();
+            const bool belongsToMe = ownedRanges
+                ? ownedRanges->contains(shardKey, &_ownedRangesHint)
+                : _metadata->keyBelongsToMe(shardKey);
+
+            if (!belongsToMe) {
                 _ws->free(*out);
                 ++_specificStats.chunkSkips;
                 return PlanStage::NEED_TIME;
             }
+
+            if (_chunkHeatMap) {
+                _recordChunkRead(shardKey);
+            }
         }
 
         // If we're here either we have shard state and our doc passed, or we have no shard
@@ -122,6 +148,23 @@ PlanStage::StageState ShardFilterStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+void ShardFilterStage::_recordChunkRead(const BSONObj& shardKey) {
+    // Results usually come in shard key order, so most documents belong to the previous chunk
+    if (_lastChunkRead && _lastChunkRead->containsKey(shardKey)) {
+        return;
+    }
+
+    auto range = ChunkHeatMap::getOwningChunk(*_metadata, shardKey);
+    if (!range) {
+        return;
+    }
+
+    if (_chunksRead.insert(range->getMin()).second) {
+        _chunkHeatMap->recordRead(*range, _chunkHeatSampleWeight, Date_t::now());
+    }
+    _lastChunkRead = std::move(range);
+}
+
 unique_ptr<PlanStageStats> ShardFilterStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret =
@@ -30,11 +30,18 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/s/scoped_collection_metadata.h"
+#include "mongo/s/catalog/type_chunk.h"
 
 namespace mongo {
 
+class ChunkHeatMap;
+class ShardKeyPattern;
+
 /**
  * This stage drops documents that didn't belong to the shard we're executing on at the time of
  * construction. This matches the contract for sharded cursorids which guarantees that a
@@ -72,10 +79,15 @@ namespace mongo {
  */
 class ShardFilterStage final : public PlanStage {
 public:
+    /**
+     * If 'chunkHeatMap' is specified and the operation is sampled, every chunk which owns documents
+     * returned by the stage is recorded into it as read once by the operation.
+     */
     ShardFilterStage(OperationContext* opCtx,
                      ScopedCollectionMetadata metadata,
                      WorkingSet* ws,
-                     PlanStage* child);
+                     PlanStage* child,
+                     std::shared_ptr<ChunkHeatMap> chunkHeatMap = nullptr);
     ~ShardFilterStage();
 
     bool isEOF() final;
@@ -92,6 +104,11 @@ public:
     static const char* kStageType;
 
 private:
+    /**
+     * Accounts for the read of the chunk which owns 'shardKey', unless it was already accounted.
+     */
+    void _recordChunkRead(const BSONObj& shardKey);
+
     WorkingSet* _ws;
 
     // Stats
@@ -100,6 +117,23 @@ private:
     // Note: it is important that this is the metadata from the time this stage is constructed.
     // See class comment for details.
     ScopedCollectionMetadata _metadata;
+
+    // Parsed once from the metadata rather than for every document. Null if not sharded.
+    std::unique_ptr<ShardKeyPattern> _shardKeyPattern;
+
+    // Where the previous document's shard key fell in the owned ranges, if the metadata has them.
+    // Results usually come in shard key order, or cluster on it, so this saves most searches.
+    size_t _ownedRangesHint = 0;
+
+    // Where to account for the reads against the collection's chunks, if anywhere. Reset unless
+    // the operation was sampled, in which case '_chunkHeatSampleWeight' is the number of operations
+    // the sample stands for.
+    std::shared_ptr<ChunkHeatMap> _chunkHeatMap;
+    int _chunkHeatSampleWeight = 0;
+
+    // The chunks whose reads were already accounted for, and the most recent one of them
+    BSONObjSet _chunksRead = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+    boost::optional<ChunkRange> _lastChunkRead;
 };
 
 }  // namespace mongo
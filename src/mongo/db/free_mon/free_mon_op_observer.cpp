@@ -133,7 +133,8 @@ void FreeMonOpObserver::onDelete(OperationContext* opCtx,
                                  OptionalCollectionUUID uuid,
                                  StmtId stmtId,
                                  bool fromMigrate,
-                                 const boost::optional<BSONObj>& deletedDoc) {
+                                 const boost::optional<BSONObj>& deletedDoc,
+                                 const OplogSlot& oplogSlot) {
     if (nss != NamespaceString::kServerConfigurationNamespace) {
         return;
     }
@@ -70,7 +70,8 @@ public:
                   OptionalCollectionUUID uuid,
                   StmtId stmtId,
                   bool fromMigrate,
-                  const boost::optional<BSONObj>& deletedDoc) final;
+                  const boost::optional<BSONObj>& deletedDoc,
+                  const OplogSlot& oplogSlot) final;
 
     void onInternalOpMessage(OperationContext* opCtx,
                              const NamespaceString& nss,
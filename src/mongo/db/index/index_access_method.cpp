@@ -34,6 +34,8 @@
 
 #include "mongo/db/index/btree_access_method.h"
 
+#include <algorithm>
+#include <cstring>
 #include <utility>
 #include <vector>
 
@@ -115,7 +117,12 @@ private:
 };
 
 IndexAccessMethod::IndexAccessMethod(IndexCatalogEntry* btreeState, SortedDataInterface* btree)
-    : _btreeState(btreeState), _descriptor(btreeState->descriptor()), _newInterface(btree) {
+    : _btreeState(btreeState),
+      _descriptor(btreeState->descriptor()),
+      _newInterface(btree),
+      _keyStringVersion(_descriptor->version() >= IndexVersion::kV2 ? KeyString::Version::V1
+                                                                     : KeyString::Version::V0),
+      _sdiConsumesKeyStrings(_newInterface->consumesKeyStrings(_keyStringVersion)) {
     verify(IndexDescriptor::isIndexVersionSupported(_descriptor->version()));
 }
 
@@ -140,9 +147,22 @@ Status IndexAccessMethod::insert(OperationContext* opCtx,
     // Delegate to the subclass.
     getKeys(obj, options.getKeysMode, &keys, &multikeyPaths);
 
+    return insertKeys(opCtx, keys, multikeyPaths, loc, options, numInserted);
+}
+
+Status IndexAccessMethod::insertKeys(OperationContext* opCtx,
+                                     const BSONObjSet& keys,
+                                     const MultikeyPaths& multikeyPaths,
+                                     const RecordId& loc,
+                                     const InsertDeleteOptions& options,
+                                     int64_t* numInserted) {
+    invariant(numInserted);
+    *numInserted = 0;
+
     Status ret = Status::OK();
+    KeyString keyString(_keyStringVersion);
     for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
-        Status status = _newInterface->insert(opCtx, *i, loc, options.dupsAllowed);
+        Status status = insertOneKey(opCtx, *i, &keyString, loc, options.dupsAllowed);
 
         // Everything's OK, carry on.
         if (status.isOK()) {
@@ -169,7 +189,7 @@ Status IndexAccessMethod::insert(OperationContext* opCtx,
 
         // Clean up after ourselves.
         for (BSONObjSet::const_iterator j = keys.begin(); j != i; ++j) {
-            removeOneKey(opCtx, *j, loc, options.dupsAllowed);
+            removeOneKey(opCtx, *j, &keyString, loc, options.dupsAllowed);
             *numInserted = 0;
         }
 
@@ -183,13 +203,32 @@ Status IndexAccessMethod::insert(OperationContext* opCtx,
     return ret;
 }
 
+Status IndexAccessMethod::insertOneKey(OperationContext* opCtx,
+                                       const BSONObj& key,
+                                       KeyString* keyString,
+                                       const RecordId& loc,
+                                       bool dupsAllowed) {
+    if (!_sdiConsumesKeyStrings) {
+        return _newInterface->insert(opCtx, key, loc, dupsAllowed);
+    }
+
+    keyString->resetToKey(key, _btreeState->ordering(), loc);
+    return _newInterface->insertKeyString(opCtx, key, *keyString, loc, dupsAllowed);
+}
+
 void IndexAccessMethod::removeOneKey(OperationContext* opCtx,
                                      const BSONObj& key,
+                                     KeyString* keyString,
                                      const RecordId& loc,
                                      bool dupsAllowed) {
 
     try {
-        _newInterface->unindex(opCtx, key, loc, dupsAllowed);
+        if (_sdiConsumesKeyStrings) {
+            keyString->resetToKey(key, _btreeState->ordering(), loc);
+            _newInterface->unindexKeyString(opCtx, key, *keyString, loc, dupsAllowed);
+        } else {
+            _newInterface->unindex(opCtx, key, loc, dupsAllowed);
+        }
         IndexKeyEntry indexEntry = IndexKeyEntry(key, loc);
     } catch (AssertionException& e) {
         log() << "Assertion failure: _unindex failed " << _descriptor->indexNamespace();
@@ -227,12 +266,79 @@ Status IndexAccessMethod::remove(OperationContext* opCtx,
     // those that don't apply to the partialIndex filter.
     getKeys(obj, GetKeysMode::kRelaxConstraintsUnfiltered, &keys, multikeyPaths);
 
+    removeKeys(opCtx, keys, loc, options, numDeleted);
+    return Status::OK();
+}
+
+void IndexAccessMethod::removeKeys(OperationContext* opCtx,
+                                   const BSONObjSet& keys,
+                                   const RecordId& loc,
+                                   const InsertDeleteOptions& options,
+                                   int64_t* numDeleted) {
+    invariant(numDeleted);
+    *numDeleted = 0;
+
+    KeyString keyString(_keyStringVersion);
     for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
-        removeOneKey(opCtx, *i, loc, options.dupsAllowed);
+        removeOneKey(opCtx, *i, &keyString, loc, options.dupsAllowed);
         ++*numDeleted;
     }
+}
 
-    return Status::OK();
+void IndexAccessMethod::removeMany(OperationContext* opCtx,
+                                   const std::vector<BsonRecord>& bsonRecords,
+                                   const InsertDeleteOptions& options,
+                                   int64_t* numDeleted) {
+    invariant(numDeleted);
+    *numDeleted = 0;
+
+    struct KeyToRemove {
+        std::pair<BSONObj, RecordId> entry;
+        Timestamp ts;
+    };
+
+    std::vector<KeyToRemove> toRemove;
+    for (const auto& bsonRecord : bsonRecords) {
+        BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+        // See remove() for why the key constraints are relaxed and no multikey paths are needed.
+        MultikeyPaths* multikeyPaths = nullptr;
+        getKeys(*bsonRecord.docPtr,
+                GetKeysMode::kRelaxConstraintsUnfiltered,
+                &keys,
+                multikeyPaths);
+
+        for (const auto& key : keys) {
+            toRemove.push_back({{key, bsonRecord.id}, bsonRecord.ts});
+        }
+    }
+
+    // The keys are removed in the order of the index, which sorts them the way the external
+    // sorter of index builds does.
+    const BtreeExternalSortComparison comparison(_descriptor->keyPattern(), _descriptor->version());
+    std::sort(toRemove.begin(),
+              toRemove.end(),
+              [&](const KeyToRemove& lhs, const KeyToRemove& rhs) {
+                  return comparison(lhs.entry, rhs.entry) < 0;
+              });
+
+    KeyString keyString(_keyStringVersion);
+    Timestamp lastTimestampSet;
+    for (const auto& key : toRemove) {
+        // Each key is removed at the timestamp of its document's delete, which the documents of
+        // the batch interleave in key order.
+        if (!key.ts.isNull() && key.ts != lastTimestampSet) {
+            uassertStatusOK(opCtx->recoveryUnit()->setTimestamp(key.ts));
+            lastTimestampSet = key.ts;
+        }
+        removeOneKey(opCtx, key.entry.first, &keyString, key.entry.second, options.dupsAllowed);
+        ++*numDeleted;
+    }
+}
+
+void IndexAccessMethod::truncateRange(OperationContext* opCtx,
+                                      const BSONObj& startKey,
+                                      const BSONObj& endKey) {
+    _newInterface->truncateRange(opCtx, startKey, endKey);
 }
 
 Status IndexAccessMethod::initializeAsEmpty(OperationContext* opCtx) {
@@ -364,13 +470,82 @@ Status IndexAccessMethod::validateUpdate(OperationContext* opCtx,
     ticket->loc = record;
     ticket->dupsAllowed = options.dupsAllowed;
 
-    std::tie(ticket->removed, ticket->added) = setDifference(ticket->oldKeys, ticket->newKeys);
+    diffKeysForUpdate(ticket);
 
     ticket->_isValid = true;
 
     return Status::OK();
 }
 
+void IndexAccessMethod::diffKeysForUpdate(UpdateTicket* ticket) const {
+    // The encodings of the old and new keys are built in one KeyString and copied one after the
+    // other into a single buffer, rather than each kept in a KeyString of its own.
+    struct EncodedKey {
+        const BSONObj* key;
+        size_t offset;
+        size_t size;
+    };
+
+    StackBufBuilder encodings;
+    KeyString keyString(_keyStringVersion);
+    auto encode = [&](const BSONObjSet& keys) {
+        std::vector<EncodedKey> encoded;
+        encoded.reserve(keys.size());
+        for (const auto& key : keys) {
+            keyString.resetToKey(key, _btreeState->ordering(), ticket->loc);
+            encoded.push_back({&key, static_cast<size_t>(encodings.len()), keyString.getSize()});
+            encodings.appendBuf(keyString.getBuffer(), keyString.getSize());
+        }
+        return encoded;
+    };
+
+    std::vector<EncodedKey> oldEncoded = encode(ticket->oldKeys);
+    std::vector<EncodedKey> newEncoded = encode(ticket->newKeys);
+
+    // Compares encodings as KeyString::compare() does.
+    auto compare = [&](const EncodedKey& lhs, const EncodedKey& rhs) {
+        const int cmp = memcmp(encodings.buf() + lhs.offset,
+                               encodings.buf() + rhs.offset,
+                               std::min(lhs.size, rhs.size));
+        if (cmp) {
+            return cmp < 0 ? -1 : 1;
+        }
+        return lhs.size == rhs.size ? 0 : (lhs.size < rhs.size ? -1 : 1);
+    };
+
+    // The encodings sort the way the index does, which for descending fields is not the order of
+    // the BSONObjSet.
+    auto less = [&](const EncodedKey& lhs, const EncodedKey& rhs) { return compare(lhs, rhs) < 0; };
+    std::sort(oldEncoded.begin(), oldEncoded.end(), less);
+    std::sort(newEncoded.begin(), newEncoded.end(), less);
+
+    auto oldIt = oldEncoded.begin();
+    auto newIt = newEncoded.begin();
+    while (oldIt != oldEncoded.end() && newIt != newEncoded.end()) {
+        const int cmp = compare(*oldIt, *newIt);
+        if (cmp == 0) {
+            // Keys with the same encoding may still differ in type (e.g. 0.0 and 0LL), which is
+            // recorded in the TypeBits and should result in an index change, as in setDifference().
+            if (!oldIt->key->binaryEqual(*newIt->key)) {
+                ticket->removed.push_back(*oldIt->key);
+                ticket->added.push_back(*newIt->key);
+            }
+            ++oldIt;
+            ++newIt;
+        } else if (cmp > 0) {
+            ticket->added.push_back(*(newIt++)->key);
+        } else {
+            ticket->removed.push_back(*(oldIt++)->key);
+        }
+    }
+    for (; oldIt != oldEncoded.end(); ++oldIt) {
+        ticket->removed.push_back(*oldIt->key);
+    }
+    for (; newIt != newEncoded.end(); ++newIt) {
+        ticket->added.push_back(*newIt->key);
+    }
+}
+
 Status IndexAccessMethod::update(OperationContext* opCtx,
                                  const UpdateTicket& ticket,
                                  int64_t* numInserted,
@@ -390,14 +565,21 @@ Status IndexAccessMethod::update(OperationContext* opCtx,
         _btreeState->setMultikey(opCtx, ticket.newMultikeyPaths);
     }
 
+    KeyString keyString(_keyStringVersion);
     for (size_t i = 0; i < ticket.removed.size(); ++i) {
-        _newInterface->unindex(opCtx, ticket.removed[i], ticket.loc, ticket.dupsAllowed);
+        if (_sdiConsumesKeyStrings) {
+            keyString.resetToKey(ticket.removed[i], _btreeState->ordering(), ticket.loc);
+            _newInterface->unindexKeyString(
+                opCtx, ticket.removed[i], keyString, ticket.loc, ticket.dupsAllowed);
+        } else {
+            _newInterface->unindex(opCtx, ticket.removed[i], ticket.loc, ticket.dupsAllowed);
+        }
         IndexKeyEntry indexEntry = IndexKeyEntry(ticket.removed[i], ticket.loc);
     }
 
     for (size_t i = 0; i < ticket.added.size(); ++i) {
         Status status =
-            _newInterface->insert(opCtx, ticket.added[i], ticket.loc, ticket.dupsAllowed);
+            insertOneKey(opCtx, ticket.added[i], &keyString, ticket.loc, ticket.dupsAllowed);
         if (!status.isOK()) {
             if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(opCtx)) {
                 // Ignore.
@@ -435,7 +617,15 @@ IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
               .ExtSortAllowed()
               .MaxMemoryUsageBytes(maxMemoryUsageBytes),
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
-      _real(index) {}
+      _real(index),
+      _descriptor(descriptor) {}
+
+IndexAccessMethod::BulkBuilder* IndexAccessMethod::BulkBuilder::addPartition(
+    size_t maxMemoryUsageBytes) {
+    invariant(_keysInserted == 0);
+    _partitions.emplace_back(new BulkBuilder(_real, _descriptor, maxMemoryUsageBytes));
+    return _partitions.back().get();
+}
 
 Status IndexAccessMethod::BulkBuilder::insert(OperationContext* opCtx,
                                               const BSONObj& obj,
@@ -477,22 +667,43 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
                                      BulkBuilder* bulk,
                                      bool mayInterrupt,
                                      bool dupsAllowed,
-                                     set<RecordId>* dupsToDrop) {
+                                     set<RecordId>* dupsToDrop,
+                                     BSONObjSet* dupKeysInserted) {
     Timer timer;
+    const bool recordDupKeys = !dupsAllowed && dupKeysInserted;
 
-    std::unique_ptr<BulkBuilder::Sorter::Iterator> it(bulk->_sorter->done());
+    std::unique_ptr<BulkBuilder::Sorter::Iterator> it;
+    int64_t keysInserted = bulk->_keysInserted;
+    if (bulk->_partitions.empty()) {
+        it.reset(bulk->_sorter->done());
+    } else {
+        // Each partition sorted its own keys. Merge the sorted runs of all partitions into a
+        // single stream in index order.
+        std::vector<std::shared_ptr<BulkBuilder::Sorter::Iterator>> partitionIts;
+        partitionIts.emplace_back(bulk->_sorter->done());
+        for (const auto& partition : bulk->_partitions) {
+            partitionIts.emplace_back(partition->_sorter->done());
+            keysInserted += partition->_keysInserted;
+        }
+        it.reset(BulkBuilder::Sorter::Iterator::merge(
+            partitionIts,
+            "",  // The partitions' iterators clean up their own spill files.
+            SortOptions(),
+            BtreeExternalSortComparison(_descriptor->keyPattern(), _descriptor->version())));
+    }
 
     stdx::unique_lock<Client> lk(*opCtx->getClient());
     ProgressMeterHolder pm(
         CurOp::get(opCtx)->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
                                              "Index: (2/3) BTree Bottom Up Progress",
-                                             bulk->_keysInserted,
+                                             keysInserted,
                                              10));
     lk.unlock();
 
     auto builder = std::unique_ptr<SortedDataBuilderInterface>(
-        _newInterface->getBulkBuilder(opCtx, dupsAllowed));
+        _newInterface->getBulkBuilder(opCtx, dupsAllowed || recordDupKeys));
 
+    BSONObj previousKey;
     while (it->more()) {
         if (mayInterrupt) {
             opCtx->checkForInterrupt();
@@ -507,6 +718,14 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
 
         // Get the next datum and add it to the builder.
         BulkBuilder::Sorter::Data data = it->next();
+        if (recordDupKeys) {
+            // Keys come out of the sorter in order, so duplicates are adjacent.
+            if (!previousKey.isEmpty() &&
+                data.first.woCompare(previousKey, BSONObj(), /*considerFieldNames*/ false) == 0) {
+                dupKeysInserted->insert(data.first.getOwned());
+            }
+            previousKey = data.first.getOwned();
+        }
         Status status = builder->addKey(data.first, data.second);
 
         if (!status.isOK()) {
@@ -611,7 +830,34 @@ void IndexAccessMethod::getKeys(const BSONObj& obj,
 }
 
 bool IndexAccessMethod::BulkBuilder::isMultikey() const {
-    return _everGeneratedMultipleKeys || isMultikeyFromPaths(_indexMultikeyPaths);
+    if (_everGeneratedMultipleKeys || isMultikeyFromPaths(_indexMultikeyPaths)) {
+        return true;
+    }
+    for (const auto& partition : _partitions) {
+        if (partition->isMultikey()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+MultikeyPaths IndexAccessMethod::BulkBuilder::getMultikeyPaths() const {
+    MultikeyPaths multikeyPaths = _indexMultikeyPaths;
+    for (const auto& partition : _partitions) {
+        const MultikeyPaths& partitionPaths = partition->_indexMultikeyPaths;
+        if (partitionPaths.empty()) {
+            continue;
+        }
+        if (multikeyPaths.empty()) {
+            multikeyPaths = partitionPaths;
+            continue;
+        }
+        invariant(multikeyPaths.size() == partitionPaths.size());
+        for (size_t i = 0; i < partitionPaths.size(); ++i) {
+            multikeyPaths[i].insert(partitionPaths[i].begin(), partitionPaths[i].end());
+        }
+    }
+    return multikeyPaths;
 }
 
 /**
@@ -32,6 +32,7 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/simple_bsonobj_comparator.h"
@@ -40,6 +41,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/sorted_data_interface.h"
 
 namespace mongo {
@@ -49,6 +51,7 @@ extern AtomicBool failIndexKeyTooLong;
 class BSONObjBuilder;
 class MatchExpression;
 class UpdateTicket;
+struct BsonRecord;
 struct InsertDeleteOptions;
 
 /**
@@ -96,6 +99,44 @@ public:
                   const InsertDeleteOptions& options,
                   int64_t* numDeleted);
 
+    /**
+     * Inserts (k -> 'loc') into the index for each of the precomputed 'keys', which must have been
+     * generated by getKeys() along with 'multikeyPaths'. Behaves like insert() otherwise.
+     */
+    Status insertKeys(OperationContext* opCtx,
+                      const BSONObjSet& keys,
+                      const MultikeyPaths& multikeyPaths,
+                      const RecordId& loc,
+                      const InsertDeleteOptions& options,
+                      int64_t* numInserted);
+
+    /**
+     * Removes (k -> 'loc') from the index for each of the precomputed 'keys'. Behaves like
+     * remove() otherwise.
+     */
+    void removeKeys(OperationContext* opCtx,
+                    const BSONObjSet& keys,
+                    const RecordId& loc,
+                    const InsertDeleteOptions& options,
+                    int64_t* numDeleted);
+
+    /**
+     * Removes the keys of every document in 'bsonRecords'. The keys of all the documents are
+     * generated first and removed in index order, so that a large batch walks the index once
+     * instead of seeking back and forth for each document. Each key is removed at the timestamp of
+     * its document's BsonRecord, if it has one. Behaves like remove() otherwise.
+     */
+    void removeMany(OperationContext* opCtx,
+                    const std::vector<BsonRecord>& bsonRecords,
+                    const InsertDeleteOptions& options,
+                    int64_t* numDeleted);
+
+    /**
+     * Removes every entry whose key lies in [startKey, endKey]. See
+     * SortedDataInterface::truncateRange().
+     */
+    void truncateRange(OperationContext* opCtx, const BSONObj& startKey, const BSONObj& endKey);
+
     /**
      * Checks whether the index entries for the document 'from', which is placed at location
      * 'loc' on disk, can be changed to the index entries for the doc 'to'. Provides a ticket
@@ -212,9 +253,21 @@ public:
                       const InsertDeleteOptions& options,
                       int64_t* numInserted);
 
-        const MultikeyPaths& getMultikeyPaths() const {
-            return _indexMultikeyPaths;
-        }
+        /**
+         * Returns a new partition of this BulkBuilder, with its own sorter limited to
+         * 'maxMemoryUsageBytes'. A partition is an independent BulkBuilder that may be inserted
+         * into from another thread, concurrently with this one and with the other partitions. Its
+         * keys are merged with the others by commitBulk().
+         *
+         * The partition is owned by this BulkBuilder. Partitions must be added before any keys are
+         * inserted, and cannot be partitioned further.
+         */
+        BulkBuilder* addPartition(size_t maxMemoryUsageBytes);
+
+        /**
+         * Returns the path components that cause this index to be multikey, over all partitions.
+         */
+        MultikeyPaths getMultikeyPaths() const;
 
         bool isMultikey() const;
 
@@ -229,8 +282,11 @@ public:
 
         std::unique_ptr<Sorter> _sorter;
         const IndexAccessMethod* _real;
+        const IndexDescriptor* _descriptor;
         int64_t _keysInserted = 0;
 
+        std::vector<std::unique_ptr<BulkBuilder>> _partitions;
+
         // Set to true if at least one document causes IndexAccessMethod::getKeys() to return a
         // BSONObjSet with size strictly greater than one.
         bool _everGeneratedMultipleKeys = false;
@@ -260,12 +316,16 @@ public:
      * @param dupsAllowed - if false, error or fill 'dups' if any duplicate values are found
      * @param dups - if NULL, error out on dups if not allowed
      *               if not NULL, put the bad RecordIds there
+     * @param dupKeysInserted - if not NULL, duplicate keys are inserted even if not allowed and
+     *                          recorded here instead, for the caller to check once the index is
+     *                          complete
      */
     Status commitBulk(OperationContext* opCtx,
                       BulkBuilder* bulk,
                       bool mayInterrupt,
                       bool dupsAllowed,
-                      std::set<RecordId>* dups);
+                      std::set<RecordId>* dups,
+                      BSONObjSet* dupKeysInserted = nullptr);
 
     /**
      * Specifies whether getKeys should relax the index constraints or not, in order of most
@@ -331,12 +391,38 @@ protected:
     const IndexDescriptor* _descriptor;
 
 private:
+    /**
+     * Insert and remove one key, encoded in 'keyString' first if '_newInterface' consumes
+     * KeyStrings. 'keyString' is a buffer which callers reuse for all of their keys.
+     */
+    Status insertOneKey(OperationContext* opCtx,
+                        const BSONObj& key,
+                        KeyString* keyString,
+                        const RecordId& loc,
+                        bool dupsAllowed);
+
     void removeOneKey(OperationContext* opCtx,
                       const BSONObj& key,
+                      KeyString* keyString,
                       const RecordId& loc,
                       bool dupsAllowed);
 
+    /**
+     * Fills out 'ticket->removed' and 'ticket->added' from 'ticket->oldKeys' and
+     * 'ticket->newKeys'. Keys are compared by their KeyString encodings, which are built in a
+     * single buffer, so the comparisons are plain memcmp()s.
+     */
+    void diffKeysForUpdate(UpdateTicket* ticket) const;
+
     const std::unique_ptr<SortedDataInterface> _newInterface;
+
+    // The KeyString version keys are encoded in before being handed to '_newInterface', which
+    // matches the format the storage engine uses for indexes of '_descriptor->version()'.
+    const KeyString::Version _keyStringVersion;
+
+    // Whether '_newInterface' writes keys encoded in '_keyStringVersion' directly. Keys are only
+    // encoded before being handed to it if it does.
+    const bool _sdiConsumesKeyStrings;
 };
 
 /**
@@ -0,0 +1,282 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kIndex
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/index_build_interceptor.h"
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+// Upper bound on the memory used to buffer side writes for a single index during a hybrid index
+// build. Index builds that exceed it are failed.
+MONGO_EXPORT_SERVER_PARAMETER(maxIndexBuildSideWritesMemoryUsageMegabytes, int, 200);
+
+namespace {
+
+// Rough per-key overhead of a BSONObjSet node, on top of the key data itself.
+const int64_t kPerKeyOverheadBytes = sizeof(BSONObj) + 32;
+
+}  // namespace
+
+/**
+ * Makes a side write eligible for draining once its WriteUnitOfWork commits, or forgets it on
+ * rollback.
+ */
+class IndexBuildInterceptor::SideWriteChange : public RecoveryUnit::Change {
+public:
+    SideWriteChange(IndexBuildInterceptor* interceptor, uint64_t seq, SideWrite write)
+        : _interceptor(interceptor), _seq(seq), _write(std::move(write)) {}
+
+    void commit(boost::optional<Timestamp>) final {
+        _interceptor->_onCommit(_seq, std::move(_write));
+    }
+
+    void rollback() final {
+        _interceptor->_onRollback(_seq, _write.memoryUsageBytes);
+    }
+
+private:
+    IndexBuildInterceptor* const _interceptor;
+    const uint64_t _seq;
+    SideWrite _write;
+};
+
+IndexBuildInterceptor::IndexBuildInterceptor(const IndexDescriptor* descriptor)
+    : _ns(descriptor->parentNS()), _indexName(descriptor->indexName()) {}
+
+Status IndexBuildInterceptor::sideWrite(OperationContext* opCtx,
+                                        IndexAccessMethod* indexAccessMethod,
+                                        const BSONObj& obj,
+                                        const RecordId& loc,
+                                        Op op,
+                                        const InsertDeleteOptions& options,
+                                        int64_t* numKeysOut) {
+    invariant(opCtx->lockState()->inAWriteUnitOfWork());
+    invariant(numKeysOut);
+    *numKeysOut = 0;
+
+    SideWrite write;
+    write.op = op;
+    write.loc = loc;
+
+    // Generate the keys now rather than at drain time, both so that the document does not need to
+    // be retained and so that invalid documents are rejected to the writer, as they would be had
+    // the index been ready.
+    if (op == Op::kInsert) {
+        indexAccessMethod->getKeys(obj, options.getKeysMode, &write.keys, &write.multikeyPaths);
+    } else {
+        indexAccessMethod->getKeys(obj,
+                                   IndexAccessMethod::GetKeysMode::kRelaxConstraintsUnfiltered,
+                                   &write.keys,
+                                   nullptr);
+    }
+
+    *numKeysOut = write.keys.size();
+    if (write.keys.empty()) {
+        return Status::OK();
+    }
+
+    write.memoryUsageBytes = sizeof(SideWrite);
+    for (const auto& key : write.keys) {
+        write.memoryUsageBytes += key.objsize() + kPerKeyOverheadBytes;
+    }
+
+    if (_overflowed.load()) {
+        return Status::OK();
+    }
+
+    const int64_t maxMemoryUsageBytes =
+        static_cast<int64_t>(maxIndexBuildSideWritesMemoryUsageMegabytes.load()) * 1024 * 1024;
+    if (_memoryUsageBytes.addAndFetch(write.memoryUsageBytes) > maxMemoryUsageBytes) {
+        _memoryUsageBytes.subtractAndFetch(write.memoryUsageBytes);
+        if (!_overflowed.swap(true)) {
+            warning() << "index build on " << _ns << " index: " << _indexName
+                      << " exceeded the side writes memory limit of "
+                      << maxIndexBuildSideWritesMemoryUsageMegabytes.load()
+                      << " megabytes; the index build will be failed";
+        }
+        return Status::OK();
+    }
+
+    uint64_t seq;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        seq = _nextSeq++;
+        _inFlight.insert(seq);
+    }
+
+    opCtx->recoveryUnit()->registerChange(new SideWriteChange(this, seq, std::move(write)));
+    return Status::OK();
+}
+
+void IndexBuildInterceptor::_onCommit(uint64_t seq, SideWrite write) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _inFlight.erase(seq);
+    _committed.emplace(seq, std::move(write));
+}
+
+void IndexBuildInterceptor::_onRollback(uint64_t seq, int64_t memoryUsageBytes) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _inFlight.erase(seq);
+    _memoryUsageBytes.subtractAndFetch(memoryUsageBytes);
+}
+
+Status IndexBuildInterceptor::drainWritesIntoIndex(OperationContext* opCtx,
+                                                   IndexAccessMethod* indexAccessMethod,
+                                                   const InsertDeleteOptions& options,
+                                                   size_t batchSize,
+                                                   int64_t* numAppliedOut) {
+    invariant(!opCtx->lockState()->inAWriteUnitOfWork());
+    invariant(numAppliedOut);
+    *numAppliedOut = 0;
+
+    if (_overflowed.load()) {
+        return Status(ErrorCodes::ExceededMemoryLimit,
+                      str::stream() << "Index build on " << _ns << " index: " << _indexName
+                                    << " exceeded the side writes memory limit of "
+                                    << maxIndexBuildSideWritesMemoryUsageMegabytes.load()
+                                    << " megabytes");
+    }
+
+    // Take the committed side writes that precede every uncommitted one, so that a write is never
+    // applied ahead of one that committed later but was recorded earlier.
+    std::vector<SideWrite> batch;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto end =
+            _inFlight.empty() ? _committed.end() : _committed.lower_bound(*_inFlight.begin());
+        for (auto it = _committed.begin(); it != end && batch.size() < batchSize;) {
+            batch.push_back(std::move(it->second));
+            it = _committed.erase(it);
+        }
+    }
+
+    if (batch.empty()) {
+        return Status::OK();
+    }
+
+    // Unique constraints are checked once all writes have been drained, since a duplicate may be
+    // resolved by a later delete.
+    const bool checkUnique = !options.dupsAllowed;
+    InsertDeleteOptions drainOptions = options;
+    drainOptions.dupsAllowed = true;
+
+    Status status = writeConflictRetry(opCtx, "index build drain", _ns, [&] {
+        WriteUnitOfWork wunit(opCtx);
+        for (const auto& write : batch) {
+            int64_t numKeys;
+            if (write.op == Op::kInsert) {
+                Status status = indexAccessMethod->insertKeys(
+                    opCtx, write.keys, write.multikeyPaths, write.loc, drainOptions, &numKeys);
+                if (!status.isOK()) {
+                    return status;
+                }
+            } else {
+                indexAccessMethod->removeKeys(opCtx, write.keys, write.loc, drainOptions, &numKeys);
+            }
+        }
+        wunit.commit();
+        return Status::OK();
+    });
+    if (!status.isOK()) {
+        return status;
+    }
+
+    int64_t memoryUsageBytes = 0;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (const auto& write : batch) {
+            memoryUsageBytes += write.memoryUsageBytes;
+            if (checkUnique && write.op == Op::kInsert) {
+                _keysToCheckForDuplicates.insert(write.keys.begin(), write.keys.end());
+            }
+        }
+    }
+    _memoryUsageBytes.subtractAndFetch(memoryUsageBytes);
+
+    *numAppliedOut = batch.size();
+    return Status::OK();
+}
+
+void IndexBuildInterceptor::addKeysToCheckForDuplicates(const BSONObjSet& keys) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _keysToCheckForDuplicates.insert(keys.begin(), keys.end());
+}
+
+Status IndexBuildInterceptor::checkDuplicateKeyConstraints(
+    OperationContext* opCtx, IndexAccessMethod* indexAccessMethod) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(_inFlight.empty() && _committed.empty());
+
+    if (_keysToCheckForDuplicates.empty()) {
+        return Status::OK();
+    }
+
+    auto cursor = indexAccessMethod->newCursor(opCtx, true);
+    for (const auto& key : _keysToCheckForDuplicates) {
+        int numEntries = 0;
+        for (auto kv = cursor->seek(key, true);
+             kv && kv->key.woCompare(key, BSONObj(), /*considerFieldNames*/ false) == 0;
+             kv = cursor->next()) {
+            if (++numEntries > 1) {
+                return Status(ErrorCodes::DuplicateKey,
+                              str::stream() << "E11000 duplicate key error collection: " << _ns
+                                            << " index: "
+                                            << _indexName
+                                            << " dup key: "
+                                            << redact(key));
+            }
+        }
+    }
+
+    return Status::OK();
+}
+
+bool IndexBuildInterceptor::areAllWritesApplied() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _inFlight.empty() && _committed.empty();
+}
+
+size_t IndexBuildInterceptor::numPendingWrites() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _committed.size();
+}
+
+}  // namespace mongo
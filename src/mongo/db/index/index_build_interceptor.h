@@ -0,0 +1,186 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/index/multikey_paths.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class IndexAccessMethod;
+class IndexDescriptor;
+class OperationContext;
+struct InsertDeleteOptions;
+
+/**
+ * Captures writes made to an index while a hybrid index build is in progress.
+ *
+ * A hybrid index build loads the index from a collection scan with the bulk builder, without
+ * blocking writers. Writes that reach the index while the scan is running are diverted here as
+ * "side writes" rather than being applied to the index, which the bulk loader requires to be
+ * empty. Once the bulk load has finished, the side writes are drained into the index in the order
+ * in which they were committed.
+ *
+ * Keys are generated at the time of the write so that key generation errors are still reported to
+ * the writer. Side writes are buffered in memory; if the buffer grows beyond
+ * 'maxIndexBuildSideWritesMemoryUsageMegabytes' the interceptor stops recording and the index
+ * build must be failed. Writers are never failed on behalf of the index build. Since only builds
+ * that can report that failure to the user are hybrid, builds on secondaries never get here.
+ *
+ * All methods are thread-safe.
+ */
+class IndexBuildInterceptor {
+    MONGO_DISALLOW_COPYING(IndexBuildInterceptor);
+
+public:
+    enum class Op { kInsert, kDelete };
+
+    explicit IndexBuildInterceptor(const IndexDescriptor* descriptor);
+
+    /**
+     * Records the keys that 'obj' generates for the index served by 'indexAccessMethod' as an
+     * insert or a delete to apply once the bulk load has finished. The side write only becomes
+     * eligible for draining once the enclosing WriteUnitOfWork commits.
+     *
+     * Sets 'numKeysOut' to the number of keys recorded.
+     */
+    Status sideWrite(OperationContext* opCtx,
+                     IndexAccessMethod* indexAccessMethod,
+                     const BSONObj& obj,
+                     const RecordId& loc,
+                     Op op,
+                     const InsertDeleteOptions& options,
+                     int64_t* numKeysOut);
+
+    /**
+     * Applies up to 'batchSize' committed side writes to the index in commit order, in a single
+     * WriteUnitOfWork. Side writes that were recorded after a still uncommitted one are left for a
+     * later call. Sets 'numAppliedOut' to the number of side writes applied.
+     *
+     * Keys inserted into a unique index are applied with duplicates allowed and remembered, so
+     * that checkDuplicateKeyConstraints() can verify them once all writes are drained.
+     *
+     * Must not be called inside of a WriteUnitOfWork.
+     */
+    Status drainWritesIntoIndex(OperationContext* opCtx,
+                                IndexAccessMethod* indexAccessMethod,
+                                const InsertDeleteOptions& options,
+                                size_t batchSize,
+                                int64_t* numAppliedOut);
+
+    /**
+     * Adds 'keys' to the keys that checkDuplicateKeyConstraints() verifies. Used for duplicates
+     * that the bulk load let through because a side write may yet resolve them.
+     */
+    void addKeysToCheckForDuplicates(const BSONObjSet& keys);
+
+    /**
+     * Returns a DuplicateKey error if any key drained into a unique index, or added with
+     * addKeysToCheckForDuplicates(), maps to more than one record. Must be called after all side
+     * writes have been drained.
+     */
+    Status checkDuplicateKeyConstraints(OperationContext* opCtx,
+                                        IndexAccessMethod* indexAccessMethod) const;
+
+    /**
+     * Returns true if there are no side writes waiting to be applied, committed or not.
+     */
+    bool areAllWritesApplied() const;
+
+    /**
+     * Returns the number of committed side writes waiting to be applied.
+     */
+    size_t numPendingWrites() const;
+
+    /**
+     * Returns true if side writes were dropped because the memory limit was reached. The index
+     * build can no longer succeed once this happens.
+     */
+    bool hasOverflowed() const {
+        return _overflowed.load();
+    }
+
+    /**
+     * Returns the memory currently used by buffered side writes, in bytes.
+     */
+    int64_t memoryUsageBytes() const {
+        return _memoryUsageBytes.load();
+    }
+
+private:
+    class SideWriteChange;
+
+    struct SideWrite {
+        Op op;
+        RecordId loc;
+        BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+        MultikeyPaths multikeyPaths;
+        int64_t memoryUsageBytes = 0;
+    };
+
+    void _onCommit(uint64_t seq, SideWrite write);
+    void _onRollback(uint64_t seq, int64_t memoryUsageBytes);
+
+    const std::string _ns;
+    const std::string _indexName;
+
+    mutable stdx::mutex _mutex;
+
+    // Sequence number assigned to the next side write. Side writes are applied in sequence order.
+    uint64_t _nextSeq = 0;
+
+    // Sequence numbers of side writes whose WriteUnitOfWork has not committed or rolled back yet.
+    // No side write at or beyond the smallest of these may be applied.
+    std::set<uint64_t> _inFlight;
+
+    // Committed side writes that have not been applied yet, keyed by sequence number.
+    std::map<uint64_t, SideWrite> _committed;
+
+    // Keys of a unique index to be checked for duplicates before the build commits.
+    BSONObjSet _keysToCheckForDuplicates = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+
+    AtomicInt64 _memoryUsageBytes{0};
+    AtomicBool _overflowed{false};
+};
+
+}  // namespace mongo
@@ -261,6 +261,16 @@ Status IndexBuilder::_build(OperationContext* opCtx,
     if (allowBackgroundBuilding) {
         dbLock->relockWithMode(MODE_X);
     }
+
+    // Apply the remaining writes made while the index was being built.
+    status = indexer.drainBackgroundWrites();
+    if (status.isOK()) {
+        status = indexer.checkConstraints();
+    }
+    if (!status.isOK()) {
+        return _failIndexBuild(indexer, status, allowBackgroundBuilding);
+    }
+
     writeConflictRetry(opCtx, "Commit index build", ns.ns(), [opCtx, coll, &indexer, &ns] {
         WriteUnitOfWork wunit(opCtx);
         indexer.commit([opCtx, coll, &ns](const BSONObj& indexSpec) {
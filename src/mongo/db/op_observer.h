@@ -121,13 +121,16 @@ public:
      * "fromMigrate" indicates whether the delete was induced by a chunk migration, and
      * so should be ignored by the user as an internal maintenance operation and not a
      * real delete.
+     * "oplogSlot" is the optime reserved for the delete's oplog entry, or a null one to have it
+     * assigned when the entry is written.
      */
     virtual void onDelete(OperationContext* opCtx,
                           const NamespaceString& nss,
                           OptionalCollectionUUID uuid,
                           StmtId stmtId,
                           bool fromMigrate,
-                          const boost::optional<BSONObj>& deletedDoc) = 0;
+                          const boost::optional<BSONObj>& deletedDoc,
+                          const OplogSlot& oplogSlot) = 0;
     /**
      * Logs a no-op with "msgObj" in the o field into oplog.
      *
@@ -234,7 +234,8 @@ OpTimeBundle replLogDelete(OperationContext* opCtx,
                            Session* session,
                            StmtId stmtId,
                            bool fromMigrate,
-                           const boost::optional<BSONObj>& deletedDoc) {
+                           const boost::optional<BSONObj>& deletedDoc,
+                           const OplogSlot& oplogSlot) {
     OperationSessionInfo sessionInfo;
     repl::OplogLink oplogLink;
 
@@ -248,6 +249,9 @@ OpTimeBundle replLogDelete(OperationContext* opCtx,
     opTimes.wallClockTime = getWallClockTimeForOpLog(opCtx);
 
     if (deletedDoc && opCtx->getTxnNumber()) {
+        // The pre-image entry must precede the delete entry, so it cannot be written after a slot
+        // was reserved for the latter.
+        invariant(oplogSlot.opTime.isNull());
         auto noteOplog = logOperation(opCtx,
                                       "n",
                                       nss,
@@ -276,7 +280,7 @@ OpTimeBundle replLogDelete(OperationContext* opCtx,
                                        sessionInfo,
                                        stmtId,
                                        oplogLink,
-                                       OplogSlot());
+                                       oplogSlot);
     return opTimes;
 }
 
@@ -510,7 +514,8 @@ void OpObserverImpl::onDelete(OperationContext* opCtx,
                               OptionalCollectionUUID uuid,
                               StmtId stmtId,
                               bool fromMigrate,
-                              const boost::optional<BSONObj>& deletedDoc) {
+                              const boost::optional<BSONObj>& deletedDoc,
+                              const OplogSlot& oplogSlot) {
     Session* const session = OperationContextSession::get(opCtx);
     auto& documentKey = documentKeyDecoration(opCtx);
     invariant(!documentKey.isEmpty());
@@ -522,7 +527,8 @@ void OpObserverImpl::onDelete(OperationContext* opCtx,
             OplogEntry::makeDeleteOperation(nss, uuid, deletedDoc ? deletedDoc.get() : documentKey);
         session->addTransactionOperation(opCtx, operation);
     } else {
-        opTime = replLogDelete(opCtx, nss, uuid, session, stmtId, fromMigrate, deletedDoc);
+        opTime = replLogDelete(
+            opCtx, nss, uuid, session, stmtId, fromMigrate, deletedDoc, oplogSlot);
         onWriteOpCompleted(opCtx,
                            nss,
                            session,
@@ -98,10 +98,11 @@ public:
                   OptionalCollectionUUID uuid,
                   StmtId stmtId,
                   bool fromMigrate,
-                  const boost::optional<BSONObj>& deletedDoc) override {
+                  const boost::optional<BSONObj>& deletedDoc,
+                  const OplogSlot& oplogSlot) override {
         ReservedTimes times{opCtx};
         for (auto& o : _observers)
-            o->onDelete(opCtx, nss, uuid, stmtId, fromMigrate, deletedDoc);
+            o->onDelete(opCtx, nss, uuid, stmtId, fromMigrate, deletedDoc, oplogSlot);
     }
 
     void onInternalOpMessage(OperationContext* const opCtx,
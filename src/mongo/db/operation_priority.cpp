@@ -0,0 +1,96 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/operation_priority.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+// Decorations are value-initialized, which makes kInteractive the default.
+const auto clientPriority = Client::declareDecoration<OperationPriority>();
+const auto operationPriorityOverride =
+    OperationContext::declareDecoration<boost::optional<OperationPriority>>();
+
+}  // namespace
+
+StringData toString(OperationPriority priority) {
+    switch (priority) {
+        case OperationPriority::kInteractive:
+            return "interactive"_sd;
+        case OperationPriority::kBatch:
+            return "batch"_sd;
+        case OperationPriority::kBackground:
+            return "background"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
+int getOperationPriorityWeight(OperationPriority priority) {
+    switch (priority) {
+        case OperationPriority::kInteractive:
+            return 16;
+        case OperationPriority::kBatch:
+            return 4;
+        case OperationPriority::kBackground:
+            return 1;
+    }
+    MONGO_UNREACHABLE;
+}
+
+OperationPriority getOperationPriority(OperationContext* opCtx) {
+    const auto& priorityOverride = operationPriorityOverride(opCtx);
+    if (priorityOverride)
+        return *priorityOverride;
+    if (auto client = opCtx->getClient())
+        return clientPriority(client);
+    return OperationPriority::kInteractive;
+}
+
+void setClientOperationPriority(Client* client, OperationPriority priority) {
+    clientPriority(client) = priority;
+}
+
+ScopedOperationPriority::ScopedOperationPriority(OperationContext* opCtx,
+                                                 OperationPriority priority)
+    : _opCtx(opCtx), _previousOverride(operationPriorityOverride(opCtx)) {
+    operationPriorityOverride(opCtx) = priority;
+}
+
+ScopedOperationPriority::~ScopedOperationPriority() {
+    operationPriorityOverride(_opCtx) = _previousOverride;
+}
+
+}  // namespace mongo
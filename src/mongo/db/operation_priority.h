@@ -0,0 +1,94 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+
+class Client;
+class OperationContext;
+
+/**
+ * Scheduling class of an operation. When operations queue for storage engine tickets or for locks,
+ * waiters are ordered by class so that internal maintenance work yields to user traffic, without
+ * starving it entirely.
+ */
+enum class OperationPriority {
+    // Requests issued by users. The default for every operation.
+    kInteractive = 0,
+    // Internal bulk work performed on behalf of users, such as chunk migration cloning.
+    kBatch = 1,
+    // Internal maintenance whose timing is flexible, such as TTL and orphan range deletion.
+    kBackground = 2,
+};
+
+constexpr int kNumOperationPriorities = 3;
+
+StringData toString(OperationPriority priority);
+
+/**
+ * Relative share of contended tickets granted to waiters of 'priority' when all classes have
+ * waiters.
+ */
+int getOperationPriorityWeight(OperationPriority priority);
+
+/**
+ * Returns the priority of the operation: its own override if one is set through
+ * ScopedOperationPriority, otherwise the priority of its client.
+ */
+OperationPriority getOperationPriority(OperationContext* opCtx);
+
+/**
+ * Sets the priority of all operations run by 'client'. Internal threads set this once when they
+ * start.
+ */
+void setClientOperationPriority(Client* client, OperationPriority priority);
+
+/**
+ * Overrides the priority of a single operation for the lifetime of this object.
+ */
+class ScopedOperationPriority {
+    MONGO_DISALLOW_COPYING(ScopedOperationPriority);
+
+public:
+    ScopedOperationPriority(OperationContext* opCtx, OperationPriority priority);
+    ~ScopedOperationPriority();
+
+private:
+    OperationContext* const _opCtx;
+    const boost::optional<OperationPriority> _previousOverride;
+};
+
+}  // namespace mongo
@@ -32,11 +32,13 @@
 
 #include "mongo/db/pipeline/cluster_aggregation_planner.h"
 
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_merge_cursors.h"
 #include "mongo/db/pipeline/document_source_project.h"
 #include "mongo/db/pipeline/document_source_sort.h"
 #include "mongo/db/pipeline/document_source_unwind.h"
+#include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
 namespace cluster_aggregation_planner {
@@ -84,6 +86,28 @@ void findSplitPoint(Pipeline* shardPipe, Pipeline* mergePipe) {
     }
 }
 
+/**
+ * If the pipeline was split at a $group, makes the shards return their partial groups ordered by
+ * group key, so that the merging $group sees all the partial groups of a key together once the
+ * cursors are merge-sorted, and can return each group as soon as it is complete. This bounds the
+ * memory used by the merger to a single group, however many groups there are.
+ */
+void mergePartialGroupsInOrder(Pipeline* shardPipe, Pipeline* mergePipe) {
+    if (!internalQueryMergePartialGroupsInOrder.load() || shardPipe->getSources().empty() ||
+        mergePipe->getSources().empty()) {
+        return;
+    }
+
+    auto shardGroup = dynamic_cast<DocumentSourceGroup*>(shardPipe->getSources().back().get());
+    auto mergeGroup = dynamic_cast<DocumentSourceGroup*>(mergePipe->getSources().front().get());
+    if (!shardGroup || shardGroup->isDoingMerge() || !mergeGroup || !mergeGroup->isDoingMerge()) {
+        return;
+    }
+
+    shardGroup->setSortedOutput(true);
+    mergeGroup->setMergingPresorted(true);
+}
+
 /**
  * If the final stage on shards is to unwind an array, move that stage to the merger. This cuts down
  * on network traffic and allows us to take advantage of reduced copying in unwind.
@@ -142,6 +166,7 @@ void performSplitPipelineOptimizations(Pipeline* shardPipeline, Pipeline* mergin
     // The order in which optimizations are applied can have significant impact on the
     // efficiency of the final pipeline. Be Careful!
     findSplitPoint(shardPipeline, mergingPipeline);
+    mergePartialGroupsInOrder(shardPipeline, mergingPipeline);
     moveFinalUnwindFromShardsToMerger(shardPipeline, mergingPipeline);
     limitFieldsSentFromShardsToMerger(shardPipeline, mergingPipeline);
 }
@@ -163,6 +188,16 @@ boost::optional<BSONObj> popLeadingMergeSort(Pipeline* pipeline) {
             ->sortKeyPattern(DocumentSourceSort::SortKeySerialization::kForSortKeyMerging)
             .toBson();
     }
+
+    // A $group merging presorted partial groups stays in the pipeline, but needs the cursors to be
+    // merged in the order of the sort keys the shards attach to the partial groups.
+    const auto& sources = pipeline->getSources();
+    if (!sources.empty()) {
+        auto group = dynamic_cast<DocumentSourceGroup*>(sources.front().get());
+        if (group && group->isMergingPresorted()) {
+            return BSON("_id" << 1);
+        }
+    }
     return boost::none;
 }
 
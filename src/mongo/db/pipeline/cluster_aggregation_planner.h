@@ -44,7 +44,9 @@ void performSplitPipelineOptimizations(Pipeline* shardPipeline, Pipeline* mergin
 
 /**
  * Rips off an initial $sort stage that can be handled by cursor merging machinery. Returns the
- * sort key pattern of such a $sort stage if there was one, and boost::none otherwise.
+ * sort key pattern of such a $sort stage if there was one, the pattern by which to merge the
+ * partial groups of an initial $group merging presorted input if there was one of those, and
+ * boost::none otherwise.
  */
 boost::optional<BSONObj> popLeadingMergeSort(Pipeline* mergePipeline);
 
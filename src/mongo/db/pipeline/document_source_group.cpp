@@ -42,6 +42,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/collation/collation_index_key.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/destructor_guard.h"
 
@@ -89,6 +90,10 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
         invariant(initializationResult.isEOF());
     }
 
+    if (_mergingPresorted) {
+        return getNextMergingPresorted();
+    }
+
     for (auto&& accum : _currentAccumulators) {
         accum->reset();  // Prep accumulators for a new group.
     }
@@ -141,7 +146,10 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     if (_groups->empty())
         return GetNextResult::makeEOF();
 
-    Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+    // Groups are returned in the order of '_sortedGroups' if it was populated, but
+    // 'groupsIterator' still tells when all of them have been.
+    const auto& group = _sortedOutput ? *_sortedGroups[_nextSortedGroup++] : *groupsIterator;
+    Document out = makeDocument(group.first, group.second, pExpCtx->needsMerge);
 
     if (++groupsIterator == _groups->end())
         dispose();
@@ -190,9 +198,52 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
     return std::move(out);
 }
 
+DocumentSource::GetNextResult DocumentSourceGroup::getNextMergingPresorted() {
+    // The partial groups of a key are adjacent in the input, so the current group is complete once
+    // a partial group with another key, or the end of the input, is seen.
+    while (true) {
+        auto nextInput = pSource->getNext();
+        if (nextInput.isPaused()) {
+            return nextInput;
+        }
+
+        if (nextInput.isEOF()) {
+            if (!_haveCurrentGroup) {
+                return nextInput;
+            }
+            _haveCurrentGroup = false;
+            return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+        }
+
+        const auto input = nextInput.releaseDocument();
+        Value id = computeId(input);
+
+        boost::optional<Document> out;
+        if (_haveCurrentGroup && !pExpCtx->getValueComparator().evaluate(_currentId == id)) {
+            out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+            for (auto&& accum : _currentAccumulators) {
+                accum->reset();
+            }
+        }
+
+        _currentId = std::move(id);
+        _haveCurrentGroup = true;
+        for (size_t i = 0; i < _currentAccumulators.size(); i++) {
+            _currentAccumulators[i]->process(
+                _accumulatedFields[i].expression->evaluate(input, &pExpCtx->variables),
+                _doingMerge);
+        }
+
+        if (out) {
+            return std::move(*out);
+        }
+    }
+}
+
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    _sortedGroups.clear();
     _sorterIterator.reset();
 
     // Make us look done.
@@ -247,6 +298,14 @@ Value DocumentSourceGroup::serialize(boost::optional<ExplainOptions::Verbosity>
         insides["$doingMerge"] = Value(true);
     }
 
+    if (_sortedOutput) {
+        insides["$sortedOutput"] = Value(true);
+    }
+
+    if (_mergingPresorted) {
+        insides["$mergingPresorted"] = Value(true);
+    }
+
     if (explain && findRelevantInputSort()) {
         return Value(DOC("$streamingGroup" << insides.freeze()));
     }
@@ -381,6 +440,18 @@ intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBson(
             massert(17030, "$doingMerge should be true if present", groupField.Bool());
 
             pGroup->setDoingMerge(true);
+        } else if (str::equals(pFieldName, "$sortedOutput")) {
+            uassert(ErrorCodes::FailedToParse,
+                    "$sortedOutput should be true if present",
+                    groupField.type() == Bool && groupField.Bool());
+
+            pGroup->setSortedOutput(true);
+        } else if (str::equals(pFieldName, "$mergingPresorted")) {
+            uassert(ErrorCodes::FailedToParse,
+                    "$mergingPresorted should be true if present",
+                    groupField.type() == Bool && groupField.Bool());
+
+            pGroup->setMergingPresorted(true);
         } else {
             // Any other field will be treated as an accumulator specification.
             pGroup->addAccumulator(
@@ -488,7 +559,21 @@ void getFieldPathListForSpilled(ExpressionObject* expressionObj,
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     const size_t numAccumulators = _accumulatedFields.size();
 
-    boost::optional<BSONObj> inputSort = findRelevantInputSort();
+    if (_mergingPresorted) {
+        // Nothing needs to be loaded up front, see getNextMergingPresorted().
+        _currentAccumulators.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
+        }
+        _initialized = true;
+        return DocumentSource::GetNextResult::makeEOF();
+    }
+
+    // A streaming $group returns its groups in input order, which is not necessarily ascending.
+    boost::optional<BSONObj> inputSort;
+    if (!_sortedOutput) {
+        inputSort = findRelevantInputSort();
+    }
     if (inputSort) {
         // We can convert to streaming.
         _streaming = true;
@@ -613,6 +698,17 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             } else {
                 // start the group iterator
                 groupsIterator = _groups->begin();
+
+                if (_sortedOutput) {
+                    _sortedGroups.reserve(_groups->size());
+                    for (auto&& group : *_groups) {
+                        _sortedGroups.push_back(&group);
+                    }
+                    std::sort(_sortedGroups.begin(),
+                              _sortedGroups.end(),
+                              SpillSTLComparator(pExpCtx->getValueComparator()));
+                    _nextSortedGroup = 0;
+                }
             }
 
             // This must happen last so that, unless control gets here, we will re-enter
@@ -870,9 +966,37 @@ Document DocumentSourceGroup::makeDocument(const Value& id,
         }
     }
 
+    if (_sortedOutput) {
+        out.setSortKeyMetaField(makeSortKey(id));
+    }
+
     return out.freeze();
 }
 
+BSONObj DocumentSourceGroup::makeSortKey(const Value& id) const {
+    BSONObjBuilder idBuilder;
+    if (_idExpressions.size() == 1) {
+        // computeId() has already replaced a missing key with null.
+        id.addToBsonObj(&idBuilder, "");
+    } else {
+        // A missing component of a compound key is ordered like undefined, as Value orders it.
+        BSONArrayBuilder components(idBuilder.subarrayStart(""));
+        for (auto&& component : id.getArray()) {
+            if (component.missing()) {
+                components.appendUndefined();
+            } else {
+                component.addToBsonArray(&components);
+            }
+        }
+        components.doneFast();
+    }
+
+    BSONObjBuilder sortKeyBuilder;
+    CollationIndexKey::collationAwareIndexKeyAppend(
+        idBuilder.done().firstElement(), pExpCtx->getCollator(), &sortKeyBuilder);
+    return sortKeyBuilder.obj();
+}
+
 intrusive_ptr<DocumentSource> DocumentSourceGroup::getShardSource() {
     return this;  // No modifications necessary when on shard
 }
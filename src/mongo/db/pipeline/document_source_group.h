@@ -72,10 +72,12 @@ public:
         BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
 
     StageConstraints constraints(Pipeline::SplitState pipeState) const final {
-        return {StreamType::kBlocking,
+        // A merger of presorted partial groups only ever holds the group currently being merged.
+        return {_mergingPresorted ? StreamType::kStreaming : StreamType::kBlocking,
                 PositionRequirement::kNone,
                 HostTypeRequirement::kNone,
-                DiskUseRequirement::kWritesTmpData,
+                _mergingPresorted ? DiskUseRequirement::kNoDiskUse
+                                  : DiskUseRequirement::kWritesTmpData,
                 FacetRequirement::kAllowed,
                 TransactionRequirement::kAllowed};
     }
@@ -97,6 +99,32 @@ public:
         _doingMerge = doingMerge;
     }
 
+    bool isDoingMerge() const {
+        return _doingMerge;
+    }
+
+    /**
+     * Tell this source to return its groups in ascending order of group key, each carrying its key
+     * as sort key metadata, so that the partial groups from several shards can be merge-sorted.
+     * Defaults to false.
+     */
+    void setSortedOutput(bool sortedOutput) {
+        _sortedOutput = sortedOutput;
+    }
+
+    /**
+     * Tell this source that it is merging partial groups which arrive merge-sorted by group key, as
+     * produced by setSortedOutput(). Each group is then returned as soon as the partial groups of
+     * the next key start, rather than after the whole input has been consumed. Defaults to false.
+     */
+    void setMergingPresorted(bool mergingPresorted) {
+        _mergingPresorted = mergingPresorted;
+    }
+
+    bool isMergingPresorted() const {
+        return _mergingPresorted;
+    }
+
     bool isStreaming() const {
         return _streaming;
     }
@@ -123,6 +151,12 @@ private:
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
 
+    /**
+     * getNext() for a $group merging presorted partial groups. Unlike the three above, this manages
+     * '_currentAccumulators' itself, since a group may span several calls.
+     */
+    GetNextResult getNextMergingPresorted();
+
     /**
      * Attempt to identify an input sort order that allows us to turn into a streaming $group. If we
      * find one, return it. Otherwise, return boost::none.
@@ -150,6 +184,12 @@ private:
 
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
+    /**
+     * Returns the sort key which orders the partial group with internal group key 'id' among the
+     * partial groups of other shards, with strings mapped to their collation comparison keys.
+     */
+    BSONObj makeSortKey(const Value& id) const;
+
     /**
      * Computes the internal representation of the group key.
      */
@@ -164,6 +204,8 @@ private:
     std::vector<AccumulationStatement> _accumulatedFields;
 
     bool _doingMerge;
+    bool _sortedOutput = false;
+    bool _mergingPresorted = false;
     size_t _memoryUsageBytes = 0;
     size_t _maxMemoryUsageBytes;
     std::string _fileName;
@@ -191,6 +233,15 @@ private:
     // Only used when '_spilled' is false.
     GroupsMap::iterator groupsIterator;
 
+    // Only used when '_spilled' is false and '_sortedOutput' is true. The entries of '_groups' in
+    // the order they are returned, and the position of the next one.
+    std::vector<const GroupsMap::value_type*> _sortedGroups;
+    size_t _nextSortedGroup = 0;
+
+    // Only used when '_mergingPresorted' is true. Whether '_currentId' and '_currentAccumulators'
+    // hold a group which has not been returned yet.
+    bool _haveCurrentGroup = false;
+
     // Only used when '_spilled' is true.
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
     const bool _allowDiskUse;
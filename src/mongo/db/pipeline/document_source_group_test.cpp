@@ -191,6 +191,113 @@ TEST_F(DocumentSourceGroupTest, ShouldCorrectlyTrackMemoryUsageBetweenPauses) {
     ASSERT_THROWS_CODE(group->getNext(), AssertionException, 16945);
 }
 
+TEST_F(DocumentSourceGroupTest, SortedOutputShouldReturnGroupsInKeyOrderWithSortKeys) {
+    auto expCtx = getExpCtx();
+    expCtx->inMongos = true;  // Disallow external sort.
+                              // This is the only way to do this in a debug build.
+    expCtx->needsMerge = true;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement sumStatement{"total",
+                                       ExpressionFieldPath::parse(expCtx, "$b", vps),
+                                       AccumulationStatement::getFactory("$sum")};
+    auto group = DocumentSourceGroup::create(
+        expCtx, ExpressionFieldPath::parse(expCtx, "$a", vps), {sumStatement});
+    group->setSortedOutput(true);
+
+    auto mock = DocumentSourceMock::create({Document{{"a", 3}, {"b", 1}},
+                                            Document{{"a", "x"_sd}, {"b", 1}},
+                                            Document{{"b", 1}},
+                                            Document{{"a", 1}, {"b", 1}},
+                                            Document{{"a", 3}, {"b", 1}}});
+    group->setSource(mock.get());
+
+    // Groups come out ordered by key, a missing key grouped and ordered as null.
+    const std::vector<Value> expectedIds{Value(BSONNULL), Value(1), Value(3), Value("x"_sd)};
+    for (auto&& expectedId : expectedIds) {
+        auto next = group->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        auto doc = next.releaseDocument();
+        ASSERT_VALUE_EQ(doc["_id"], expectedId);
+        ASSERT_TRUE(doc.hasSortKeyMetaField());
+        ASSERT_BSONOBJ_EQ(doc.getSortKeyMetaField(), BSON("" << expectedId));
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceGroupTest, MergingPresortedShouldReturnEachGroupOnceTheNextKeyStarts) {
+    auto expCtx = getExpCtx();
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement sumStatement{"total",
+                                       ExpressionFieldPath::parse(expCtx, "$$ROOT.total", vps),
+                                       AccumulationStatement::getFactory("$sum")};
+    auto group = DocumentSourceGroup::create(
+        expCtx, ExpressionFieldPath::parse(expCtx, "$$ROOT._id", vps), {sumStatement});
+    group->setDoingMerge(true);
+    group->setMergingPresorted(true);
+
+    auto constraints = group->constraints(Pipeline::SplitState::kSplitForMerge);
+    ASSERT(constraints.streamType == DocumentSource::StreamType::kStreaming);
+    ASSERT(constraints.diskRequirement == DocumentSource::DiskUseRequirement::kNoDiskUse);
+
+    // The partial groups of several shards, merge-sorted by key.
+    auto mock = DocumentSourceMock::create({Document{{"_id", 1}, {"total", 2}},
+                                            Document{{"_id", 1}, {"total", 3}},
+                                            Document{{"_id", 2}, {"total", 1}},
+                                            DocumentSource::GetNextResult::makePauseExecution(),
+                                            Document{{"_id", 2}, {"total", 4}},
+                                            Document{{"_id", 5}, {"total", 7}}});
+    group->setSource(mock.get());
+
+    auto next = group->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"_id", 1}, {"total", 5}}));
+
+    // A pause in the middle of a group leaves the partial sums seen so far in place.
+    ASSERT_TRUE(group->getNext().isPaused());
+
+    next = group->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"_id", 2}, {"total", 5}}));
+
+    next = group->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"_id", 5}, {"total", 7}}));
+
+    ASSERT_TRUE(group->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldRoundTripPartialGroupMergeFlags) {
+    auto expCtx = getExpCtx();
+    auto spec = BSON("$group" << BSON("_id"
+                                      << "$a"
+                                      << "$sortedOutput"
+                                      << true));
+    auto group = DocumentSourceGroup::createFromBson(spec.firstElement(), expCtx);
+    vector<Value> serialized;
+    group->serializeToArray(serialized);
+    ASSERT_EQ(serialized.size(), 1UL);
+    ASSERT_VALUE_EQ(serialized[0]["$group"]["$sortedOutput"], Value(true));
+
+    spec = BSON("$group" << BSON("_id"
+                                 << "$$ROOT._id"
+                                 << "$doingMerge"
+                                 << true
+                                 << "$mergingPresorted"
+                                 << true));
+    group = DocumentSourceGroup::createFromBson(spec.firstElement(), expCtx);
+    ASSERT_TRUE(static_cast<DocumentSourceGroup*>(group.get())->isMergingPresorted());
+
+    spec = BSON("$group" << BSON("_id"
+                                 << "$a"
+                                 << "$sortedOutput"
+                                 << false));
+    ASSERT_THROWS_CODE(DocumentSourceGroup::createFromBson(spec.firstElement(), expCtx),
+                       AssertionException,
+                       ErrorCodes::FailedToParse);
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
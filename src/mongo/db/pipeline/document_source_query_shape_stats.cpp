@@ -0,0 +1,107 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_query_shape_stats.h"
+
+#include "mongo/db/query/query_shape_stats.h"
+
+namespace mongo {
+
+REGISTER_DOCUMENT_SOURCE(queryShapeStats,
+                         DocumentSourceQueryShapeStats::LiteParsed::parse,
+                         DocumentSourceQueryShapeStats::createFromBson);
+
+const char* DocumentSourceQueryShapeStats::kStageName = "$queryShapeStats";
+
+DocumentSource::GetNextResult DocumentSourceQueryShapeStats::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    if (!_initialized) {
+        auto stats = QueryShapeStats::get(pExpCtx->opCtx).getStats(_includeHistograms);
+        _stats.assign(std::make_move_iterator(stats.begin()),
+                      std::make_move_iterator(stats.end()));
+        _initialized = true;
+    }
+
+    if (!_stats.empty()) {
+        Document doc(_stats.front());
+        _stats.pop_front();
+        return std::move(doc);
+    }
+
+    return GetNextResult::makeEOF();
+}
+
+Value DocumentSourceQueryShapeStats::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    return Value(Document{{getSourceName(), Document{{"histograms", _includeHistograms}}}});
+}
+
+boost::intrusive_ptr<DocumentSource> DocumentSourceQueryShapeStats::createFromBson(
+    BSONElement spec, const boost::intrusive_ptr<ExpressionContext>& pExpCtx) {
+    uassert(
+        ErrorCodes::InvalidNamespace,
+        str::stream() << kStageName
+                      << " must be run against the database with {aggregate: 1}, not a collection",
+        pExpCtx->ns.isCollectionlessAggregateNS());
+
+    uassert(ErrorCodes::FailedToParse,
+            str::stream() << kStageName << " must be specified as an object, but found: "
+                          << typeName(spec.type()),
+            spec.type() == BSONType::Object);
+
+    bool includeHistograms = false;
+    for (auto&& elem : spec.embeddedObject()) {
+        const auto fieldName = elem.fieldNameStringData();
+        if (fieldName == "histograms"_sd) {
+            uassert(ErrorCodes::FailedToParse,
+                    str::stream() << "The 'histograms' parameter of the " << kStageName
+                                  << " stage must be a boolean, but found: "
+                                  << typeName(elem.type()),
+                    elem.type() == BSONType::Bool);
+            includeHistograms = elem.boolean();
+        } else {
+            uasserted(ErrorCodes::FailedToParse,
+                      str::stream() << "Unrecognized option '" << fieldName << "' in "
+                                    << kStageName
+                                    << " stage");
+        }
+    }
+
+    return new DocumentSourceQueryShapeStats(pExpCtx, includeHistograms);
+}
+
+DocumentSourceQueryShapeStats::DocumentSourceQueryShapeStats(
+    const boost::intrusive_ptr<ExpressionContext>& pExpCtx, bool includeHistograms)
+    : DocumentSource(pExpCtx), _includeHistograms(includeHistograms) {}
+
+}  // namespace mongo
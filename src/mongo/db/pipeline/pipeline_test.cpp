@@ -52,11 +52,13 @@
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/temp_dir.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -1945,6 +1947,28 @@ class ShardAlreadyExhaustive : public Base {
     }
 };
 
+// Same as above, but with internalQueryMergePartialGroupsInOrder enabled the shards return their
+// partial groups ordered by group key and the merger combines them as they stream in.
+class ShardAlreadyExhaustiveMergesGroupsInOrder : public ShardAlreadyExhaustive {
+public:
+    void run() override {
+        internalQueryMergePartialGroupsInOrder.store(true);
+        ON_BLOCK_EXIT([] { internalQueryMergePartialGroupsInOrder.store(false); });
+        ShardAlreadyExhaustive::run();
+    }
+
+private:
+    string shardPipeJson() {
+        return "[{$project: {_id:true, a:true}}"
+               ",{$group: {_id: '$_id', $sortedOutput: true}}"
+               "]";
+    }
+    string mergePipeJson() {
+        return "[{$group: {_id: '$$ROOT._id', $doingMerge: true, $mergingPresorted: true}}"
+               "]";
+    }
+};
+
 class ShardedSortMatchProjSkipLimBecomesMatchTopKSortSkipProj : public Base {
     string inputPipeJson() {
         return "[{$sort: {a : 1}}"
@@ -2728,6 +2752,8 @@ public:
         add<Optimizations::Sharded::limitFieldsSentFromShardsToMerger::
                 ShardedMatchSortProjLimBecomesMatchTopKSortProj>();
         add<Optimizations::Sharded::limitFieldsSentFromShardsToMerger::ShardAlreadyExhaustive>();
+        add<Optimizations::Sharded::limitFieldsSentFromShardsToMerger::
+                ShardAlreadyExhaustiveMergesGroupsInOrder>();
         add<Optimizations::Sharded::needsPrimaryShardMerger::Out>();
         add<Optimizations::Sharded::needsPrimaryShardMerger::Project>();
         add<Optimizations::Sharded::needsPrimaryShardMerger::LookUp>();
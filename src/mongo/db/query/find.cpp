@@ -53,6 +53,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/query/query_planner_params.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/server_options.h"
@@ -133,8 +134,9 @@ void endQueryOp(OperationContext* opCtx,
                 Collection* collection,
                 const PlanExecutor& exec,
                 long long numResults,
-                CursorId cursorId) {
+                ClientCursor* cursor) {
     auto curOp = CurOp::get(opCtx);
+    const CursorId cursorId = cursor ? cursor->cursorid() : 0;
 
     // Fill out basic CurOp query exec properties.
     curOp->debug().nreturned = numResults;
@@ -155,6 +157,20 @@ void endQueryOp(OperationContext* opCtx,
         Explain::getWinningPlanStats(&exec, &statsBob);
         curOp->debug().execStats = statsBob.obj();
     }
+
+    auto cq = exec.getCanonicalQuery();
+    if (cq && QueryShapeStats::isEnabled(opCtx)) {
+        QueryShapeStats::ExecutionMetrics metrics;
+        metrics.latency = curOp->elapsedTimeExcludingPauses();
+        metrics.nReturned = numResults;
+        if (cursor) {
+            cursor->recordQueryShapeOnDispose(metrics);
+        } else {
+            metrics.keysExamined = summaryStats.totalKeysExamined;
+            metrics.docsExamined = summaryStats.totalDocsExamined;
+            QueryShapeStats::get(opCtx).record(opCtx, QueryShapeStats::Shape(*cq), metrics);
+        }
+    }
 }
 
 namespace {
@@ -472,6 +488,8 @@ Message getMore(OperationContext* opCtx,
         //    case, the pin's destructor will be invoked, which will call release() on the pin.
         //    Because our ClientCursorPin is declared after our lock is declared, this will happen
         //    under the lock if any locking was necessary.
+        cc->incQueryShapeMetrics(curOp.elapsedTimeExcludingPauses(), numResults);
+
         if (!shouldSaveCursorGetMore(state, exec, cc->isTailable())) {
             ccPin.getValue().deleteUnderlying();
 
@@ -693,10 +711,14 @@ std::string runQuery(OperationContext* opCtx,
             pinnedCursor.getCursor()->setLeftoverMaxTimeMicros(opCtx->getRemainingMaxTimeMicros());
         }
 
-        endQueryOp(opCtx, collection, *pinnedCursor.getCursor()->getExecutor(), numResults, ccId);
+        endQueryOp(opCtx,
+                   collection,
+                   *pinnedCursor.getCursor()->getExecutor(),
+                   numResults,
+                   pinnedCursor.getCursor());
     } else {
         LOG(5) << "Not caching executor but returning " << numResults << " results.";
-        endQueryOp(opCtx, collection, *exec, numResults, ccId);
+        endQueryOp(opCtx, collection, *exec, numResults, nullptr);
     }
 
     // Fill out the output buffer's header.
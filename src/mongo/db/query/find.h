@@ -78,14 +78,17 @@ void beginQueryOp(OperationContext* opCtx,
 /**
  * 1) Fills out CurOp for "opCtx" with information regarding this query's execution.
  * 2) Reports index usage to the CollectionInfoCache.
+ * 3) Records the query in the query shape statistics, right away if it returned all of its
+ *    results, or else once 'cursor', the cursor which returns the rest, is disposed of.
  *
- * Uses explain functionality to extract stats from 'exec'.
+ * Uses explain functionality to extract stats from 'exec'. 'cursor' is null if the query did not
+ * open a cursor, and otherwise owns 'exec'.
  */
 void endQueryOp(OperationContext* opCtx,
                 Collection* collection,
                 const PlanExecutor& exec,
                 long long numResults,
-                CursorId cursorId);
+                ClientCursor* cursor);
 
 /**
  * Constructs a PlanExecutor for a query with the oplogReplay option set to true,
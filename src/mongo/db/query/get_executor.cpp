@@ -123,6 +123,34 @@ namespace {
 // The body is below in the "count hack" section but getExecutor calls it.
 bool turnIxscanIntoCount(QuerySolution* soln);
 
+// Past this many ranges the bounds of a restricted index scan become costlier to check than the
+// documents they would spare.
+const size_t kMaxOwnedShardKeyIntervals = 128;
+
+/**
+ * Returns the intervals of the shard key owned by this shard as bounds for index scans, if the
+ * shard key is a single ascending field and its owned ranges are known and few enough.
+ */
+boost::optional<OrderedIntervalList> getShardKeyOwnedIntervals(const CollectionMetadata& metadata) {
+    const auto ownedRanges = metadata.getOwnedRanges();
+    const BSONElement shardKeyField = metadata.getKeyPattern().firstElement();
+    if (!ownedRanges || metadata.getKeyPattern().nFields() != 1 || !shardKeyField.isNumber() ||
+        shardKeyField.number() <= 0 ||
+        ownedRanges->getRanges().size() > kMaxOwnedShardKeyIntervals) {
+        return boost::none;
+    }
+
+    OrderedIntervalList oil(shardKeyField.fieldName());
+    for (const auto& range : ownedRanges->getRanges()) {
+        BSONObjBuilder bob;
+        bob.appendAs(range.first.firstElement(), "");
+        bob.appendAs(range.second.firstElement(), "");
+        oil.intervals.push_back(Interval(bob.obj(), true, false));
+    }
+
+    return oil;
+}
+
 }  // namespace
 
 
@@ -182,6 +210,10 @@ void fillOutPlannerParams(OperationContext* opCtx,
             CollectionShardingState::get(opCtx, canonicalQuery->nss())->getMetadata(opCtx);
         if (collMetadata->isSharded()) {
             plannerParams->shardKey = collMetadata->getKeyPattern();
+
+            if (internalQueryPlannerRestrictScansToOwnedRanges.load()) {
+                plannerParams->shardKeyOwnedIntervals = getShardKeyOwnedIntervals(*collMetadata);
+            }
         } else {
             // If there's no metadata don't bother w/the shard filter since we won't know what
             // the key pattern is anyway...
@@ -302,9 +334,10 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
     }
 
     const IndexDescriptor* descriptor = collection->getIndexCatalog()->findIdIndex(opCtx);
+    const bool hasIdLookup = descriptor || collection->getRecordStore()->isClustered();
 
-    // If we have an _id index we can use an idhack plan.
-    if (descriptor && IDHackStage::supportsQuery(collection, *canonicalQuery)) {
+    // If we have an _id index, or the collection is clustered by _id, we can use an idhack plan.
+    if (hasIdLookup && IDHackStage::supportsQuery(collection, *canonicalQuery)) {
         LOG(2) << "Using idhack: " << redact(canonicalQuery->toStringShort());
 
         root = make_unique<IDHackStage>(opCtx, collection, canonicalQuery.get(), ws, descriptor);
@@ -831,6 +864,7 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorDelete(
         }
 
         const IndexDescriptor* descriptor = collection->getIndexCatalog()->findIdIndex(opCtx);
+        const bool hasIdLookup = descriptor || collection->getRecordStore()->isClustered();
 
         // Construct delete request collator.
         std::unique_ptr<CollatorInterface> collator;
@@ -845,7 +879,7 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorDelete(
         const bool hasCollectionDefaultCollation = request->getCollation().isEmpty() ||
             CollatorInterface::collatorsMatch(collator.get(), collection->getDefaultCollator());
 
-        if (descriptor && CanonicalQuery::isSimpleIdQuery(unparsedQuery) &&
+        if (hasIdLookup && CanonicalQuery::isSimpleIdQuery(unparsedQuery) &&
             request->getProj().isEmpty() && hasCollectionDefaultCollation) {
             LOG(2) << "Using idhack: " << redact(unparsedQuery);
 
@@ -979,11 +1013,12 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorUpdate(
         }
 
         const IndexDescriptor* descriptor = collection->getIndexCatalog()->findIdIndex(opCtx);
+        const bool hasIdLookup = descriptor || collection->getRecordStore()->isClustered();
 
         const bool hasCollectionDefaultCollation = CollatorInterface::collatorsMatch(
             parsedUpdate->getCollator(), collection->getDefaultCollator());
 
-        if (descriptor && CanonicalQuery::isSimpleIdQuery(unparsedQuery) &&
+        if (hasIdLookup && CanonicalQuery::isSimpleIdQuery(unparsedQuery) &&
             request->getProj().isEmpty() && hasCollectionDefaultCollation) {
             LOG(2) << "Using idhack: " << redact(unparsedQuery);
 
@@ -41,6 +41,7 @@
 #include "mongo/db/index/s2_common.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_geo.h"
+#include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/util/log.h"
@@ -292,6 +293,44 @@ void geoSkipValidationOn(const std::set<StringData>& twoDSphereFields,
     }
 }
 
+/**
+ * Intersects the leading bounds of each index scan under 'node', whose index starts with the shard
+ * key field in ascending order and compares strings without a collation, with 'ownedIntervals'.
+ * The shard filter above the scans still checks every document; this only spares the fetching and
+ * filtering of documents which it would drop anyway.
+ */
+void restrictScansToOwnedIntervals(const OrderedIntervalList& ownedIntervals,
+                                   QuerySolutionNode* node) {
+    if (STAGE_IXSCAN == node->getType()) {
+        IndexScanNode* ixn = static_cast<IndexScanNode*>(node);
+        const BSONElement firstField = ixn->index.keyPattern.firstElement();
+
+        if (INDEX_BTREE != ixn->index.type || ixn->index.collator || ixn->bounds.isSimpleRange ||
+            ixn->bounds.fields.empty() || !firstField.isNumber() || firstField.number() <= 0 ||
+            firstField.fieldNameStringData() != ownedIntervals.name) {
+            return;
+        }
+
+        OrderedIntervalList* oil = &ixn->bounds.fields[0];
+        if (ixn->direction < 0) {
+            oil->reverse();
+        }
+
+        OrderedIntervalList owned = ownedIntervals;
+        owned.name = oil->name;
+        IndexBoundsBuilder::intersectize(owned, oil);
+
+        if (ixn->direction < 0) {
+            oil->reverse();
+        }
+        return;
+    }
+
+    for (QuerySolutionNode* child : node->children) {
+        restrictScansToOwnedIntervals(ownedIntervals, child);
+    }
+}
+
 }  // namespace
 
 // static
@@ -635,6 +674,10 @@ std::unique_ptr<QuerySolution> QueryPlannerAnalysis::analyzeDataAccess(
     // If we're answering a query on a sharded system, we need to drop documents that aren't
     // logically part of our shard.
     if (params.options & QueryPlannerParams::INCLUDE_SHARD_FILTER) {
+        if (params.shardKeyOwnedIntervals) {
+            restrictScansToOwnedIntervals(*params.shardKeyOwnedIntervals, solnRoot.get());
+        }
+
         if (!solnRoot->fetched()) {
             // See if we need to fetch information for our shard key.
             // NOTE: Solution nodes only list ordinary, non-transformed index keys for now
@@ -94,7 +94,20 @@ MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupCacheSizeBytes, int, 1
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerGenerateCoveredWholeIndexScans, bool, false);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerRestrictScansToOwnedRanges, bool, true);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryIgnoreUnknownJSONSchemaKeywords, bool, false);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryProhibitBlockingMergeOnMongoS, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMergePartialGroupsInOrder, bool, false);
+
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(internalQueryShapeStatsCacheSize, int, 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "internalQueryShapeStatsCacheSize must be greater than or equal to 0");
+        }
+        return Status::OK();
+    });
 }  // namespace mongo
@@ -97,6 +97,10 @@ extern AtomicInt32 internalQueryMaxScansToExplode;
 // Allow the planner to generate covered whole index scans, rather than falling back to a COLLSCAN.
 extern AtomicBool internalQueryPlannerGenerateCoveredWholeIndexScans;
 
+// Restrict index scans on a sharded collection to the shard key ranges owned by the shard, when the
+// index leads with the shard key.
+extern AtomicBool internalQueryPlannerRestrictScansToOwnedRanges;
+
 // Ignore unknown JSON Schema keywords.
 extern AtomicBool internalQueryIgnoreUnknownJSONSchemaKeywords;
 
@@ -127,4 +131,13 @@ extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 extern AtomicInt32 internalDocumentSourceLookupCacheSizeBytes;
 
 extern AtomicBool internalQueryProhibitBlockingMergeOnMongoS;
+
+// If true, shards return the partial results of a split $group ordered by group key, and the merger
+// combines them as they stream in instead of holding every group in memory. Shards from before this
+// knob was added reject the $group options it relies on, so it must only be enabled once every
+// shard in the cluster has been upgraded.
+extern AtomicBool internalQueryMergePartialGroupsInOrder;
+
+// How many query shapes to keep execution statistics for. Zero disables the statistics.
+extern int internalQueryShapeStatsCacheSize;
 }  // namespace mongo
@@ -30,9 +30,11 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <vector>
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/query/index_bounds.h"
 #include "mongo/db/query/index_entry.h"
 #include "mongo/db/query/query_knobs.h"
 
@@ -114,6 +116,11 @@ struct QueryPlannerParams {
     // forcing a fetch.
     BSONObj shardKey;
 
+    // The intervals of the shard key owned by this shard, if the shard key is a single ascending
+    // field. Scans of indexes which lead with that field are restricted to these intervals, so
+    // that documents the shard filter is bound to drop are not fetched in the first place.
+    boost::optional<OrderedIntervalList> shardKeyOwnedIntervals;
+
     // Were index filters applied to indices?
     bool indexFiltersApplied;
 
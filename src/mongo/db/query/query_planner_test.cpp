@@ -4076,6 +4076,47 @@ TEST_F(QueryPlannerTest, ShardFilterNoIndexNotCovered) {
         "{ixscan: {pattern: {b: 1}}}}}}}}}");
 }
 
+TEST_F(QueryPlannerTest, ShardFilterRestrictsIndexScanToOwnedIntervals) {
+    params.options = QueryPlannerParams::INCLUDE_SHARD_FILTER | QueryPlannerParams::NO_TABLE_SCAN;
+    params.shardKey = BSON("a" << 1);
+    params.shardKeyOwnedIntervals = OrderedIntervalList("a");
+    params.shardKeyOwnedIntervals->intervals.push_back(
+        Interval(BSON("" << MINKEY << "" << 0), true, false));
+    params.shardKeyOwnedIntervals->intervals.push_back(
+        Interval(BSON("" << 10 << "" << 20), true, false));
+    addIndex(BSON("a" << 1));
+    addIndex(BSON("b" << 1));
+
+    runQuery(fromjson("{a: {$gte: 5}, b: 1}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sharding_filter: {node: {fetch: {node: "
+        "{ixscan: {pattern: {a: 1}, bounds: {a: [[10, 20, true, false]]}}}}}}}");
+    assertSolutionExists(
+        "{sharding_filter: {node: {fetch: {node: "
+        "{ixscan: {pattern: {b: 1}, bounds: {b: [[1, 1, true, true]]}}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, ShardFilterRestrictsReverseIndexScanToOwnedIntervals) {
+    params.options = QueryPlannerParams::INCLUDE_SHARD_FILTER | QueryPlannerParams::NO_TABLE_SCAN;
+    params.shardKey = BSON("a" << 1);
+    params.shardKeyOwnedIntervals = OrderedIntervalList("a");
+    params.shardKeyOwnedIntervals->intervals.push_back(
+        Interval(BSON("" << MINKEY << "" << 0), true, false));
+    params.shardKeyOwnedIntervals->intervals.push_back(
+        Interval(BSON("" << 10 << "" << 20), true, false));
+    addIndex(BSON("a" << 1 << "b" << 1));
+
+    runQuerySortProj(fromjson("{a: {$lte: 15}}"), fromjson("{a: -1}"), BSONObj());
+
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{sharding_filter: {node: {fetch: {node: "
+        "{ixscan: {pattern: {a: 1, b: 1}, dir: -1, bounds: {a: [[15, 10, true, true], "
+        "[0, -Infinity, false, true]], b: [['MaxKey', 'MinKey', true, true]]}}}}}}}");
+}
+
 TEST_F(QueryPlannerTest, CannotTrimIxisectParam) {
     params.options = QueryPlannerParams::CANNOT_TRIM_IXISECT;
     params.options |= QueryPlannerParams::INDEX_INTERSECTION;
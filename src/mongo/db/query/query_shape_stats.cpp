@@ -0,0 +1,207 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/clock_source.h"
+#include "mongo/util/hex.h"
+#include "mongo/util/mongoutils/str.h"
+#include <third_party/murmurhash3/MurmurHash3.h>
+
+namespace mongo {
+namespace {
+
+const auto getQueryShapeStats = ServiceContext::declareDecoration<QueryShapeStats>();
+
+/**
+ * Returns the number of partitions over which a store of 'maxShapes' shapes is spread.
+ */
+size_t numPartitionsFor(size_t maxShapes) {
+    return std::max(size_t(1),
+                    std::min(QueryShapeStats::kNumPartitions,
+                             maxShapes / QueryShapeStats::kMinShapesPerPartition));
+}
+
+}  // namespace
+
+constexpr size_t QueryShapeStats::kNumPartitions;
+constexpr size_t QueryShapeStats::kMinShapesPerPartition;
+
+QueryShapeStats::Shape::Shape(const CanonicalQuery& query)
+    : _ns(query.nss().ns()),
+      _key(str::stream() << _ns << '\0' << computeShapeKey(query)),
+      _query(query.getQueryRequest().getFilter().getOwned()),
+      _sort(query.getQueryRequest().getSort().getOwned()),
+      _projection(query.getQueryRequest().getProj().getOwned()) {}
+
+QueryShapeStats& QueryShapeStats::get(ServiceContext* service) {
+    return getQueryShapeStats(service);
+}
+
+QueryShapeStats& QueryShapeStats::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+bool QueryShapeStats::isEnabled(OperationContext* opCtx) {
+    return internalQueryShapeStatsCacheSize > 0 && !opCtx->getClient()->isInDirectClient();
+}
+
+std::string QueryShapeStats::computeShapeKey(const CanonicalQuery& query) {
+    // A plan cache which knows of no indexes encodes nothing but the shape of the query. It is
+    // never written to, so it may be shared without locking.
+    static const PlanCache shapeEncoder;
+    return shapeEncoder.computeKey(query);
+}
+
+std::string QueryShapeStats::computeShapeHash(StringData shapeKey) {
+    std::uint32_t hash;
+    MurmurHash3_x86_32(shapeKey.rawData(), shapeKey.size(), 0, &hash);
+    return integerToHex(static_cast<unsigned int>(hash));
+}
+
+void QueryShapeStats::record(OperationContext* opCtx,
+                             const Shape& shape,
+                             const ExecutionMetrics& metrics) {
+    const size_t maxShapes = internalQueryShapeStatsCacheSize;
+    if (maxShapes == 0) {
+        return;
+    }
+
+    const size_t numPartitions = numPartitionsFor(maxShapes);
+    Partition& partition = _partitions[std::hash<std::string>()(shape._key) % numPartitions];
+    const auto now = opCtx->getServiceContext()->getFastClockSource()->now();
+
+    stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+    if (!partition.shapes) {
+        partition.shapes = stdx::make_unique<LRUKeyValue<std::string, ShapeStats>>(
+            (maxShapes + numPartitions - 1) / numPartitions);
+    }
+
+    ShapeStats* stats;
+    if (!partition.shapes->get(shape._key, &stats).isOK()) {
+        stats = new ShapeStats;
+        stats->ns = shape._ns;
+        stats->queryHash = computeShapeHash(StringData(shape._key).substr(shape._ns.size() + 1));
+        stats->query = shape._query;
+        stats->sort = shape._sort;
+        stats->projection = shape._projection;
+        stats->firstSeen = now;
+
+        // Takes ownership of 'stats', and returns the shape evicted to make room for it, if any.
+        partition.shapes->add(shape._key, stats);
+    }
+
+    stats->lastSeen = now;
+    ++stats->execCount;
+    stats->keysExamined += metrics.keysExamined;
+    stats->docsExamined += metrics.docsExamined;
+    stats->nReturned += metrics.nReturned;
+    stats->shardsTargeted += metrics.shardsTargeted;
+    stats->bytesSent += metrics.bytesSent;
+    stats->latency.increment(durationCount<Microseconds>(metrics.latency),
+                             Command::ReadWriteType::kRead);
+}
+
+std::vector<BSONObj> QueryShapeStats::getStats(bool includeHistograms) const {
+    // Each partition lists its shapes from the most to the least recently run. Merge them by the
+    // time they were last run, keeping that order between shapes last run at the same time.
+    std::vector<std::pair<Date_t, BSONObj>> shapes;
+    for (const auto& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+        if (!partition.shapes) {
+            continue;
+        }
+
+        for (auto it = partition.shapes->begin(); it != partition.shapes->end(); ++it) {
+            shapes.emplace_back(it->second->lastSeen,
+                                _buildStatsDoc(*it->second, includeHistograms));
+        }
+    }
+
+    std::stable_sort(shapes.begin(), shapes.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    std::vector<BSONObj> result;
+    result.reserve(shapes.size());
+    for (auto& shape : shapes) {
+        result.push_back(std::move(shape.second));
+    }
+    return result;
+}
+
+BSONObj QueryShapeStats::_buildStatsDoc(const ShapeStats& stats, bool includeHistograms) {
+    BSONObjBuilder builder;
+    builder.append("ns", stats.ns);
+    builder.append("queryHash", stats.queryHash);
+    builder.append("query", stats.query);
+    builder.append("sort", stats.sort);
+    builder.append("projection", stats.projection);
+    builder.append("firstSeen", stats.firstSeen);
+    builder.append("lastSeen", stats.lastSeen);
+    builder.append("execCount", stats.execCount);
+    builder.append("keysExamined", stats.keysExamined);
+    builder.append("docsExamined", stats.docsExamined);
+    builder.append("nReturned", stats.nReturned);
+    builder.append("shardsTargeted", stats.shardsTargeted);
+    builder.append("bytesSent", stats.bytesSent);
+
+    // Queries are only ever recorded as reads, so the other histograms are left out.
+    BSONObjBuilder latencyBuilder;
+    stats.latency.append(includeHistograms, &latencyBuilder);
+    builder.append("latencyStats", latencyBuilder.done()["reads"].Obj());
+
+    return builder.obj();
+}
+
+void QueryShapeStats::clear() {
+    for (auto& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+        if (partition.shapes) {
+            partition.shapes->clear();
+        }
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,184 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/db/stats/operation_latency_histogram.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class CanonicalQuery;
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Execution statistics of the queries run by this process, aggregated by namespace and query shape.
+ * The shape of a query is the plan cache encoding of its predicate, sort and projection, which
+ * leaves out the constants they contain. Shapes are reported with a hash of that encoding, which
+ * is the same on every mongod and mongos, so that a shape can be followed through a cluster.
+ *
+ * At most internalQueryShapeStatsCacheSize shapes are tracked, rounded up to a multiple of the
+ * number of partitions in use. Shapes are spread over up to kNumPartitions partitions by hash, each
+ * with its own mutex, so that concurrent queries of different shapes rarely contend. When a new
+ * shape would exceed its partition's share, the shape of that partition which was run least
+ * recently is dropped.
+ *
+ * A query which returns its results in several batches is recorded once, when its cursor is
+ * closed, with the metrics of all of its batches.
+ *
+ * This class is thread-safe.
+ */
+class QueryShapeStats {
+public:
+    /**
+     * What one execution of a query contributes to the statistics of its shape. Metrics which do
+     * not apply to the process which ran the query, such as the shards targeted on a mongod, are
+     * left at zero.
+     */
+    struct ExecutionMetrics {
+        Microseconds latency{0};
+        long long keysExamined = 0;
+        long long docsExamined = 0;
+        long long nReturned = 0;
+        long long shardsTargeted = 0;
+        long long bytesSent = 0;
+    };
+
+    /**
+     * The shape of one query, computed once when the query starts. A query which opens a cursor
+     * keeps its shape, or what it takes to compute it, until the cursor is closed.
+     */
+    class Shape {
+    public:
+        explicit Shape(const CanonicalQuery& query);
+
+    private:
+        friend class QueryShapeStats;
+
+        std::string _ns;
+
+        // The namespace and the shape key, separated by a NUL character.
+        std::string _key;
+
+        BSONObj _query;
+        BSONObj _sort;
+        BSONObj _projection;
+    };
+
+    static constexpr size_t kNumPartitions = 16;
+
+    // Stores which track fewer shapes than this per partition use fewer partitions, down to one,
+    // so that small stores still evict the least recently run shape overall.
+    static constexpr size_t kMinShapesPerPartition = 32;
+
+    static QueryShapeStats& get(ServiceContext* service);
+    static QueryShapeStats& get(OperationContext* opCtx);
+
+    /**
+     * Returns whether the queries run by 'opCtx' are recorded. They are not if the statistics are
+     * disabled, or if they are run on behalf of the server itself, through DBDirectClient.
+     */
+    static bool isEnabled(OperationContext* opCtx);
+
+    /**
+     * Returns the encoding of the shape of 'query'. Unlike PlanCache::computeKey(), it does not
+     * depend on the indexes of the collection, so it can be computed where the collection is not
+     * available, such as on mongos.
+     */
+    static std::string computeShapeKey(const CanonicalQuery& query);
+
+    /**
+     * Returns the hash with which the shape encoded as 'shapeKey' is reported.
+     */
+    static std::string computeShapeHash(StringData shapeKey);
+
+    /**
+     * Adds one execution of a query of shape 'shape' to the statistics of that shape. Callers
+     * check isEnabled() first, so that the shape is not computed for queries which are not
+     * recorded.
+     */
+    void record(OperationContext* opCtx, const Shape& shape, const ExecutionMetrics& metrics);
+
+    /**
+     * Returns one document per tracked shape, the most recently run shape first.
+     */
+    std::vector<BSONObj> getStats(bool includeHistograms) const;
+
+    /**
+     * Drops the statistics of all shapes.
+     */
+    void clear();
+
+private:
+    struct ShapeStats {
+        std::string ns;
+        std::string queryHash;
+
+        // The first query seen with this shape, as planCacheListQueryShapes reports shapes.
+        BSONObj query;
+        BSONObj sort;
+        BSONObj projection;
+
+        Date_t firstSeen;
+        Date_t lastSeen;
+
+        long long execCount = 0;
+        long long keysExamined = 0;
+        long long docsExamined = 0;
+        long long nReturned = 0;
+        long long shardsTargeted = 0;
+        long long bytesSent = 0;
+        OperationLatencyHistogram latency;
+    };
+
+    static BSONObj _buildStatsDoc(const ShapeStats& stats, bool includeHistograms);
+
+    struct Partition {
+        mutable stdx::mutex mutex;
+
+        // Keyed by namespace and shape key. Created by the first record() call which falls into
+        // this partition, after the startup parameters which size it have been set.
+        std::unique_ptr<LRUKeyValue<std::string, ShapeStats>> shapes;
+    };
+
+    std::array<Partition, kNumPartitions> _partitions;
+};
+
+}  // namespace mongo
@@ -0,0 +1,203 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test", "coll");
+const NamespaceString kOtherNss("test", "otherColl");
+
+class QueryShapeStatsTest : public unittest::Test {
+protected:
+    void setUp() override {
+        _originalCacheSize = internalQueryShapeStatsCacheSize;
+        _opCtx = _serviceContext.makeOperationContext();
+    }
+
+    void tearDown() override {
+        internalQueryShapeStatsCacheSize = _originalCacheSize;
+    }
+
+    std::unique_ptr<CanonicalQuery> canonicalize(const NamespaceString& nss,
+                                                 const BSONObj& findCmd) {
+        auto qr = uassertStatusOK(QueryRequest::makeFromFindCommand(nss, findCmd, false));
+        return uassertStatusOK(CanonicalQuery::canonicalize(_opCtx.get(), std::move(qr)));
+    }
+
+    void record(const NamespaceString& nss, const BSONObj& findCmd, long long nReturned = 1) {
+        QueryShapeStats::ExecutionMetrics metrics;
+        metrics.latency = Microseconds(10);
+        metrics.nReturned = nReturned;
+        _stats.record(_opCtx.get(), QueryShapeStats::Shape(*canonicalize(nss, findCmd)), metrics);
+    }
+
+    QueryShapeStats _stats;
+
+    QueryTestServiceContext _serviceContext;
+    ServiceContext::UniqueOperationContext _opCtx;
+
+private:
+    int _originalCacheSize;
+};
+
+TEST_F(QueryShapeStatsTest, QueriesWhichDifferOnlyInConstantsShareAShape) {
+    record(kNss, BSON("find" << kNss.coll() << "filter" << BSON("a" << 1)), 3);
+    record(kNss, BSON("find" << kNss.coll() << "filter" << BSON("a" << 2)), 4);
+
+    auto stats = _stats.getStats(false);
+    ASSERT_EQ(1U, stats.size());
+    ASSERT_EQ(kNss.ns(), stats[0]["ns"].String());
+    ASSERT_EQ(2, stats[0]["execCount"].numberLong());
+    ASSERT_EQ(7, stats[0]["nReturned"].numberLong());
+
+    // The first query seen is reported for the shape.
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1), stats[0]["query"].Obj());
+    ASSERT_EQ(2, stats[0]["latencyStats"]["ops"].numberLong());
+    ASSERT_FALSE(stats[0]["latencyStats"].Obj().hasField("histogram"));
+}
+
+TEST_F(QueryShapeStatsTest, DifferentShapesAndNamespacesAreTrackedSeparately) {
+    record(kNss, BSON("find" << kNss.coll() << "filter" << BSON("a" << 1)));
+    record(kNss, BSON("find" << kNss.coll() << "filter" << BSON("b" << 1)));
+    record(kOtherNss, BSON("find" << kOtherNss.coll() << "filter" << BSON("a" << 1)));
+    record(kNss,
+           BSON("find" << kNss.coll() << "filter" << BSON("a" << 1) << "sort" << BSON("b" << 1)));
+
+    auto stats = _stats.getStats(true);
+    ASSERT_EQ(4U, stats.size());
+    for (auto&& shape : stats) {
+        ASSERT_EQ(1, shape["execCount"].numberLong());
+        ASSERT_TRUE(shape["latencyStats"].Obj().hasField("histogram"));
+    }
+
+    // The same shape has the same hash on every namespace.
+    auto shapeOnOtherNss = std::find_if(stats.begin(), stats.end(), [](const BSONObj& shape) {
+        return shape["ns"].String() == kOtherNss.ns();
+    });
+    ASSERT(shapeOnOtherNss != stats.end());
+
+    auto query = canonicalize(kNss, BSON("find" << kNss.coll() << "filter" << BSON("a" << 5)));
+    ASSERT_EQ(QueryShapeStats::computeShapeHash(QueryShapeStats::computeShapeKey(*query)),
+              (*shapeOnOtherNss)["queryHash"].String());
+}
+
+TEST_F(QueryShapeStatsTest, LeastRecentlyRunShapeIsEvicted) {
+    internalQueryShapeStatsCacheSize = 2;
+
+    record(kNss, BSON("find" << kNss.coll() << "filter" << BSON("a" << 1)));
+    record(kNss, BSON("find" << kNss.coll() << "filter" << BSON("b" << 1)));
+    record(kNss, BSON("find" << kNss.coll() << "filter" << BSON("a" << 2)));
+    record(kNss, BSON("find" << kNss.coll() << "filter" << BSON("c" << 1)));
+
+    auto stats = _stats.getStats(false);
+    ASSERT_EQ(2U, stats.size());
+    ASSERT_BSONOBJ_EQ(BSON("c" << 1), stats[0]["query"].Obj());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1), stats[1]["query"].Obj());
+    ASSERT_EQ(2, stats[1]["execCount"].numberLong());
+}
+
+TEST_F(QueryShapeStatsTest, LargeStoresArePartitionedAndStayBounded) {
+    // Large enough to be spread over several partitions.
+    const int cacheSize = 4 * QueryShapeStats::kMinShapesPerPartition;
+    internalQueryShapeStatsCacheSize = cacheSize;
+
+    // Every field name makes a distinct shape.
+    const int numShapes = 10 * cacheSize;
+    for (int i = 0; i < numShapes; ++i) {
+        record(kNss, BSON("find" << kNss.coll() << "filter" << BSON(std::to_string(i) << 1)));
+    }
+
+    auto stats = _stats.getStats(false);
+    ASSERT_GT(stats.size(), 0U);
+    ASSERT_LTE(stats.size(), static_cast<size_t>(cacheSize));
+
+    // The shape run last is never evicted, and all shapes are reported exactly once.
+    const auto lastQuery = BSON(std::to_string(numShapes - 1) << 1);
+    ASSERT_EQ(1,
+              std::count_if(stats.begin(), stats.end(), [&](const BSONObj& shape) {
+                  return SimpleBSONObjComparator::kInstance.evaluate(shape["query"].Obj() ==
+                                                                     lastQuery);
+              }));
+
+    std::set<std::string> hashes;
+    for (auto&& shape : stats) {
+        ASSERT_EQ(1, shape["execCount"].numberLong());
+        ASSERT_TRUE(hashes.insert(shape["queryHash"].String()).second);
+    }
+}
+
+TEST_F(QueryShapeStatsTest, ShapesFromAllPartitionsAreListedByLastRun) {
+    internalQueryShapeStatsCacheSize = 4 * QueryShapeStats::kMinShapesPerPartition;
+
+    for (int i = 0; i < 20; ++i) {
+        record(kNss, BSON("find" << kNss.coll() << "filter" << BSON(std::to_string(i) << 1)));
+    }
+
+    auto stats = _stats.getStats(false);
+    ASSERT_EQ(20U, stats.size());
+    for (size_t i = 1; i < stats.size(); ++i) {
+        ASSERT_GTE(stats[i - 1]["lastSeen"].Date(), stats[i]["lastSeen"].Date());
+    }
+}
+
+TEST_F(QueryShapeStatsTest, NothingIsRecordedWhenDisabled) {
+    internalQueryShapeStatsCacheSize = 0;
+    ASSERT_FALSE(QueryShapeStats::isEnabled(_opCtx.get()));
+
+    record(kNss, BSON("find" << kNss.coll() << "filter" << BSON("a" << 1)));
+    ASSERT_EQ(0U, _stats.getStats(false).size());
+}
+
+TEST_F(QueryShapeStatsTest, ClearDropsAllShapes) {
+    record(kNss, BSON("find" << kNss.coll() << "filter" << BSON("a" << 1)));
+    _stats.clear();
+    ASSERT_EQ(0U, _stats.getStats(false).size());
+
+    record(kNss, BSON("find" << kNss.coll() << "filter" << BSON("a" << 1)));
+    ASSERT_EQ(1U, _stats.getStats(false).size());
+}
+
+}  // namespace
+}  // namespace mongo
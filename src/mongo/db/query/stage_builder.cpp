@@ -34,6 +34,9 @@
 
 #include "mongo/db/query/stage_builder.h"
 
+#include <cmath>
+#include <limits>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/index_catalog.h"
@@ -58,8 +61,10 @@
 #include "mongo/db/exec/sort_key_generator.h"
 #include "mongo/db/exec/text.h"
 #include "mongo/db/index/fts_access_method.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/s/collection_sharding_state.h"
+#include "mongo/db/storage/clustered_key.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
@@ -68,6 +73,165 @@ namespace mongo {
 using std::unique_ptr;
 using stdx::make_unique;
 
+namespace {
+
+// 2^63, the smallest double that does not fit in a long long.
+const double kTwoToThe63 = 9223372036854775808.0;
+
+/**
+ * Returns the smallest integer that is greater than (or equal to, if 'inclusive') the numeric
+ * 'bound', clamped to [0, LLONG_MAX].
+ */
+long long lowestIntegralIdAbove(const BSONElement& bound, bool inclusive) {
+    if (bound.type() == NumberDouble) {
+        const double d = bound._numberDouble();
+        if (std::isnan(d)) {
+            // NaN sorts before every other number.
+            return 0;
+        }
+        const double lowest = inclusive ? std::ceil(d) : std::floor(d) + 1;
+        if (lowest <= 0)
+            return 0;
+        if (lowest >= kTwoToThe63)
+            return std::numeric_limits<long long>::max();
+        return static_cast<long long>(lowest);
+    }
+
+    long long lowest = bound.numberLong();
+    if (!inclusive && lowest != std::numeric_limits<long long>::max())
+        ++lowest;
+    return std::max(lowest, 0LL);
+}
+
+/**
+ * Returns the largest integer that is less than (or equal to, if 'inclusive') the numeric
+ * 'bound', clamped to [-1, LLONG_MAX].
+ */
+long long highestIntegralIdBelow(const BSONElement& bound, bool inclusive) {
+    if (bound.type() == NumberDouble) {
+        const double d = bound._numberDouble();
+        if (std::isnan(d)) {
+            // Nothing but NaN is less than or equal to NaN.
+            return -1;
+        }
+        const double highest = inclusive ? std::floor(d) : std::ceil(d) - 1;
+        if (highest < 0)
+            return -1;
+        if (highest >= kTwoToThe63)
+            return std::numeric_limits<long long>::max();
+        return static_cast<long long>(highest);
+    }
+
+    long long highest = bound.numberLong();
+    if (!inclusive && highest != std::numeric_limits<long long>::min())
+        --highest;
+    return std::max(highest, -1LL);
+}
+
+/**
+ * Narrows [*low, *high], the range of _id values a scan over a clustered collection has to visit,
+ * using 'expr' if it is a numeric comparison on _id.
+ */
+void narrowClusteredIdRange(const MatchExpression* expr, long long* low, long long* high) {
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+            break;
+        default:
+            return;
+    }
+
+    const auto* cmp = static_cast<const ComparisonMatchExpressionBase*>(expr);
+    const BSONElement& bound = cmp->getData();
+    if (cmp->path() != "_id" ||
+        (bound.type() != NumberInt && bound.type() != NumberLong && bound.type() != NumberDouble)) {
+        return;
+    }
+
+    const auto type = expr->matchType();
+    if (type == MatchExpression::EQ || type == MatchExpression::GT ||
+        type == MatchExpression::GTE) {
+        *low = std::max(*low, lowestIntegralIdAbove(bound, type != MatchExpression::GT));
+    }
+    if (type == MatchExpression::EQ || type == MatchExpression::LT ||
+        type == MatchExpression::LTE) {
+        *high = std::min(*high, highestIntegralIdBelow(bound, type != MatchExpression::LT));
+    }
+}
+
+/**
+ * Restricts a scan over a clustered collection to the range of _id values allowed by top-level
+ * comparisons on _id in 'filter'. The filter is still applied to every document scanned.
+ */
+void setClusteredScanBounds(const MatchExpression* filter, CollectionScanParams* params) {
+    if (!filter) {
+        return;
+    }
+
+    long long low = 0;
+    long long high = std::numeric_limits<long long>::max();
+    if (filter->matchType() == MatchExpression::AND) {
+        for (size_t i = 0; i < filter->numChildren(); ++i) {
+            narrowClusteredIdRange(filter->getChild(i), &low, &high);
+        }
+    } else {
+        narrowClusteredIdRange(filter, &low, &high);
+    }
+
+    if (low > 0) {
+        auto key = clusteredkey::keyForIdValue(low);
+        // A lower bound above every valid _id leaves nothing to scan.
+        params->minRecord = key.isOK() ? key.getValue() : RecordId::max();
+    }
+    if (high < 0) {
+        params->maxRecord = RecordId::min();
+    } else {
+        auto key = clusteredkey::keyForIdValue(high);
+        // An upper bound above every valid _id does not restrict the scan.
+        if (key.isOK()) {
+            params->maxRecord = key.getValue();
+        }
+    }
+}
+
+/**
+ * Builds the stage for 'ixn'. If 'numKeyFieldsToDecode' is non-zero the parent stage reads only
+ * that many leading fields of each key.
+ */
+PlanStage* buildIndexScan(OperationContext* opCtx,
+                          Collection* collection,
+                          const CanonicalQuery& cq,
+                          const IndexScanNode* ixn,
+                          WorkingSet* ws,
+                          size_t numKeyFieldsToDecode) {
+    if (nullptr == collection) {
+        warning() << "Can't ixscan null namespace";
+        return nullptr;
+    }
+
+    IndexScanParams params;
+
+    params.descriptor = collection->getIndexCatalog()->findIndexByName(opCtx, ixn->index.name);
+    invariant(params.descriptor,
+              str::stream() << "Namespace: " << collection->ns().toString()
+                            << ", CanonicalQuery: "
+                            << cq.toStringShort()
+                            << ", IndexEntry: "
+                            << ixn->index.toString());
+
+    params.bounds = ixn->bounds;
+    params.direction = ixn->direction;
+    params.maxScan = ixn->maxScan;
+    params.addKeyMetadata = ixn->addKeyMetadata;
+    params.numKeyFieldsToDecode = numKeyFieldsToDecode;
+    return new IndexScan(opCtx, params, ws, ixn->filter.get());
+}
+
+}  // namespace
+
 PlanStage* buildStages(OperationContext* opCtx,
                        Collection* collection,
                        const CanonicalQuery& cq,
@@ -85,32 +249,14 @@ PlanStage* buildStages(OperationContext* opCtx,
                                                      : CollectionScanParams::BACKWARD;
             params.maxScan = csn->maxScan;
             params.shouldWaitForOplogVisibility = csn->shouldWaitForOplogVisibility;
+            if (collection && collection->getRecordStore()->isClustered()) {
+                setClusteredScanBounds(csn->filter.get(), &params);
+            }
             return new CollectionScan(opCtx, params, ws, csn->filter.get());
         }
         case STAGE_IXSCAN: {
             const IndexScanNode* ixn = static_cast<const IndexScanNode*>(root);
-
-            if (nullptr == collection) {
-                warning() << "Can't ixscan null namespace";
-                return nullptr;
-            }
-
-            IndexScanParams params;
-
-            params.descriptor =
-                collection->getIndexCatalog()->findIndexByName(opCtx, ixn->index.name);
-            invariant(params.descriptor,
-                      str::stream() << "Namespace: " << collection->ns().toString()
-                                    << ", CanonicalQuery: "
-                                    << cq.toStringShort()
-                                    << ", IndexEntry: "
-                                    << ixn->index.toString());
-
-            params.bounds = ixn->bounds;
-            params.direction = ixn->direction;
-            params.maxScan = ixn->maxScan;
-            params.addKeyMetadata = ixn->addKeyMetadata;
-            return new IndexScan(opCtx, params, ws, ixn->filter.get());
+            return buildIndexScan(opCtx, collection, cq, ixn, ws, 0);
         }
         case STAGE_FETCH: {
             const FetchNode* fn = static_cast<const FetchNode*>(root);
@@ -144,7 +290,22 @@ PlanStage* buildStages(OperationContext* opCtx,
         }
         case STAGE_PROJECTION: {
             const ProjectionNode* pn = static_cast<const ProjectionNode*>(root);
-            PlanStage* childStage = buildStages(opCtx, collection, cq, qsol, pn->children[0], ws);
+            const QuerySolutionNode* childNode = pn->children[0];
+            PlanStage* childStage;
+            if (ProjectionNode::COVERED_ONE_INDEX == pn->projType &&
+                STAGE_IXSCAN == childNode->getType()) {
+                // Nothing between us and the index scan reads the key, so the scan only has to
+                // decode the key fields we project.
+                childStage = buildIndexScan(
+                    opCtx,
+                    collection,
+                    cq,
+                    static_cast<const IndexScanNode*>(childNode),
+                    ws,
+                    ProjectionStage::numCoveredKeyFieldsNeeded(pn->projection, pn->coveredKeyObj));
+            } else {
+                childStage = buildStages(opCtx, collection, cq, qsol, childNode, ws);
+            }
             if (nullptr == childStage) {
                 return nullptr;
             }
@@ -302,11 +463,9 @@ PlanStage* buildStages(OperationContext* opCtx,
             if (nullptr == childStage) {
                 return nullptr;
             }
+            auto css = CollectionShardingState::get(opCtx, collection->ns());
             return new ShardFilterStage(
-                opCtx,
-                CollectionShardingState::get(opCtx, collection->ns())->getMetadata(opCtx),
-                ws,
-                childStage);
+                opCtx, css->getMetadata(opCtx), ws, childStage, css->getChunkHeatMap());
         }
         case STAGE_KEEP_MUTATIONS: {
             const KeepMutationsNode* km = static_cast<const KeepMutationsNode*>(root);
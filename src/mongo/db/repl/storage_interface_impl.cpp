@@ -897,9 +897,10 @@ Status StorageInterfaceImpl::upsertById(OperationContext* opCtx,
         }
 
         // We're using the ID hack to perform the update so we have to disallow collections
-        // without an _id index.
+        // without an _id index. Clustered collections have none, and the ID hack stage finds
+        // their documents through the RecordId their _id maps to instead.
         auto descriptor = collection->getIndexCatalog()->findIdIndex(opCtx);
-        if (!descriptor) {
+        if (!descriptor && !collection->getRecordStore()->isClustered()) {
             return Status(ErrorCodes::IndexNotFound,
                           "Unable to update document in a collection without an _id index.");
         }
@@ -69,7 +69,8 @@ void SyncTailOpObserver::onDelete(OperationContext* opCtx,
                                   OptionalCollectionUUID uuid,
                                   StmtId stmtId,
                                   bool fromMigrate,
-                                  const boost::optional<BSONObj>& deletedDoc) {
+                                  const boost::optional<BSONObj>& deletedDoc,
+                                  const OplogSlot& oplogSlot) {
     if (!onDeleteFn) {
         return;
     }
@@ -67,7 +67,8 @@ public:
                   OptionalCollectionUUID uuid,
                   StmtId stmtId,
                   bool fromMigrate,
-                  const boost::optional<BSONObj>& deletedDoc) override;
+                  const boost::optional<BSONObj>& deletedDoc,
+                  const OplogSlot& oplogSlot) override;
 
     /**
      * Called when SyncTail creates a collection.
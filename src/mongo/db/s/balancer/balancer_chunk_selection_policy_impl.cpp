@@ -39,6 +39,7 @@
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj_comparator_interface.h"
+#include "mongo/s/balancer_configuration.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/catalog/type_collection.h"
 #include "mongo/s/catalog/type_tags.h"
@@ -108,6 +109,17 @@ StatusWith<DistributionStatus> createCollectionDistributionStatus(
         }
     }
 
+    // Attach the load, which the shards have sampled on the collection's chunks
+    for (const auto& stat : allShards) {
+        const auto it = stat.chunkLoads.find(chunkMgr->getns().ns());
+        if (it == stat.chunkLoads.end())
+            continue;
+
+        for (const auto& chunkLoad : it->second) {
+            distribution.addChunkLoad(chunkLoad);
+        }
+    }
+
     return {std::move(distribution)};
 }
 
@@ -256,7 +268,8 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
     }
 
     MigrateInfoVector candidateChunks;
-    std::set<ShardId> usedShards;
+    ShardMigrationBudget budget(
+        Grid::get(opCtx)->getBalancerConfiguration()->getMaxMigrationsPerShardPerRound());
 
     std::shuffle(collections.begin(), collections.end(), _random);
 
@@ -273,7 +286,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
         }
 
         auto candidatesStatus = _getMigrateCandidatesForCollection(
-            opCtx, nss, shardStats, aggressiveBalanceHint, &usedShards);
+            opCtx, nss, shardStats, aggressiveBalanceHint, &budget);
         if (candidatesStatus == ErrorCodes::NamespaceNotFound) {
             // Namespace got dropped before we managed to get to it, so just skip it
             continue;
@@ -416,7 +429,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
     const NamespaceString& nss,
     const ShardStatisticsVector& shardStats,
     bool aggressiveBalanceHint,
-    std::set<ShardId>* usedShards) {
+    ShardMigrationBudget* budget) {
     auto routingInfoStatus =
         Grid::get(opCtx)->catalogCache()->getShardedCollectionRoutingInfoWithRefresh(opCtx, nss);
     if (!routingInfoStatus.isOK()) {
@@ -427,12 +440,12 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
 
     const auto& shardKeyPattern = cm->getShardKeyPattern().getKeyPattern();
 
-    const auto collInfoStatus = createCollectionDistributionStatus(opCtx, shardStats, cm);
+    auto collInfoStatus = createCollectionDistributionStatus(opCtx, shardStats, cm);
     if (!collInfoStatus.isOK()) {
         return collInfoStatus.getStatus();
     }
 
-    const DistributionStatus& distribution = collInfoStatus.getValue();
+    DistributionStatus& distribution = collInfoStatus.getValue();
 
     for (const auto& tagRangeEntry : distribution.tagRanges()) {
         const auto& tagRange = tagRangeEntry.second;
@@ -473,7 +486,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
         }
     }
 
-    return BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint, usedShards);
+    return BalancerPolicy::balance(shardStats, &distribution, aggressiveBalanceHint, budget);
 }
 
 }  // namespace mongo
@@ -73,7 +73,7 @@ private:
         const NamespaceString& nss,
         const ShardStatisticsVector& shardStats,
         bool aggressiveBalanceHint,
-        std::set<ShardId>* usedShards);
+        ShardMigrationBudget* budget);
 
     // Source for obtaining cluster statistics. Not owned and must not be destroyed before the
     // policy object is destroyed.
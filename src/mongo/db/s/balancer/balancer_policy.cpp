@@ -34,6 +34,9 @@
 
 #include "mongo/db/s/balancer/balancer_policy.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/catalog/type_tags.h"
 #include "mongo/util/log.h"
@@ -54,12 +57,23 @@ namespace {
 const size_t kDefaultImbalanceThreshold = 2;
 const size_t kAggressiveImbalanceThreshold = 1;
 
+// Minimum rate of operations, which a shard needs to receive for the chunks of a zone before the
+// balancer starts moving chunks in order to even out the load across the zone's shards.
+const double kMinLoadToBalanceOpsPerSec = 100;
+
+// How many times the load of the least loaded shard in a zone the load of the most loaded shard
+// needs to be in order for a load balancing migration to be initiated.
+const double kLoadImbalanceRatio = 2;
+
 }  // namespace
 
 DistributionStatus::DistributionStatus(NamespaceString nss, ShardToChunksMap shardToChunksMap)
     : _nss(std::move(nss)),
       _shardChunks(std::move(shardToChunksMap)),
-      _zoneRanges(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ZoneRange>()) {}
+      _zoneRanges(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ZoneRange>()),
+      _chunkLoads(SimpleBSONObjComparator::kInstance
+                      .makeBSONObjIndexedMap<ClusterStatistics::ChunkLoad>()),
+      _migratingChunks(SimpleBSONObjComparator::kInstance.makeBSONObjSet()) {}
 
 size_t DistributionStatus::totalChunks() const {
     size_t total = 0;
@@ -175,6 +189,62 @@ string DistributionStatus::getTagForChunk(const ChunkType& chunk) const {
     return "";
 }
 
+void DistributionStatus::addChunkLoad(const ClusterStatistics::ChunkLoad& chunkLoad) {
+    auto it = _chunkLoads.find(chunkLoad.min);
+    if (it == _chunkLoads.end()) {
+        _chunkLoads.emplace(chunkLoad.min, chunkLoad);
+    } else if (it->second.opsPerSec < chunkLoad.opsPerSec) {
+        it->second = chunkLoad;
+    }
+}
+
+double DistributionStatus::getChunkLoad(const ChunkType& chunk) const {
+    auto it = _chunkLoads.find(chunk.getMin());
+    if (it == _chunkLoads.end() ||
+        SimpleBSONObjComparator::kInstance.evaluate(it->second.max != chunk.getMax())) {
+        return 0;
+    }
+
+    return it->second.opsPerSec;
+}
+
+double DistributionStatus::totalLoadInShardWithTag(const ShardId& shardId,
+                                                   const string& tag) const {
+    double total = 0;
+
+    for (const auto& chunk : getChunks(shardId)) {
+        if (tag == getTagForChunk(chunk)) {
+            total += getChunkLoad(chunk);
+        }
+    }
+
+    return total;
+}
+
+void DistributionStatus::applyMigration(const MigrateInfo& migrateInfo) {
+    auto fromIt = _shardChunks.find(migrateInfo.from);
+    auto toIt = _shardChunks.find(migrateInfo.to);
+    invariant(fromIt != _shardChunks.end());
+    invariant(toIt != _shardChunks.end());
+
+    auto& fromChunks = fromIt->second;
+    auto chunkIt = std::find_if(fromChunks.begin(), fromChunks.end(), [&](const ChunkType& chunk) {
+        return SimpleBSONObjComparator::kInstance.evaluate(chunk.getMin() == migrateInfo.minKey);
+    });
+    invariant(chunkIt != fromChunks.end());
+
+    invariant(_migratingChunks.insert(chunkIt->getMin()).second);
+
+    ChunkType chunk = std::move(*chunkIt);
+    fromChunks.erase(chunkIt);
+    chunk.setShard(migrateInfo.to);
+    toIt->second.push_back(std::move(chunk));
+}
+
+bool DistributionStatus::isMigrating(const ChunkType& chunk) const {
+    return _migratingChunks.count(chunk.getMin()) > 0;
+}
+
 void DistributionStatus::report(BSONObjBuilder* builder) const {
     builder->append("ns", _nss.ns());
 
@@ -219,6 +289,27 @@ string DistributionStatus::toString() const {
     return builder.obj().toString();
 }
 
+ShardMigrationBudget::ShardMigrationBudget(int maxMigrationsPerShardPerRound)
+    : _maxMigrationsPerShardPerRound(maxMigrationsPerShardPerRound) {
+    invariant(_maxMigrationsPerShardPerRound > 0);
+}
+
+bool ShardMigrationBudget::hasCapacity(const ShardId& shardId) const {
+    auto it = _numMigrations.find(shardId);
+    return it == _numMigrations.end() || it->second < _maxMigrationsPerShardPerRound;
+}
+
+void ShardMigrationBudget::add(const MigrateInfo& migrateInfo) {
+    invariant(hasCapacity(migrateInfo.from));
+    invariant(hasCapacity(migrateInfo.to));
+    ++_numMigrations[migrateInfo.from];
+    ++_numMigrations[migrateInfo.to];
+}
+
+void ShardMigrationBudget::exhaust(const ShardId& shardId) {
+    _numMigrations[shardId] = _maxMigrationsPerShardPerRound;
+}
+
 Status BalancerPolicy::isShardSuitableReceiver(const ClusterStatistics::ShardStatistics& stat,
                                                const string& chunkTag) {
     if (stat.isSizeMaxed()) {
@@ -242,12 +333,12 @@ Status BalancerPolicy::isShardSuitableReceiver(const ClusterStatistics::ShardSta
 ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector& shardStats,
                                                      const DistributionStatus& distribution,
                                                      const string& tag,
-                                                     const set<ShardId>& excludedShards) {
+                                                     const ShardMigrationBudget& budget) {
     ShardId best;
     unsigned minChunks = numeric_limits<unsigned>::max();
 
     for (const auto& stat : shardStats) {
-        if (excludedShards.count(stat.shardId))
+        if (!budget.hasCapacity(stat.shardId))
             continue;
 
         auto status = isShardSuitableReceiver(stat, tag);
@@ -270,12 +361,12 @@ ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector
 ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& shardStats,
                                                 const DistributionStatus& distribution,
                                                 const string& chunkTag,
-                                                const set<ShardId>& excludedShards) {
+                                                const ShardMigrationBudget& budget) {
     ShardId worst;
     unsigned maxChunks = 0;
 
     for (const auto& stat : shardStats) {
-        if (excludedShards.count(stat.shardId))
+        if (!budget.hasCapacity(stat.shardId))
             continue;
 
         const unsigned shardChunkCount =
@@ -291,9 +382,9 @@ ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& sha
 }
 
 vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardStats,
-                                            const DistributionStatus& distribution,
+                                            DistributionStatus* distribution,
                                             bool shouldAggressivelyBalance,
-                                            std::set<ShardId>* usedShards) {
+                                            ShardMigrationBudget* budget) {
     vector<MigrateInfo> migrations;
 
     // 1) Check for shards, which are in draining mode
@@ -302,104 +393,120 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
             if (!stat.isDraining)
                 continue;
 
-            if (usedShards->count(stat.shardId))
-                continue;
+            // Keep moving chunks off the draining shard for as long as it is allowed more
+            // migrations
+            while (budget->hasCapacity(stat.shardId)) {
+                const vector<ChunkType>& chunks = distribution->getChunks(stat.shardId);
 
-            const vector<ChunkType>& chunks = distribution.getChunks(stat.shardId);
+                if (chunks.empty())
+                    break;
 
-            if (chunks.empty())
-                continue;
+                // Now we know we need to move to chunks off this shard, but only if permitted by
+                // the tags policy
+                unsigned numJumboChunks = 0;
+                boost::optional<MigrateInfo> migration;
 
-            // Now we know we need to move to chunks off this shard, but only if permitted by the
-            // tags policy
-            unsigned numJumboChunks = 0;
+                // Since we have to move all chunks, lets just do in order
+                for (const auto& chunk : chunks) {
+                    if (distribution->isMigrating(chunk))
+                        continue;
 
-            // Since we have to move all chunks, lets just do in order
-            for (const auto& chunk : chunks) {
-                if (chunk.getJumbo()) {
-                    numJumboChunks++;
-                    continue;
-                }
+                    if (chunk.getJumbo()) {
+                        numJumboChunks++;
+                        continue;
+                    }
 
-                const string tag = distribution.getTagForChunk(chunk);
+                    const string tag = distribution->getTagForChunk(chunk);
+
+                    const ShardId to =
+                        _getLeastLoadedReceiverShard(shardStats, *distribution, tag, *budget);
+                    if (!to.isValid()) {
+                        if (migrations.empty()) {
+                            warning() << "Chunk " << redact(chunk.toString())
+                                      << " is on a draining shard, but no appropriate recipient "
+                                         "found";
+                        }
+                        continue;
+                    }
+
+                    invariant(to != stat.shardId);
+                    migration.emplace(to, chunk);
+                    break;
+                }
 
-                const ShardId to =
-                    _getLeastLoadedReceiverShard(shardStats, distribution, tag, *usedShards);
-                if (!to.isValid()) {
+                if (!migration) {
                     if (migrations.empty()) {
-                        warning() << "Chunk " << redact(chunk.toString())
-                                  << " is on a draining shard, but no appropriate recipient found";
+                        warning() << "Unable to find any chunk to move from draining shard "
+                                  << stat.shardId << ". numJumboChunks: " << numJumboChunks;
                     }
-                    continue;
+                    break;
                 }
 
-                invariant(to != stat.shardId);
-                migrations.emplace_back(to, chunk);
-                invariant(usedShards->insert(stat.shardId).second);
-                invariant(usedShards->insert(to).second);
-                break;
-            }
-
-            if (migrations.empty()) {
-                warning() << "Unable to find any chunk to move from draining shard " << stat.shardId
-                          << ". numJumboChunks: " << numJumboChunks;
+                _addMigration(std::move(*migration), distribution, &migrations, budget);
             }
         }
     }
 
     // 2) Check for chunks, which are on the wrong shard and must be moved off of it
-    if (!distribution.tags().empty()) {
+    if (!distribution->tags().empty()) {
         for (const auto& stat : shardStats) {
-            if (usedShards->count(stat.shardId))
-                continue;
+            while (budget->hasCapacity(stat.shardId)) {
+                const vector<ChunkType>& chunks = distribution->getChunks(stat.shardId);
+                boost::optional<MigrateInfo> migration;
 
-            const vector<ChunkType>& chunks = distribution.getChunks(stat.shardId);
+                for (const auto& chunk : chunks) {
+                    if (distribution->isMigrating(chunk))
+                        continue;
 
-            for (const auto& chunk : chunks) {
-                const string tag = distribution.getTagForChunk(chunk);
+                    const string tag = distribution->getTagForChunk(chunk);
 
-                if (tag.empty())
-                    continue;
+                    if (tag.empty())
+                        continue;
 
-                if (stat.shardTags.count(tag))
-                    continue;
+                    if (stat.shardTags.count(tag))
+                        continue;
 
-                if (chunk.getJumbo()) {
-                    warning() << "Chunk " << redact(chunk.toString()) << " violates zone "
-                              << redact(tag) << ", but it is jumbo and cannot be moved";
-                    continue;
-                }
-
-                const ShardId to =
-                    _getLeastLoadedReceiverShard(shardStats, distribution, tag, *usedShards);
-                if (!to.isValid()) {
-                    if (migrations.empty()) {
+                    if (chunk.getJumbo()) {
                         warning() << "Chunk " << redact(chunk.toString()) << " violates zone "
-                                  << redact(tag) << ", but no appropriate recipient found";
+                                  << redact(tag) << ", but it is jumbo and cannot be moved";
+                        continue;
                     }
-                    continue;
+
+                    const ShardId to =
+                        _getLeastLoadedReceiverShard(shardStats, *distribution, tag, *budget);
+                    if (!to.isValid()) {
+                        if (migrations.empty()) {
+                            warning() << "Chunk " << redact(chunk.toString()) << " violates zone "
+                                      << redact(tag) << ", but no appropriate recipient found";
+                        }
+                        continue;
+                    }
+
+                    invariant(to != stat.shardId);
+                    migration.emplace(to, chunk);
+                    break;
                 }
 
-                invariant(to != stat.shardId);
-                migrations.emplace_back(to, chunk);
-                invariant(usedShards->insert(stat.shardId).second);
-                invariant(usedShards->insert(to).second);
-                break;
+                if (!migration)
+                    break;
+
+                _addMigration(std::move(*migration), distribution, &migrations, budget);
             }
         }
     }
 
     // 3) for each tag balance
-    const size_t imbalanceThreshold = (shouldAggressivelyBalance || distribution.totalChunks() < 20)
+    const size_t imbalanceThreshold =
+        (shouldAggressivelyBalance || distribution->totalChunks() < 20)
         ? kAggressiveImbalanceThreshold
         : kDefaultImbalanceThreshold;
 
-    vector<string> tagsPlusEmpty(distribution.tags().begin(), distribution.tags().end());
+    vector<string> tagsPlusEmpty(distribution->tags().begin(), distribution->tags().end());
     tagsPlusEmpty.push_back("");
 
     for (const auto& tag : tagsPlusEmpty) {
         const size_t totalNumberOfChunksWithTag =
-            (tag.empty() ? distribution.totalChunks() : distribution.totalChunksWithTag(tag));
+            (tag.empty() ? distribution->totalChunks() : distribution->totalChunksWithTag(tag));
 
         size_t totalNumberOfShardsWithTag = 0;
 
@@ -413,7 +520,7 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
         // should not be possible so warn the operator to correct it.
         if (totalNumberOfShardsWithTag == 0) {
             if (!tag.empty()) {
-                warning() << "Zone " << redact(tag) << " in collection " << distribution.nss()
+                warning() << "Zone " << redact(tag) << " in collection " << distribution->nss()
                           << " has no assigned shards and chunks which fall into it cannot be "
                              "balanced. This should be corrected by either assigning shards to the "
                              "zone or by deleting it.";
@@ -426,14 +533,21 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
             (totalNumberOfChunksWithTag / totalNumberOfShardsWithTag) +
             (totalNumberOfChunksWithTag % totalNumberOfShardsWithTag ? 1 : 0);
 
+        const size_t numMigrationsBeforeZone = migrations.size();
+
         while (_singleZoneBalance(shardStats,
                                   distribution,
                                   tag,
                                   idealNumberOfChunksPerShardForTag,
                                   imbalanceThreshold,
                                   &migrations,
-                                  usedShards))
+                                  budget))
             ;
+
+        // 4) Once the chunk counts in the zone are even, even out the load on its shards
+        if (migrations.size() == numMigrationsBeforeZone && distribution->hasChunkLoads()) {
+            _singleZoneLoadBalance(shardStats, distribution, tag, &migrations, budget);
+        }
     }
 
     return migrations;
@@ -446,7 +560,7 @@ boost::optional<MigrateInfo> BalancerPolicy::balanceSingleChunk(
     const string tag = distribution.getTagForChunk(chunk);
 
     ShardId newShardId =
-        _getLeastLoadedReceiverShard(shardStats, distribution, tag, set<ShardId>());
+        _getLeastLoadedReceiverShard(shardStats, distribution, tag, ShardMigrationBudget());
     if (!newShardId.isValid() || newShardId == chunk.getShard()) {
         return boost::optional<MigrateInfo>();
     }
@@ -455,23 +569,23 @@ boost::optional<MigrateInfo> BalancerPolicy::balanceSingleChunk(
 }
 
 bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
-                                        const DistributionStatus& distribution,
+                                        DistributionStatus* distribution,
                                         const string& tag,
                                         size_t idealNumberOfChunksPerShardForTag,
                                         size_t imbalanceThreshold,
                                         vector<MigrateInfo>* migrations,
-                                        set<ShardId>* usedShards) {
-    const ShardId from = _getMostOverloadedShard(shardStats, distribution, tag, *usedShards);
+                                        ShardMigrationBudget* budget) {
+    const ShardId from = _getMostOverloadedShard(shardStats, *distribution, tag, *budget);
     if (!from.isValid())
         return false;
 
-    const size_t max = distribution.numberOfChunksInShardWithTag(from, tag);
+    const size_t max = distribution->numberOfChunksInShardWithTag(from, tag);
 
     // Do not use a shard if it already has less entries than the optimal per-shard chunk count
     if (max <= idealNumberOfChunksPerShardForTag)
         return false;
 
-    const ShardId to = _getLeastLoadedReceiverShard(shardStats, distribution, tag, *usedShards);
+    const ShardId to = _getLeastLoadedReceiverShard(shardStats, *distribution, tag, *budget);
     if (!to.isValid()) {
         if (migrations->empty()) {
             log() << "No available shards to take chunks for zone [" << tag << "]";
@@ -479,7 +593,7 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
         return false;
     }
 
-    const size_t min = distribution.numberOfChunksInShardWithTag(to, tag);
+    const size_t min = distribution->numberOfChunksInShardWithTag(to, tag);
 
     // Do not use a shard if it already has more entries than the optimal per-shard chunk count
     if (min >= idealNumberOfChunksPerShardForTag)
@@ -487,7 +601,7 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
 
     const size_t imbalance = max - idealNumberOfChunksPerShardForTag;
 
-    LOG(1) << "collection : " << distribution.nss().ns();
+    LOG(1) << "collection : " << distribution->nss().ns();
     LOG(1) << "zone       : " << tag;
     LOG(1) << "donor      : " << from << " chunks on " << max;
     LOG(1) << "receiver   : " << to << " chunks on " << min;
@@ -498,12 +612,20 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
     if (imbalance < imbalanceThreshold)
         return false;
 
-    const vector<ChunkType>& chunks = distribution.getChunks(from);
+    const vector<ChunkType>& chunks = distribution->getChunks(from);
 
     unsigned numJumboChunks = 0;
 
+    // Prefer moving the coldest chunk, so that evening out the chunk counts does not undo the work
+    // of load balancing
+    const ChunkType* chunkToMove = nullptr;
+    double chunkToMoveLoad = 0;
+
     for (const auto& chunk : chunks) {
-        if (distribution.getTagForChunk(chunk) != tag)
+        if (distribution->isMigrating(chunk))
+            continue;
+
+        if (distribution->getTagForChunk(chunk) != tag)
             continue;
 
         if (chunk.getJumbo()) {
@@ -511,14 +633,20 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
             continue;
         }
 
-        migrations->emplace_back(to, chunk);
-        invariant(usedShards->insert(chunk.getShard()).second);
-        invariant(usedShards->insert(to).second);
+        const double load = distribution->getChunkLoad(chunk);
+        if (!chunkToMove || load < chunkToMoveLoad) {
+            chunkToMove = &chunk;
+            chunkToMoveLoad = load;
+        }
+    }
+
+    if (chunkToMove) {
+        _addMigration(MigrateInfo(to, *chunkToMove), distribution, migrations, budget);
         return true;
     }
 
     if (numJumboChunks) {
-        warning() << "Shard: " << from << ", collection: " << distribution.nss().ns()
+        warning() << "Shard: " << from << ", collection: " << distribution->nss().ns()
                   << " has only jumbo chunks for zone \'" << tag
                   << "\' and cannot be balanced. Jumbo chunks count: " << numJumboChunks;
     }
@@ -526,6 +654,97 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
     return false;
 }
 
+bool BalancerPolicy::_singleZoneLoadBalance(const ShardStatisticsVector& shardStats,
+                                            DistributionStatus* distribution,
+                                            const string& tag,
+                                            vector<MigrateInfo>* migrations,
+                                            ShardMigrationBudget* budget) {
+    ShardId from;
+    double maxLoad = 0;
+
+    ShardId to;
+    double minLoad = numeric_limits<double>::max();
+
+    for (const auto& stat : shardStats) {
+        if (!tag.empty() && !stat.shardTags.count(tag))
+            continue;
+
+        if (!budget->hasCapacity(stat.shardId))
+            continue;
+
+        const double load = distribution->totalLoadInShardWithTag(stat.shardId, tag);
+
+        if (load > maxLoad) {
+            from = stat.shardId;
+            maxLoad = load;
+        }
+
+        if (load < minLoad && isShardSuitableReceiver(stat, tag).isOK()) {
+            to = stat.shardId;
+            minLoad = load;
+        }
+    }
+
+    if (!from.isValid() || !to.isValid() || from == to)
+        return false;
+
+    if (maxLoad < kMinLoadToBalanceOpsPerSec || maxLoad < kLoadImbalanceRatio * minLoad)
+        return false;
+
+    // Moving a chunk with load L changes the loads to (maxLoad - L) and (minLoad + L), so the best
+    // chunk to move is the one closest to half the difference. Chunks with load of at least the
+    // difference would make the receiver at least as hot as the donor was.
+    const double loadDifference = maxLoad - minLoad;
+
+    const ChunkType* chunkToMove = nullptr;
+    double bestDistance = numeric_limits<double>::max();
+
+    for (const auto& chunk : distribution->getChunks(from)) {
+        if (distribution->isMigrating(chunk))
+            continue;
+
+        if (distribution->getTagForChunk(chunk) != tag)
+            continue;
+
+        if (chunk.getJumbo())
+            continue;
+
+        const double load = distribution->getChunkLoad(chunk);
+        if (load <= 0 || load >= loadDifference)
+            continue;
+
+        const double distance = std::abs(loadDifference / 2 - load);
+        if (distance < bestDistance) {
+            chunkToMove = &chunk;
+            bestDistance = distance;
+        }
+    }
+
+    LOG(1) << "collection : " << distribution->nss().ns();
+    LOG(1) << "zone       : " << tag;
+    LOG(1) << "donor      : " << from << " load " << maxLoad << " ops/sec";
+    LOG(1) << "receiver   : " << to << " load " << minLoad << " ops/sec";
+
+    if (!chunkToMove) {
+        LOG(1) << "Shard: " << from << ", collection: " << distribution->nss().ns()
+               << " has no chunk for zone \'" << tag
+               << "\', which can be moved to even out the load, hot chunks must be split first";
+        return false;
+    }
+
+    _addMigration(MigrateInfo(to, *chunkToMove), distribution, migrations, budget);
+    return true;
+}
+
+void BalancerPolicy::_addMigration(MigrateInfo migrateInfo,
+                                  DistributionStatus* distribution,
+                                  vector<MigrateInfo>* migrations,
+                                  ShardMigrationBudget* budget) {
+    budget->add(migrateInfo);
+    distribution->applyMigration(migrateInfo);
+    migrations->push_back(std::move(migrateInfo));
+}
+
 ZoneRange::ZoneRange(const BSONObj& a_min, const BSONObj& a_max, const std::string& _zone)
     : min(a_min.getOwned()), max(a_max.getOwned()), zone(_zone) {}
 
@@ -142,6 +142,43 @@ public:
      */
     std::string getTagForChunk(const ChunkType& chunk) const;
 
+    /**
+     * Records the load a shard has sampled on one of the collection's chunks. If the load of the
+     * same chunk is reported more than once, the highest one is kept.
+     */
+    void addChunkLoad(const ClusterStatistics::ChunkLoad& chunkLoad);
+
+    /**
+     * Returns whether any shard reported load on the collection's chunks.
+     */
+    bool hasChunkLoads() const {
+        return !_chunkLoads.empty();
+    }
+
+    /**
+     * Returns the rate of operations against the specified chunk. Chunks, for which no load was
+     * reported are considered idle.
+     */
+    double getChunkLoad(const ChunkType& chunk) const;
+
+    /**
+     * Returns the rate of operations against the chunks in the specified shard, which have the
+     * given tag.
+     */
+    double totalLoadInShardWithTag(const ShardId& shardId, const std::string& tag) const;
+
+    /**
+     * Moves the chunk described by 'migrateInfo' from its donor to its recipient, so that later
+     * balancing decisions see the distribution as it will be once the migration commits.
+     */
+    void applyMigration(const MigrateInfo& migrateInfo);
+
+    /**
+     * Returns whether a migration was already applied to the specified chunk. Such a chunk must not
+     * be selected again, because a chunk can only take part in one migration per balancing round.
+     */
+    bool isMigrating(const ChunkType& chunk) const;
+
     /**
      * Returns a BSON/string representation of this distribution status.
      */
@@ -160,6 +197,43 @@ private:
 
     // Set of all zones defined for this collection
     std::set<std::string> _allTags;
+
+    // Map of chunk min key to the load sampled on that chunk
+    BSONObjIndexedMap<ClusterStatistics::ChunkLoad> _chunkLoads;
+
+    // Min keys of the chunks, which applyMigration() has moved
+    BSONObjSet _migratingChunks;
+};
+
+/**
+ * Keeps track of how many of the migrations selected during a balancing round each shard takes
+ * part in, either as donor or as recipient, so that no shard is handed more than a fixed number.
+ */
+class ShardMigrationBudget {
+public:
+    explicit ShardMigrationBudget(int maxMigrationsPerShardPerRound = 1);
+
+    /**
+     * Returns whether the specified shard can take part in another migration.
+     */
+    bool hasCapacity(const ShardId& shardId) const;
+
+    /**
+     * Accounts for a migration between the donor and recipient of 'migrateInfo', both of which
+     * must have capacity left.
+     */
+    void add(const MigrateInfo& migrateInfo);
+
+    /**
+     * Prevents the specified shard from being used for any more migrations.
+     */
+    void exhaust(const ShardId& shardId);
+
+private:
+    int _maxMigrationsPerShardPerRound;
+
+    // Number of migrations each shard has been handed so far
+    std::map<ShardId, int> _numMigrations;
 };
 
 class BalancerPolicy {
@@ -186,14 +260,21 @@ public:
      * The shouldAggressivelyBalance parameter causes the threshold for chunk could disparity
      * between shards to be lowered.
      *
-     * The usedShards parameter is in/out and it contains the set of shards, which have already been
-     * used for migrations. Used so we don't return multiple conflicting migrations for the same
-     * shard.
+     * Once the chunks of a zone are evenly spread, if the shards reported the load they observe on
+     * the collection's chunks and one of them receives a disproportionate share of it, suggests
+     * moving one of its hot chunks to the least loaded shard of the zone.
+     *
+     * The budget parameter is in/out and it tracks the migrations each shard has already been
+     * handed. Used so we don't return more migrations for the same shard than it is allowed. When
+     * a shard may take part in several migrations, they are meant to be run one after the other.
+     *
+     * Each suggested migration is applied to 'distribution', so that the ones selected after it
+     * take it into account.
      */
     static std::vector<MigrateInfo> balance(const ShardStatisticsVector& shardStats,
-                                            const DistributionStatus& distribution,
+                                            DistributionStatus* distribution,
                                             bool shouldAggressivelyBalance,
-                                            std::set<ShardId>* usedShards);
+                                            ShardMigrationBudget* budget);
 
     /**
      * Using the specified distribution information, returns a suggested better location for the
@@ -211,7 +292,7 @@ private:
     static ShardId _getLeastLoadedReceiverShard(const ShardStatisticsVector& shardStats,
                                                 const DistributionStatus& distribution,
                                                 const std::string& tag,
-                                                const std::set<ShardId>& excludedShards);
+                                                const ShardMigrationBudget& budget);
 
     /**
      * Return the shard which has the least number of chunks with the specified tag. If the tag is
@@ -220,7 +301,16 @@ private:
     static ShardId _getMostOverloadedShard(const ShardStatisticsVector& shardStats,
                                            const DistributionStatus& distribution,
                                            const std::string& chunkTag,
-                                           const std::set<ShardId>& excludedShards);
+                                           const ShardMigrationBudget& budget);
+
+    /**
+     * Appends 'migrateInfo' to the suggested migrations and accounts for it in the budget and the
+     * distribution.
+     */
+    static void _addMigration(MigrateInfo migrateInfo,
+                              DistributionStatus* distribution,
+                              std::vector<MigrateInfo>* migrations,
+                              ShardMigrationBudget* budget);
 
     /**
      * Selects one chunk for the specified zone (if appropriate) to be moved in order to bring the
@@ -235,12 +325,27 @@ private:
      * called multiple times until all posible migrations for a zone have been selected.
      */
     static bool _singleZoneBalance(const ShardStatisticsVector& shardStats,
-                                   const DistributionStatus& distribution,
+                                   DistributionStatus* distribution,
                                    const std::string& tag,
                                    size_t idealNumberOfChunksPerShardForTag,
                                    size_t imbalanceThreshold,
                                    std::vector<MigrateInfo>* migrations,
-                                   std::set<ShardId>* usedShards);
+                                   ShardMigrationBudget* budget);
+
+    /**
+     * Selects one chunk for the specified zone (if appropriate) to be moved from the shard with the
+     * highest load on the collection to the one with the lowest, picking the chunk which brings
+     * the load of the two shards closest to each other. Chunks, which are so hot that moving them
+     * would only move the hot spot to the other shard are left alone, since they need to be split
+     * first.
+     *
+     * Returns true if a migration was suggested, false otherwise.
+     */
+    static bool _singleZoneLoadBalance(const ShardStatisticsVector& shardStats,
+                                       DistributionStatus* distribution,
+                                       const std::string& tag,
+                                       std::vector<MigrateInfo>* migrations,
+                                       ShardMigrationBudget* budget);
 };
 
 }  // namespace mongo
@@ -113,11 +113,27 @@ std::pair<ShardStatisticsVector, ShardToChunksMap> generateCluster(
 }
 
 std::vector<MigrateInfo> balanceChunks(const ShardStatisticsVector& shardStats,
-                                       const DistributionStatus& distribution,
-                                       bool shouldAggressivelyBalance) {
-    std::set<ShardId> usedShards;
-    return BalancerPolicy::balance(
-        shardStats, distribution, shouldAggressivelyBalance, &usedShards);
+                                       DistributionStatus& distribution,
+                                       bool shouldAggressivelyBalance,
+                                       int maxMigrationsPerShardPerRound = 1) {
+    ShardMigrationBudget budget(maxMigrationsPerShardPerRound);
+    return BalancerPolicy::balance(shardStats, &distribution, shouldAggressivelyBalance, &budget);
+}
+
+std::vector<MigrateInfo> balanceChunks(const ShardStatisticsVector& shardStats,
+                                       DistributionStatus&& distribution,
+                                       bool shouldAggressivelyBalance,
+                                       int maxMigrationsPerShardPerRound = 1) {
+    return balanceChunks(
+        shardStats, distribution, shouldAggressivelyBalance, maxMigrationsPerShardPerRound);
+}
+
+ClusterStatistics::ChunkLoad makeChunkLoad(const ChunkType& chunk, double opsPerSec) {
+    ClusterStatistics::ChunkLoad chunkLoad;
+    chunkLoad.min = chunk.getMin();
+    chunkLoad.max = chunk.getMax();
+    chunkLoad.opsPerSec = opsPerSec;
+    return chunkLoad;
 }
 
 TEST(BalancerPolicy, Basic) {
@@ -237,6 +253,30 @@ TEST(BalancerPolicy, ParallelBalancingDoesNotMoveChunksFromShardsBelowOptimal) {
     ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMax(), migrations[0].maxKey);
 }
 
+TEST(BalancerPolicy, SeveralMigrationsPerShardAccountForEachOther) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    const auto migrations(balanceChunks(cluster.first, distribution, false, 3));
+    ASSERT_EQ(3U, migrations.size());
+
+    // Each migration sees the ones selected before it, so the recipients alternate and no chunk
+    // is selected twice
+    const ShardId expectedRecipients[] = {kShardId1, kShardId2, kShardId1};
+    for (size_t i = 0; i < migrations.size(); ++i) {
+        ASSERT_EQ(kShardId0, migrations[i].from);
+        ASSERT_EQ(expectedRecipients[i], migrations[i].to);
+        ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][i].getMin(), migrations[i].minKey);
+    }
+
+    ASSERT_EQ(5U, distribution.numberOfChunksInShard(kShardId0));
+    ASSERT_EQ(2U, distribution.numberOfChunksInShard(kShardId1));
+    ASSERT_EQ(1U, distribution.numberOfChunksInShard(kShardId2));
+}
+
 TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseSourceShardsWithMoveNecessary) {
     auto cluster = generateCluster(
         {{ShardStatistics(kShardId0, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
@@ -245,9 +285,11 @@ TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseSourceShardsWithMoveNe
          {ShardStatistics(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
 
     // Here kShardId0 would have been selected as a donor
-    std::set<ShardId> usedShards{kShardId0};
+    DistributionStatus distribution(kNamespace, cluster.second);
+    ShardMigrationBudget budget;
+    budget.exhaust(kShardId0);
     const auto migrations(BalancerPolicy::balance(
-        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+        cluster.first, &distribution, false, &budget));
     ASSERT_EQ(1U, migrations.size());
 
     ASSERT_EQ(kShardId1, migrations[0].from);
@@ -264,9 +306,11 @@ TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseSourceShardsWithMoveNo
          {ShardStatistics(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
 
     // Here kShardId0 would have been selected as a donor
-    std::set<ShardId> usedShards{kShardId0};
+    DistributionStatus distribution(kNamespace, cluster.second);
+    ShardMigrationBudget budget;
+    budget.exhaust(kShardId0);
     const auto migrations(BalancerPolicy::balance(
-        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+        cluster.first, &distribution, false, &budget));
     ASSERT_EQ(0U, migrations.size());
 }
 
@@ -278,9 +322,11 @@ TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseDestinationShards) {
          {ShardStatistics(kShardId3, kNoMaxSize, 1, false, emptyTagSet, emptyShardVersion), 1}});
 
     // Here kShardId2 would have been selected as a recipient
-    std::set<ShardId> usedShards{kShardId2};
+    DistributionStatus distribution(kNamespace, cluster.second);
+    ShardMigrationBudget budget;
+    budget.exhaust(kShardId2);
     const auto migrations(BalancerPolicy::balance(
-        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+        cluster.first, &distribution, false, &budget));
     ASSERT_EQ(1U, migrations.size());
 
     ASSERT_EQ(kShardId0, migrations[0].from);
@@ -393,6 +439,27 @@ TEST(BalancerPolicy, DrainingWithTwoChunksFirstOneSelected) {
     ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMax(), migrations[0].maxKey);
 }
 
+TEST(BalancerPolicy, DrainingShardHandsOutSeveralChunksWithinBudget) {
+    // shard0 is draining and may take part in two migrations, so its first two chunks go to the
+    // least loaded shard at the time each of them is selected
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 2, true, emptyTagSet, emptyShardVersion), 3},
+         {ShardStatistics(kShardId1, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 5},
+         {ShardStatistics(kShardId2, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 5}});
+
+    const auto migrations(balanceChunks(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false, 2));
+    ASSERT_EQ(2U, migrations.size());
+
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMin(), migrations[0].minKey);
+
+    ASSERT_EQ(kShardId0, migrations[1].from);
+    ASSERT_EQ(kShardId2, migrations[1].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), migrations[1].minKey);
+}
+
 TEST(BalancerPolicy, DrainingMultipleShardsFirstOneSelected) {
     // shard0 and shard1 are both draining with very little chunks in them and chunks will go to
     // shard2, even though it has a lot more chunks that the other two
@@ -536,6 +603,37 @@ TEST(BalancerPolicy, BalancerRespectsTagPolicyBeforeImbalance) {
     ASSERT_BSONOBJ_EQ(cluster.second[kShardId2][0].getMax(), migrations[0].maxKey);
 }
 
+TEST(BalancerPolicy, ChunkIsNotSelectedTwiceInTheSameRound) {
+    // The chunk on shard0 violates zone "a" and moves to shard1, the shard in the zone with the
+    // fewest chunks. That leaves shard1 with both chunks of the zone, and the one it received is
+    // the coldest, so it would otherwise be selected again to move on to shard2.
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 1},
+         {ShardStatistics(kShardId2, kNoMaxSize, 5, false, {"a"}, emptyShardVersion), 2},
+         {ShardStatistics(kShardId1, kNoMaxSize, 5, false, {"a"}, emptyShardVersion), 1}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    ASSERT_OK(distribution.addRangeToZone(ZoneRange(kMinBSONKey, BSON("x" << 1), "a")));
+    ASSERT_OK(distribution.addRangeToZone(ZoneRange(BSON("x" << 3), kMaxBSONKey, "a")));
+    distribution.addChunkLoad(makeChunkLoad(cluster.second[kShardId1][0], 100));
+
+    const auto migrations(balanceChunks(cluster.first, distribution, false, 2));
+
+    std::set<std::string> names;
+    for (const auto& migration : migrations) {
+        ASSERT(names.insert(migration.getName()).second);
+    }
+
+    ASSERT_GTE(migrations.size(), 2U);
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMin(), migrations[0].minKey);
+
+    ASSERT_EQ(kShardId1, migrations[1].from);
+    ASSERT_EQ(kShardId2, migrations[1].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId1][0].getMin(), migrations[1].minKey);
+}
+
 TEST(BalancerPolicy, BalancerFixesIncorrectTagsWithCrossShardViolationOfTags) {
     // The zone policy dictates that the same shard must donate and also receive chunks. The test
     // validates that the same shard is not used as a donor and recipient as part of the same round.
@@ -611,6 +709,70 @@ TEST(BalancerPolicy, BalancerHandlesNoShardsWithTag) {
     ASSERT(balanceChunks(cluster.first, distribution, false).empty());
 }
 
+TEST(BalancerPolicy, LoadBalancingMovesHotChunkToLeastLoadedShard) {
+    // Chunk counts are even, but all the load is on shard0
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 3},
+         {ShardStatistics(kShardId1, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 3},
+         {ShardStatistics(kShardId2, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 3}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    distribution.addChunkLoad(makeChunkLoad(cluster.second[kShardId0][0], 200));
+    distribution.addChunkLoad(makeChunkLoad(cluster.second[kShardId0][1], 300));
+    distribution.addChunkLoad(makeChunkLoad(cluster.second[kShardId0][2], 100));
+    distribution.addChunkLoad(makeChunkLoad(cluster.second[kShardId2][0], 50));
+
+    // The chunk with load closest to half of the difference between shard0 and shard1 is chosen
+    const auto migrations(balanceChunks(cluster.first, distribution, false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), migrations[0].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMax(), migrations[0].maxKey);
+}
+
+TEST(BalancerPolicy, LoadBalancingLeavesChunkTooHotToMove) {
+    // Moving the only hot chunk would just make the other shard the hot one
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 2},
+         {ShardStatistics(kShardId1, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 2}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    distribution.addChunkLoad(makeChunkLoad(cluster.second[kShardId0][0], 1000));
+
+    ASSERT(balanceChunks(cluster.first, distribution, false).empty());
+}
+
+TEST(BalancerPolicy, LoadBalancingIgnoresLightLoad) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 2},
+         {ShardStatistics(kShardId1, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 2}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    distribution.addChunkLoad(makeChunkLoad(cluster.second[kShardId0][0], 20));
+    distribution.addChunkLoad(makeChunkLoad(cluster.second[kShardId0][1], 20));
+
+    ASSERT(balanceChunks(cluster.first, distribution, false).empty());
+}
+
+TEST(BalancerPolicy, ChunkCountBalancingMovesColdestChunk) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    distribution.addChunkLoad(makeChunkLoad(cluster.second[kShardId0][0], 500));
+    distribution.addChunkLoad(makeChunkLoad(cluster.second[kShardId0][1], 20));
+    distribution.addChunkLoad(makeChunkLoad(cluster.second[kShardId0][3], 500));
+
+    const auto migrations(balanceChunks(cluster.first, distribution, false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][2].getMin(), migrations[0].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][2].getMax(), migrations[0].maxKey);
+}
+
 TEST(DistributionStatus, AddTagRangeOverlap) {
     DistributionStatus d(kNamespace, ShardToChunksMap{});
 
@@ -30,17 +30,18 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/s/client/shard.h"
 
 namespace mongo {
 
-class BSONObj;
 class OperationContext;
 template <typename T>
 class StatusWith;
@@ -54,6 +55,20 @@ class ClusterStatistics {
     MONGO_DISALLOW_COPYING(ClusterStatistics);
 
 public:
+    /**
+     * Structure, which describes the load sampled by a shard on one of the chunks it owns.
+     */
+    struct ChunkLoad {
+        BSONObj min;
+        BSONObj max;
+
+        // Rate of reads and writes against the chunk
+        double opsPerSec{0};
+
+        // Rate at which data is written to the chunk
+        double bytesWrittenPerSec{0};
+    };
+
     /**
      * Structure, which describes the statistics of a single shard host.
      */
@@ -94,6 +109,10 @@ public:
 
         // Version of mongod, which runs on this shard's primary
         std::string mongoVersion;
+
+        // The hottest chunks of each collection on this shard, keyed by namespace. Only chunks with
+        // recent activity are reported, so any chunk missing from here can be considered idle.
+        std::map<std::string, std::vector<ChunkLoad>> chunkLoads;
     };
 
     virtual ~ClusterStatistics();
@@ -49,17 +49,19 @@
 namespace mongo {
 namespace {
 
+using ChunkLoad = ClusterStatistics::ChunkLoad;
+
 const char kVersionField[] = "version";
+const char kChunkHeatField[] = "chunkHeat";
 
 /**
- * Executes the serverStatus command against the specified shard and obtains the version of the
- * running MongoD service.
+ * Executes the serverStatus command against the specified shard, including the section which
+ * reports the load on the shard's hottest chunks.
  *
- * Returns the MongoD version in strig format or an error. Known error codes are:
+ * Returns the serverStatus response or an error. Known error codes are:
  *  ShardNotFound if shard by that id is not available on the registry
- *  NoSuchKey if the version could not be retrieved
  */
-StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, ShardId shardId) {
+StatusWith<BSONObj> retrieveShardServerStatus(OperationContext* opCtx, ShardId shardId) {
     auto shardRegistry = Grid::get(opCtx)->shardRegistry();
     auto shardStatus = shardRegistry->getShard(opCtx, shardId);
     if (!shardStatus.isOK()) {
@@ -71,7 +73,7 @@ StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, Shar
         shard->runCommandWithFixedRetryAttempts(opCtx,
                                                 ReadPreferenceSetting{ReadPreference::PrimaryOnly},
                                                 "admin",
-                                                BSON("serverStatus" << 1),
+                                                BSON("serverStatus" << 1 << kChunkHeatField << 1),
                                                 Shard::RetryPolicy::kIdempotent);
     if (!commandResponse.isOK()) {
         return commandResponse.getStatus();
@@ -80,15 +82,47 @@ StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, Shar
         return commandResponse.getValue().commandStatus;
     }
 
-    BSONObj serverStatus = std::move(commandResponse.getValue().response);
+    return std::move(commandResponse.getValue().response);
+}
+
+/**
+ * Extracts the load on each chunk from the chunkHeat section of a shard's serverStatus response.
+ * Since the load is only used as a hint for balancing, malformed entries are skipped.
+ */
+std::map<std::string, std::vector<ChunkLoad>> extractChunkLoads(const BSONObj& serverStatus) {
+    std::map<std::string, std::vector<ChunkLoad>> chunkLoads;
+
+    const BSONElement collections = serverStatus[kChunkHeatField]["collections"];
+    if (collections.type() != Object) {
+        return chunkLoads;
+    }
+
+    for (const auto& collection : collections.Obj()) {
+        if (collection.type() != Array)
+            continue;
+
+        auto& collectionChunkLoads = chunkLoads[collection.fieldName()];
+
+        for (const auto& chunkElem : collection.Obj()) {
+            if (chunkElem.type() != Object)
+                continue;
+
+            const BSONObj chunkObj = chunkElem.Obj();
+            if (chunkObj["min"].type() != Object || chunkObj["max"].type() != Object)
+                continue;
 
-    std::string version;
-    Status status = bsonExtractStringField(serverStatus, kVersionField, &version);
-    if (!status.isOK()) {
-        return status;
+            ChunkLoad chunkLoad;
+            chunkLoad.min = chunkObj["min"].Obj().getOwned();
+            chunkLoad.max = chunkObj["max"].Obj().getOwned();
+            chunkLoad.opsPerSec =
+                chunkObj["readsPerSec"].numberDouble() + chunkObj["writesPerSec"].numberDouble();
+            chunkLoad.bytesWrittenPerSec = chunkObj["bytesWrittenPerSec"].numberDouble();
+
+            collectionChunkLoads.push_back(std::move(chunkLoad));
+        }
     }
 
-    return version;
+    return chunkLoads;
 }
 
 }  // namespace
@@ -135,15 +169,26 @@ StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(Operati
         }
 
         std::string mongoDVersion;
+        std::map<std::string, std::vector<ChunkLoad>> chunkLoads;
+
+        // Since the mongod version is only used for reporting and the chunk loads are only a hint,
+        // there is no need to fail the entire round if they cannot be retrieved, so just leave them
+        // empty
+        auto serverStatusStatus = retrieveShardServerStatus(opCtx, shard.getName());
+        if (serverStatusStatus.isOK()) {
+            const BSONObj& serverStatus = serverStatusStatus.getValue();
+
+            auto versionStatus =
+                bsonExtractStringField(serverStatus, kVersionField, &mongoDVersion);
+            if (!versionStatus.isOK()) {
+                log() << "Unable to obtain shard version for " << shard.getName()
+                      << causedBy(versionStatus);
+            }
 
-        auto mongoDVersionStatus = retrieveShardMongoDVersion(opCtx, shard.getName());
-        if (mongoDVersionStatus.isOK()) {
-            mongoDVersion = std::move(mongoDVersionStatus.getValue());
+            chunkLoads = extractChunkLoads(serverStatus);
         } else {
-            // Since the mongod version is only used for reporting, there is no need to fail the
-            // entire round if it cannot be retrieved, so just leave it empty
             log() << "Unable to obtain shard version for " << shard.getName()
-                  << causedBy(mongoDVersionStatus.getStatus());
+                  << causedBy(serverStatusStatus.getStatus());
         }
 
         std::set<std::string> shardTags;
@@ -158,6 +203,7 @@ StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(Operati
                            shard.getDraining(),
                            std::move(shardTags),
                            std::move(mongoDVersion));
+        stats.back().chunkLoads = std::move(chunkLoads);
     }
 
     return stats;
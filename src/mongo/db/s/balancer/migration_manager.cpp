@@ -34,7 +34,10 @@
 
 #include "mongo/db/s/balancer/migration_manager.h"
 
+#include <algorithm>
+#include <list>
 #include <memory>
+#include <set>
 
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/bson/util/bson_extract.h"
@@ -126,37 +129,83 @@ MigrationStatuses MigrationManager::executeMigrationsForAutoBalance(
         std::map<MigrationIdentifier, ScopedMigrationRequest> scopedMigrationRequests;
         vector<std::pair<shared_ptr<Notification<RemoteCommandResponse>>, MigrateInfo>> responses;
 
-        for (const auto& migrateInfo : migrateInfos) {
-            // Write a document to the config.migrations collection, in case this migration must be
-            // recovered by the Balancer. Fail if the chunk is already moving.
-            auto statusWithScopedMigrationRequest =
-                ScopedMigrationRequest::writeMigration(opCtx, migrateInfo, waitForDelete);
-            if (!statusWithScopedMigrationRequest.isOK()) {
-                migrationStatuses.emplace(migrateInfo.getName(),
-                                          std::move(statusWithScopedMigrationRequest.getStatus()));
-                continue;
+        std::list<MigrateInfo> pending(migrateInfos.begin(), migrateInfos.end());
+        std::set<ShardId> busyShards;
+
+        // Schedules every pending migration whose donor and recipient are not busy with another
+        // one, in the order in which they were selected. A shard never runs more than one at a
+        // time, because the donor and recipient side registries reject a second migration.
+        auto scheduleReadyMigrations = [&] {
+            for (auto it = pending.begin(); it != pending.end();) {
+                const auto& migrateInfo = *it;
+                if (busyShards.count(migrateInfo.from) || busyShards.count(migrateInfo.to)) {
+                    ++it;
+                    continue;
+                }
+
+                // Write a document to the config.migrations collection, in case this migration
+                // must be recovered by the Balancer. Fail if the chunk is already moving.
+                auto statusWithScopedMigrationRequest =
+                    ScopedMigrationRequest::writeMigration(opCtx, migrateInfo, waitForDelete);
+                if (!statusWithScopedMigrationRequest.isOK()) {
+                    migrationStatuses.emplace(
+                        migrateInfo.getName(),
+                        std::move(statusWithScopedMigrationRequest.getStatus()));
+                    it = pending.erase(it);
+                    continue;
+                }
+                scopedMigrationRequests.emplace(
+                    migrateInfo.getName(), std::move(statusWithScopedMigrationRequest.getValue()));
+
+                busyShards.insert(migrateInfo.from);
+                busyShards.insert(migrateInfo.to);
+                responses.emplace_back(
+                    _schedule(
+                        opCtx, migrateInfo, maxChunkSizeBytes, secondaryThrottle, waitForDelete),
+                    migrateInfo);
+                it = pending.erase(it);
+            }
+        };
+
+        scheduleReadyMigrations();
+
+        // Wait for the scheduled migrations to complete, starting the pending ones as the shards
+        // they need become free.
+        while (!responses.empty()) {
+            {
+                stdx::unique_lock<stdx::mutex> lock(_mutex);
+                _migrationCompletedCV.wait(lock, [&] {
+                    return std::any_of(
+                        responses.begin(), responses.end(), [](const auto& response) {
+                            return static_cast<bool>(*response.first);
+                        });
+                });
             }
-            scopedMigrationRequests.emplace(migrateInfo.getName(),
-                                            std::move(statusWithScopedMigrationRequest.getValue()));
 
-            responses.emplace_back(
-                _schedule(opCtx, migrateInfo, maxChunkSizeBytes, secondaryThrottle, waitForDelete),
-                migrateInfo);
-        }
+            for (auto responseIt = responses.begin(); responseIt != responses.end();) {
+                if (!*responseIt->first) {
+                    ++responseIt;
+                    continue;
+                }
 
-        // Wait for all the scheduled migrations to complete.
-        for (auto& response : responses) {
-            auto notification = std::move(response.first);
-            auto migrateInfo = std::move(response.second);
+                const auto& migrateInfo = responseIt->second;
+                const auto& remoteCommandResponse = responseIt->first->get();
 
-            const auto& remoteCommandResponse = notification->get();
+                auto it = scopedMigrationRequests.find(migrateInfo.getName());
+                invariant(it != scopedMigrationRequests.end());
+                Status commandStatus =
+                    _processRemoteCommandResponse(remoteCommandResponse, &it->second);
+                migrationStatuses.emplace(migrateInfo.getName(), std::move(commandStatus));
 
-            auto it = scopedMigrationRequests.find(migrateInfo.getName());
-            invariant(it != scopedMigrationRequests.end());
-            Status commandStatus =
-                _processRemoteCommandResponse(remoteCommandResponse, &it->second);
-            migrationStatuses.emplace(migrateInfo.getName(), std::move(commandStatus));
+                busyShards.erase(migrateInfo.from);
+                busyShards.erase(migrateInfo.to);
+                responseIt = responses.erase(responseIt);
+            }
+
+            scheduleReadyMigrations();
         }
+
+        invariant(pending.empty());
     }
 
     invariant(migrationStatuses.size() == migrateInfos.size());
@@ -562,6 +611,7 @@ void MigrationManager::_complete(WithLock lock,
     }
 
     notificationToSignal->set(remoteCommandResponse);
+    _migrationCompletedCV.notify_all();
 }
 
 void MigrationManager::_checkDrained(WithLock) {
@@ -76,6 +76,11 @@ public:
      * "candidateMigrations" and wait for them to complete. Takes the distributed lock for each
      * collection with a chunk being migrated.
      *
+     * The shards only allow one active migration each, as either donor or recipient, so
+     * migrations which share a shard run one after the other, each starting as soon as both of its
+     * shards are free. The balancing round may therefore hand a shard up to
+     * 'maxMigrationsPerShardPerRound' migrations, but never runs them concurrently.
+     *
      * If any of the migrations, which were scheduled in parallel fails with a LockBusy error
      * reported from the shard, retries it serially without the distributed lock.
      *
@@ -270,6 +275,9 @@ private:
     // signaled when the state change is complete.
     stdx::condition_variable _condVar;
 
+    // Signaled whenever a scheduled migration completes.
+    stdx::condition_variable _migrationCompletedCV;
+
     // Maps collection namespaces to that collection's active migrations.
     CollectionMigrationsStateMap _activeMigrations;
 };
@@ -0,0 +1,269 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/chunk_heat_map.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/s/collection_metadata.h"
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+namespace {
+
+// One in how many operations executed by a thread are sampled into the chunk heat maps. Zero
+// disables the tracking of chunk heat.
+MONGO_EXPORT_SERVER_PARAMETER(chunkHeatSampleInterval, int, 16)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue, "chunkHeatSampleInterval must not be negative");
+        }
+        return Status::OK();
+    });
+
+// Time it takes for the recorded load of a chunk to decay by half
+MONGO_EXPORT_SERVER_PARAMETER(chunkHeatHalfLifeSecs, int, 60)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1) {
+            return Status(ErrorCodes::BadValue, "chunkHeatHalfLifeSecs must be at least 1");
+        }
+        return Status::OK();
+    });
+
+// Rate of operations above which a chunk, which takes at least half of the load of its collection
+// on this shard, is split. Zero disables the splitting of hot chunks.
+MONGO_EXPORT_SERVER_PARAMETER(chunkHeatSplitOpsPerSec, int, 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue, "chunkHeatSplitOpsPerSec must not be negative");
+        }
+        return Status::OK();
+    });
+
+// Number of operations left before the current thread takes its next sample
+thread_local int samplingCountdown = 0;
+
+/**
+ * With exponential decay, a steady rate of operations accumulates to rate * halfLife / ln(2), so
+ * this converts decayed counts to per-second rates.
+ */
+double toRate(double decayedCount) {
+    return decayedCount * std::log(2.0) / chunkHeatHalfLifeSecs.load();
+}
+
+}  // namespace
+
+void ChunkHeatMap::ChunkHeat::append(BSONObjBuilder* builder) const {
+    range.append(builder);
+    builder->append("readsPerSec", readsPerSec);
+    builder->append("writesPerSec", writesPerSec);
+    builder->append("bytesWrittenPerSec", bytesWrittenPerSec);
+}
+
+void ChunkHeatMap::Counters::decay(Date_t now) {
+    if (now <= lastDecayed) {
+        return;
+    }
+
+    const double elapsedSecs = durationCount<Milliseconds>(now - lastDecayed) / 1000.0;
+    const double factor = std::exp2(-elapsedSecs / chunkHeatHalfLifeSecs.load());
+
+    reads *= factor;
+    writes *= factor;
+    bytesWritten *= factor;
+    lastDecayed = now;
+}
+
+ChunkHeatMap::ChunkHeatMap()
+    : _chunks(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ChunkEntry>()) {}
+
+int ChunkHeatMap::sampleOperation() {
+    const int interval = chunkHeatSampleInterval.load();
+    if (interval == 0) {
+        return 0;
+    }
+
+    // The countdown is also restarted if the interval was lowered since it was last armed
+    if (--samplingCountdown > 0 && samplingCountdown < interval) {
+        return 0;
+    }
+
+    samplingCountdown = interval;
+    return interval;
+}
+
+boost::optional<ChunkRange> ChunkHeatMap::getOwningChunk(const CollectionMetadata& metadata,
+                                                         const BSONObj& shardKey) {
+    ChunkType chunk;
+    if (!metadata.getNextChunk(shardKey, &chunk)) {
+        return boost::none;
+    }
+
+    ChunkRange range(chunk.getMin(), chunk.getMax());
+    if (!range.containsKey(shardKey)) {
+        return boost::none;
+    }
+
+    return range;
+}
+
+void ChunkHeatMap::recordRead(const ChunkRange& range, int weight, Date_t now) {
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+
+    auto& entry = _getEntry(lg, range, now);
+    entry.counters.reads += weight;
+
+    _total.decay(now);
+    _total.reads += weight;
+}
+
+bool ChunkHeatMap::recordWrite(const ChunkRange& range,
+                               int weight,
+                               long long bytesWritten,
+                               Date_t now) {
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+
+    auto& entry = _getEntry(lg, range, now);
+    entry.counters.writes += weight;
+    entry.counters.bytesWritten += static_cast<double>(weight) * bytesWritten;
+
+    _total.decay(now);
+    _total.writes += weight;
+    _total.bytesWritten += static_cast<double>(weight) * bytesWritten;
+
+    const int splitOpsPerSec = chunkHeatSplitOpsPerSec.load();
+    if (!splitOpsPerSec || entry.splitSuggested) {
+        return false;
+    }
+
+    if (toRate(entry.counters.ops()) < splitOpsPerSec ||
+        entry.counters.ops() * 2 < _total.ops()) {
+        return false;
+    }
+
+    entry.splitSuggested = true;
+    return true;
+}
+
+std::vector<ChunkHeatMap::ChunkHeat> ChunkHeatMap::getHottestChunks(size_t limit, Date_t now) {
+    std::vector<ChunkHeat> chunks;
+
+    {
+        stdx::lock_guard<stdx::mutex> lg(_mutex);
+
+        for (auto it = _chunks.begin(); it != _chunks.end();) {
+            auto& counters = it->second.counters;
+            counters.decay(now);
+
+            // Less than a single operation is left, so the chunk is no longer interesting
+            if (counters.ops() < 1) {
+                it = _chunks.erase(it);
+                continue;
+            }
+
+            chunks.push_back({ChunkRange(it->first, it->second.max),
+                              toRate(counters.reads),
+                              toRate(counters.writes),
+                              toRate(counters.bytesWritten)});
+            ++it;
+        }
+    }
+
+    const auto hotter = [](const ChunkHeat& a, const ChunkHeat& b) {
+        return a.opsPerSec() > b.opsPerSec();
+    };
+
+    if (chunks.size() > limit) {
+        std::partial_sort(chunks.begin(), chunks.begin() + limit, chunks.end(), hotter);
+        chunks.erase(chunks.begin() + limit, chunks.end());
+    } else {
+        std::sort(chunks.begin(), chunks.end(), hotter);
+    }
+
+    return chunks;
+}
+
+void ChunkHeatMap::retainOwnedChunks(const RangeMap& ownedChunks) {
+    const auto now = Date_t::now();
+
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+
+    _total = Counters();
+    _total.lastDecayed = now;
+
+    for (auto it = _chunks.begin(); it != _chunks.end();) {
+        const auto owned = ownedChunks.find(it->first);
+        if (owned == ownedChunks.end() ||
+            SimpleBSONObjComparator::kInstance.evaluate(owned->second != it->second.max)) {
+            it = _chunks.erase(it);
+            continue;
+        }
+
+        auto& counters = it->second.counters;
+        counters.decay(now);
+
+        _total.reads += counters.reads;
+        _total.writes += counters.writes;
+        _total.bytesWritten += counters.bytesWritten;
+        ++it;
+    }
+}
+
+void ChunkHeatMap::clear() {
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+    _chunks.clear();
+    _total = Counters();
+}
+
+ChunkHeatMap::ChunkEntry& ChunkHeatMap::_getEntry(WithLock, const ChunkRange& range, Date_t now) {
+    auto it = _chunks.find(range.getMin());
+    if (it != _chunks.end() &&
+        SimpleBSONObjComparator::kInstance.evaluate(it->second.max == range.getMax())) {
+        it->second.counters.decay(now);
+        return it->second;
+    }
+
+    ChunkEntry entry;
+    entry.max = range.getMax().getOwned();
+    entry.counters.lastDecayed = now;
+
+    if (it != _chunks.end()) {
+        it->second = std::move(entry);
+        return it->second;
+    }
+
+    return _chunks.emplace(range.getMin().getOwned(), std::move(entry)).first->second;
+}
+
+}  // namespace mongo
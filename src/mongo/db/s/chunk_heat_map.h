@@ -0,0 +1,168 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/range_arithmetic.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+class CollectionMetadata;
+
+/**
+ * Keeps a decaying estimate of the rate of reads and writes, which hit each of the chunks of a
+ * sharded collection owned by this shard. Operations are sampled (see the chunkHeatSampleInterval
+ * server parameter) and every sample is accounted with the weight of the operations it stands for.
+ *
+ * The accumulated counts decay exponentially with a half-life controlled by the
+ * chunkHeatHalfLifeSecs server parameter, so the reported rates reflect the recent load on a chunk
+ * rather than its entire history. This information is what the balancer uses in order to even out
+ * the load across shards and what the shard uses in order to decide to split hot chunks.
+ *
+ * This class is thread-safe.
+ */
+class ChunkHeatMap {
+    MONGO_DISALLOW_COPYING(ChunkHeatMap);
+
+public:
+    /**
+     * Estimated load of a single chunk.
+     */
+    struct ChunkHeat {
+        double opsPerSec() const {
+            return readsPerSec + writesPerSec;
+        }
+
+        /**
+         * Appends { min: <min bound>, max: <max bound>, readsPerSec: ..., writesPerSec: ...,
+         * bytesWrittenPerSec: ... } to the specified builder.
+         */
+        void append(BSONObjBuilder* builder) const;
+
+        ChunkRange range;
+        double readsPerSec{0};
+        double writesPerSec{0};
+        double bytesWrittenPerSec{0};
+    };
+
+    ChunkHeatMap();
+
+    /**
+     * Decides whether the operation, which the calling thread is about to account for, should be
+     * sampled. Returns the number of operations the sample stands for or zero if the operation
+     * should not be recorded.
+     */
+    static int sampleOperation();
+
+    /**
+     * Returns the range of the chunk owned by this shard, which contains the specified shard key,
+     * or boost::none if the key is not owned.
+     */
+    static boost::optional<ChunkRange> getOwningChunk(const CollectionMetadata& metadata,
+                                                      const BSONObj& shardKey);
+
+    /**
+     * Accounts for 'weight' reads against the specified chunk.
+     */
+    void recordRead(const ChunkRange& range, int weight, Date_t now);
+
+    /**
+     * Accounts for 'weight' writes of 'bytesWritten' each against the specified chunk. Returns
+     * true if the chunk has become hot enough that it should be split in order to allow the load
+     * on it to be spread across shards. Returns true at most once for any given chunk range.
+     */
+    bool recordWrite(const ChunkRange& range, int weight, long long bytesWritten, Date_t now);
+
+    /**
+     * Returns up to 'limit' chunks with the highest rate of operations, hottest first. Chunks,
+     * whose load has decayed to nothing are forgotten.
+     */
+    std::vector<ChunkHeat> getHottestChunks(size_t limit, Date_t now);
+
+    /**
+     * Forgets any chunks, which are not in the specified set of owned chunks with the exact same
+     * bounds. Used after the shard's filtering metadata changes.
+     */
+    void retainOwnedChunks(const RangeMap& ownedChunks);
+
+    /**
+     * Forgets all chunks.
+     */
+    void clear();
+
+private:
+    // Decayed operation counters for a chunk or for the entire collection
+    struct Counters {
+        void decay(Date_t now);
+
+        double ops() const {
+            return reads + writes;
+        }
+
+        double reads{0};
+        double writes{0};
+        double bytesWritten{0};
+        Date_t lastDecayed;
+    };
+
+    struct ChunkEntry {
+        BSONObj max;
+        Counters counters;
+
+        // Whether a split was already suggested for this range
+        bool splitSuggested{false};
+    };
+
+    /**
+     * Returns the entry for the specified chunk, decayed to 'now'. If the chunk was not tracked
+     * or its bounds have changed, starts tracking it from scratch.
+     */
+    ChunkEntry& _getEntry(WithLock, const ChunkRange& range, Date_t now);
+
+    // Protects the state below
+    stdx::mutex _mutex;
+
+    // Per-chunk counters, keyed by the chunk's min key
+    BSONObjIndexedMap<ChunkEntry> _chunks;
+
+    // Sum of the counters of all tracked chunks
+    Counters _total;
+};
+
+}  // namespace mongo
@@ -0,0 +1,135 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <cmath>
+
+#include "mongo/db/s/chunk_heat_map.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const ChunkRange kRange0(BSON("x" << MINKEY), BSON("x" << 0));
+const ChunkRange kRange1(BSON("x" << 0), BSON("x" << 10));
+const ChunkRange kRange2(BSON("x" << 10), BSON("x" << MAXKEY));
+
+// Default value of the chunkHeatHalfLifeSecs server parameter
+const double kHalfLifeSecs = 60;
+
+double toRate(double count) {
+    return count * std::log(2.0) / kHalfLifeSecs;
+}
+
+TEST(ChunkHeatMap, ReportsHottestChunksFirst) {
+    const auto now = Date_t::now();
+
+    ChunkHeatMap heatMap;
+    heatMap.recordRead(kRange0, 10, now);
+    heatMap.recordWrite(kRange1, 30, 100, now);
+    heatMap.recordRead(kRange2, 20, now);
+
+    const auto hottest = heatMap.getHottestChunks(2, now);
+    ASSERT_EQ(2U, hottest.size());
+
+    ASSERT(kRange1 == hottest[0].range);
+    ASSERT_APPROX_EQUAL(0, hottest[0].readsPerSec, 1e-9);
+    ASSERT_APPROX_EQUAL(toRate(30), hottest[0].writesPerSec, 1e-9);
+    ASSERT_APPROX_EQUAL(toRate(30 * 100), hottest[0].bytesWrittenPerSec, 1e-9);
+
+    ASSERT(kRange2 == hottest[1].range);
+    ASSERT_APPROX_EQUAL(toRate(20), hottest[1].readsPerSec, 1e-9);
+}
+
+TEST(ChunkHeatMap, LoadDecaysWithTime) {
+    const auto now = Date_t::now();
+
+    ChunkHeatMap heatMap;
+    heatMap.recordRead(kRange0, 1000, now);
+
+    auto hottest = heatMap.getHottestChunks(10, now + Seconds(60));
+    ASSERT_EQ(1U, hottest.size());
+    ASSERT_APPROX_EQUAL(toRate(500), hottest[0].readsPerSec, 1e-9);
+
+    // Once less than a single operation is left, the chunk is forgotten
+    hottest = heatMap.getHottestChunks(10, now + Seconds(60 * 11));
+    ASSERT(hottest.empty());
+}
+
+TEST(ChunkHeatMap, ChangedChunkBoundsResetLoad) {
+    const auto now = Date_t::now();
+
+    ChunkHeatMap heatMap;
+    heatMap.recordRead(ChunkRange(BSON("x" << 0), BSON("x" << MAXKEY)), 1000, now);
+    heatMap.recordRead(kRange1, 10, now);
+
+    const auto hottest = heatMap.getHottestChunks(10, now);
+    ASSERT_EQ(1U, hottest.size());
+    ASSERT(kRange1 == hottest[0].range);
+    ASSERT_APPROX_EQUAL(toRate(10), hottest[0].readsPerSec, 1e-9);
+}
+
+TEST(ChunkHeatMap, RetainOwnedChunks) {
+    const auto now = Date_t::now();
+
+    ChunkHeatMap heatMap;
+    heatMap.recordRead(kRange0, 10, now);
+    heatMap.recordRead(kRange1, 10, now);
+    heatMap.recordRead(kRange2, 10, now);
+
+    RangeMap ownedChunks = SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<BSONObj>();
+    ownedChunks.emplace(kRange0.getMin(), kRange0.getMax());
+    ownedChunks.emplace(kRange1.getMin(), BSON("x" << 5));
+    heatMap.retainOwnedChunks(ownedChunks);
+
+    const auto hottest = heatMap.getHottestChunks(10, now);
+    ASSERT_EQ(1U, hottest.size());
+    ASSERT(kRange0 == hottest[0].range);
+}
+
+TEST(ChunkHeatMap, SuggestsSplittingChunkWithMostOfTheLoadOnce) {
+    const auto now = Date_t::now();
+
+    // The default chunkHeatSplitOpsPerSec is 1000 operations per second
+    const int kSplitWeight = static_cast<int>(std::ceil(1000 * kHalfLifeSecs / std::log(2.0)));
+
+    ChunkHeatMap heatMap;
+    ASSERT(!heatMap.recordWrite(kRange0, kSplitWeight / 2, 10, now));
+    ASSERT(heatMap.recordWrite(kRange0, kSplitWeight / 2 + 1, 10, now));
+    ASSERT(!heatMap.recordWrite(kRange0, kSplitWeight, 10, now));
+
+    // Chunks with less than half of the collection's load are not split, no matter how hot
+    ASSERT(!heatMap.recordWrite(kRange1, kSplitWeight * 2 - 1, 10, now));
+    ASSERT(heatMap.recordWrite(kRange1, kSplitWeight * 2, 10, now));
+}
+
+}  // namespace
+}  // namespace mongo
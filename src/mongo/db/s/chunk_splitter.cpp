@@ -42,6 +42,7 @@
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/s/split_chunk.h"
 #include "mongo/db/s/split_vector.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/s/balancer_configuration.h"
 #include "mongo/s/catalog/type_chunk.h"
@@ -54,6 +55,17 @@
 #include "mongo/util/log.h"
 
 namespace mongo {
+
+// Number of random documents in a chunk which the auto-splitter samples to estimate split points,
+// instead of scanning the whole chunk. Zero disables sampling.
+MONGO_EXPORT_SERVER_PARAMETER(autoSplitVectorSampleSize, long long, 0)
+    ->withValidator([](const long long& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue, "autoSplitVectorSampleSize must not be negative");
+        }
+        return Status::OK();
+    });
+
 namespace {
 
 /**
@@ -103,6 +115,36 @@ Status splitChunkAtMultiplePoints(OperationContext* opCtx,
     return status.getStatus().withContext("split failed");
 }
 
+/**
+ * Finds the points to split the chunk [min, max) at, by sampling the collection if
+ * autoSplitVectorSampleSize is set and by scanning the chunk otherwise.
+ */
+StatusWith<std::vector<BSONObj>> findSplitPoints(OperationContext* opCtx,
+                                                 const NamespaceString& nss,
+                                                 const BSONObj& keyPattern,
+                                                 const BSONObj& min,
+                                                 const BSONObj& max,
+                                                 bool force,
+                                                 boost::optional<long long> maxSplitPoints,
+                                                 long long maxChunkSizeBytes) {
+    const long long sampleSize = autoSplitVectorSampleSize.load();
+    if (sampleSize > 0) {
+        return splitVectorSampled(
+            opCtx, nss, keyPattern, min, max, force, maxSplitPoints, maxChunkSizeBytes, sampleSize);
+    }
+
+    return splitVector(opCtx,
+                       nss,
+                       keyPattern,
+                       min,
+                       max,
+                       force,
+                       maxSplitPoints,
+                       boost::none,
+                       boost::none,
+                       maxChunkSizeBytes);
+}
+
 /**
  * Attempts to move the chunk specified by minKey away from its current shard.
  */
@@ -273,6 +315,24 @@ void ChunkSplitter::trySplitting(const NamespaceString& nss,
     }));
 }
 
+void ChunkSplitter::trySplittingHotChunk(const NamespaceString& nss,
+                                         const BSONObj& min,
+                                         const BSONObj& max) {
+    if (!_isPrimary) {
+        return;
+    }
+
+    auto status = _threadPool.schedule(
+        [ this, nss, min = min.getOwned(), max = max.getOwned() ]() noexcept {
+            _runHotChunkSplit(nss, min, max);
+        });
+    if (!status.isOK()) {
+        LOG(1) << "Unable to schedule split of hot chunk "
+               << redact(ChunkRange(min, max).toString()) << " in nss " << nss
+               << causedBy(redact(status));
+    }
+}
+
 void ChunkSplitter::_runAutosplit(const NamespaceString& nss,
                                   const BSONObj& min,
                                   const BSONObj& max,
@@ -320,16 +380,14 @@ void ChunkSplitter::_runAutosplit(const NamespaceString& nss,
                << " dataWritten since last check: " << dataWritten
                << " maxChunkSizeBytes: " << maxChunkSizeBytes;
 
-        auto splitPoints = uassertStatusOK(splitVector(opCtx.get(),
-                                                       nss,
-                                                       cm->getShardKeyPattern().toBSON(),
-                                                       chunk.getMin(),
-                                                       chunk.getMax(),
-                                                       false,
-                                                       boost::none,
-                                                       boost::none,
-                                                       boost::none,
-                                                       maxChunkSizeBytes));
+        auto splitPoints = uassertStatusOK(findSplitPoints(opCtx.get(),
+                                                           nss,
+                                                           cm->getShardKeyPattern().toBSON(),
+                                                           chunk.getMin(),
+                                                           chunk.getMax(),
+                                                           false,
+                                                           boost::none,
+                                                           maxChunkSizeBytes));
 
         if (splitPoints.size() <= 1) {
             // No split points means there isn't enough data to split on; 1 split point means we
@@ -405,4 +463,72 @@ void ChunkSplitter::_runAutosplit(const NamespaceString& nss,
     }
 }
 
+void ChunkSplitter::_runHotChunkSplit(const NamespaceString& nss,
+                                      const BSONObj& min,
+                                      const BSONObj& max) {
+    if (!_isPrimary) {
+        return;
+    }
+
+    try {
+        const auto opCtx = cc().makeOperationContext();
+        const auto routingInfo = uassertStatusOK(
+            Grid::get(opCtx.get())->catalogCache()->getCollectionRoutingInfo(opCtx.get(), nss));
+
+        uassert(ErrorCodes::NamespaceNotSharded,
+                "Could not split chunk. Collection is no longer sharded",
+                routingInfo.cm());
+
+        const auto cm = routingInfo.cm();
+        const auto chunk = cm->findIntersectingChunkWithSimpleCollation(min);
+
+        // Stop if the chunk has been split or moved since it was found to be hot
+        if ((0 != chunk.getMin().woCompare(min)) || (0 != chunk.getMax().woCompare(max)) ||
+            (chunk.getShardId() != ShardingState::get(opCtx.get())->shardId())) {
+            LOG(1) << "Cannot split hot chunk with range '"
+                   << redact(ChunkRange(min, max).toString()) << "' for nss '" << nss
+                   << "' because it has since been changed to '" << redact(chunk.toString())
+                   << "'";
+            return;
+        }
+
+        const auto balancerConfig = Grid::get(opCtx.get())->getBalancerConfiguration();
+        uassertStatusOK(balancerConfig->refreshAndCheck(opCtx.get()));
+
+        if (!balancerConfig->getShouldAutoSplit()) {
+            return;
+        }
+
+        // Forcing the split yields the median key of the chunk
+        auto splitPoints =
+            uassertStatusOK(findSplitPoints(opCtx.get(),
+                                            nss,
+                                            cm->getShardKeyPattern().toBSON(),
+                                            chunk.getMin(),
+                                            chunk.getMax(),
+                                            true,
+                                            1,
+                                            balancerConfig->getMaxChunkSizeBytes()));
+
+        if (splitPoints.empty()) {
+            // The chunk holds a single key value, so there is nothing to split on
+            return;
+        }
+
+        uassertStatusOK(splitChunkAtMultiplePoints(opCtx.get(),
+                                                   chunk.getShardId(),
+                                                   nss,
+                                                   cm->getShardKeyPattern(),
+                                                   cm->getVersion(),
+                                                   ChunkRange(chunk.getMin(), chunk.getMax()),
+                                                   splitPoints));
+
+        log() << "split hot chunk " << redact(chunk.toString()) << " of " << nss << " at "
+              << redact(splitPoints.front());
+    } catch (const DBException& ex) {
+        log() << "Unable to split hot chunk " << redact(ChunkRange(min, max).toString())
+              << " in nss " << nss << causedBy(redact(ex.toStatus()));
+    }
+}
+
 }  // namespace mongo
@@ -82,6 +82,13 @@ public:
                       const BSONObj& max,
                       long dataWritten);
 
+    /**
+     * Schedules a task, which splits the specified chunk in half, because it receives too large a
+     * share of the load on this shard. Unlike trySplitting, this function does not throw, because
+     * it is invoked from the write path.
+     */
+    void trySplittingHotChunk(const NamespaceString& nss, const BSONObj& min, const BSONObj& max);
+
 private:
     /**
      * Determines if the specified chunk should be split and then performs any necessary splits.
@@ -96,6 +103,12 @@ private:
                        const BSONObj& max,
                        long dataWritten);
 
+    /**
+     * Splits the specified chunk at its median key, so that the balancer is able to spread its load
+     * across more than one shard.
+     */
+    void _runHotChunkSplit(const NamespaceString& nss, const BSONObj& min, const BSONObj& max);
+
     // Protects the state below.
     stdx::mutex _mutex;
 
@@ -62,6 +62,11 @@ RangeMap CollectionMetadata::getChunks() const {
     return chunksMap;
 }
 
+void CollectionMetadata::buildOwnedRanges() {
+    invariant(isSharded());
+    _ownedRanges = std::make_shared<ShardKeyRangeSet>(getKeyPattern(), getChunks());
+}
+
 bool CollectionMetadata::getNextChunk(const BSONObj& lookupKey, ChunkType* chunk) const {
     invariant(isSharded());
 
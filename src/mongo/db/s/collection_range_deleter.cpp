@@ -44,6 +44,7 @@
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/internal_plans.h"
@@ -54,6 +55,7 @@
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/clustered_key.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/util/log.h"
@@ -100,6 +102,36 @@ boost::optional<DeleteNotification> checkOverlap(std::list<Deletion> const& dele
     return boost::none;
 }
 
+/**
+ * Returns true if a chunk range of 'collection' can be deleted by truncating it in storage. That
+ * requires the collection to be clustered and sharded by {_id: 1}, so that the chunk is a single
+ * range of RecordIds, and every index to be ready and lead with an ascending _id, so that the
+ * chunk is also a single range of each index.
+ */
+bool canTruncateRange(OperationContext* opCtx, Collection* collection, const BSONObj& keyPattern) {
+    if (!collection->getRecordStore()->isClustered() || !KeyPattern::isIdKeyPattern(keyPattern) ||
+        keyPattern.firstElement().numberInt() != 1) {
+        return false;
+    }
+
+    IndexCatalog* catalog = collection->getIndexCatalog();
+    if (catalog->numIndexesInProgress(opCtx) > 0) {
+        return false;
+    }
+
+    IndexCatalog::IndexIterator ii = catalog->getIndexIterator(opCtx, false);
+    while (ii.more()) {
+        const BSONObj indexKeyPattern = ii.next()->keyPattern();
+        const BSONElement first = indexKeyPattern.firstElement();
+        if (first.fieldNameStringData() != "_id" || !first.isNumber() || first.number() <= 0 ||
+            IndexNames::findPluginName(indexKeyPattern) != IndexNames::BTREE) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 }  // namespace
 
 CollectionRangeDeleter::CollectionRangeDeleter() = default;
@@ -342,6 +374,10 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
 
     auto const& nss = collection->ns();
 
+    if (canTruncateRange(opCtx, collection, keyPattern)) {
+        return _doTruncation(opCtx, collection, range, maxToDelete);
+    }
+
     // The IndexChunk has a keyPattern that may apply to more than one index - we need to
     // select the index and get the full index keyPattern here.
     auto catalog = collection->getIndexCatalog();
@@ -383,45 +419,99 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
     auto forward = InternalPlanner::FORWARD;
     auto fetch = InternalPlanner::IXSCAN_FETCH;
 
-    auto exec = InternalPlanner::indexScan(
-        opCtx, collection, descriptor, min, max, halfOpen, manual, forward, fetch);
-
+    // Collect the whole batch first, then delete it with a single call so that each index is
+    // updated once per batch, in key order, rather than once per document. Both happen in the same
+    // WriteUnitOfWork, so that a write conflict retry scans the range again rather than deleting
+    // RecordIds read in the aborted unit. For the same reason, the documents are only saved once
+    // the unit has committed.
     int numDeleted = 0;
-    do {
-        RecordId rloc;
-        BSONObj obj;
-        PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
-        if (state == PlanExecutor::IS_EOF) {
-            break;
+    std::vector<BSONObj> toSave;
+    writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
+        WriteUnitOfWork wuow(opCtx);
+        toSave.clear();
+
+        auto exec = InternalPlanner::indexScan(
+            opCtx, collection, descriptor, min, max, halfOpen, manual, forward, fetch);
+
+        std::vector<RecordId> batch;
+        while (batch.size() < static_cast<size_t>(maxToDelete)) {
+            RecordId rloc;
+            BSONObj obj;
+            PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
+            if (state == PlanExecutor::IS_EOF) {
+                break;
+            }
+            if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
+                warning() << PlanExecutor::statestr(state)
+                          << " - cursor error while trying to delete " << redact(min) << " to "
+                          << redact(max) << " in " << nss << ": "
+                          << redact(WorkingSetCommon::toStatusString(obj))
+                          << ", stats: " << Explain::getWinningPlanStats(exec.get());
+                break;
+            }
+            invariant(PlanExecutor::ADVANCED == state);
+
+            if (saver) {
+                toSave.push_back(obj.getOwned());
+            }
+            batch.push_back(rloc);
         }
-        if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
-            warning() << PlanExecutor::statestr(state) << " - cursor error while trying to delete "
-                      << redact(min) << " to " << redact(max) << " in " << nss << ": "
-                      << redact(WorkingSetCommon::toStatusString(obj))
-                      << ", stats: " << Explain::getWinningPlanStats(exec.get());
-            break;
+
+        numDeleted = batch.size();
+        if (batch.empty()) {
+            return;
         }
-        invariant(PlanExecutor::ADVANCED == state);
 
-        exec->saveState();
-        writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
-            WriteUnitOfWork wuow(opCtx);
-            if (saver) {
-                uassertStatusOK(saver->goingToDelete(obj));
+        collection->deleteDocuments(opCtx, batch, nullptr, true);
+        wuow.commit();
+    });
+
+    for (const auto& doc : toSave) {
+        uassertStatusOK(saver->goingToDelete(doc));
+    }
+
+    return numDeleted;
+}
+
+StatusWith<int> CollectionRangeDeleter::_doTruncation(OperationContext* opCtx,
+                                                      Collection* collection,
+                                                      ChunkRange const& range,
+                                                      int maxToDelete) {
+    auto const& nss = collection->ns();
+
+    const RecordId minRecord = clusteredkey::lowestKeyAtOrAbove(range.getMin().firstElement());
+    const RecordId maxRecord = clusteredkey::lowestKeyAtOrAbove(range.getMax().firstElement());
+
+    LOG(1) << "begin truncation of " << minRecord << " to " << maxRecord << " in " << nss.ns();
+
+    boost::optional<Helpers::RemoveSaver> saver;
+    if (serverGlobalParams.moveParanoia) {
+        saver.emplace("moveChunk", nss.ns(), "cleaning");
+    }
+
+    // The truncation does not hand back the documents it removes, so read them in the same
+    // WriteUnitOfWork, and only save them once it has committed.
+    int numDeleted = 0;
+    std::vector<BSONObj> toSave;
+    writeConflictRetry(opCtx, "truncate range", nss.ns(), [&] {
+        WriteUnitOfWork wuow(opCtx);
+        toSave.clear();
+        if (saver) {
+            auto cursor = collection->getCursor(opCtx);
+            for (auto record = cursor->seekNear(minRecord);
+                 record && record->id < maxRecord && static_cast<int>(toSave.size()) < maxToDelete;
+                 record = cursor->next()) {
+                toSave.push_back(record->data.toBson().getOwned());
             }
-            collection->deleteDocument(opCtx, kUninitializedStmtId, rloc, nullptr, true);
-            wuow.commit();
-        });
-        auto restoreStateStatus = exec->restoreState();
-        if (!restoreStateStatus.isOK()) {
-            warning() << "error restoring cursor state while trying to delete " << redact(min)
-                      << " to " << redact(max) << " in " << nss
-                      << ", stats: " << Explain::getWinningPlanStats(exec.get()) << ": "
-                      << redact(restoreStateStatus);
-            break;
         }
+        numDeleted =
+            collection->truncateRecordRange(opCtx, minRecord, maxRecord, maxToDelete, true);
+        wuow.commit();
+    });
 
-    } while (++numDeleted < maxToDelete);
+    for (const auto& doc : toSave) {
+        uassertStatusOK(saver->goingToDelete(doc));
+    }
 
     return numDeleted;
 }
@@ -210,6 +210,16 @@ private:
                                 ChunkRange const& range,
                                 int maxToDelete);
 
+    /**
+     * Same as _doDeletion(), for a clustered collection sharded by {_id: 1} whose indexes all
+     * lead with _id. Removes the documents by truncating their range in the record store and in
+     * every index instead of deleting them one by one.
+     */
+    StatusWith<int> _doTruncation(OperationContext* opCtx,
+                                  Collection* collection,
+                                  ChunkRange const& range,
+                                  int maxToDelete);
+
     /**
      * Removes the latest-scheduled range from the ranges to be cleaned up, and notifies any
      * interested callers of this->overlaps(range) with specified status.
@@ -52,7 +52,8 @@ CollectionShardingRuntime::CollectionShardingRuntime(ServiceContext* sc,
                                                      executor::TaskExecutor* rangeDeleterExecutor)
     : CollectionShardingState(nss),
       _nss(std::move(nss)),
-      _metadataManager(std::make_shared<MetadataManager>(sc, _nss, rangeDeleterExecutor)) {}
+      _metadataManager(std::make_shared<MetadataManager>(sc, _nss, rangeDeleterExecutor)),
+      _chunkHeatMap(std::make_shared<ChunkHeatMap>()) {}
 
 CollectionShardingRuntime* CollectionShardingRuntime::get(OperationContext* opCtx,
                                                           const NamespaceString& nss) {
@@ -64,10 +65,17 @@ void CollectionShardingRuntime::refreshMetadata(OperationContext* opCtx,
                                                 std::unique_ptr<CollectionMetadata> newMetadata) {
     invariant(opCtx->lockState()->isCollectionLockedForMode(_nss.ns(), MODE_X));
 
+    if (newMetadata && newMetadata->isSharded()) {
+        _chunkHeatMap->retainOwnedChunks(newMetadata->getChunks());
+    } else {
+        _chunkHeatMap->clear();
+    }
+
     _metadataManager->refreshActiveMetadata(std::move(newMetadata));
 }
 
 void CollectionShardingRuntime::markNotShardedAtStepdown() {
+    _chunkHeatMap->clear();
     _metadataManager->refreshActiveMetadata(nullptr);
 }
 
@@ -32,6 +32,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/s/chunk_heat_map.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/metadata_manager.h"
 #include "mongo/util/decorable.h"
@@ -135,6 +136,10 @@ public:
         _metadataManager->toBSONPending(bb);
     }
 
+    std::shared_ptr<ChunkHeatMap> getChunkHeatMap() override {
+        return _chunkHeatMap;
+    }
+
 
 private:
     friend boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
@@ -146,6 +151,9 @@ private:
     // Contains all the metadata associated with this collection.
     std::shared_ptr<MetadataManager> _metadataManager;
 
+    // Tracks the load on the chunks owned by this shard
+    const std::shared_ptr<ChunkHeatMap> _chunkHeatMap;
+
     ScopedCollectionMetadata _getMetadata(OperationContext* opCtx) override;
 };
 
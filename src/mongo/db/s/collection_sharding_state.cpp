@@ -34,6 +34,7 @@
 
 #include "mongo/db/s/collection_sharding_state.h"
 
+#include "mongo/db/s/chunk_heat_map.h"
 #include "mongo/db/s/operation_sharding_state.h"
 #include "mongo/db/s/sharded_connection_info.h"
 #include "mongo/s/stale_exception.h"
@@ -82,6 +83,30 @@ public:
         versionB.done();
     }
 
+    void reportChunkHeat(size_t maxChunksPerCollection, BSONObjBuilder* builder) {
+        const auto now = Date_t::now();
+
+        BSONObjBuilder collectionsB(builder->subobjStart("collections"));
+
+        stdx::lock_guard<stdx::mutex> lg(_mutex);
+
+        for (auto& coll : _collections) {
+            auto chunkHeatMap = coll.second->getChunkHeatMap();
+            if (!chunkHeatMap)
+                continue;
+
+            const auto hottestChunks = chunkHeatMap->getHottestChunks(maxChunksPerCollection, now);
+            if (hottestChunks.empty())
+                continue;
+
+            BSONArrayBuilder chunksB(collectionsB.subarrayStart(coll.first));
+            for (const auto& chunkHeat : hottestChunks) {
+                BSONObjBuilder chunkB(chunksB.subobjStart());
+                chunkHeat.append(&chunkB);
+            }
+        }
+    }
+
 private:
     using CollectionsMap = StringMap<std::shared_ptr<CollectionShardingState>>;
 
@@ -113,6 +138,13 @@ void CollectionShardingState::report(OperationContext* opCtx, BSONObjBuilder* bu
     collectionsMap->report(opCtx, builder);
 }
 
+void CollectionShardingState::reportChunkHeat(OperationContext* opCtx,
+                                              size_t maxChunksPerCollection,
+                                              BSONObjBuilder* builder) {
+    auto& collectionsMap = CollectionShardingStateMap::get(opCtx->getServiceContext());
+    collectionsMap->reportChunkHeat(maxChunksPerCollection, builder);
+}
+
 ScopedCollectionMetadata CollectionShardingState::getMetadata(OperationContext* opCtx) {
     return _getMetadata(opCtx);
 }
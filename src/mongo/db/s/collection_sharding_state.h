@@ -37,6 +37,8 @@
 
 namespace mongo {
 
+class ChunkHeatMap;
+
 /**
  * Each collection on a mongod instance is dynamically assigned two pieces of information for the
  * duration of its lifetime:
@@ -71,6 +73,14 @@ public:
      */
     static void report(OperationContext* opCtx, BSONObjBuilder* builder);
 
+    /**
+     * Reports the hottest chunks of all collections, which track chunk heat, limited to
+     * 'maxChunksPerCollection' chunks for each collection.
+     */
+    static void reportChunkHeat(OperationContext* opCtx,
+                                size_t maxChunksPerCollection,
+                                BSONObjBuilder* builder);
+
     /**
      * Returns the chunk filtering metadata for the collection. The returned object is safe to
      * access outside of collection lock.
@@ -104,6 +114,14 @@ public:
         return _critSec.getSignal(op);
     }
 
+    /**
+     * Returns the map used to track the load on the collection's chunks or nullptr if this kind of
+     * node does not track it. The returned object is safe to access outside of collection lock.
+     */
+    virtual std::shared_ptr<ChunkHeatMap> getChunkHeatMap() {
+        return nullptr;
+    }
+
 protected:
     CollectionShardingState(NamespaceString nss);
 
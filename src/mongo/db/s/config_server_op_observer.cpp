@@ -49,7 +49,8 @@ void ConfigServerOpObserver::onDelete(OperationContext* opCtx,
                                       OptionalCollectionUUID uuid,
                                       StmtId stmtId,
                                       bool fromMigrate,
-                                      const boost::optional<BSONObj>& deletedDoc) {
+                                      const boost::optional<BSONObj>& deletedDoc,
+                                      const OplogSlot& oplogSlot) {
     if (nss == VersionType::ConfigNS) {
         if (!repl::ReplicationCoordinator::get(opCtx)->getMemberState().rollback()) {
             uasserted(40302, "cannot delete config.version document while in --configsvr mode");
@@ -70,7 +70,8 @@ public:
                   OptionalCollectionUUID uuid,
                   StmtId stmtId,
                   bool fromMigrate,
-                  const boost::optional<BSONObj>& deletedDoc) override;
+                  const boost::optional<BSONObj>& deletedDoc,
+                  const OplogSlot& oplogSlot) override;
 
     void onInternalOpMessage(OperationContext* opCtx,
                              const NamespaceString& nss,
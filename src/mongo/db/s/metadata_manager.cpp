@@ -37,6 +37,7 @@
 #include "mongo/base/string_data.h"
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/bson/util/builder.h"
+#include "mongo/db/operation_priority.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/range_arithmetic.h"
 #include "mongo/db/s/collection_sharding_state.h"
@@ -148,6 +149,7 @@ void scheduleCleanup(executor::TaskExecutor* executor,
             Client::initThreadIfNotAlready("Collection Range Deleter");
             auto uniqueOpCtx = Client::getCurrent()->makeOperationContext();
             auto opCtx = uniqueOpCtx.get();
+            ScopedOperationPriority priority(opCtx, OperationPriority::kBackground);
 
             MONGO_FAIL_POINT_PAUSE_WHILE_SET(suspendRangeDeletion);
 
@@ -291,6 +293,11 @@ int MetadataManager::numberOfEmptyMetadataSnapshots() const {
 }
 
 void MetadataManager::refreshActiveMetadata(std::unique_ptr<CollectionMetadata> remoteMetadata) {
+    // Building the owned ranges walks the whole routing table, so do it before taking the lock
+    if (remoteMetadata) {
+        remoteMetadata->buildOwnedRanges();
+    }
+
     stdx::lock_guard<stdx::mutex> lg(_managerLock);
 
     // Collection was never sharded in the first place. This check is necessary in order to avoid
@@ -34,6 +34,9 @@
 
 #include "mongo/db/s/migration_chunk_cloner_source_legacy.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "mongo/base/status.h"
 #include "mongo/client/read_preference.h"
 #include "mongo/db/catalog/index_catalog.h"
@@ -54,6 +57,7 @@
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
+#include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/elapsed_tracker.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -69,6 +73,10 @@ const char kRecvChunkAbort[] = "_recvChunkAbort";
 
 const int kMaxObjectPerChunk{250000};
 
+// Upper bound on the number of record ids a single nextCloneBatch call takes out of the clone set
+// at once, in case the average object size estimate is far too small.
+const uint64_t kMaxCloneLocsToClaim{10000};
+
 bool isInRange(const BSONObj& obj,
                const BSONObj& min,
                const BSONObj& max,
@@ -102,6 +110,7 @@ public:
         if (type == INVALIDATION_DELETION) {
             stdx::lock_guard<stdx::mutex> sl(_cloner->_mutex);
             _cloner->_cloneLocs.erase(dl);
+            _cloner->_inProgressCloneLocs.erase(dl);
         }
     }
 
@@ -279,10 +288,14 @@ Status MigrationChunkClonerSourceLegacy::awaitUntilCriticalSectionIsAppropriate(
 
         stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-        const std::size_t cloneLocsRemaining = _cloneLocs.size();
+        const std::size_t cloneLocsRemaining = _cloneLocs.size() + _inProgressCloneLocs.size();
 
+        const auto elapsedSecs = durationCount<Seconds>(Date_t::now() - startTime);
         log() << "moveChunk data transfer progress: " << redact(res) << " mem used: " << _memoryUsed
-              << " documents remaining to clone: " << cloneLocsRemaining;
+              << " documents remaining to clone: " << _cloneLocs.size()
+              << " documents sent: " << _numClonedDocsSent << " bytes sent: " << _numClonedBytesSent
+              << " (" << (elapsedSecs > 0 ? _numClonedBytesSent / elapsedSecs : _numClonedBytesSent)
+              << " bytes/sec)";
 
         if (res["state"].String() == "steady") {
             if (cloneLocsRemaining != 0) {
@@ -486,35 +499,92 @@ Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
                            internalQueryExecYieldIterations.load(),
                            Milliseconds(internalQueryExecYieldPeriodMS.load()));
 
-    stdx::lock_guard<stdx::mutex> sl(_mutex);
+    const int arrSizeBefore = arrBuilder->arrSize();
+    const int arrLenBefore = arrBuilder->len();
 
-    std::set<RecordId>::iterator it;
+    std::vector<RecordId> claimed;
+    size_t numProcessed = 0;
 
-    for (it = _cloneLocs.begin(); it != _cloneLocs.end(); ++it) {
-        // We must always make progress in this method by at least one document because empty return
-        // indicates there is no more initial clone data.
-        if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
-            break;
+    // Returns the claimed ids which were neither read nor deleted in the meantime to '_cloneLocs'
+    auto releaseClaim = [&](WithLock) {
+        for (size_t i = 0; i < claimed.size(); ++i) {
+            if (_inProgressCloneLocs.erase(claimed[i]) && i >= numProcessed) {
+                _cloneLocs.insert(claimed[i]);
+            }
+        }
+        claimed.clear();
+        numProcessed = 0;
+    };
+    auto releaseClaimGuard = MakeGuard([&] {
+        stdx::lock_guard<stdx::mutex> sl(_mutex);
+        releaseClaim(sl);
+    });
+
+    // An empty batch tells the recipient that there is no more initial clone data, so keep claiming
+    // until at least one document is appended or nothing is left to clone, since all the documents
+    // of a claim may have been deleted before they were read.
+    bool cloneLocsDrained = false;
+    while (!arrBuilder->arrSize() && !cloneLocsDrained) {
+        // Claim enough record ids to fill the rest of the batch and read the documents without
+        // holding the mutex, so that concurrent _migrateClone requests and the writes being
+        // tracked for the transfer mods phase do not wait on each other's document reads. Claimed
+        // ids which do not fit are returned to '_cloneLocs'.
+        {
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+
+            const uint64_t avgObjSize = std::max<uint64_t>(_averageObjectSizeForCloneLocs, 1);
+            const uint64_t docsThatFit =
+                std::max<int64_t>(BSONObjMaxUserSize - arrBuilder->len(), 0) / avgObjSize;
+            const size_t numToClaim = std::min<uint64_t>(docsThatFit + 1, kMaxCloneLocsToClaim);
+
+            auto it = _cloneLocs.begin();
+            for (; it != _cloneLocs.end() && claimed.size() < numToClaim; ++it) {
+                claimed.push_back(*it);
+            }
+            _cloneLocs.erase(_cloneLocs.begin(), it);
+            _inProgressCloneLocs.insert(claimed.begin(), claimed.end());
         }
 
-        Snapshotted<BSONObj> doc;
-        if (collection->findDoc(opCtx, *it, &doc)) {
-            // Use the builder size instead of accumulating the document sizes directly so that we
-            // take into consideration the overhead of BSONArray indices.
-            if (arrBuilder->arrSize() &&
-                (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
+        for (; numProcessed < claimed.size(); ++numProcessed) {
+            if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
                 break;
             }
 
-            arrBuilder->append(doc.value());
+            {
+                stdx::lock_guard<stdx::mutex> sl(_mutex);
+                if (!_inProgressCloneLocs.count(claimed[numProcessed])) {
+                    // Deleted since it was claimed
+                    continue;
+                }
+            }
+
+            Snapshotted<BSONObj> doc;
+            if (collection->findDoc(opCtx, claimed[numProcessed], &doc)) {
+                // Use the builder size instead of accumulating the document sizes directly so that
+                // we take into consideration the overhead of BSONArray indices.
+                if (arrBuilder->arrSize() &&
+                    (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
+                    break;
+                }
+
+                arrBuilder->append(doc.value());
+            }
         }
+
+        stdx::lock_guard<stdx::mutex> sl(_mutex);
+        releaseClaim(sl);
+        cloneLocsDrained = _cloneLocs.empty();
     }
 
-    _cloneLocs.erase(_cloneLocs.begin(), it);
+    releaseClaimGuard.Dismiss();
+    stdx::lock_guard<stdx::mutex> sl(_mutex);
+
+    _numClonedDocsSent += arrBuilder->arrSize() - arrSizeBefore;
+    _numClonedBytesSent += arrBuilder->len() - arrLenBefore;
 
     // If we have drained all the cloned data, there is no need to keep the delete notify executor
     // around
-    if (_cloneLocs.empty() && _deleteNotifyExec) {
+    if (_cloneLocs.empty() && _inProgressCloneLocs.empty() && _deleteNotifyExec) {
         // We have a different OperationContext than when we created the PlanExecutor, so need to
         // manually destroy it ourselves.
         _deleteNotifyExec->dispose(opCtx, collection->getCursorManager());
@@ -130,6 +130,9 @@ public:
      * give a chance to the caller to perform some form of yielding. It does not free or acquire any
      * locks on its own.
      *
+     * Concurrent calls are allowed and return disjoint sets of documents. The initial clone is
+     * only complete once every caller has received an empty result.
+     *
      * NOTE: Must be called with the collection lock held in at least IS mode.
      */
     Status nextCloneBatch(OperationContext* opCtx,
@@ -248,6 +251,14 @@ private:
     // List of record ids that needs to be transferred (initial clone)
     std::set<RecordId> _cloneLocs;
 
+    // Record ids which nextCloneBatch calls have taken out of '_cloneLocs' and not yet read. Deleted
+    // documents are removed from here too, so that they are skipped by the read (initial clone).
+    std::set<RecordId> _inProgressCloneLocs;
+
+    // Documents and bytes handed to the recipient so far (initial clone)
+    long long _numClonedDocsSent{0};
+    long long _numClonedBytesSent{0};
+
     // The estimated average object size during the clone phase. Used for buffer size
     // pre-allocation (initial clone).
     uint64_t _averageObjectSizeForCloneLocs{0};
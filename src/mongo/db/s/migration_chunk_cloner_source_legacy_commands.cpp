@@ -40,6 +40,7 @@
 #include "mongo/db/catalog_raii.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/operation_priority.h"
 #include "mongo/db/repl/replication_process.h"
 #include "mongo/db/s/active_migrations_registry.h"
 #include "mongo/db/s/collection_sharding_runtime.h"
@@ -150,6 +151,10 @@ public:
         const MigrationSessionId migrationSessionId(
             uassertStatusOK(MigrationSessionId::extractFromBSON(cmdObj)));
 
+        // The bulk of a migration should not delay user operations. The catch-up phase which
+        // follows keeps the default priority, since it determines how long writes are blocked.
+        ScopedOperationPriority priority(opCtx, OperationPriority::kBatch);
+
         boost::optional<BSONArrayBuilder> arrBuilder;
 
         // Try to maximize on the size of the buffer, which we are returning in order to have less
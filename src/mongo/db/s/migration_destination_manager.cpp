@@ -34,6 +34,7 @@
 
 #include "mongo/db/s/migration_destination_manager.h"
 
+#include <algorithm>
 #include <list>
 #include <vector>
 
@@ -46,6 +47,7 @@
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/operation_priority.h"
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/ops/write_ops_exec.h"
 #include "mongo/db/repl/repl_client_info.h"
@@ -61,6 +63,7 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/stdx/chrono.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/concurrency/notification.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -306,6 +309,13 @@ void MigrationDestinationManager::report(BSONObjBuilder& b,
     BSONObjBuilder bb(b.subobjStart("counts"));
     bb.append("cloned", _numCloned);
     bb.append("clonedBytes", _clonedBytes);
+    if (_cloneStartTime != Date_t()) {
+        const auto cloneEndTime = _cloneEndTime != Date_t() ? _cloneEndTime : Date_t::now();
+        const auto cloneMillis = durationCount<Milliseconds>(cloneEndTime - _cloneStartTime);
+        bb.append("cloneMillis", cloneMillis);
+        bb.append("clonedBytesPerSecond",
+                  cloneMillis > 0 ? _clonedBytes * 1000 / cloneMillis : _clonedBytes);
+    }
     bb.append("catchup", _numCatchup);
     bb.append("steady", _numSteady);
     bb.done();
@@ -353,6 +363,8 @@ Status MigrationDestinationManager::start(OperationContext* opCtx,
 
     _numCloned = 0;
     _clonedBytes = 0;
+    _cloneStartTime = Date_t();
+    _cloneEndTime = Date_t();
     _numCatchup = 0;
     _numSteady = 0;
 
@@ -377,48 +389,145 @@ Status MigrationDestinationManager::start(OperationContext* opCtx,
 void MigrationDestinationManager::cloneDocumentsFromDonor(
     OperationContext* opCtx,
     stdx::function<void(OperationContext*, BSONObj)> insertBatchFn,
-    stdx::function<BSONObj(OperationContext*)> fetchBatchFn) {
+    stdx::function<BSONObj(OperationContext*)> fetchBatchFn,
+    int numFetchers,
+    int numInserters) {
+    invariant(numFetchers >= 1);
+    invariant(numInserters >= 1);
+
+    // Allows each inserter to have a batch waiting for it while the fetchers request more.
+    ProducerConsumerQueue<BSONObj> batches(numInserters);
+
+    // The queue admits a single producer at a time, so the fetchers take turns pushing. Waiting for
+    // a turn is interruptible, so that a fetcher stuck behind a full queue can still be torn down.
+    stdx::mutex pushMutex;
+    stdx::condition_variable pushTurnCV;
+    bool pushInProgress = false;
+
+    auto pushBatch = [&](BSONObj batch, OperationContext* fetchOpCtx) {
+        {
+            stdx::unique_lock<stdx::mutex> lk(pushMutex);
+            fetchOpCtx->waitForConditionOrInterrupt(
+                pushTurnCV, lk, [&] { return !pushInProgress; });
+            pushInProgress = true;
+        }
+        ON_BLOCK_EXIT([&] {
+            stdx::lock_guard<stdx::mutex> lk(pushMutex);
+            pushInProgress = false;
+            pushTurnCV.notify_all();
+        });
+
+        batches.push(std::move(batch), fetchOpCtx);
+    };
+
+    // The operation contexts of the helper threads, so they can be interrupted if the clone is
+    // abandoned while they are waiting on the network or on a write.
+    stdx::mutex helpersMutex;
+    bool helpersStopped = false;
+    std::vector<OperationContext*> helperOpCtxs;
+
+    // Runs 'work' on a helper thread. A failure interrupts the calling operation, which then
+    // reports it and tears down the remaining helpers.
+    auto runHelper = [&](std::string threadName, stdx::function<void(OperationContext*)> work) {
+        Client::initThreadIfNotAlready(threadName);
+        auto helperOpCtx = Client::getCurrent()->makeOperationContext();
+        ScopedOperationPriority priority(helperOpCtx.get(), OperationPriority::kBatch);
+        {
+            stdx::lock_guard<stdx::mutex> lk(helpersMutex);
+            if (helpersStopped) {
+                return;
+            }
+            helperOpCtxs.push_back(helperOpCtx.get());
+        }
+        ON_BLOCK_EXIT([&] {
+            stdx::lock_guard<stdx::mutex> lk(helpersMutex);
+            helperOpCtxs.erase(
+                std::find(helperOpCtxs.begin(), helperOpCtxs.end(), helperOpCtx.get()));
+        });
 
-    ProducerConsumerQueue<BSONObj> batches(1);
-    stdx::thread inserterThread{[&] {
-        Client::initThreadIfNotAlready("chunkInserter");
-        auto inserterOpCtx = Client::getCurrent()->makeOperationContext();
-        auto consumerGuard = MakeGuard([&] { batches.closeConsumerEnd(); });
         try {
-            while (true) {
-                auto nextBatch = batches.pop(inserterOpCtx.get());
-                auto arr = nextBatch["objects"].Obj();
-                if (arr.isEmpty()) {
-                    return;
-                }
-                insertBatchFn(inserterOpCtx.get(), arr);
-            }
+            work(helperOpCtx.get());
         } catch (...) {
             stdx::lock_guard<Client> lk(*opCtx->getClient());
             opCtx->getServiceContext()->killOperation(opCtx, exceptionToStatus().code());
-            log() << "Batch insertion failed " << causedBy(redact(exceptionToStatus()));
+            log() << threadName << " failed " << causedBy(redact(exceptionToStatus()));
         }
-    }};
-    auto inserterThreadJoinGuard = MakeGuard([&] {
-        batches.closeProducerEnd();
-        inserterThread.join();
-    });
+    };
+
+    auto insertUntilDrained = [&](OperationContext* insertOpCtx) {
+        while (true) {
+            BSONObj nextBatch;
+            try {
+                nextBatch = batches.pop(insertOpCtx);
+            } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueEndClosed>&) {
+                // All fetchers are done and the queue is empty, or the clone was abandoned.
+                return;
+            }
+            insertBatchFn(insertOpCtx, nextBatch["objects"].Obj());
+        }
+    };
 
-    while (true) {
-        opCtx->checkForInterrupt();
+    // Each fetcher keeps requesting batches until the donor returns an empty one. The donor hands
+    // out every document exactly once, so concurrent fetchers never receive the same document.
+    auto fetchUntilDrained = [&](OperationContext* fetchOpCtx) {
+        while (true) {
+            fetchOpCtx->checkForInterrupt();
 
-        auto res = fetchBatchFn(opCtx);
+            auto res = fetchBatchFn(fetchOpCtx);
 
-        opCtx->checkForInterrupt();
-        batches.push(res.getOwned(), opCtx);
-        auto arr = res["objects"].Obj();
-        if (arr.isEmpty()) {
-            inserterThreadJoinGuard.Dismiss();
-            inserterThread.join();
-            opCtx->checkForInterrupt();
-            break;
+            fetchOpCtx->checkForInterrupt();
+            if (res["objects"].Obj().isEmpty()) {
+                return;
+            }
+            pushBatch(res.getOwned(), fetchOpCtx);
+        }
+    };
+
+    std::vector<stdx::thread> inserterThreads;
+    std::vector<stdx::thread> fetcherThreads;
+    ON_BLOCK_EXIT([&] {
+        batches.closeConsumerEnd();
+        {
+            stdx::lock_guard<stdx::mutex> lk(helpersMutex);
+            helpersStopped = true;
+            for (auto helperOpCtx : helperOpCtxs) {
+                stdx::lock_guard<Client> clientLock(*helperOpCtx->getClient());
+                helperOpCtx->getServiceContext()->killOperation(helperOpCtx,
+                                                                ErrorCodes::Interrupted);
+            }
+        }
+        for (auto& thread : fetcherThreads) {
+            thread.join();
         }
+        for (auto& thread : inserterThreads) {
+            thread.join();
+        }
+    });
+
+    for (int i = 0; i < numInserters; ++i) {
+        inserterThreads.emplace_back(
+            [&, i] { runHelper(str::stream() << "chunkInserter-" << i, insertUntilDrained); });
     }
+    for (int i = 1; i < numFetchers; ++i) {
+        fetcherThreads.emplace_back(
+            [&, i] { runHelper(str::stream() << "chunkFetcher-" << i, fetchUntilDrained); });
+    }
+
+    fetchUntilDrained(opCtx);
+
+    for (auto& thread : fetcherThreads) {
+        thread.join();
+    }
+    fetcherThreads.clear();
+    opCtx->checkForInterrupt();
+
+    // Let the inserters drain what is left in the queue.
+    batches.closeProducerEnd();
+    for (auto& thread : inserterThreads) {
+        thread.join();
+    }
+    inserterThreads.clear();
+    opCtx->checkForInterrupt();
 }
 
 Status MigrationDestinationManager::abort(const MigrationSessionId& sessionId) {
@@ -727,6 +836,27 @@ MONGO_EXPORT_SERVER_PARAMETER(migrateCloneInsertionBatchDelayMS, int, 0)
         return Status::OK();
     });
 
+// The number of _migrateClone requests kept in flight to the donor during migration clone, so
+// the donor reads the next batches while earlier ones are on the wire or being inserted.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneConcurrentFetchers, int, 2)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1 || newVal > 16) {
+            return Status(ErrorCodes::BadValue,
+                          "migrateCloneConcurrentFetchers must be between 1 and 16");
+        }
+        return Status::OK();
+    });
+
+// The number of threads inserting cloned batches in parallel during migration clone.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneConcurrentInserters, int, 4)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1 || newVal > 16) {
+            return Status(ErrorCodes::BadValue,
+                          "migrateCloneConcurrentInserters must be between 1 and 16");
+        }
+        return Status::OK();
+    });
+
 void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx) {
     invariant(isActive());
     invariant(_sessionId);
@@ -869,7 +999,30 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx) {
             return res.response;
         };
 
-        cloneDocumentsFromDonor(opCtx, insertBatchFn, fetchBatchFn);
+        {
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+            _cloneStartTime = Date_t::now();
+        }
+
+        {
+            // Only the bulk clone yields to user operations. Catching up and committing block
+            // writes to the chunk on the donor, so they keep the interactive priority.
+            ScopedOperationPriority priority(opCtx, OperationPriority::kBatch);
+            cloneDocumentsFromDonor(opCtx,
+                                    insertBatchFn,
+                                    fetchBatchFn,
+                                    migrateCloneConcurrentFetchers.load(),
+                                    migrateCloneConcurrentInserters.load());
+        }
+
+        {
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+            _cloneEndTime = Date_t::now();
+        }
+
+        // The documents were inserted by the inserter threads' clients. Make sure waiting for
+        // our last op below also covers them.
+        repl::ReplClientInfo::forClient(opCtx->getClient()).setLastOpToSystemLastOpTime(opCtx);
 
         timing.done(3);
         MONGO_FAIL_POINT_PAUSE_WHILE_SET(migrateThreadHangAtStep3);
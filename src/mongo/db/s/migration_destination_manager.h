@@ -48,6 +48,7 @@
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -110,12 +111,16 @@ public:
                  const WriteConcernOptions& writeConcern);
 
     /**
-     * Clones documents from a donor shard.
+     * Clones documents from a donor shard. 'numFetchers' threads (including the calling one) call
+     * 'fetchBatchFn' until each gets an empty batch, and 'numInserters' threads pass the fetched
+     * batches to 'insertBatchFn' in no particular order.
      */
     static void cloneDocumentsFromDonor(
         OperationContext* opCtx,
         stdx::function<void(OperationContext*, BSONObj)> insertBatchFn,
-        stdx::function<BSONObj(OperationContext*)> fetchBatchFn);
+        stdx::function<BSONObj(OperationContext*)> fetchBatchFn,
+        int numFetchers = 1,
+        int numInserters = 1);
 
     /**
      * Idempotent method, which causes the current ongoing migration to abort only if it has the
@@ -210,6 +215,10 @@ private:
 
     long long _numCloned{0};
     long long _clonedBytes{0};
+
+    // When the initial clone started and finished, for throughput reporting.
+    Date_t _cloneStartTime;
+    Date_t _cloneEndTime;
     long long _numCatchup{0};
     long long _numSteady{0};
 
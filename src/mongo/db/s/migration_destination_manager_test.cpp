@@ -31,8 +31,12 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/s/migration_destination_manager.h"
+
+#include <set>
+
 #include "mongo/s/shard_server_test_fixture.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 namespace {
@@ -106,6 +110,83 @@ TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorWorksCorrectly) {
     }
 }
 
+// Tests that with several fetchers and inserters every fetched document is inserted exactly once.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorWithConcurrentFetchersAndInserters) {
+    const int kNumBatches = 20;
+
+    stdx::mutex mutex;
+    int batchesFetched = 0;
+    std::vector<BSONObj> resultDocs;
+
+    auto fetchBatchFn = [&](OperationContext* opCtx) {
+        BSONArrayBuilder objects;
+        {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            if (batchesFetched < kNumBatches) {
+                objects.append(BSON("_id" << batchesFetched++));
+            }
+        }
+        return BSON("objects" << objects.arr());
+    };
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObj docs) {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        for (auto&& docToClone : docs) {
+            resultDocs.push_back(docToClone.Obj().getOwned());
+        }
+    };
+
+    MigrationDestinationManager::cloneDocumentsFromDonor(
+        operationContext(), insertBatchFn, fetchBatchFn, 3 /* numFetchers */, 4 /* numInserters */);
+
+    std::set<int> ids;
+    for (auto&& doc : resultDocs) {
+        ids.insert(doc["_id"].numberInt());
+    }
+    ASSERT_EQ(static_cast<size_t>(kNumBatches), resultDocs.size());
+    ASSERT_EQ(static_cast<size_t>(kNumBatches), ids.size());
+}
+
+// Tests that several fetchers may block on a full queue at the same time, which happens whenever
+// the inserters are slower than the fetchers.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorWithSlowInserterAndFullQueue) {
+    const int kNumBatches = 20;
+
+    stdx::mutex mutex;
+    int batchesFetched = 0;
+    std::vector<BSONObj> resultDocs;
+
+    auto fetchBatchFn = [&](OperationContext* opCtx) {
+        BSONArrayBuilder objects;
+        {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            if (batchesFetched < kNumBatches) {
+                objects.append(BSON("_id" << batchesFetched++));
+            }
+        }
+        return BSON("objects" << objects.arr());
+    };
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObj docs) {
+        sleepmillis(5);
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        for (auto&& docToClone : docs) {
+            resultDocs.push_back(docToClone.Obj().getOwned());
+        }
+    };
+
+    // A single inserter gives the queue a depth of one batch.
+    MigrationDestinationManager::cloneDocumentsFromDonor(
+        operationContext(), insertBatchFn, fetchBatchFn, 4 /* numFetchers */, 1 /* numInserters */);
+
+    std::set<int> ids;
+    for (auto&& doc : resultDocs) {
+        ids.insert(doc["_id"].numberInt());
+    }
+    ASSERT_EQ(static_cast<size_t>(kNumBatches), resultDocs.size());
+    ASSERT_EQ(static_cast<size_t>(kNumBatches), ids.size());
+}
+
 // Tests that an exception in the fetch logic will successfully throw an exception on the main
 // thread.
 TEST_F(MigrationDestinationManagerTest, CloneDocumentsThrowsFetchErrors) {
@@ -51,6 +51,7 @@
 //#include "mongo/db/repl/oplog_entry_gen.h"
 //#include "mongo/db/repl/replication_coordinator.h"
 ////#include "mongo/db/s/shard_server_op_observer.h"
+#include "mongo/db/s/chunk_splitter.h"
 #include "mongo/db/s/collection_sharding_runtime.h"
 #include "mongo/db/s/migration_source_manager.h"
 //#include "mongo/db/server_options.h"
@@ -60,12 +61,44 @@
 //#include "mongo/scripting/engine.h"
 //#include "mongo/util/assert_util.h"
 //#include "mongo/util/fail_point_service.h"
+#include "mongo/s/shard_key_pattern.h"
 
 namespace mongo {
 namespace {
 const auto getIsMigrating = OperationContext::declareDecoration<bool>();
+
+/**
+ * Samples a write of 'bytesWritten' bytes against the chunk which owns 'doc' into the collection's
+ * chunk heat map and asks for the chunk to be split if it has become too hot.
+ */
+void recordChunkWrite(OperationContext* opCtx,
+                      CollectionShardingRuntime* css,
+                      const NamespaceString& nss,
+                      const BSONObj& doc,
+                      long long bytesWritten) {
+    const int weight = ChunkHeatMap::sampleOperation();
+    if (!weight)
+        return;
+
+    auto metadata = css->getMetadata(opCtx);
+    if (!metadata->isSharded())
+        return;
+
+    const BSONObj shardKey = ShardKeyPattern(metadata->getKeyPattern()).extractShardKeyFromDoc(doc);
+    if (shardKey.isEmpty())
+        return;
+
+    const auto range = ChunkHeatMap::getOwningChunk(*metadata, shardKey);
+    if (!range)
+        return;
+
+    if (css->getChunkHeatMap()->recordWrite(*range, weight, bytesWritten, Date_t::now())) {
+        ChunkSplitter::get(opCtx).trySplittingHotChunk(nss, range->getMin(), range->getMax());
+    }
 }
 
+}  // namespace
+
 bool OpObserverShardingImpl::isMigrating(OperationContext* opCtx,
                                          NamespaceString const& nss,
                                          BSONObj const& docToDelete) {
@@ -94,6 +127,8 @@ void OpObserverShardingImpl::shardObserveInsertOp(OperationContext* opCtx,
         if (msm) {
             msm->getCloner()->onInsertOp(opCtx, insertedDoc, opTime);
         }
+
+        recordChunkWrite(opCtx, css, nss, insertedDoc, insertedDoc.objsize());
     }
 }
 
@@ -108,6 +143,8 @@ void OpObserverShardingImpl::shardObserveUpdateOp(OperationContext* opCtx,
     if (msm) {
         msm->getCloner()->onUpdateOp(opCtx, updatedDoc, opTime, prePostImageOpTime);
     }
+
+    recordChunkWrite(opCtx, css, nss, updatedDoc, updatedDoc.objsize());
 }
 
 void OpObserverShardingImpl::shardObserveDeleteOp(OperationContext* opCtx,
@@ -122,6 +159,8 @@ void OpObserverShardingImpl::shardObserveDeleteOp(OperationContext* opCtx,
     if (msm && isMigrating) {
         msm->getCloner()->onDeleteOp(opCtx, documentKey, opTime, preImageOpTime);
     }
+
+    recordChunkWrite(opCtx, css, nss, documentKey, 0);
 }
 
 }  // namespace mongo
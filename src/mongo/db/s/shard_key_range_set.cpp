@@ -0,0 +1,97 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/shard_key_range_set.h"
+
+#include <algorithm>
+
+#include "mongo/db/storage/key_string.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+ShardKeyRangeSet::ShardKeyRangeSet(const BSONObj& keyPattern, const RangeMap& ranges)
+    : _ordering(Ordering::make(keyPattern)) {
+    for (const auto& range : ranges) {
+        if (!_ranges.empty() && SimpleBSONObjComparator::kInstance.evaluate(
+                                    _ranges.back().second == range.first)) {
+            _ranges.back().second = range.second;
+            _bounds.back() = _extractKeyString(range.second);
+            continue;
+        }
+
+        _ranges.emplace_back(range.first, range.second);
+        _bounds.push_back(_extractKeyString(range.first));
+        _bounds.push_back(_extractKeyString(range.second));
+        invariant(_bounds.size() < 3 || _bounds[_bounds.size() - 3] <= _bounds[_bounds.size() - 2]);
+    }
+}
+
+bool ShardKeyRangeSet::contains(const BSONObj& shardKey, size_t* hint) const {
+    if (shardKey.isEmpty())
+        return false;
+
+    const auto key = _extractKeyString(shardKey);
+
+    size_t pos;
+    if (hint && _inSlot(key, *hint)) {
+        pos = *hint;
+    } else if (hint && _inSlot(key, *hint + 1)) {
+        pos = *hint + 1;
+    } else {
+        pos = std::upper_bound(_bounds.begin(), _bounds.end(), key) - _bounds.begin();
+    }
+
+    if (hint)
+        *hint = pos;
+
+    return pos % 2 == 1;
+}
+
+std::string ShardKeyRangeSet::_extractKeyString(const BSONObj& shardKey) const {
+    BSONObjBuilder strippedKeyValue;
+    for (const auto& elem : shardKey) {
+        strippedKeyValue.appendAs(elem, ""_sd);
+    }
+
+    KeyString ks(KeyString::Version::V1, strippedKeyValue.done(), _ordering);
+    return {ks.getBuffer(), ks.getSize()};
+}
+
+bool ShardKeyRangeSet::_inSlot(const std::string& key, size_t pos) const {
+    if (pos > _bounds.size())
+        return false;
+
+    return (pos == 0 || _bounds[pos - 1] <= key) && (pos == _bounds.size() || key < _bounds[pos]);
+}
+
+}  // namespace mongo
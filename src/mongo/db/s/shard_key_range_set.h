@@ -0,0 +1,93 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/ordering.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/range_arithmetic.h"
+
+namespace mongo {
+
+/**
+ * An immutable set of disjoint ranges of shard key values, such as the ranges owned by one shard,
+ * with adjacent ranges merged. The bounds are kept KeyString-encoded in a single sorted array, so
+ * testing a key for membership is a binary search over the shard's own ranges instead of a lookup
+ * in the routing table of the whole collection.
+ *
+ * Lookups may carry a hint, which remembers where the previous key fell. A caller testing keys in
+ * shard key order, as a collection or index scan over a clustered or shard-key-prefixed layout
+ * does, pays for one or two comparisons per key rather than for a search.
+ */
+class ShardKeyRangeSet {
+public:
+    /**
+     * Builds the set from 'ranges', which map inclusive lower bounds to exclusive upper bounds of
+     * the shard key described by 'keyPattern' and must not overlap.
+     */
+    ShardKeyRangeSet(const BSONObj& keyPattern, const RangeMap& ranges);
+
+    /**
+     * Returns whether 'shardKey' falls in one of the ranges. An empty key is never contained.
+     *
+     * If 'hint' is not null, it must point to zero or to the value left there by the previous call
+     * on the same set, and it is updated to the position of 'shardKey'.
+     */
+    bool contains(const BSONObj& shardKey, size_t* hint = nullptr) const;
+
+    /**
+     * Returns the merged ranges in ascending order.
+     */
+    const std::vector<std::pair<BSONObj, BSONObj>>& getRanges() const {
+        return _ranges;
+    }
+
+private:
+    std::string _extractKeyString(const BSONObj& shardKey) const;
+
+    // Returns whether 'key' sorts in the slot of '_bounds' just before the bound at 'pos', that is
+    // at or after _bounds[pos - 1] and before _bounds[pos].
+    bool _inSlot(const std::string& key, size_t pos) const;
+
+    const Ordering _ordering;
+
+    // The merged ranges, as they were given.
+    std::vector<std::pair<BSONObj, BSONObj>> _ranges;
+
+    // The bounds of '_ranges' flattened into one ascending array, so that range 'i' spans
+    // [_bounds[2 * i], _bounds[2 * i + 1]). A key is contained if and only if the number of bounds
+    // less than or equal to it is odd.
+    std::vector<std::string> _bounds;
+};
+
+}  // namespace mongo
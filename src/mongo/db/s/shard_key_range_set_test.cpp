@@ -0,0 +1,103 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/shard_key_range_set.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+RangeMap makeRanges(const std::vector<std::pair<BSONObj, BSONObj>>& ranges) {
+    RangeMap map(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<BSONObj>());
+    for (const auto& range : ranges) {
+        map.emplace(range.first, range.second);
+    }
+    return map;
+}
+
+TEST(ShardKeyRangeSetTest, EmptySetContainsNothing) {
+    ShardKeyRangeSet set(BSON("a" << 1), makeRanges({}));
+    ASSERT(set.getRanges().empty());
+    ASSERT_FALSE(set.contains(BSON("a" << 0)));
+    ASSERT_FALSE(set.contains(BSON("a" << MINKEY)));
+}
+
+TEST(ShardKeyRangeSetTest, BoundsAreInclusiveExclusive) {
+    ShardKeyRangeSet set(BSON("a" << 1),
+                         makeRanges({{BSON("a" << 10), BSON("a" << 20)},
+                                     {BSON("a" << 30), BSON("a" << MAXKEY)}}));
+    ASSERT_FALSE(set.contains(BSON("a" << MINKEY)));
+    ASSERT_FALSE(set.contains(BSON("a" << 5)));
+    ASSERT(set.contains(BSON("a" << 10)));
+    ASSERT(set.contains(BSON("a" << 15)));
+    ASSERT_FALSE(set.contains(BSON("a" << 20)));
+    ASSERT_FALSE(set.contains(BSON("a" << 25)));
+    ASSERT(set.contains(BSON("a" << 30)));
+    ASSERT(set.contains(BSON("a" << "string")));
+    ASSERT_FALSE(set.contains(BSONObj()));
+}
+
+TEST(ShardKeyRangeSetTest, AdjacentRangesAreMerged) {
+    ShardKeyRangeSet set(BSON("a" << 1 << "b" << 1),
+                         makeRanges({{BSON("a" << 0 << "b" << 0), BSON("a" << 1 << "b" << 0)},
+                                     {BSON("a" << 1 << "b" << 0), BSON("a" << 2 << "b" << 0)},
+                                     {BSON("a" << 3 << "b" << 0), BSON("a" << 4 << "b" << 0)}}));
+    ASSERT_EQ(2U, set.getRanges().size());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 0 << "b" << 0), set.getRanges()[0].first);
+    ASSERT_BSONOBJ_EQ(BSON("a" << 2 << "b" << 0), set.getRanges()[0].second);
+    ASSERT(set.contains(BSON("a" << 1 << "b" << 0)));
+    ASSERT(set.contains(BSON("a" << 1 << "b" << -5)));
+    ASSERT_FALSE(set.contains(BSON("a" << 2 << "b" << 0)));
+}
+
+TEST(ShardKeyRangeSetTest, HintedLookupsMatchUnhintedLookups) {
+    ShardKeyRangeSet set(BSON("a" << 1),
+                         makeRanges({{BSON("a" << 10), BSON("a" << 20)},
+                                     {BSON("a" << 30), BSON("a" << 40)},
+                                     {BSON("a" << 50), BSON("a" << 60)}}));
+
+    // Ascending, descending and scattered orders all have to give the same answers.
+    size_t hint = 0;
+    for (int i = 0; i < 70; ++i) {
+        ASSERT_EQ(set.contains(BSON("a" << i)), set.contains(BSON("a" << i), &hint)) << i;
+    }
+    for (int i = 70; i >= 0; --i) {
+        ASSERT_EQ(set.contains(BSON("a" << i)), set.contains(BSON("a" << i), &hint)) << i;
+    }
+    for (int i = 0; i < 70; ++i) {
+        const int key = (i * 37) % 70;
+        ASSERT_EQ(set.contains(BSON("a" << key)), set.contains(BSON("a" << key), &hint)) << key;
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -339,7 +339,8 @@ void ShardServerOpObserver::onDelete(OperationContext* opCtx,
                                      OptionalCollectionUUID uuid,
                                      StmtId stmtId,
                                      bool fromMigrate,
-                                     const boost::optional<BSONObj>& deletedDoc) {
+                                     const boost::optional<BSONObj>& deletedDoc,
+                                     const OplogSlot& oplogSlot) {
     auto& documentKey = getDocumentKey(opCtx);
 
     if (nss == NamespaceString::kShardConfigCollectionsNamespace) {
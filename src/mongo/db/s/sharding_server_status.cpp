@@ -33,6 +33,7 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/s/active_migrations_registry.h"
+#include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/s/sharding_statistics.h"
 #include "mongo/s/balancer_configuration.h"
@@ -117,5 +118,36 @@ public:
 
 } shardingStatisticsServerStatus;
 
+/**
+ * Reports the sampled load on the hottest chunks of each sharded collection. Not included by
+ * default, because it is only of interest to the balancer, which asks for it explicitly.
+ */
+class ChunkHeatServerStatus final : public ServerStatusSection {
+public:
+    ChunkHeatServerStatus() : ServerStatusSection("chunkHeat") {}
+
+    bool includeByDefault() const override {
+        return false;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        if (!isClusterNode())
+            return {};
+
+        auto const shardingState = ShardingState::get(opCtx);
+        if (!shardingState->enabled())
+            return {};
+
+        // Only the hottest chunks are of any use for balancing, so bound the size of the report
+        const size_t kMaxChunksPerCollection = 20;
+
+        BSONObjBuilder result;
+        CollectionShardingState::reportChunkHeat(opCtx, kMaxChunksPerCollection, &result);
+        return result.obj();
+    }
+
+} chunkHeatServerStatus;
+
 }  // namespace
 }  // namespace mongo
@@ -45,6 +45,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -52,10 +53,23 @@ namespace {
 
 const int kMaxObjectPerChunk{250000};
 
+// The fewest sampled documents that must fall in the chunk for splitVectorSampled() to trust its
+// estimates instead of scanning the chunk.
+const size_t kMinSampledKeysInChunk{20};
+
+// The most split points splitVectorSampled() looks for when it falls back to scanning the chunk,
+// so that the scan stops after this many chunks' worth of keys. A chunk which the auto-splitter
+// picks normally yields two, and whatever is left over is split once it grows again.
+const long long kMaxFallbackSplitPoints{4};
+
 BSONObj prettyKey(const BSONObj& keyPattern, const BSONObj& key) {
     return key.replaceFieldNames(keyPattern).clientReadable();
 }
 
+bool isKeyInRange(const BSONObj& key, const BSONObj& min, const BSONObj& max) {
+    return key.woCompare(min) >= 0 && (max.isEmpty() || key.woCompare(max) < 0);
+}
+
 }  // namespace
 
 StatusWith<std::vector<BSONObj>> splitVector(OperationContext* opCtx,
@@ -308,4 +322,167 @@ StatusWith<std::vector<BSONObj>> splitVector(OperationContext* opCtx,
     return splitKeys;
 }
 
+StatusWith<std::vector<BSONObj>> splitVectorSampled(OperationContext* opCtx,
+                                                    const NamespaceString& nss,
+                                                    const BSONObj& keyPattern,
+                                                    const BSONObj& min,
+                                                    const BSONObj& max,
+                                                    bool force,
+                                                    boost::optional<long long> maxSplitPoints,
+                                                    long long maxChunkSizeBytes,
+                                                    long long sampleSize) {
+    invariant(sampleSize > 0);
+
+    {
+        AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+
+        Collection* const collection = autoColl.getCollection();
+        if (!collection) {
+            return {ErrorCodes::NamespaceNotFound, "ns not found"};
+        }
+
+        const long long recCount = collection->numRecords(opCtx);
+        const long long dataSize = collection->dataSize(opCtx);
+
+        // Same as in splitVector(), forcing a split makes the whole collection a single chunk's
+        // worth of data, and the chunk is then split in half.
+        const long long maxChunkSize = force ? dataSize : maxChunkSizeBytes;
+        if (maxChunkSize <= 0 && recCount != 0) {
+            return {ErrorCodes::InvalidOptions, "need to specify the desired max chunk size"};
+        }
+
+        if (dataSize < maxChunkSize || recCount == 0) {
+            return std::vector<BSONObj>();
+        }
+
+        auto cursor = collection->getRecordStore()->getRandomCursor(opCtx);
+        if (cursor) {
+            Timer timer;
+            const ShardKeyPattern shardKeyPattern(keyPattern);
+
+            // The chunk is about to be split, so it holds around a chunk's worth of the
+            // collection's data. Draw enough documents for about 'sampleSize' of them to fall in
+            // the chunk, but never more than there are documents in the collection.
+            const double expectedChunkShare = maxChunkSizeBytes > 0
+                ? std::min(1.0, static_cast<double>(maxChunkSizeBytes) / dataSize)
+                : 1.0;
+            const long long maxNumSampled = std::max(
+                sampleSize,
+                std::min(recCount, static_cast<long long>(sampleSize / expectedChunkShare)));
+
+            long long numSampled = 0;
+            std::vector<BSONObj> sampledKeys;
+            while (numSampled < maxNumSampled &&
+                   static_cast<long long>(sampledKeys.size()) < sampleSize) {
+                auto record = cursor->next();
+                if (!record) {
+                    break;
+                }
+                ++numSampled;
+
+                const BSONObj key = shardKeyPattern.extractShardKeyFromDoc(record->data.toBson());
+                if (!key.isEmpty() && isKeyInRange(key, min, max)) {
+                    sampledKeys.push_back(key.getOwned());
+                }
+            }
+
+            if (sampledKeys.size() >= kMinSampledKeysInChunk) {
+                std::sort(sampledKeys.begin(),
+                          sampledKeys.end(),
+                          SimpleBSONObjComparator::kInstance.makeLessThan());
+
+                const long long estimatedChunkDocs =
+                    recCount * static_cast<double>(sampledKeys.size()) / numSampled;
+
+                long long keyCount;
+                if (force) {
+                    keyCount = estimatedChunkDocs / 2;
+                    maxSplitPoints = 1;
+                } else {
+                    keyCount = std::min<long long>(maxChunkSize / (2 * (dataSize / recCount)),
+                                                   kMaxObjectPerChunk);
+                }
+
+                auto splitKeys = pickSampledSplitPoints(
+                    sampledKeys, estimatedChunkDocs, std::max(keyCount, 1LL), maxSplitPoints);
+
+                if (splitKeys.empty() && SimpleBSONObjComparator::kInstance.evaluate(
+                                             sampledKeys.front() == sampledKeys.back())) {
+                    warning() << "possible low cardinality key detected in " << nss.toString()
+                              << " - range " << redact(min) << " -->> " << redact(max)
+                              << " appears to contain only the key "
+                              << redact(sampledKeys.front());
+                }
+
+                LOG(1) << "sampled " << numSampled << " documents of " << nss.toString()
+                       << " to estimate " << estimatedChunkDocs << " documents in chunk "
+                       << redact(min) << " -->> " << redact(max) << " and pick "
+                       << splitKeys.size() << " split points, took " << timer.millis() << "ms";
+
+                return splitKeys;
+            }
+        }
+    }
+
+    LOG(1) << "too few sampled documents of " << nss.toString() << " fall in chunk "
+           << redact(min) << " -->> " << redact(max) << ", scanning it to find split points";
+
+    if (!maxSplitPoints || !maxSplitPoints.get() ||
+        maxSplitPoints.get() > kMaxFallbackSplitPoints) {
+        maxSplitPoints = kMaxFallbackSplitPoints;
+    }
+
+    return splitVector(opCtx,
+                       nss,
+                       keyPattern,
+                       min,
+                       max,
+                       force,
+                       maxSplitPoints,
+                       boost::none,
+                       boost::none,
+                       maxChunkSizeBytes);
+}
+
+std::vector<BSONObj> pickSampledSplitPoints(const std::vector<BSONObj>& sampledKeys,
+                                            long long estimatedChunkDocs,
+                                            long long keyCount,
+                                            boost::optional<long long> maxSplitPoints) {
+    invariant(keyCount > 0);
+
+    std::vector<BSONObj> splitKeys;
+    if (sampledKeys.empty() || estimatedChunkDocs <= 0) {
+        return splitKeys;
+    }
+
+    // Every sampled key stands for the same number of documents in the chunk, so a chunk of
+    // 'keyCount' documents spans 'stride' consecutive sampled keys.
+    const double stride =
+        std::max(1.0, static_cast<double>(keyCount) * sampledKeys.size() / estimatedChunkDocs);
+
+    const auto& comparator = SimpleBSONObjComparator::kInstance;
+    const BSONObj* previous = &sampledKeys.front();
+    double next = stride;
+    while (next < sampledKeys.size()) {
+        size_t i = static_cast<size_t>(next);
+        while (i < sampledKeys.size() && comparator.evaluate(sampledKeys[i] == *previous)) {
+            ++i;
+        }
+        if (i == sampledKeys.size()) {
+            break;
+        }
+
+        splitKeys.push_back(sampledKeys[i]);
+        if (maxSplitPoints && maxSplitPoints.get() &&
+            static_cast<long long>(splitKeys.size()) >= maxSplitPoints.get()) {
+            break;
+        }
+
+        previous = &sampledKeys[i];
+        next = i + stride;
+    }
+
+    return splitKeys;
+}
+
 }  // namespace mongo
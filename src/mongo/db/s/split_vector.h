@@ -68,4 +68,40 @@ StatusWith<std::vector<BSONObj>> splitVector(OperationContext* opCtx,
                                              boost::optional<long long> maxChunkSize,
                                              boost::optional<long long> maxChunkSizeBytes);
 
+/**
+ * Approximate version of splitVector() which does not walk the shard key index over the chunk.
+ * Instead it draws random documents from the collection until 'sampleSize' of them fall in the
+ * chunk, estimates the number of documents in the chunk from the fraction of them that do, and
+ * picks the split points from the quantiles of the sampled shard keys. Since the chunk is
+ * expected to hold about 'maxChunkSizeBytes' of data, the number of documents drawn is scaled by
+ * the share of the collection that this represents, and is at most the number of documents in
+ * the collection.
+ *
+ * Falls back to splitVector() if the storage engine has no random cursors, or if too few of the
+ * sampled documents fall in the chunk for the quantiles to be meaningful. The fallback stops
+ * scanning once it has found a few split points rather than scanning the whole chunk.
+ */
+StatusWith<std::vector<BSONObj>> splitVectorSampled(OperationContext* opCtx,
+                                                    const NamespaceString& nss,
+                                                    const BSONObj& keyPattern,
+                                                    const BSONObj& min,
+                                                    const BSONObj& max,
+                                                    bool force,
+                                                    boost::optional<long long> maxSplitPoints,
+                                                    long long maxChunkSizeBytes,
+                                                    long long sampleSize);
+
+/**
+ * Picks split points from 'sampledKeys', the sorted shard keys of a uniform sample of the
+ * documents in a chunk that holds about 'estimatedChunkDocs' documents, so that each resulting
+ * chunk holds about 'keyCount' documents. A key equal to the lowest sampled key or to the previous
+ * split point is never used, so all the documents with one key value stay in the same chunk.
+ *
+ * Exposed for unit testing.
+ */
+std::vector<BSONObj> pickSampledSplitPoints(const std::vector<BSONObj>& sampledKeys,
+                                            long long estimatedChunkDocs,
+                                            long long keyCount,
+                                            boost::optional<long long> maxSplitPoints);
+
 }  // namespace mongo
@@ -257,6 +257,98 @@ TEST_F(SplitVectorTest, MaxChunkSizeSpecified) {
     ASSERT_EQ(splitKeys.size(), 0UL);
 }
 
+TEST_F(SplitVectorTest, SampledFallsBackToScanWithoutRandomCursor) {
+    // The record store used by this fixture has no random cursors, so the result must be the same
+    // as in SplitVectorInHalf.
+    std::vector<BSONObj> splitKeys =
+        unittest::assertGet(splitVectorSampled(operationContext(),
+                                               kNss,
+                                               BSON(kPattern << 1),
+                                               BSON(kPattern << 0),
+                                               BSON(kPattern << 100),
+                                               false,
+                                               boost::none,
+                                               getDocSizeBytes() * 100LL,
+                                               1000));
+    ASSERT_EQ(splitKeys.size(), 1UL);
+    ASSERT_BSONOBJ_EQ(splitKeys.front(), BSON(kPattern << 50));
+}
+
+TEST_F(SplitVectorTest, SampledFallbackStopsAfterFewSplitPoints) {
+    // With chunks of ten documents, a full scan of the 100 documents finds many split points. The
+    // fallback scan stops early, after finding the same first few.
+    const std::vector<BSONObj> allSplitKeys =
+        unittest::assertGet(splitVector(operationContext(),
+                                        kNss,
+                                        BSON(kPattern << 1),
+                                        BSON(kPattern << 0),
+                                        BSON(kPattern << 100),
+                                        false,
+                                        boost::none,
+                                        boost::none,
+                                        boost::none,
+                                        getDocSizeBytes() * 10LL));
+
+    std::vector<BSONObj> splitKeys =
+        unittest::assertGet(splitVectorSampled(operationContext(),
+                                               kNss,
+                                               BSON(kPattern << 1),
+                                               BSON(kPattern << 0),
+                                               BSON(kPattern << 100),
+                                               false,
+                                               boost::none,
+                                               getDocSizeBytes() * 10LL,
+                                               1000));
+    ASSERT_GT(splitKeys.size(), 0UL);
+    ASSERT_LT(splitKeys.size(), allSplitKeys.size());
+    for (size_t i = 0; i < splitKeys.size(); i++) {
+        ASSERT_BSONOBJ_EQ(splitKeys[i], allSplitKeys[i]);
+    }
+}
+
+TEST(PickSampledSplitPointsTest, EvenlySpacedQuantiles) {
+    // 100 sampled keys, each standing for 10 of the 1000 documents in the chunk.
+    std::vector<BSONObj> sampledKeys;
+    for (int i = 0; i < 100; i++) {
+        sampledKeys.push_back(BSON(kPattern << i));
+    }
+
+    auto splitKeys = pickSampledSplitPoints(sampledKeys, 1000, 250, boost::none);
+    ASSERT_EQ(splitKeys.size(), 3UL);
+    ASSERT_BSONOBJ_EQ(splitKeys[0], BSON(kPattern << 25));
+    ASSERT_BSONOBJ_EQ(splitKeys[1], BSON(kPattern << 50));
+    ASSERT_BSONOBJ_EQ(splitKeys[2], BSON(kPattern << 75));
+
+    splitKeys = pickSampledSplitPoints(sampledKeys, 1000, 250, 2LL);
+    ASSERT_EQ(splitKeys.size(), 2UL);
+
+    ASSERT_EQ(pickSampledSplitPoints(sampledKeys, 1000, 1000, boost::none).size(), 0UL);
+}
+
+TEST(PickSampledSplitPointsTest, SkipsRepeatedKeys) {
+    // Keys 0 and 1 each make up 40% of the sample, and 2 through 21 the rest.
+    std::vector<BSONObj> sampledKeys;
+    for (int i = 0; i < 40; i++) {
+        sampledKeys.push_back(BSON(kPattern << 0));
+    }
+    for (int i = 0; i < 40; i++) {
+        sampledKeys.push_back(BSON(kPattern << 1));
+    }
+    for (int i = 2; i < 22; i++) {
+        sampledKeys.push_back(BSON(kPattern << i));
+    }
+
+    // Every 20th key would be a split point, but a repeated key moves the split point past all
+    // of its copies.
+    auto splitKeys = pickSampledSplitPoints(sampledKeys, 100, 20, boost::none);
+    ASSERT_EQ(splitKeys.size(), 2UL);
+    ASSERT_BSONOBJ_EQ(splitKeys[0], BSON(kPattern << 1));
+    ASSERT_BSONOBJ_EQ(splitKeys[1], BSON(kPattern << 2));
+
+    const std::vector<BSONObj> singleKey(50, BSON(kPattern << 7));
+    ASSERT_EQ(pickSampledSplitPoints(singleKey, 50, 10, boost::none).size(), 0UL);
+}
+
 TEST_F(SplitVectorTest, NoCollection) {
     auto status = splitVector(operationContext(),
                               NamespaceString("dummy", "collection"),
@@ -36,6 +36,7 @@
 
 #include "mongo/base/init.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/db/catalog/util/thread_cached_snapshot.h"
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/locker_noop.h"
 #include "mongo/db/op_observer.h"
@@ -272,6 +273,7 @@ void ServiceContext::OperationContextDeleter::operator()(OperationContext* opCtx
     }
     onDestroy(opCtx, service->_clientObservers);
     delete opCtx;
+    releaseThreadCachedSnapshots();
 }
 
 void ServiceContext::registerClientObserver(std::unique_ptr<ClientObserver> observer) {
@@ -67,6 +67,7 @@
 #include "mongo/db/s/operation_sharding_state.h"
 #include "mongo/db/s/sharded_connection_info.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_entry_point_common.h"
 #include "mongo/db/session_catalog.h"
 #include "mongo/db/stats/counters.h"
@@ -99,6 +100,11 @@ MONGO_FAIL_POINT_DEFINE(skipCheckingForNotMasterInCommandDispatch);
 namespace {
 using logger::LogComponent;
 
+// Whether a secondary checks the shard version sent with a read which does not specify a read
+// concern level, and so filters out orphaned documents as a primary does. By default such reads
+// keep their historical behaviour of returning whatever documents the secondary holds.
+MONGO_EXPORT_SERVER_PARAMETER(filterOrphansOnSecondaryReads, bool, false);
+
 // The command names for which to check out a session. These are commands that support retryable
 // writes, readConcern snapshot, or multi-statement transactions. We additionally check out the
 // session for commands that can take a lock and then run another whitelisted command in
@@ -876,8 +882,9 @@ void execCommandDatabase(OperationContext* opCtx,
 
         if (!opCtx->getClient()->isInDirectClient() &&
             readConcernArgs.getLevel() != repl::ReadConcernLevel::kAvailableReadConcern &&
-            (iAmPrimary ||
-             (readConcernArgs.hasLevel() || readConcernArgs.getArgsAfterClusterTime()))) {
+            (iAmPrimary || readConcernArgs.hasLevel() ||
+             readConcernArgs.getArgsAfterClusterTime() ||
+             filterOrphansOnSecondaryReads.load())) {
             oss.initializeClientRoutingVersions(invocation->ns(), request.body);
 
             auto const shardingState = ShardingState::get(opCtx);
@@ -93,6 +93,11 @@ public:
             activeClientsBuilder.done();
         }
 
+        {
+            BSONObjBuilder waitsByPriorityBuilder(ret.subobjStart("waitsByPriority"));
+            reportLockWaitsByPriority(&waitsByPriorityBuilder);
+        }
+
         ret.done();
 
         return ret.obj();
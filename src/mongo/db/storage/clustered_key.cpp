@@ -0,0 +1,146 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/clustered_key.h"
+
+#include <cmath>
+#include <limits>
+
+#include "mongo/bson/bson_validate.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/util/debug_util.h"
+
+namespace mongo {
+namespace clusteredkey {
+
+namespace {
+
+// _id values are shifted up by one so that an _id of 0 does not map to the null RecordId.
+const long long kMaxId = RecordId::max().repr() - 2;
+
+StatusWith<RecordId> badId() {
+    return StatusWith<RecordId>(
+        ErrorCodes::BadValue,
+        str::stream() << "_id of a document in a clustered collection must be an integer "
+                      << "between 0 and "
+                      << kMaxId
+                      << ", so ObjectId _id values, including the one generated for a document "
+                      << "inserted without an _id, are not supported");
+}
+
+}  // namespace
+
+StatusWith<RecordId> keyForId(const BSONElement& id) {
+    long long value;
+    switch (id.type()) {
+        case NumberInt:
+            value = id._numberInt();
+            break;
+        case NumberLong:
+            value = id._numberLong();
+            break;
+        case NumberDouble: {
+            const double d = id._numberDouble();
+            // Doubles at or above 2^63 cannot be converted without overflow, and everything
+            // above kMaxId is rejected below anyway.
+            if (!(d >= 0 && d < 9223372036854775808.0) || std::trunc(d) != d)
+                return badId();
+            value = static_cast<long long>(d);
+            break;
+        }
+        default:
+            return badId();
+    }
+
+    return keyForIdValue(value);
+}
+
+StatusWith<RecordId> keyForIdValue(long long id) {
+    if (id < 0 || id > kMaxId)
+        return badId();
+
+    return StatusWith<RecordId>(RecordId(id + 1));
+}
+
+RecordId lowestKeyAtOrAbove(const BSONElement& bound) {
+    if (!bound.isNumber()) {
+        // Every _id is a number, so 'bound' sorts either before all of them or after all of them.
+        return bound.canonicalType() < canonicalizeBSONType(NumberDouble) ? RecordId(1)
+                                                                          : RecordId::max();
+    }
+
+    long long lowest;
+    switch (bound.type()) {
+        case NumberDouble: {
+            const double d = bound._numberDouble();
+            // NaN sorts before every other number.
+            if (std::isnan(d) || d <= 0)
+                return RecordId(1);
+            const double ceiling = std::ceil(d);
+            if (ceiling >= 9223372036854775808.0)
+                return RecordId::max();
+            lowest = static_cast<long long>(ceiling);
+            break;
+        }
+        case NumberDecimal: {
+            const Decimal128 dec = bound._numberDecimal();
+            if (dec.isNaN() || dec.isNegative())
+                return RecordId(1);
+            if (dec.isGreater(Decimal128(static_cast<std::int64_t>(kMaxId))))
+                return RecordId::max();
+            lowest = dec.toLong(Decimal128::kRoundTowardPositive);
+            break;
+        }
+        default:
+            lowest = bound.numberLong();
+            break;
+    }
+
+    if (lowest > kMaxId)
+        return RecordId::max();
+    return RecordId(std::max(lowest, 0LL) + 1);
+}
+
+StatusWith<RecordId> extractKey(const char* data, int len) {
+    DEV invariant(validateBSON(data, len, BSONVersion::kLatest).isOK());
+
+    const BSONObj obj(data);
+    const BSONElement elem = obj["_id"];
+    if (elem.eoo())
+        return StatusWith<RecordId>(ErrorCodes::BadValue, "no _id field");
+
+    return keyForId(elem);
+}
+
+}  // namespace clusteredkey
+}  // namespace mongo
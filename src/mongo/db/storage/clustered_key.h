@@ -0,0 +1,66 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/status_with.h"
+
+namespace mongo {
+class BSONElement;
+class RecordId;
+
+namespace clusteredkey {
+
+/**
+ * Converts the _id of a document in a clustered collection to the RecordId it is stored under.
+ * Numerically equal _id values of different numeric types map to the same RecordId, and the
+ * mapping preserves numeric order. Fails unless 'id' is a non-negative integral number.
+ */
+StatusWith<RecordId> keyForId(const BSONElement& id);
+
+/**
+ * Same as keyForId(), for an _id whose integral value is already known.
+ */
+StatusWith<RecordId> keyForIdValue(long long id);
+
+/**
+ * Returns the smallest RecordId that a document whose _id is at or above 'bound' in BSON order
+ * can be stored under, or RecordId::max() if there is none. 'bound' may be of any type, such as
+ * the MinKey or MaxKey ends of a chunk range.
+ */
+RecordId lowestKeyAtOrAbove(const BSONElement& bound);
+
+/**
+ * data and len must be the arguments from RecordStore::insert() on a clustered collection.
+ */
+StatusWith<RecordId> extractKey(const char* data, int len);
+
+}  // namespace clusteredkey
+}  // namespace mongo
@@ -0,0 +1,104 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/clustered_key.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+RecordId keyFor(const BSONObj& doc) {
+    return unittest::assertGet(clusteredkey::keyForId(doc["_id"]));
+}
+
+TEST(ClusteredKeyTest, NumericTypesMapToSameKey) {
+    ASSERT_EQ(keyFor(BSON("_id" << 7)), keyFor(BSON("_id" << 7LL)));
+    ASSERT_EQ(keyFor(BSON("_id" << 7)), keyFor(BSON("_id" << 7.0)));
+}
+
+TEST(ClusteredKeyTest, PreservesOrderAndAvoidsNullRecordId) {
+    const RecordId zero = keyFor(BSON("_id" << 0));
+    ASSERT_FALSE(zero.isNull());
+    ASSERT_TRUE(zero.isNormal());
+    ASSERT_LT(zero, keyFor(BSON("_id" << 1)));
+    ASSERT_LT(keyFor(BSON("_id" << 1)), keyFor(BSON("_id" << 1000000000000LL)));
+    ASSERT_TRUE(keyFor(BSON("_id" << std::numeric_limits<long long>::max() - 2)).isNormal());
+}
+
+TEST(ClusteredKeyTest, RejectsUnsupportedIds) {
+    ASSERT_NOT_OK(clusteredkey::keyForId(BSON("_id" << -1)["_id"]));
+    ASSERT_NOT_OK(clusteredkey::keyForId(BSON("_id" << 1.5)["_id"]));
+    ASSERT_NOT_OK(clusteredkey::keyForId(BSON("_id"
+                                              << "abc")["_id"]));
+    ASSERT_NOT_OK(clusteredkey::keyForId(BSON("_id" << OID::gen())["_id"]));
+    ASSERT_NOT_OK(clusteredkey::keyForId(
+        BSON("_id" << std::numeric_limits<long long>::max())["_id"]));
+    ASSERT_NOT_OK(clusteredkey::keyForId(BSON("_id" << 1e19)["_id"]));
+}
+
+TEST(ClusteredKeyTest, LowestKeyAtOrAboveBound) {
+    const auto lowest = [](const BSONObj& bound) {
+        return clusteredkey::lowestKeyAtOrAbove(bound.firstElement());
+    };
+
+    ASSERT_EQ(lowest(BSON("" << 7)), keyFor(BSON("_id" << 7)));
+    ASSERT_EQ(lowest(BSON("" << 6.5)), keyFor(BSON("_id" << 7)));
+    ASSERT_EQ(lowest(BSON("" << Decimal128("6.5"))), keyFor(BSON("_id" << 7)));
+    ASSERT_EQ(lowest(BSON("" << -3)), keyFor(BSON("_id" << 0)));
+    ASSERT_EQ(lowest(BSON("" << MINKEY)), keyFor(BSON("_id" << 0)));
+    ASSERT_EQ(lowest(BSONObjBuilder().appendNull("").obj()), keyFor(BSON("_id" << 0)));
+    ASSERT_EQ(lowest(BSON("" << MAXKEY)), RecordId::max());
+    ASSERT_EQ(lowest(BSON(""
+                          << "abc")),
+              RecordId::max());
+    ASSERT_EQ(lowest(BSON("" << 1e19)), RecordId::max());
+}
+
+TEST(ClusteredKeyTest, ExtractKeyRequiresId) {
+    const BSONObj noId = BSON("x" << 1);
+    ASSERT_NOT_OK(clusteredkey::extractKey(noId.objdata(), noId.objsize()));
+
+    // The _id generated for a document inserted without one is an ObjectId.
+    const BSONObj generatedId = BSON("_id" << OID::gen() << "x" << 1);
+    ASSERT_EQ(clusteredkey::extractKey(generatedId.objdata(), generatedId.objsize()).getStatus(),
+              ErrorCodes::BadValue);
+
+    const BSONObj doc = BSON("_id" << 42 << "x" << 1);
+    ASSERT_EQ(unittest::assertGet(clusteredkey::extractKey(doc.objdata(), doc.objsize())),
+              keyFor(doc));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -37,6 +37,7 @@
 #include "mongo/db/storage/key_string.h"
 
 #include <cmath>
+#include <limits>
 #include <type_traits>
 
 #include "mongo/base/data_view.h"
@@ -2037,14 +2038,16 @@ size_t KeyString::getKeySize(const char* buffer,
     return (len - (remainingBytes - 1));
 }
 
-BSONObj KeyString::toBsonSafe(const char* buffer,
-                              size_t len,
-                              Ordering ord,
-                              const TypeBits& typeBits) {
+namespace {
+BSONObj toBsonFields(const char* buffer,
+                     size_t len,
+                     Ordering ord,
+                     const KeyString::TypeBits& typeBits,
+                     size_t maxFields) {
     BSONObjBuilder builder;
     BufReader reader(buffer, len);
-    TypeBits::Reader typeBitsReader(typeBits);
-    for (int i = 0; reader.remaining(); i++) {
+    KeyString::TypeBits::Reader typeBitsReader(typeBits);
+    for (size_t i = 0; i < maxFields && reader.remaining(); i++) {
         const bool invert = (ord.get(i) == -1);
         uint8_t ctype = readType<uint8_t>(&reader, invert);
         if (ctype == kLess || ctype == kGreater) {
@@ -2061,6 +2064,22 @@ BSONObj KeyString::toBsonSafe(const char* buffer,
     }
     return builder.obj();
 }
+}  // namespace
+
+BSONObj KeyString::toBsonSafe(const char* buffer,
+                              size_t len,
+                              Ordering ord,
+                              const TypeBits& typeBits) {
+    return toBsonFields(buffer, len, ord, typeBits, std::numeric_limits<size_t>::max());
+}
+
+BSONObj KeyString::toBsonPrefix(const char* buffer,
+                                size_t len,
+                                Ordering ord,
+                                const TypeBits& typeBits,
+                                size_t numFields) noexcept {
+    return toBsonFields(buffer, len, ord, typeBits, numFields);
+}
 
 BSONObj KeyString::toBson(const char* buffer,
                           size_t len,
@@ -2074,14 +2093,18 @@ BSONObj KeyString::toBson(StringData data, Ordering ord, const TypeBits& typeBit
 }
 
 RecordId KeyString::decodeRecordIdAtEnd(const void* bufferRaw, size_t bufSize) {
+    const size_t ridStart = sizeWithoutRecordIdAtEnd(bufferRaw, bufSize);
+    BufReader reader(static_cast<const char*>(bufferRaw) + ridStart, bufSize - ridStart);
+    return decodeRecordId(&reader);
+}
+
+size_t KeyString::sizeWithoutRecordIdAtEnd(const void* bufferRaw, size_t bufSize) {
     invariant(bufSize >= 2);  // smallest possible encoding of a RecordId.
     const unsigned char* buffer = static_cast<const unsigned char*>(bufferRaw);
     const unsigned char lastByte = *(buffer + bufSize - 1);
     const size_t ridSize = 2 + (lastByte & 0x7);  // stored in low 3 bits.
     invariant(bufSize >= ridSize);
-    const unsigned char* firstBytePtr = buffer + bufSize - ridSize;
-    BufReader reader(firstBytePtr, ridSize);
-    return decodeRecordId(&reader);
+    return bufSize - ridSize;
 }
 
 RecordId KeyString::decodeRecordId(BufReader* reader) {
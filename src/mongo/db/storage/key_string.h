@@ -315,11 +315,26 @@ public:
                           const TypeBits& types) noexcept;
     static BSONObj toBsonSafe(const char* buffer, size_t len, Ordering ord, const TypeBits& types);
 
+    /**
+     * Like toBson(), but decodes only the first 'numFields' fields of the key. The bytes and type
+     * bits of the remaining fields are not read.
+     */
+    static BSONObj toBsonPrefix(const char* buffer,
+                                size_t len,
+                                Ordering ord,
+                                const TypeBits& types,
+                                size_t numFields) noexcept;
+
     /**
      * Decodes a RecordId from the end of a buffer.
      */
     static RecordId decodeRecordIdAtEnd(const void* buf, size_t size);
 
+    /**
+     * Returns the size of a buffer which ends with a RecordId, without that RecordId.
+     */
+    static size_t sizeWithoutRecordIdAtEnd(const void* buf, size_t size);
+
     /**
      * Decodes a RecordId, consuming all bytes needed from reader.
      */
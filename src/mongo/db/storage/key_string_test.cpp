@@ -262,6 +262,27 @@ TEST_F(KeyStringTest, Compound1) {
     ROUNDTRIP(version, BSON("" << BSON("" << 5) << "" << 1));
 }
 
+TEST_F(KeyStringTest, ToBsonPrefixDecodesLeadingFields) {
+    const BSONObj key = BSON("" << 1.0 << ""
+                                << "abc"
+                                << ""
+                                << 5LL);
+    const Ordering ord = Ordering::make(BSON("a" << 1 << "b" << -1 << "c" << 1));
+    const KeyString ks(version, key, ord, RecordId(7));
+
+    auto prefix = [&](size_t numFields) {
+        return KeyString::toBsonPrefix(
+            ks.getBuffer(), ks.getSize(), ord, ks.getTypeBits(), numFields);
+    };
+
+    ASSERT(prefix(0).isEmpty());
+    ASSERT(prefix(1).binaryEqual(BSON("" << 1.0)));
+    ASSERT(prefix(2).binaryEqual(BSON("" << 1.0 << ""
+                                         << "abc")));
+    ASSERT(prefix(3).binaryEqual(key));
+    ASSERT(prefix(4).binaryEqual(key));
+}
+
 TEST_F(KeyStringTest, Undef1) {
     ROUNDTRIP(version, BSON("" << BSONUndefined));
 }
@@ -1173,6 +1194,18 @@ TEST_F(KeyStringTest, RecordIds) {
     }
 }
 
+TEST_F(KeyStringTest, SizeWithoutRecordIdAtEnd) {
+    const BSONObj key = BSON("" << 1 << ""
+                                << "abc");
+    const KeyString prefix(version, key, ALL_ASCENDING);
+    for (int i = 0; i < 63; i++) {
+        const KeyString ks(version, key, ALL_ASCENDING, RecordId(1ll << i));
+        ASSERT_EQ(prefix.getSize(),
+                  KeyString::sizeWithoutRecordIdAtEnd(ks.getBuffer(), ks.getSize()));
+        ASSERT_EQ(0, memcmp(prefix.getBuffer(), ks.getBuffer(), prefix.getSize()));
+    }
+}
+
 TEST_F(KeyStringTest, KeyWithTooManyTypeBitsCausesUassert) {
     BSONObj obj;
     {
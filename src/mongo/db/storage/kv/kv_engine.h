@@ -356,6 +356,13 @@ public:
         return false;
     }
 
+    /**
+     * See `StorageEngine::supportsClusteredCollections`
+     */
+    virtual bool supportsClusteredCollections() const {
+        return false;
+    }
+
     /**
      * See `StorageEngine::replicationBatchIsComplete()`
      */
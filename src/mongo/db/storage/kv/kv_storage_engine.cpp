@@ -690,6 +690,10 @@ bool KVStorageEngine::supportsReadConcernMajority() const {
     return _engine->supportsReadConcernMajority();
 }
 
+bool KVStorageEngine::supportsClusteredCollections() const {
+    return _engine->supportsClusteredCollections();
+}
+
 void KVStorageEngine::replicationBatchIsComplete() const {
     return _engine->replicationBatchIsComplete();
 }
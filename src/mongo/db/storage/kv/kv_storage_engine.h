@@ -144,6 +144,8 @@ public:
 
     bool supportsReadConcernMajority() const final;
 
+    bool supportsClusteredCollections() const final;
+
     virtual void replicationBatchIsComplete() const override;
 
     SnapshotManager* getSnapshotManager() const final;
@@ -245,6 +245,17 @@ public:
      */
     virtual boost::optional<Record> seekExact(const RecordId& id) = 0;
 
+    /**
+     * Seeks to the first Record at or after the provided id in the direction of the cursor, and
+     * returns it. Returns boost::none if there is no such Record.
+     *
+     * Only cursors over record stores that can be clustered (see RecordStore::isClustered())
+     * need to implement this.
+     */
+    virtual boost::optional<Record> seekNear(const RecordId& id) {
+        MONGO_UNREACHABLE;
+    }
+
     /**
      * Prepares for state changes in underlying data without necessarily saving the current
      * state.
@@ -313,6 +324,14 @@ public:
 
     virtual bool isCapped() const = 0;
 
+    /**
+     * Returns true if records are keyed by their _id (see clustered_key.h) rather than by a
+     * RecordId the store assigns itself.
+     */
+    virtual bool isClustered() const {
+        return false;
+    }
+
     virtual void setCappedCallback(CappedCallback*) {
         MONGO_UNREACHABLE;
     }
@@ -527,6 +546,23 @@ public:
      */
     virtual void cappedTruncateAfter(OperationContext* opCtx, RecordId end, bool inclusive) = 0;
 
+    /**
+     * Removes every Record with an id in [first, last] as part of the caller's WriteUnitOfWork.
+     * The caller must already have visited those Records, and passes their number and total size
+     * so that the store does not have to read them again to maintain its statistics.
+     *
+     * Throws WriteConflictException if the range is in use by a concurrent operation.
+     *
+     * Only record stores that can be clustered (see isClustered()) need to implement this.
+     */
+    virtual void truncateRange(OperationContext* opCtx,
+                               const RecordId& first,
+                               const RecordId& last,
+                               int64_t numRecords,
+                               int64_t dataSize) {
+        MONGO_UNREACHABLE;
+    }
+
     /**
      * does this RecordStore support the compact operation?
      *
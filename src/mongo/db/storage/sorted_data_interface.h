@@ -36,6 +36,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/key_string.h"
 
 #pragma once
 
@@ -115,6 +116,56 @@ public:
                          const RecordId& loc,
                          bool dupsAllowed) = 0;
 
+    /**
+     * Returns whether insertKeyString() and unindexKeyString() write keys encoded in 'version'
+     * directly. Callers only encode keys ahead of time for implementations which do; for others
+     * they call insert() and unindex().
+     */
+    virtual bool consumesKeyStrings(KeyString::Version version) const {
+        return false;
+    }
+
+    /**
+     * Same as insert(), but 'keyString' is 'key' already encoded with this index's Ordering and
+     * with 'loc' appended, as done by KeyString(version, key, ordering, loc). Implementations that
+     * store KeyStrings in the same version can write the caller's encoding directly instead of
+     * producing their own; the default implementation ignores it.
+     */
+    virtual Status insertKeyString(OperationContext* opCtx,
+                                   const BSONObj& key,
+                                   const KeyString& keyString,
+                                   const RecordId& loc,
+                                   bool dupsAllowed) {
+        return insert(opCtx, key, loc, dupsAllowed);
+    }
+
+    /**
+     * Same as unindex(), but 'keyString' is the pre-encoded form of 'key' described for
+     * insertKeyString().
+     */
+    virtual void unindexKeyString(OperationContext* opCtx,
+                                  const BSONObj& key,
+                                  const KeyString& keyString,
+                                  const RecordId& loc,
+                                  bool dupsAllowed) {
+        unindex(opCtx, key, loc, dupsAllowed);
+    }
+
+    /**
+     * Removes every entry whose key lies in [startKey, endKey] as part of the caller's
+     * WriteUnitOfWork. The bounds may name fewer fields than the index has, in which case only
+     * the leading fields of each key are compared with them.
+     *
+     * Throws WriteConflictException if the range is in use by a concurrent operation.
+     *
+     * Only indexes over record stores that can be clustered need to implement this.
+     */
+    virtual void truncateRange(OperationContext* opCtx,
+                               const BSONObj& startKey,
+                               const BSONObj& endKey) {
+        MONGO_UNREACHABLE;
+    }
+
     /**
      * Return ErrorCodes::DuplicateKey if 'key' already exists in 'this'
      * index at a RecordId other than 'loc', and Status::OK() otherwise.
@@ -258,6 +309,13 @@ public:
          */
         virtual void setEndPosition(const BSONObj& key, bool inclusive) = 0;
 
+        /**
+         * Asks the cursor to return only the first 'numFields' fields of each key, for callers
+         * that never look at the rest. This is only a hint: implementations may ignore it and
+         * return complete keys.
+         */
+        virtual void setNumKeyFieldsToDecode(size_t numFields) {}
+
         /**
          * Moves forward and returns the new data or boost::none if there is no more data.
          * If not positioned, returns boost::none.
@@ -367,5 +367,62 @@ TEST(SortedDataInterface, InsertMultipleCompoundKeys) {
     }
 }
 
+// Insert and remove keys through the pre-encoded KeyString entry points and verify that the index
+// ends up with the same entries as through insert() and unindex(). The harness's indexes are on
+// {a: 1}, so both KeyString versions are tried to cover implementations that fall back, on both
+// unique and non-unique indexes.
+TEST(SortedDataInterface, InsertAndUnindexKeyString) {
+    const Ordering ordering = Ordering::make(BSON("a" << 1));
+    for (bool unique : {false, true}) {
+        for (auto version : {KeyString::Version::V0, KeyString::Version::V1}) {
+            const auto harnessHelper(newSortedDataInterfaceHarnessHelper());
+            const std::unique_ptr<SortedDataInterface> sorted(
+                harnessHelper->newSortedDataInterface(unique));
+            const bool dupsAllowed = !unique;
+
+            {
+                const ServiceContext::UniqueOperationContext opCtx(
+                    harnessHelper->newOperationContext());
+                WriteUnitOfWork uow(opCtx.get());
+                for (auto&& key : {key1, key2, key3}) {
+                    const KeyString keyString(version, key, ordering, loc1);
+                    ASSERT_OK(
+                        sorted->insertKeyString(opCtx.get(), key, keyString, loc1, dupsAllowed));
+                }
+                uow.commit();
+            }
+
+            if (unique) {
+                const ServiceContext::UniqueOperationContext opCtx(
+                    harnessHelper->newOperationContext());
+                WriteUnitOfWork uow(opCtx.get());
+                const KeyString keyString(version, key1, ordering, loc2);
+                ASSERT_NOT_OK(sorted->insertKeyString(opCtx.get(), key1, keyString, loc2, false));
+            }
+
+            {
+                const ServiceContext::UniqueOperationContext opCtx(
+                    harnessHelper->newOperationContext());
+                WriteUnitOfWork uow(opCtx.get());
+                const KeyString keyString(version, key2, ordering, loc1);
+                sorted->unindexKeyString(opCtx.get(), key2, keyString, loc1, dupsAllowed);
+                uow.commit();
+            }
+
+            {
+                const ServiceContext::UniqueOperationContext opCtx(
+                    harnessHelper->newOperationContext());
+                ASSERT_EQUALS(2, sorted->numEntries(opCtx.get()));
+
+                const std::unique_ptr<SortedDataInterface::Cursor> cursor(
+                    sorted->newCursor(opCtx.get()));
+                ASSERT_EQ(cursor->seekExact(key1), IndexKeyEntry(key1, loc1));
+                ASSERT_EQ(cursor->seekExact(key2), boost::none);
+                ASSERT_EQ(cursor->seekExact(key3), IndexKeyEntry(key3, loc1));
+            }
+        }
+    }
+}
+
 }  // namespace
 }  // namespace mongo
@@ -339,6 +339,14 @@ public:
         return false;
     }
 
+    /**
+     * Returns true if the storage engine can create collections with the 'clusteredIndex' option,
+     * whose records are keyed by their _id.
+     */
+    virtual bool supportsClusteredCollections() const {
+        return false;
+    }
+
     /**
      * Recovers the storage engine state to the last stable timestamp. "Stable" in this case
      * refers to a timestamp that is guaranteed to never be rolled back. The stable timestamp
@@ -349,6 +349,52 @@ void WiredTigerIndex::unindex(OperationContext* opCtx,
     _unindex(opCtx, c, key, id, dupsAllowed);
 }
 
+Status WiredTigerIndex::insertKeyString(OperationContext* opCtx,
+                                        const BSONObj& key,
+                                        const KeyString& keyString,
+                                        const RecordId& id,
+                                        bool dupsAllowed) {
+    if (keyString.version != keyStringVersion()) {
+        return insert(opCtx, key, id, dupsAllowed);
+    }
+
+    dassert(opCtx->lockState()->isWriteLocked());
+    invariant(id.isNormal());
+    dassert(!hasFieldNames(key));
+
+    Status s = checkKeySize(key);
+    if (!s.isOK())
+        return s;
+
+    WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+
+    return _insertKeyString(opCtx, c, key, keyString, id, dupsAllowed);
+}
+
+void WiredTigerIndex::unindexKeyString(OperationContext* opCtx,
+                                       const BSONObj& key,
+                                       const KeyString& keyString,
+                                       const RecordId& id,
+                                       bool dupsAllowed) {
+    if (keyString.version != keyStringVersion()) {
+        unindex(opCtx, key, id, dupsAllowed);
+        return;
+    }
+
+    dassert(opCtx->lockState()->isWriteLocked());
+    invariant(id.isNormal());
+    dassert(!hasFieldNames(key));
+
+    WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+    invariant(c);
+
+    _unindexKeyString(opCtx, c, key, keyString, id, dupsAllowed);
+}
+
 void WiredTigerIndex::fullValidate(OperationContext* opCtx,
                                    long long* numKeysOut,
                                    ValidateResults* fullResults) const {
@@ -443,6 +489,41 @@ Status WiredTigerIndex::dupKeyCheck(OperationContext* opCtx,
     return Status::OK();
 }
 
+void WiredTigerIndex::truncateRange(OperationContext* opCtx,
+                                    const BSONObj& startKey,
+                                    const BSONObj& endKey) {
+    dassert(opCtx->lockState()->isWriteLocked());
+
+    // The discriminators place the bounds before and after every key that starts with them, in
+    // both the unique and the standard key formats.
+    const KeyString start(
+        _keyStringVersion, stripFieldNames(startKey), _ordering, KeyString::kExclusiveBefore);
+    const KeyString stop(
+        _keyStringVersion, stripFieldNames(endKey), _ordering, KeyString::kExclusiveAfter);
+    invariant(start < stop);
+
+    WiredTigerCursor startWrap(_uri, _tableId, false, opCtx);
+    WT_CURSOR* startCursor = startWrap.get();
+    WiredTigerItem startItem(start.getBuffer(), start.getSize());
+    setKey(startCursor, startItem.Get());
+
+    WiredTigerCursor stopWrap(_uri, _tableId, false, opCtx);
+    WT_CURSOR* stopCursor = stopWrap.get();
+    WiredTigerItem stopItem(stop.getBuffer(), stop.getSize());
+    setKey(stopCursor, stopItem.Get());
+
+    // Neither bound names an existing entry. WiredTiger truncates from the first entry after
+    // 'start' to the last entry before 'stop', and does nothing if there are none.
+    WT_SESSION* session = WiredTigerRecoveryUnit::get(opCtx)->getSession()->getSession();
+    int ret = WT_OP_CHECK(session->truncate(session, nullptr, startCursor, stopCursor, nullptr));
+
+    // A range in use by another session is retried the same way as a write conflict.
+    if (ret == EBUSY) {
+        throw WriteConflictException();
+    }
+    uassertStatusOK(wtRCToStatus(ret));
+}
+
 bool WiredTigerIndex::isEmpty(OperationContext* opCtx) {
     if (_prefix != KVPrefix::kNotPrefixed) {
         const bool forward = true;
@@ -835,6 +916,10 @@ public:
         return curr(parts);
     }
 
+    void setNumKeyFieldsToDecode(size_t numFields) override {
+        _numKeyFieldsToDecode = numFields;
+    }
+
     void setEndPosition(const BSONObj& key, bool inclusive) override {
         TRACE_CURSOR << "setEndPosition inclusive: " << inclusive << ' ' << key;
         if (key.isEmpty()) {
@@ -939,6 +1024,17 @@ protected:
     virtual void updateIdAndTypeBits() {
         _id = KeyString::decodeRecordIdAtEnd(_key.getBuffer(), _key.getSize());
 
+        // The value only holds the TypeBits, which are needed to decode the key. Defer reading it
+        // until curr() is asked for the key.
+        _typeBitsLoaded = false;
+    }
+
+    // Reads the TypeBits for the current position from the value, if that has not been done.
+    // Must only be called while '_cursor' is positioned on '_key'.
+    void loadTypeBits() {
+        if (_typeBitsLoaded)
+            return;
+
         WT_CURSOR* c = _cursor->get();
         WT_ITEM item;
         // Can't get WT_ROLLBACK and hence won't throw an exception.
@@ -948,6 +1044,7 @@ protected:
         invariantWTOK(ret);
         BufReader br(item.data, item.size);
         _typeBits.resetFromBuffer(&br);
+        _typeBitsLoaded = true;
     }
 
     void setKey(WT_CURSOR* cursor, const WT_ITEM* item) {
@@ -979,7 +1076,7 @@ protected:
         return _prefix.repr() != prefix;
     }
 
-    boost::optional<IndexKeyEntry> curr(RequestedInfo parts) const {
+    boost::optional<IndexKeyEntry> curr(RequestedInfo parts) {
         if (_eof)
             return {};
 
@@ -988,7 +1085,14 @@ protected:
 
         BSONObj bson;
         if (TRACING_ENABLED || (parts & kWantKey)) {
-            bson = KeyString::toBson(_key.getBuffer(), _key.getSize(), _idx.ordering(), _typeBits);
+            loadTypeBits();
+            bson = _numKeyFieldsToDecode
+                ? KeyString::toBsonPrefix(_key.getBuffer(),
+                                          _key.getSize(),
+                                          _idx.ordering(),
+                                          _typeBits,
+                                          _numKeyFieldsToDecode)
+                : KeyString::toBson(_key.getBuffer(), _key.getSize(), _idx.ordering(), _typeBits);
 
             TRACE_CURSOR << " returning " << bson << ' ' << _id;
         }
@@ -1134,6 +1238,12 @@ protected:
     RecordId _id;
     bool _eof = true;
 
+    // Whether '_typeBits' has been read for the current position. See loadTypeBits().
+    bool _typeBitsLoaded = false;
+
+    // If non-zero, only this many leading fields of each key are decoded.
+    size_t _numKeyFieldsToDecode = 0;
+
     // This differs from _eof in that it always reflects the result of the most recent call to
     // reposition _cursor.
     bool _cursorAtEof = false;
@@ -1224,6 +1334,7 @@ private:
         BufReader br(item.data, item.size);
         _id = KeyString::decodeRecordId(&br);
         _typeBits.resetFromBuffer(&br);
+        _typeBitsLoaded = true;
 
         if (!br.atEof()) {
             severe() << "Unique index cursor seeing multiple records for key "
@@ -1325,23 +1436,39 @@ Status WiredTigerIndexUnique::_insert(OperationContext* opCtx,
                                       const BSONObj& key,
                                       const RecordId& id,
                                       bool dupsAllowed) {
+    const KeyString tableKey(keyStringVersion(), key, _ordering, id);
+    return _insertKeyString(opCtx, c, key, tableKey, id, dupsAllowed);
+}
+
+Status WiredTigerIndexUnique::_insertKeyString(OperationContext* opCtx,
+                                               WT_CURSOR* c,
+                                               const BSONObj& key,
+                                               const KeyString& tableKey,
+                                               const RecordId& id,
+                                               bool dupsAllowed) {
+    dassert(tableKey == KeyString(keyStringVersion(), key, _ordering, id));
+
     if (isTimestampSafeUniqueIdx()) {
-        return _insertTimestampSafe(opCtx, c, key, id, dupsAllowed);
+        return _insertTimestampSafe(opCtx, c, key, tableKey, id, dupsAllowed);
     }
-    return _insertTimestampUnsafe(opCtx, c, key, id, dupsAllowed);
+    return _insertTimestampUnsafe(opCtx, c, key, tableKey, id, dupsAllowed);
 }
 
 Status WiredTigerIndexUnique::_insertTimestampUnsafe(OperationContext* opCtx,
                                                      WT_CURSOR* c,
                                                      const BSONObj& key,
+                                                     const KeyString& tableKey,
                                                      const RecordId& id,
                                                      bool dupsAllowed) {
-    const KeyString data(keyStringVersion(), key, _ordering);
-    WiredTigerItem keyItem(data.getBuffer(), data.getSize());
+    // The table key is the key without the RecordId, which goes in the value.
+    const KeyString::TypeBits& typeBits = tableKey.getTypeBits();
+    WiredTigerItem keyItem(
+        tableKey.getBuffer(),
+        KeyString::sizeWithoutRecordIdAtEnd(tableKey.getBuffer(), tableKey.getSize()));
 
     KeyString value(keyStringVersion(), id);
-    if (!data.getTypeBits().isAllZeros())
-        value.appendTypeBits(data.getTypeBits());
+    if (!typeBits.isAllZeros())
+        value.appendTypeBits(typeBits);
 
     WiredTigerItem valueItem(value.getBuffer(), value.getSize());
     setKey(c, keyItem.Get());
@@ -1373,7 +1500,7 @@ Status WiredTigerIndexUnique::_insertTimestampUnsafe(OperationContext* opCtx,
 
         if (!insertedId && id < idInIndex) {
             value.appendRecordId(id);
-            value.appendTypeBits(data.getTypeBits());
+            value.appendTypeBits(typeBits);
             insertedId = true;
         }
 
@@ -1388,7 +1515,7 @@ Status WiredTigerIndexUnique::_insertTimestampUnsafe(OperationContext* opCtx,
     if (!insertedId) {
         // This id is higher than all currently in the index for this key
         value.appendRecordId(id);
-        value.appendTypeBits(data.getTypeBits());
+        value.appendTypeBits(typeBits);
     }
 
     valueItem = WiredTigerItem(value.getBuffer(), value.getSize());
@@ -1399,6 +1526,7 @@ Status WiredTigerIndexUnique::_insertTimestampUnsafe(OperationContext* opCtx,
 Status WiredTigerIndexUnique::_insertTimestampSafe(OperationContext* opCtx,
                                                    WT_CURSOR* c,
                                                    const BSONObj& key,
+                                                   const KeyString& tableKey,
                                                    const RecordId& id,
                                                    bool dupsAllowed) {
     TRACE_INDEX << "Timestamp safe unique idx key: " << key << " id: " << id;
@@ -1409,8 +1537,9 @@ Status WiredTigerIndexUnique::_insertTimestampSafe(OperationContext* opCtx,
     if (!dupsAllowed) {
         // A prefix key is KeyString of index key. It is the component of the index entry that
         // should be unique.
-        const KeyString prefixKey(keyStringVersion(), key, _ordering);
-        WiredTigerItem prefixKeyItem(prefixKey.getBuffer(), prefixKey.getSize());
+        WiredTigerItem prefixKeyItem(
+            tableKey.getBuffer(),
+            KeyString::sizeWithoutRecordIdAtEnd(tableKey.getBuffer(), tableKey.getSize()));
 
         // First phase inserts the prefix key to prohibit concurrent insertions of same key
         setKey(c, prefixKeyItem.Get());
@@ -1436,8 +1565,7 @@ Status WiredTigerIndexUnique::_insertTimestampSafe(OperationContext* opCtx,
             return dupKeyError(key);
     }
 
-    // Now create the table key/value, the actual data record.
-    KeyString tableKey(keyStringVersion(), key, _ordering, id);
+    // Now write the table key/value, the actual data record.
     WiredTigerItem keyItem(tableKey.getBuffer(), tableKey.getSize());
 
     // Pre-check before inserting on a secondary. An entry with same prefix key is allowed but not
@@ -1465,19 +1593,33 @@ void WiredTigerIndexUnique::_unindex(OperationContext* opCtx,
                                      const BSONObj& key,
                                      const RecordId& id,
                                      bool dupsAllowed) {
+    const KeyString tableKey(keyStringVersion(), key, _ordering, id);
+    _unindexKeyString(opCtx, c, key, tableKey, id, dupsAllowed);
+}
+
+void WiredTigerIndexUnique::_unindexKeyString(OperationContext* opCtx,
+                                              WT_CURSOR* c,
+                                              const BSONObj& key,
+                                              const KeyString& tableKey,
+                                              const RecordId& id,
+                                              bool dupsAllowed) {
+    dassert(tableKey == KeyString(keyStringVersion(), key, _ordering, id));
+
     if (isTimestampSafeUniqueIdx()) {
-        return _unindexTimestampSafe(opCtx, c, key, id, dupsAllowed);
+        return _unindexTimestampSafe(opCtx, c, key, tableKey, id, dupsAllowed);
     }
-    return _unindexTimestampUnsafe(opCtx, c, key, id, dupsAllowed);
+    return _unindexTimestampUnsafe(opCtx, c, key, tableKey, id, dupsAllowed);
 }
 
 void WiredTigerIndexUnique::_unindexTimestampUnsafe(OperationContext* opCtx,
                                                     WT_CURSOR* c,
                                                     const BSONObj& key,
+                                                    const KeyString& tableKey,
                                                     const RecordId& id,
                                                     bool dupsAllowed) {
-    KeyString data(keyStringVersion(), key, _ordering);
-    WiredTigerItem keyItem(data.getBuffer(), data.getSize());
+    WiredTigerItem keyItem(
+        tableKey.getBuffer(),
+        KeyString::sizeWithoutRecordIdAtEnd(tableKey.getBuffer(), tableKey.getSize()));
     setKey(c, keyItem.Get());
 
     auto triggerWriteConflictAtPoint = [this, &keyItem](WT_CURSOR* point) {
@@ -1581,10 +1723,10 @@ void WiredTigerIndexUnique::_unindexTimestampUnsafe(OperationContext* opCtx,
 void WiredTigerIndexUnique::_unindexTimestampSafe(OperationContext* opCtx,
                                                   WT_CURSOR* c,
                                                   const BSONObj& key,
+                                                  const KeyString& tableKey,
                                                   const RecordId& id,
                                                   bool dupsAllowed) {
-    KeyString data(keyStringVersion(), key, _ordering, id);
-    WiredTigerItem item(data.getBuffer(), data.getSize());
+    WiredTigerItem item(tableKey.getBuffer(), tableKey.getSize());
     setKey(c, item.Get());
     int ret = WT_OP_CHECK(c->remove(c));
     if (ret != WT_NOTFOUND) {
@@ -1596,8 +1738,9 @@ void WiredTigerIndexUnique::_unindexTimestampSafe(OperationContext* opCtx,
     // timestamp safe (new) unique indexes. Old format keys just had the index key while new
     // format key has index key + Record id. WT_NOTFOUND is possible if index key is in old format.
     // Retry removal of key using old format.
-    KeyString oldFormatKey(keyStringVersion(), key, _ordering);
-    WiredTigerItem keyItem(oldFormatKey.getBuffer(), oldFormatKey.getSize());
+    WiredTigerItem keyItem(
+        tableKey.getBuffer(),
+        KeyString::sizeWithoutRecordIdAtEnd(tableKey.getBuffer(), tableKey.getSize()));
     setKey(c, keyItem.Get());
 
     ret = WT_OP_CHECK(c->remove(c));
@@ -1640,11 +1783,21 @@ Status WiredTigerIndexStandard::_insert(OperationContext* opCtx,
                                         const BSONObj& keyBson,
                                         const RecordId& id,
                                         bool dupsAllowed) {
+    const KeyString key(keyStringVersion(), keyBson, _ordering, id);
+    return _insertKeyString(opCtx, c, keyBson, key, id, dupsAllowed);
+}
+
+Status WiredTigerIndexStandard::_insertKeyString(OperationContext* opCtx,
+                                                 WT_CURSOR* c,
+                                                 const BSONObj& keyBson,
+                                                 const KeyString& key,
+                                                 const RecordId& id,
+                                                 bool dupsAllowed) {
     invariant(dupsAllowed);
+    dassert(key == KeyString(keyStringVersion(), keyBson, _ordering, id));
 
     TRACE_INDEX << " key: " << keyBson << " id: " << id;
 
-    KeyString key(keyStringVersion(), keyBson, _ordering, id);
     WiredTigerItem keyItem(key.getBuffer(), key.getSize());
 
     WiredTigerItem valueItem = key.getTypeBits().isAllZeros()
@@ -1668,8 +1821,19 @@ void WiredTigerIndexStandard::_unindex(OperationContext* opCtx,
                                        const BSONObj& key,
                                        const RecordId& id,
                                        bool dupsAllowed) {
+    const KeyString data(keyStringVersion(), key, _ordering, id);
+    _unindexKeyString(opCtx, c, key, data, id, dupsAllowed);
+}
+
+void WiredTigerIndexStandard::_unindexKeyString(OperationContext* opCtx,
+                                                WT_CURSOR* c,
+                                                const BSONObj& key,
+                                                const KeyString& data,
+                                                const RecordId& id,
+                                                bool dupsAllowed) {
     invariant(dupsAllowed);
-    KeyString data(keyStringVersion(), key, _ordering, id);
+    dassert(data == KeyString(keyStringVersion(), key, _ordering, id));
+
     WiredTigerItem item(data.getBuffer(), data.getSize());
     setKey(c, item.Get());
     int ret = WT_OP_CHECK(c->remove(c));
@@ -102,6 +102,22 @@ public:
                          const RecordId& id,
                          bool dupsAllowed);
 
+    bool consumesKeyStrings(KeyString::Version version) const override {
+        return version == keyStringVersion();
+    }
+
+    Status insertKeyString(OperationContext* opCtx,
+                           const BSONObj& key,
+                           const KeyString& keyString,
+                           const RecordId& id,
+                           bool dupsAllowed) override;
+
+    void unindexKeyString(OperationContext* opCtx,
+                          const BSONObj& key,
+                          const KeyString& keyString,
+                          const RecordId& id,
+                          bool dupsAllowed) override;
+
     virtual void fullValidate(OperationContext* opCtx,
                               long long* numKeysOut,
                               ValidateResults* fullResults) const;
@@ -110,6 +126,10 @@ public:
                                    double scale) const;
     virtual Status dupKeyCheck(OperationContext* opCtx, const BSONObj& key, const RecordId& id);
 
+    void truncateRange(OperationContext* opCtx,
+                       const BSONObj& startKey,
+                       const BSONObj& endKey) final;
+
     virtual bool isEmpty(OperationContext* opCtx);
 
     virtual Status touch(OperationContext* opCtx) const;
@@ -172,6 +192,24 @@ protected:
                           const RecordId& id,
                           bool dupsAllowed) = 0;
 
+    /**
+     * Variants of _insert() and _unindex() that are handed the caller's encoding of 'key' with
+     * 'id' appended, in this index's KeyString version, so that 'key' is not encoded again.
+     */
+    virtual Status _insertKeyString(OperationContext* opCtx,
+                                    WT_CURSOR* c,
+                                    const BSONObj& key,
+                                    const KeyString& keyString,
+                                    const RecordId& id,
+                                    bool dupsAllowed) = 0;
+
+    virtual void _unindexKeyString(OperationContext* opCtx,
+                                   WT_CURSOR* c,
+                                   const BSONObj& key,
+                                   const KeyString& keyString,
+                                   const RecordId& id,
+                                   bool dupsAllowed) = 0;
+
     void setKey(WT_CURSOR* cursor, const WT_ITEM* item);
 
     class BulkBuilder;
@@ -221,15 +259,26 @@ public:
                    const RecordId& id,
                    bool dupsAllowed) override;
 
+    Status _insertKeyString(OperationContext* opCtx,
+                            WT_CURSOR* c,
+                            const BSONObj& key,
+                            const KeyString& tableKey,
+                            const RecordId& id,
+                            bool dupsAllowed) override;
+
+    // The timestamp unsafe format keys entries by 'tableKey' without its RecordId, which is
+    // stored in the value instead.
     Status _insertTimestampUnsafe(OperationContext* opCtx,
                                   WT_CURSOR* c,
                                   const BSONObj& key,
+                                  const KeyString& tableKey,
                                   const RecordId& id,
                                   bool dupsAllowed);
 
     Status _insertTimestampSafe(OperationContext* opCtx,
                                 WT_CURSOR* c,
                                 const BSONObj& key,
+                                const KeyString& tableKey,
                                 const RecordId& id,
                                 bool dupsAllowed);
 
@@ -239,15 +288,24 @@ public:
                   const RecordId& id,
                   bool dupsAllowed) override;
 
+    void _unindexKeyString(OperationContext* opCtx,
+                           WT_CURSOR* c,
+                           const BSONObj& key,
+                           const KeyString& tableKey,
+                           const RecordId& id,
+                           bool dupsAllowed) override;
+
     void _unindexTimestampUnsafe(OperationContext* opCtx,
                                  WT_CURSOR* c,
                                  const BSONObj& key,
+                                 const KeyString& tableKey,
                                  const RecordId& id,
                                  bool dupsAllowed);
 
     void _unindexTimestampSafe(OperationContext* opCtx,
                                WT_CURSOR* c,
                                const BSONObj& key,
+                               const KeyString& tableKey,
                                const RecordId& id,
                                bool dupsAllowed);
 
@@ -287,6 +345,20 @@ public:
                   const BSONObj& key,
                   const RecordId& id,
                   bool dupsAllowed) override;
+
+    Status _insertKeyString(OperationContext* opCtx,
+                            WT_CURSOR* c,
+                            const BSONObj& key,
+                            const KeyString& keyString,
+                            const RecordId& id,
+                            bool dupsAllowed) override;
+
+    void _unindexKeyString(OperationContext* opCtx,
+                           WT_CURSOR* c,
+                           const BSONObj& key,
+                           const KeyString& keyString,
+                           const RecordId& id,
+                           bool dupsAllowed) override;
 };
 
 }  // namespace
@@ -80,6 +80,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_tuner.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/background.h"
@@ -435,10 +436,28 @@ class TicketServerParameter : public ServerParameter {
 
 public:
     TicketServerParameter(TicketHolder* holder, const std::string& name)
-        : ServerParameter(ServerParameterSet::getGlobal(), name, true, true), _holder(holder) {}
+        : ServerParameter(ServerParameterSet::getGlobal(), name, true, true),
+          _holder(holder),
+          _maxTickets(holder->outof()) {}
 
     virtual void append(OperationContext* opCtx, BSONObjBuilder& b, const std::string& name) {
-        b.append(name, _holder->outof());
+        b.append(name, maxTickets());
+    }
+
+    /**
+     * The configured number of tickets. With adaptive tickets enabled, the current number of
+     * tickets may be lower.
+     */
+    int maxTickets() const {
+        return _maxTickets.load();
+    }
+
+    /**
+     * Serializes the resizes of the pool, so that it is never resized based on a configured
+     * number of tickets which has since changed.
+     */
+    stdx::mutex* resizeMutex() {
+        return &_resizeMutex;
     }
 
     virtual Status set(const BSONElement& newValueElement) {
@@ -460,11 +479,19 @@ public:
             return Status(ErrorCodes::BadValue, str::stream() << name() << " has to be > 0");
         }
 
-        return _holder->resize(newNum);
+        stdx::lock_guard<stdx::mutex> lk(_resizeMutex);
+        Status status = _holder->resize(newNum);
+        if (status.isOK())
+            _maxTickets.store(newNum);
+        return status;
     }
 
 private:
     TicketHolder* _holder;
+
+    // Protects the writes to _maxTickets and every resize of _holder.
+    stdx::mutex _resizeMutex;
+    AtomicInt32 _maxTickets;
 };
 
 TicketHolder openWriteTransaction(128);
@@ -629,6 +656,20 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
     _sizeStorer = std::make_unique<WiredTigerSizeStorer>(_conn, _sizeStorerUri, _readOnly);
 
     Locker::setGlobalThrottling(&openReadTransaction, &openWriteTransaction);
+
+    if (!_ephemeral && wiredTigerAdaptiveTickets) {
+        std::vector<WiredTigerTicketTuner::TicketPool> pools;
+        pools.push_back({"read",
+                         &openReadTransaction,
+                         openReadTransactionParam.resizeMutex(),
+                         [] { return openReadTransactionParam.maxTickets(); }});
+        pools.push_back({"write",
+                         &openWriteTransaction,
+                         openWriteTransactionParam.resizeMutex(),
+                         [] { return openWriteTransactionParam.maxTickets(); }});
+        _ticketTuner = stdx::make_unique<WiredTigerTicketTuner>(_conn, std::move(pools));
+        _ticketTuner->go();
+    }
 }
 
 
@@ -647,6 +688,7 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openWriteTransaction.used());
         bbb.append("available", openWriteTransaction.available());
         bbb.append("totalTickets", openWriteTransaction.outof());
+        openWriteTransaction.appendWaitStats(&bbb);
         bbb.done();
     }
     {
@@ -654,6 +696,7 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openReadTransaction.used());
         bbb.append("available", openReadTransaction.available());
         bbb.append("totalTickets", openReadTransaction.outof());
+        openReadTransaction.appendWaitStats(&bbb);
         bbb.done();
     }
     bb.done();
@@ -730,6 +773,9 @@ void WiredTigerKVEngine::cleanShutdown() {
     }
 
     // these must be the last things we do before _conn->close();
+    if (_ticketTuner) {
+        _ticketTuner->shutdown();
+    }
     if (_sessionSweeper) {
         log() << "Shutting down session sweeper thread";
         _sessionSweeper->shutdown();
@@ -1102,6 +1148,7 @@ std::unique_ptr<RecordStore> WiredTigerKVEngine::getGroupedRecordStore(
     params.cappedCallback = nullptr;
     params.sizeStorer = _sizeStorer.get();
     params.isReadOnly = _readOnly;
+    params.isClustered = options.clusteredIndex;
 
     params.cappedMaxSize = -1;
     if (options.capped) {
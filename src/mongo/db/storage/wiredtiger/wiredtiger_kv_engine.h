@@ -56,6 +56,7 @@ class JournalListener;
 class WiredTigerRecordStore;
 class WiredTigerSessionCache;
 class WiredTigerSizeStorer;
+class WiredTigerTicketTuner;
 
 struct WiredTigerFileVersion {
     enum class StartupVersion { IS_34, IS_36, IS_40 };
@@ -219,6 +220,10 @@ public:
 
     bool supportsReadConcernMajority() const final;
 
+    bool supportsClusteredCollections() const final {
+        return true;
+    }
+
     // wiredtiger specific
     // Calls WT_CONNECTION::reconfigure on the underlying WT_CONNECTION
     // held by this class
@@ -362,6 +367,7 @@ private:
     std::unique_ptr<WiredTigerSessionSweeper> _sessionSweeper;
     std::unique_ptr<WiredTigerJournalFlusher> _journalFlusher;  // Depends on _sizeStorer
     std::unique_ptr<WiredTigerCheckpointThread> _checkpointThread;
+    std::unique_ptr<WiredTigerTicketTuner> _ticketTuner;
 
     std::string _rsOptions;
     std::string _indexOptions;
@@ -50,6 +50,7 @@
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/server_recovery.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/clustered_key.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
@@ -634,6 +635,7 @@ WiredTigerRecordStore::WiredTigerRecordStore(WiredTigerKVEngine* kvEngine,
           getGlobalReplSettings().usingReplSets() ||
               repl::ReplSettings::shouldRecoverFromOplogAsStandalone())),
       _isOplog(NamespaceString::oplog(params.ns)),
+      _isClustered(params.isClustered),
       _cappedMaxSize(params.cappedMaxSize),
       _cappedMaxSizeSlack(std::min(params.cappedMaxSize / 10, int64_t(16 * 1024 * 1024))),
       _cappedMaxDocs(params.cappedMaxDocs),
@@ -1231,6 +1233,15 @@ Status WiredTigerRecordStore::_insertRecords(OperationContext* opCtx,
             if (!status.isOK())
                 return status.getStatus();
             record.id = status.getValue();
+        } else if (_isClustered) {
+            StatusWith<RecordId> status =
+                clusteredkey::extractKey(record.data.data(), record.data.size());
+            if (!status.isOK())
+                return status.getStatus();
+            record.id = status.getValue();
+            // Documents in a batch may arrive in any _id order.
+            highestId = std::max(highestId, record.id);
+            continue;
         } else if (_isCapped) {
             record.id = _nextId();
         } else {
@@ -1260,6 +1271,20 @@ Status WiredTigerRecordStore::_insertRecords(OperationContext* opCtx,
             fassert(39001, opCtx->recoveryUnit()->setTimestamp(ts));
         }
         setKey(c, record.id);
+        if (_isClustered) {
+            // Record store cursors overwrite existing keys, so the uniqueness that an _id index
+            // would otherwise enforce has to be checked here.
+            int ret = wiredTigerPrepareConflictRetry(opCtx, [&] { return c->search(c); });
+            if (ret == 0) {
+                return Status(ErrorCodes::DuplicateKey,
+                              str::stream() << "E11000 duplicate key error collection: " << ns()
+                                            << " index: _id_ dup key: "
+                                            << BSONObj(record.data.data())["_id"]);
+            }
+            if (ret != WT_NOTFOUND)
+                return wtRCToStatus(ret, "WiredTigerRecordStore::insertRecord");
+            setKey(c, record.id);
+        }
         WiredTigerItem value(record.data.data(), record.data.size());
         c->set_value(c, value.Get());
         int ret = WT_OP_CHECK(c->insert(c));
@@ -1497,6 +1522,36 @@ Status WiredTigerRecordStore::truncate(OperationContext* opCtx) {
     return Status::OK();
 }
 
+void WiredTigerRecordStore::truncateRange(OperationContext* opCtx,
+                                          const RecordId& first,
+                                          const RecordId& last,
+                                          int64_t numRecords,
+                                          int64_t dataSize) {
+    dassert(opCtx->lockState()->isWriteLocked());
+    invariant(_isClustered);
+    invariant(first <= last);
+
+    WiredTigerCursor startWrap(_uri, _tableId, true, opCtx);
+    WT_CURSOR* start = startWrap.get();
+    setKey(start, first);
+
+    WiredTigerCursor stopWrap(_uri, _tableId, true, opCtx);
+    WT_CURSOR* stop = stopWrap.get();
+    setKey(stop, last);
+
+    WT_SESSION* session = WiredTigerRecoveryUnit::get(opCtx)->getSession()->getSession();
+    int ret = WT_OP_CHECK(session->truncate(session, nullptr, start, stop, nullptr));
+
+    // A range in use by another session is retried the same way as a write conflict.
+    if (ret == EBUSY) {
+        throw WriteConflictException();
+    }
+    uassertStatusOK(wtRCToStatus(ret));
+
+    _changeNumRecords(opCtx, -numRecords);
+    _increaseDataSize(opCtx, -dataSize);
+}
+
 Status WiredTigerRecordStore::compact(OperationContext* opCtx,
                                       RecordStoreCompactAdaptor* adaptor,
                                       const CompactOptions* options,
@@ -1954,6 +2009,47 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordI
     return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
 }
 
+boost::optional<Record> WiredTigerRecordStoreCursorBase::seekNear(const RecordId& id) {
+    _skipNextAdvance = false;
+    WT_CURSOR* c = _cursor->get();
+    setKey(c, id);
+    int cmp;
+    // Nothing after the next line can throw WCEs.
+    int seekRet = wiredTigerPrepareConflictRetry(_opCtx, [&] { return c->search_near(c, &cmp); });
+    if (seekRet == WT_NOTFOUND) {
+        _eof = true;
+        return {};
+    }
+    invariantWTOK(seekRet);
+
+    // 'search_near' may land on either side of 'id'. Step once if it landed behind it.
+    if (_forward ? cmp < 0 : cmp > 0) {
+        int advanceRet = wiredTigerPrepareConflictRetry(
+            _opCtx, [&] { return _forward ? c->next(c) : c->prev(c); });
+        if (advanceRet == WT_NOTFOUND) {
+            _eof = true;
+            return {};
+        }
+        invariantWTOK(advanceRet);
+    }
+
+    RecordId curId;
+    if (hasWrongPrefix(c, &curId)) {
+        _eof = true;
+        return {};
+    }
+    if (!curId.isNormal()) {
+        curId = getKey(c);
+    }
+
+    WT_ITEM value;
+    invariantWTOK(c->get_value(c, &value));
+
+    _lastReturnedId = curId;
+    _eof = false;
+    return {{curId, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
+}
+
 
 void WiredTigerRecordStoreCursorBase::save() {
     try {
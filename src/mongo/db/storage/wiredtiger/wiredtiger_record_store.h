@@ -113,6 +113,7 @@ public:
         CappedCallback* cappedCallback;
         WiredTigerSizeStorer* sizeStorer;
         bool isReadOnly;
+        bool isClustered = false;
     };
 
     WiredTigerRecordStore(WiredTigerKVEngine* kvEngine, OperationContext* opCtx, Params params);
@@ -130,6 +131,10 @@ public:
 
     virtual bool isCapped() const;
 
+    bool isClustered() const final {
+        return _isClustered;
+    }
+
     virtual int64_t storageSize(OperationContext* opCtx,
                                 BSONObjBuilder* extraInfo = NULL,
                                 int infoLevel = 0) const;
@@ -217,6 +222,12 @@ public:
 
     virtual void cappedTruncateAfter(OperationContext* opCtx, RecordId end, bool inclusive);
 
+    void truncateRange(OperationContext* opCtx,
+                       const RecordId& first,
+                       const RecordId& last,
+                       int64_t numRecords,
+                       int64_t dataSize) final;
+
     virtual boost::optional<RecordId> oplogStartHack(OperationContext* opCtx,
                                                      const RecordId& startingPosition) const;
 
@@ -344,6 +355,8 @@ private:
     const bool _isLogged;
     // True if the namespace of this record store starts with "local.oplog.", and false otherwise.
     const bool _isOplog;
+    // True if records are keyed by their _id rather than by _nextId().
+    const bool _isClustered;
     int64_t _cappedMaxSize;
     const int64_t _cappedMaxSizeSlack;  // when to start applying backpressure
     const int64_t _cappedMaxDocs;
@@ -423,6 +436,8 @@ public:
 
     boost::optional<Record> seekExact(const RecordId& id);
 
+    boost::optional<Record> seekNear(const RecordId& id);
+
     void save();
 
     void saveUnpositioned();
@@ -45,6 +45,7 @@
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/clustered_key.h"
 #include "mongo/db/storage/kv/kv_engine_test_harness.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/record_store_test_harness.h"
@@ -97,38 +98,11 @@ public:
     }
 
     virtual std::unique_ptr<RecordStore> newNonCappedRecordStore(const std::string& ns) {
-        WiredTigerRecoveryUnit* ru =
-            dynamic_cast<WiredTigerRecoveryUnit*>(_engine.newRecoveryUnit());
-        OperationContextNoop opCtx(ru);
-        string uri = "table:" + ns;
-
-        const bool prefixed = false;
-        StatusWith<std::string> result = WiredTigerRecordStore::generateCreateString(
-            kWiredTigerEngineName, ns, CollectionOptions(), "", prefixed);
-        ASSERT_TRUE(result.isOK());
-        std::string config = result.getValue();
-
-        {
-            WriteUnitOfWork uow(&opCtx);
-            WT_SESSION* s = ru->getSession()->getSession();
-            invariantWTOK(s->create(s, uri.c_str(), config.c_str()));
-            uow.commit();
-        }
-
-        WiredTigerRecordStore::Params params;
-        params.ns = ns;
-        params.uri = uri;
-        params.engineName = kWiredTigerEngineName;
-        params.isCapped = false;
-        params.isEphemeral = false;
-        params.cappedMaxSize = -1;
-        params.cappedMaxDocs = -1;
-        params.cappedCallback = nullptr;
-        params.sizeStorer = nullptr;
+        return _newRecordStore(ns, false /* isClustered */);
+    }
 
-        auto ret = stdx::make_unique<StandardWiredTigerRecordStore>(&_engine, &opCtx, params);
-        ret->postConstructorInit(&opCtx);
-        return std::move(ret);
+    std::unique_ptr<RecordStore> newClusteredRecordStore(const std::string& ns) {
+        return _newRecordStore(ns, true /* isClustered */);
     }
 
     virtual std::unique_ptr<RecordStore> newCappedRecordStore(int64_t cappedSizeBytes,
@@ -189,6 +163,42 @@ public:
     }
 
 private:
+    std::unique_ptr<RecordStore> _newRecordStore(const std::string& ns, bool isClustered) {
+        WiredTigerRecoveryUnit* ru =
+            dynamic_cast<WiredTigerRecoveryUnit*>(_engine.newRecoveryUnit());
+        OperationContextNoop opCtx(ru);
+        string uri = "table:" + ns;
+
+        const bool prefixed = false;
+        StatusWith<std::string> result = WiredTigerRecordStore::generateCreateString(
+            kWiredTigerEngineName, ns, CollectionOptions(), "", prefixed);
+        ASSERT_TRUE(result.isOK());
+        std::string config = result.getValue();
+
+        {
+            WriteUnitOfWork uow(&opCtx);
+            WT_SESSION* s = ru->getSession()->getSession();
+            invariantWTOK(s->create(s, uri.c_str(), config.c_str()));
+            uow.commit();
+        }
+
+        WiredTigerRecordStore::Params params;
+        params.ns = ns;
+        params.uri = uri;
+        params.engineName = kWiredTigerEngineName;
+        params.isCapped = false;
+        params.isEphemeral = false;
+        params.cappedMaxSize = -1;
+        params.cappedMaxDocs = -1;
+        params.cappedCallback = nullptr;
+        params.sizeStorer = nullptr;
+        params.isClustered = isClustered;
+
+        auto ret = stdx::make_unique<StandardWiredTigerRecordStore>(&_engine, &opCtx, params);
+        ret->postConstructorInit(&opCtx);
+        return std::move(ret);
+    }
+
     unittest::TempDir _dbpath;
     ClockSourceMock _cs;
 
@@ -212,6 +222,81 @@ TEST(WiredTigerRecordStoreTest, StorageSizeStatisticsDisabled) {
     ASSERT_THROWS(rs->storageSize(opCtx.get()), AssertionException);
 }
 
+TEST(WiredTigerRecordStoreTest, ClusteredRecordStoreKeysRecordsById) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(harnessHelper.newClusteredRecordStore("a.c"));
+    ASSERT_TRUE(rs->isClustered());
+
+    auto keyFor = [](long long id) { return unittest::assertGet(clusteredkey::keyForIdValue(id)); };
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+    auto insert = [&](const BSONObj& doc) {
+        WriteUnitOfWork uow(opCtx.get());
+        auto res = rs->insertRecord(opCtx.get(), doc.objdata(), doc.objsize(), Timestamp(), false);
+        if (res.isOK()) {
+            uow.commit();
+        }
+        return res;
+    };
+
+    for (long long id : {30, 10, 20}) {
+        ASSERT_EQ(unittest::assertGet(insert(BSON("_id" << id))), keyFor(id));
+    }
+    ASSERT_EQ(insert(BSON("_id" << 20.0)).getStatus(), ErrorCodes::DuplicateKey);
+    ASSERT_EQ(insert(BSON("_id"
+                          << "x"))
+                  .getStatus(),
+              ErrorCodes::BadValue);
+    ASSERT_EQ(3, rs->numRecords(opCtx.get()));
+
+    auto cursor = rs->getCursor(opCtx.get());
+    auto record = cursor->seekNear(keyFor(15));
+    ASSERT(record);
+    ASSERT_EQ(record->id, keyFor(20));
+    ASSERT_EQ(cursor->next()->id, keyFor(30));
+    ASSERT_FALSE(cursor->seekNear(keyFor(31)));
+
+    auto reverse = rs->getCursor(opCtx.get(), false);
+    record = reverse->seekNear(keyFor(15));
+    ASSERT(record);
+    ASSERT_EQ(record->id, keyFor(10));
+    ASSERT_FALSE(reverse->seekNear(keyFor(5)));
+}
+
+TEST(WiredTigerRecordStoreTest, ClusteredRecordStoreTruncateRange) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(harnessHelper.newClusteredRecordStore("a.c"));
+
+    auto keyFor = [](long long id) { return unittest::assertGet(clusteredkey::keyForIdValue(id)); };
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+    {
+        WriteUnitOfWork uow(opCtx.get());
+        for (long long id = 0; id < 10; id++) {
+            const BSONObj doc = BSON("_id" << id);
+            ASSERT_OK(
+                rs->insertRecord(opCtx.get(), doc.objdata(), doc.objsize(), Timestamp(), false));
+        }
+        uow.commit();
+    }
+    const int64_t docSize = BSON("_id" << 0LL).objsize();
+    ASSERT_EQ(10 * docSize, rs->dataSize(opCtx.get()));
+
+    {
+        WriteUnitOfWork uow(opCtx.get());
+        rs->truncateRange(opCtx.get(), keyFor(3), keyFor(6), 4, 4 * docSize);
+        uow.commit();
+    }
+
+    ASSERT_EQ(6, rs->numRecords(opCtx.get()));
+    ASSERT_EQ(6 * docSize, rs->dataSize(opCtx.get()));
+
+    auto cursor = rs->getCursor(opCtx.get());
+    ASSERT_EQ(cursor->seekNear(keyFor(3))->id, keyFor(7));
+    ASSERT_EQ(cursor->seekExact(keyFor(2))->id, keyFor(2));
+    ASSERT_FALSE(cursor->seekExact(keyFor(6)));
+}
+
 TEST(WiredTigerRecordStoreTest, SizeStorer1) {
     unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
     unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
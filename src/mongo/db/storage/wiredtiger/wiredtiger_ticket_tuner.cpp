@@ -0,0 +1,215 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_tuner.h"
+
+#include <algorithm>
+
+#include "mongo/db/client.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerAdaptiveTickets, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveTicketsIntervalMillis, int, 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal > 0) {
+            return Status::OK();
+        }
+        return Status(ErrorCodes::BadValue,
+                      "wiredTigerAdaptiveTicketsIntervalMillis must be greater than 0");
+    });
+
+// Lower bound for adaptive ticket pools. The TicketHolder does not support fewer than 5 tickets.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveTicketsMinimum, int, 16)
+    ->withValidator([](const int& newVal) {
+        if (newVal >= 5) {
+            return Status::OK();
+        }
+        return Status(ErrorCodes::BadValue, "wiredTigerAdaptiveTicketsMinimum must be at least 5");
+    });
+
+namespace {
+
+// WiredTiger's default eviction_trigger and eviction_dirty_trigger, as fractions of the cache
+// size. Past these, application threads are drafted into eviction and throughput collapses.
+const double kCacheFillTrigger = 0.95;
+const double kCacheDirtyTrigger = 0.20;
+
+}  // namespace
+
+constexpr int AdaptiveTicketPolicy::kIncreaseStep;
+constexpr double AdaptiveTicketPolicy::kThroughputDropTolerance;
+
+int AdaptiveTicketPolicy::nextTicketCount(const Observation& observation) {
+    const int current = observation.currentTickets;
+    int target = current;
+    bool increasing = false;
+
+    if (observation.cachePressure) {
+        target = current - std::max(1, current / 4);
+    } else if (_lastIncreased &&
+               observation.throughput < _lastThroughput * (1 - kThroughputDropTolerance)) {
+        target = current - kIncreaseStep;
+    } else if (observation.hadWaiters) {
+        target = current + kIncreaseStep;
+        increasing = true;
+    }
+
+    target = std::max(observation.minTickets, std::min(target, observation.maxTickets));
+
+    _lastIncreased = increasing && target > current;
+    _lastThroughput = observation.throughput;
+    return target;
+}
+
+WiredTigerTicketTuner::WiredTigerTicketTuner(WT_CONNECTION* conn, std::vector<TicketPool> pools)
+    : BackgroundJob(false /* deleteSelf */), _conn(conn) {
+    for (auto&& pool : pools) {
+        _pools.push_back({std::move(pool), AdaptiveTicketPolicy(), 0});
+    }
+}
+
+void WiredTigerTicketTuner::run() {
+    Client::initThread(name().c_str());
+    ON_BLOCK_EXIT([] { Client::destroy(); });
+
+    LOG(1) << "starting " << name() << " thread";
+
+    // Establish the baseline for the statistics deltas.
+    _sampleCacheStats(1);
+
+    Timer timer;
+    while (!_shuttingDown.load()) {
+        {
+            stdx::unique_lock<stdx::mutex> lock(_mutex);
+            MONGO_IDLE_THREAD_BLOCK;
+            _condvar.wait_for(
+                lock,
+                stdx::chrono::milliseconds(wiredTigerAdaptiveTicketsIntervalMillis.load()));
+        }
+        if (_shuttingDown.load())
+            break;
+
+        const double intervalSecs = std::max(timer.micros() / 1000000.0, 0.001);
+        timer.reset();
+        _adjust(intervalSecs);
+    }
+    LOG(1) << "stopping " << name() << " thread";
+}
+
+void WiredTigerTicketTuner::shutdown() {
+    _shuttingDown.store(true);
+    {
+        stdx::unique_lock<stdx::mutex> lock(_mutex);
+        _condvar.notify_one();
+    }
+    wait();
+}
+
+WiredTigerTicketTuner::CacheStats WiredTigerTicketTuner::_sampleCacheStats(double intervalSecs) {
+    WiredTigerSession session(_conn);
+    WT_SESSION* s = session.getSession();
+    const std::string uri = "statistics:";
+    const std::string config = "statistics=(fast)";
+
+    auto read = [&](int key) -> uint64_t {
+        auto swValue = WiredTigerUtil::getStatisticsValue(s, uri, config, key);
+        return swValue.isOK() ? swValue.getValue() : 0;
+    };
+
+    const uint64_t transactionsBegun = read(WT_STAT_CONN_TXN_BEGIN);
+    const uint64_t appEvictions = read(WT_STAT_CONN_CACHE_EVICTION_APP);
+    const uint64_t bytesInUse = read(WT_STAT_CONN_CACHE_BYTES_INUSE);
+    const uint64_t bytesDirty = read(WT_STAT_CONN_CACHE_BYTES_DIRTY);
+    const uint64_t bytesMax = read(WT_STAT_CONN_CACHE_BYTES_MAX);
+
+    CacheStats stats;
+    stats.throughput = (transactionsBegun - _lastTransactionsBegun) / intervalSecs;
+    stats.pressure = appEvictions > _lastAppEvictions;
+    if (bytesMax > 0) {
+        stats.pressure = stats.pressure ||
+            static_cast<double>(bytesInUse) / bytesMax >= kCacheFillTrigger ||
+            static_cast<double>(bytesDirty) / bytesMax >= kCacheDirtyTrigger;
+    }
+
+    _lastTransactionsBegun = transactionsBegun;
+    _lastAppEvictions = appEvictions;
+    return stats;
+}
+
+void WiredTigerTicketTuner::_adjust(double intervalSecs) {
+    const CacheStats stats = _sampleCacheStats(intervalSecs);
+
+    for (auto&& state : _pools) {
+        TicketHolder* holder = state.pool.holder;
+        const long long totalWaits = holder->totalWaits();
+        const bool hadWaiters = totalWaits > state.lastTotalWaits || holder->waiting() > 0;
+        state.lastTotalWaits = totalWaits;
+
+        // A setParameter of the configured size must not interleave with the resize below.
+        stdx::lock_guard<stdx::mutex> lk(*state.pool.resizeMutex);
+        const int current = holder->outof();
+        const int maxTickets = state.pool.maxTickets();
+
+        AdaptiveTicketPolicy::Observation observation;
+        observation.currentTickets = current;
+        observation.minTickets = std::min(wiredTigerAdaptiveTicketsMinimum.load(), maxTickets);
+        observation.maxTickets = maxTickets;
+        observation.hadWaiters = hadWaiters;
+        observation.throughput = stats.throughput;
+        observation.cachePressure = stats.pressure;
+        const int target = state.policy.nextTicketCount(observation);
+
+        if (target == current)
+            continue;
+
+        LOG(1) << "Resizing " << state.pool.name << " tickets from " << current << " to " << target
+               << (stats.pressure ? " under cache pressure" : "");
+        Status status = holder->resize(target);
+        if (!status.isOK()) {
+            LOG(1) << "Unable to resize " << state.pool.name << " tickets: " << status;
+        }
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,152 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <wiredtiger.h>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/background.h"
+
+namespace mongo {
+
+class TicketHolder;
+
+// Startup parameter which enables the WiredTigerTicketTuner.
+extern bool wiredTigerAdaptiveTickets;
+
+/**
+ * Additive-increase/multiplicative-decrease policy for the size of one ticket pool. It is fed one
+ * observation per adjustment interval and returns the number of tickets to use for the next one.
+ *
+ *  - Under cache pressure the pool shrinks by a quarter, so that fewer concurrent operations dirty
+ *    and pin cache pages while eviction catches up.
+ *  - Otherwise, if operations had to queue for tickets, the pool grows by a fixed step.
+ *  - If the previous interval grew the pool and throughput dropped noticeably since, the growth
+ *    is undone: the extra concurrency only added contention.
+ *
+ * The result is always within [minTickets, maxTickets].
+ */
+class AdaptiveTicketPolicy {
+public:
+    static constexpr int kIncreaseStep = 8;
+
+    // Fraction by which throughput must drop after an increase for that increase to be undone.
+    static constexpr double kThroughputDropTolerance = 0.1;
+
+    struct Observation {
+        int currentTickets;
+        int minTickets;
+        int maxTickets;
+
+        // Whether any acquisition had to wait for a ticket during the interval.
+        bool hadWaiters;
+
+        // Storage transactions begun per second during the interval.
+        double throughput;
+
+        bool cachePressure;
+    };
+
+    int nextTicketCount(const Observation& observation);
+
+private:
+    double _lastThroughput = 0;
+    bool _lastIncreased = false;
+};
+
+/**
+ * Background thread which periodically resizes the WiredTiger read and write ticket pools
+ * according to an AdaptiveTicketPolicy. It is only started when the 'wiredTigerAdaptiveTickets'
+ * startup parameter is enabled. The configured size of each pool serves as its maximum.
+ *
+ * Cache pressure is signaled by application threads having to evict pages, or by the cache or its
+ * dirty content exceeding WiredTiger's default eviction trigger levels.
+ */
+class WiredTigerTicketTuner : public BackgroundJob {
+public:
+    struct TicketPool {
+        std::string name;
+        TicketHolder* holder;
+        // Held while reading the configured size and resizing the pool, and by whoever changes
+        // the configured size.
+        stdx::mutex* resizeMutex;
+        // Returns the configured size of the pool.
+        stdx::function<int()> maxTickets;
+    };
+
+    WiredTigerTicketTuner(WT_CONNECTION* conn, std::vector<TicketPool> pools);
+
+    std::string name() const override {
+        return "WTTicketTuner";
+    }
+
+    void run() override;
+
+    void shutdown();
+
+private:
+    struct CacheStats {
+        double throughput = 0;
+        bool pressure = false;
+    };
+
+    /**
+     * Reads the connection statistics and derives throughput and cache pressure from their change
+     * since the previous call.
+     */
+    CacheStats _sampleCacheStats(double intervalSecs);
+
+    void _adjust(double intervalSecs);
+
+    WT_CONNECTION* const _conn;
+
+    struct PoolState {
+        TicketPool pool;
+        AdaptiveTicketPolicy policy;
+        long long lastTotalWaits = 0;
+    };
+    std::vector<PoolState> _pools;
+
+    uint64_t _lastTransactionsBegun = 0;
+    uint64_t _lastAppEvictions = 0;
+
+    AtomicBool _shuttingDown{false};
+    stdx::mutex _mutex;  // protects _condvar
+    stdx::condition_variable _condvar;
+};
+
+}  // namespace mongo
@@ -0,0 +1,95 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_tuner.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+AdaptiveTicketPolicy::Observation makeObservation(int current,
+                                                  bool hadWaiters,
+                                                  double throughput,
+                                                  bool cachePressure) {
+    AdaptiveTicketPolicy::Observation observation;
+    observation.currentTickets = current;
+    observation.minTickets = 16;
+    observation.maxTickets = 128;
+    observation.hadWaiters = hadWaiters;
+    observation.throughput = throughput;
+    observation.cachePressure = cachePressure;
+    return observation;
+}
+
+TEST(AdaptiveTicketPolicyTest, ShrinksMultiplicativelyUnderCachePressure) {
+    AdaptiveTicketPolicy policy;
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(128, true, 1000, true)), 96);
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(96, true, 1000, true)), 72);
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(20, true, 1000, true)), 16);
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(16, true, 1000, true)), 16);
+}
+
+TEST(AdaptiveTicketPolicyTest, GrowsAdditivelyOnlyWhenOperationsQueue) {
+    AdaptiveTicketPolicy policy;
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(64, false, 1000, false)), 64);
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(64, true, 1000, false)),
+              64 + AdaptiveTicketPolicy::kIncreaseStep);
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(124, true, 1000, false)), 128);
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(128, true, 1000, false)), 128);
+}
+
+TEST(AdaptiveTicketPolicyTest, UndoesIncreaseWhichReducedThroughput) {
+    AdaptiveTicketPolicy policy;
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(64, true, 1000, false)), 72);
+
+    // Throughput dropped by more than the tolerance after growing, so the growth is reverted.
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(72, true, 800, false)), 64);
+
+    // The revert is not itself an increase, so a further drop does not shrink the pool again.
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(64, true, 600, false)), 72);
+}
+
+TEST(AdaptiveTicketPolicyTest, KeepsIncreasingWhileThroughputHolds) {
+    AdaptiveTicketPolicy policy;
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(64, true, 1000, false)), 72);
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(72, true, 950, false)), 80);
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(80, true, 1200, false)), 88);
+}
+
+TEST(AdaptiveTicketPolicyTest, ClampsToConfiguredMaximum) {
+    AdaptiveTicketPolicy policy;
+    // The configured maximum was lowered below the current size.
+    ASSERT_EQ(policy.nextTicketCount(makeObservation(200, false, 1000, false)), 128);
+}
+
+}  // namespace
+}  // namespace mongo
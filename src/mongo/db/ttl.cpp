@@ -46,21 +46,27 @@
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/fsync_locked.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
-#include "mongo/db/exec/delete.h"
+#include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/logical_session_id.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_priority.h"
 #include "mongo/db/ops/insert.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/ttl_collection_cache.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -74,6 +80,166 @@ ServerStatusMetricField<Counter64> ttlDeletedDocumentsDisplay("ttl.deletedDocume
 MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorEnabled, bool, true);
 MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorSleepSecs, int, 60);  // used for testing
 
+// Maximum number of expired documents removed in a single WriteUnitOfWork.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorBatchDeleteSize, int, 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal <= 0) {
+            return Status(ErrorCodes::BadValue, "ttlMonitorBatchDeleteSize must be positive");
+        }
+        return Status::OK();
+    });
+
+// Number of TTL indexes processed concurrently during a pass.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ttlMonitorMaxConcurrency, int, 4)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1 || newVal > 64) {
+            return Status(ErrorCodes::BadValue,
+                          "ttlMonitorMaxConcurrency must be between 1 and 64");
+        }
+        return Status::OK();
+    });
+
+// Upper bound on documents deleted per second across all TTL indexes. 0 means unlimited.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorMaxDeletesPerSecond, int, 0)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "ttlMonitorMaxDeletesPerSecond must be greater than or equal to 0");
+        }
+        return Status::OK();
+    });
+
+namespace {
+
+/**
+ * Paces TTL deletes across all worker threads so that, on average, no more than
+ * ttlMonitorMaxDeletesPerSecond documents are removed per second.
+ */
+class TTLDeleteRateLimiter {
+public:
+    /**
+     * Accounts for 'numDeleted' documents that were just deleted, sleeping until the deletes fit
+     * within the configured rate. Must not be called while holding locks.
+     */
+    void pace(OperationContext* opCtx, long long numDeleted) {
+        const int maxDeletesPerSecond = ttlMonitorMaxDeletesPerSecond.load();
+        if (maxDeletesPerSecond <= 0 || numDeleted <= 0) {
+            return;
+        }
+
+        long long wakeupMicros;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            const long long nowMicros = Date_t::now().toMillisSinceEpoch() * 1000;
+            _nextMicros = std::max(_nextMicros, nowMicros);
+            _nextMicros += numDeleted * 1000 * 1000 / maxDeletesPerSecond;
+            wakeupMicros = _nextMicros;
+        }
+
+        opCtx->sleepUntil(Date_t::fromMillisSinceEpoch(wakeupMicros / 1000));
+    }
+
+private:
+    stdx::mutex _mutex;
+
+    // Time at which the deletes accounted for so far have been paid off.
+    long long _nextMicros = 0;
+};
+
+TTLDeleteRateLimiter ttlDeleteRateLimiter;
+
+/**
+ * Per-index backlog statistics from the most recent TTL pass, reported through the "ttl"
+ * serverStatus section.
+ */
+class TTLIndexStatsRegistry {
+public:
+    struct IndexStats {
+        // How far behind the oldest expired document was when the pass started.
+        long long lagSecs = 0;
+        long long deletedLastPass = 0;
+        long long lastPassMillis = 0;
+        long long totalDeleted = 0;
+        long long lastSeenPass = 0;
+    };
+
+    void record(const NamespaceString& nss,
+                const std::string& indexName,
+                long long pass,
+                long long lagSecs,
+                long long numDeleted,
+                long long millis) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        IndexStats& stats = _stats[nss.ns()][indexName];
+        stats.lagSecs = lagSecs;
+        stats.deletedLastPass = numDeleted;
+        stats.lastPassMillis = millis;
+        stats.totalDeleted += numDeleted;
+        stats.lastSeenPass = pass;
+    }
+
+    /**
+     * Forgets indexes that were not processed during 'pass', e.g. because they were dropped or
+     * this node is no longer primary.
+     */
+    void pruneNotSeenIn(long long pass) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (auto nsIt = _stats.begin(); nsIt != _stats.end();) {
+            auto& indexes = nsIt->second;
+            for (auto idxIt = indexes.begin(); idxIt != indexes.end();) {
+                if (idxIt->second.lastSeenPass != pass) {
+                    idxIt = indexes.erase(idxIt);
+                } else {
+                    ++idxIt;
+                }
+            }
+            if (indexes.empty()) {
+                nsIt = _stats.erase(nsIt);
+            } else {
+                ++nsIt;
+            }
+        }
+    }
+
+    void append(BSONObjBuilder* builder) const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (const auto& ns : _stats) {
+            BSONObjBuilder nsBuilder(builder->subobjStart(ns.first));
+            for (const auto& index : ns.second) {
+                BSONObjBuilder indexBuilder(nsBuilder.subobjStart(index.first));
+                indexBuilder.append("lagSecs", index.second.lagSecs);
+                indexBuilder.append("deletedLastPass", index.second.deletedLastPass);
+                indexBuilder.append("lastPassMillis", index.second.lastPassMillis);
+                indexBuilder.append("totalDeleted", index.second.totalDeleted);
+            }
+        }
+    }
+
+private:
+    mutable stdx::mutex _mutex;
+    std::map<std::string, std::map<std::string, IndexStats>> _stats;
+};
+
+TTLIndexStatsRegistry ttlIndexStats;
+
+class TTLServerStatusSection : public ServerStatusSection {
+public:
+    TTLServerStatusSection() : ServerStatusSection("ttl") {}
+
+    bool includeByDefault() const override {
+        return false;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        BSONObjBuilder builder;
+        ttlIndexStats.append(&builder);
+        return builder.obj();
+    }
+} ttlServerStatusSection;
+
+}  // namespace
+
 class TTLMonitor : public BackgroundJob {
 public:
     TTLMonitor() {}
@@ -89,6 +255,26 @@ public:
         Client::initThread(name().c_str());
         ON_BLOCK_EXIT([] { Client::destroy(); });
         AuthorizationSession::get(cc())->grantInternalAuthorization(&cc());
+        setClientOperationPriority(&cc(), OperationPriority::kBackground);
+
+        ThreadPool::Options options;
+        options.poolName = "TTLMonitorWorkers";
+        options.threadNamePrefix = "TTLMonitorWorker-";
+        options.minThreads = 0;
+        options.maxThreads = static_cast<size_t>(ttlMonitorMaxConcurrency);
+        options.onCreateThread = [](const std::string& threadName) {
+            Client::initThread(threadName);
+            AuthorizationSession::get(cc())->grantInternalAuthorization(&cc());
+            setClientOperationPriority(&cc(), OperationPriority::kBackground);
+        };
+        _workers = stdx::make_unique<ThreadPool>(options);
+        _workers->startup();
+
+        // Stop and reap the workers before the monitor's own client goes away, however it exits
+        ON_BLOCK_EXIT([this] {
+            _workers->shutdown();
+            _workers->join();
+        });
 
         while (!globalInShutdownDeprecated()) {
             {
@@ -119,6 +305,16 @@ public:
     }
 
 private:
+    /**
+     * State carried across the batches that make up one index's share of a TTL pass.
+     */
+    struct TTLIndexPass {
+        // Fixed at the first batch so that the pass terminates even if documents keep expiring.
+        boost::optional<Date_t> expirationTime;
+        long long lagSecs = 0;
+        long long numDeleted = 0;
+    };
+
     void doTTLPass() {
         const ServiceContext::UniqueOperationContext opCtxPtr = cc().makeOperationContext();
         OperationContext& opCtx = *opCtxPtr;
@@ -134,6 +330,7 @@ private:
         std::vector<BSONObj> ttlIndexes;
 
         ttlPasses.increment();
+        const long long pass = ++_passNumber;
 
         // Get all TTL indexes from every collection.
         for (const std::string& collectionNS : ttlCollections) {
@@ -157,22 +354,37 @@ private:
             }
         }
 
+        // Indexes are independent of each other, so spread them across the worker pool. Each
+        // worker runs under its own Client and OperationContext.
         for (const BSONObj& idx : ttlIndexes) {
-            try {
-                doTTLForIndex(&opCtx, idx);
-            } catch (const DBException& dbex) {
-                error() << "Error processing ttl index: " << idx << " -- " << dbex.toString();
-                // Continue on to the next index.
-                continue;
+            Status status = _workers->schedule([this, idx, pass] {
+                const ServiceContext::UniqueOperationContext workerOpCtx =
+                    cc().makeOperationContext();
+                try {
+                    doTTLForIndex(workerOpCtx.get(), idx, pass);
+                } catch (const DBException& dbex) {
+                    error() << "Error processing ttl index: " << idx << " -- " << dbex.toString();
+                }
+            });
+            if (!status.isOK()) {
+                LOG(1) << "unable to schedule ttl job for: " << idx << " -- " << status;
+                break;
             }
         }
+        _workers->waitForIdle();
+
+        ttlIndexStats.pruneNotSeenIn(pass);
     }
 
     /**
      * Remove documents from the collection using the specified TTL index after a sufficient amount
      * of time has passed according to its expiry specification.
+     *
+     * Expired documents are removed in batches of up to ttlMonitorBatchDeleteSize, each batch in
+     * its own WriteUnitOfWork. Locks are released between batches, which is also where the
+     * ttlMonitorMaxDeletesPerSecond limit is applied.
      */
-    void doTTLForIndex(OperationContext* opCtx, BSONObj idx) {
+    void doTTLForIndex(OperationContext* opCtx, BSONObj idx, long long pass) {
         const NamespaceString collectionNSS(idx["ns"].String());
         if (collectionNSS.isDropPendingNamespace()) {
             return;
@@ -184,7 +396,7 @@ private:
         }
 
         const BSONObj key = idx["key"].Obj();
-        const StringData name = idx["name"].valueStringData();
+        const std::string name = idx["name"].String();
         if (key.nFields() != 1) {
             error() << "key for ttl index can only have 1 field, skipping ttl job for: " << idx;
             return;
@@ -192,31 +404,72 @@ private:
 
         LOG(1) << "ns: " << collectionNSS << " key: " << key << " name: " << name;
 
+        Timer timer;
+        TTLIndexPass indexPass;
+        while (!globalInShutdownDeprecated() && ttlMonitorEnabled.load()) {
+            const int batchSize = ttlMonitorBatchDeleteSize.load();
+            const auto numDeleted =
+                deleteExpiredBatch(opCtx, collectionNSS, name, batchSize, &indexPass);
+            if (!numDeleted) {
+                break;
+            }
+
+            indexPass.numDeleted += *numDeleted;
+            ttlDeletedDocuments.increment(*numDeleted);
+            ttlDeleteRateLimiter.pace(opCtx, *numDeleted);
+
+            if (*numDeleted < batchSize) {
+                break;
+            }
+        }
+
+        if (indexPass.expirationTime) {
+            ttlIndexStats.record(collectionNSS,
+                                 name,
+                                 pass,
+                                 indexPass.lagSecs,
+                                 indexPass.numDeleted,
+                                 timer.millis());
+        }
+        LOG(1) << "deleted: " << indexPass.numDeleted;
+    }
+
+    /**
+     * Deletes up to 'batchSize' expired documents from 'collectionNSS' in a single
+     * WriteUnitOfWork, using the TTL index 'name' to find them. Returns the number of documents
+     * deleted, or boost::none if the index can no longer be processed during this pass.
+     */
+    boost::optional<long long> deleteExpiredBatch(OperationContext* opCtx,
+                                                  const NamespaceString& collectionNSS,
+                                                  const std::string& name,
+                                                  int batchSize,
+                                                  TTLIndexPass* indexPass) {
         AutoGetCollection autoGetCollection(opCtx, collectionNSS, MODE_IX);
         Collection* collection = autoGetCollection.getCollection();
         if (!collection) {
             // Collection was dropped.
-            return;
+            return boost::none;
         }
 
         if (!repl::ReplicationCoordinator::get(opCtx)->canAcceptWritesFor(opCtx, collectionNSS)) {
-            return;
+            return boost::none;
         }
 
         IndexDescriptor* desc = collection->getIndexCatalog()->findIndexByName(opCtx, name);
         if (!desc) {
             LOG(1) << "index not found (index build in progress? index dropped?), skipping "
-                   << "ttl job for: " << idx;
-            return;
+                   << "ttl job for: " << collectionNSS << " index: " << name;
+            return boost::none;
         }
 
-        // Re-read 'idx' from the descriptor, in case the collection or index definition changed
-        // before we re-acquired the collection lock.
-        idx = desc->infoObj();
+        // Read the spec from the descriptor, in case the collection or index definition changed
+        // since the pass started or since the previous batch released the collection lock.
+        const BSONObj idx = desc->infoObj();
+        const BSONObj key = desc->keyPattern();
 
         if (IndexType::INDEX_BTREE != IndexNames::nameToType(desc->getAccessMethodName())) {
             error() << "special index can't be used as a ttl index, skipping ttl job for: " << idx;
-            return;
+            return boost::none;
         }
 
         BSONElement secondsExpireElt = idx[secondsExpireField];
@@ -224,12 +477,16 @@ private:
             error() << "ttl indexes require the " << secondsExpireField << " field to be "
                     << "numeric but received a type of " << typeName(secondsExpireElt.type())
                     << ", skipping ttl job for: " << idx;
-            return;
+            return boost::none;
         }
 
         const Date_t kDawnOfTime =
             Date_t::fromMillisSinceEpoch(std::numeric_limits<long long>::min());
-        const Date_t expirationTime = Date_t::now() - Seconds(secondsExpireElt.numberLong());
+        const bool firstBatch = !indexPass->expirationTime;
+        if (firstBatch) {
+            indexPass->expirationTime = Date_t::now() - Seconds(secondsExpireElt.numberLong());
+        }
+        const Date_t expirationTime = *indexPass->expirationTime;
         const BSONObj startKey = BSON("" << kDawnOfTime);
         const BSONObj endKey = BSON("" << expirationTime);
         // The canonical check as to whether a key pattern element is "ascending" or
@@ -238,9 +495,27 @@ private:
             ? InternalPlanner::Direction::FORWARD
             : InternalPlanner::Direction::BACKWARD;
 
-        // We need to pass into the DeleteStageParams (below) a CanonicalQuery with a BSONObj that
-        // queries for the expired documents correctly so that we do not delete documents that are
-        // not actually expired when our snapshot changes during deletion.
+        if (firstBatch) {
+            // Both directions visit keys in ascending date order, so the first key in range
+            // belongs to the document that has been expired for the longest.
+            auto exec = InternalPlanner::indexScan(opCtx,
+                                                   collection,
+                                                   desc,
+                                                   startKey,
+                                                   endKey,
+                                                   BoundInclusion::kIncludeBothStartAndEndKeys,
+                                                   PlanExecutor::NO_YIELD,
+                                                   direction);
+            BSONObj oldestKey;
+            if (PlanExecutor::ADVANCED == exec->getNext(&oldestKey, nullptr) &&
+                oldestKey.firstElement().type() == BSONType::Date) {
+                indexPass->lagSecs = durationCount<Seconds>(expirationTime -
+                                                            oldestKey.firstElement().date());
+            }
+        }
+
+        // Documents are re-checked against this filter after being fetched so that we do not
+        // delete documents whose index key is stale with respect to our snapshot.
         const char* keyFieldName = key.firstElement().fieldName();
         BSONObj query =
             BSON(keyFieldName << BSON("$gte" << kDawnOfTime << "$lte" << expirationTime));
@@ -248,33 +523,53 @@ private:
         qr->setFilter(query);
         auto canonicalQuery = CanonicalQuery::canonicalize(opCtx, std::move(qr));
         invariant(canonicalQuery.getStatus());
+        const MatchExpression* filter = canonicalQuery.getValue()->root();
 
-        DeleteStageParams params;
-        params.isMulti = true;
-        params.canonicalQuery = canonicalQuery.getValue().get();
-
-        auto exec =
-            InternalPlanner::deleteWithIndexScan(opCtx,
-                                                 collection,
-                                                 params,
-                                                 desc,
-                                                 startKey,
-                                                 endKey,
-                                                 BoundInclusion::kIncludeBothStartAndEndKeys,
-                                                 PlanExecutor::YIELD_AUTO,
-                                                 direction);
-
-        Status result = exec->executePlan();
-        if (!result.isOK()) {
-            error() << "ttl query execution for index " << idx
-                    << " failed with status: " << redact(result);
-            return;
-        }
+        return writeConflictRetry(opCtx, "ttl", collectionNSS.ns(), [&]() -> long long {
+            WriteUnitOfWork wuow(opCtx);
+
+            std::vector<RecordId> expired;
+            {
+                auto exec = InternalPlanner::indexScan(opCtx,
+                                                       collection,
+                                                       desc,
+                                                       startKey,
+                                                       endKey,
+                                                       BoundInclusion::kIncludeBothStartAndEndKeys,
+                                                       PlanExecutor::NO_YIELD,
+                                                       direction,
+                                                       InternalPlanner::IXSCAN_FETCH);
+                BSONObj obj;
+                RecordId rid;
+                PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+                while (expired.size() < static_cast<size_t>(batchSize) &&
+                       PlanExecutor::ADVANCED == (state = exec->getNext(&obj, &rid))) {
+                    if (filter->matchesBSON(obj)) {
+                        expired.push_back(rid);
+                    }
+                }
 
-        const long long numDeleted = DeleteStage::getNumDeleted(*exec);
-        ttlDeletedDocuments.increment(numDeleted);
-        LOG(1) << "deleted: " << numDeleted;
+                if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
+                    uasserted(ErrorCodes::OperationFailed,
+                              str::stream() << "ttl index scan failed: "
+                                            << WorkingSetCommon::toStatusString(obj));
+                }
+            }
+
+            // Each document is deleted at the timestamp of its own oplog entry.
+            if (!expired.empty()) {
+                collection->deleteDocuments(opCtx, expired, nullptr, false);
+            }
+            wuow.commit();
+
+            return static_cast<long long>(expired.size());
+        });
     }
+
+    // Runs the per-index deletion work of each pass.
+    std::unique_ptr<ThreadPool> _workers;
+
+    long long _passNumber = 0;
 };
 
 namespace {
@@ -33,6 +33,7 @@
 #include "mongo/platform/basic.h"
 
 #include <cstdint>
+#include <vector>
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_catalog.h"
@@ -40,7 +41,10 @@
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/storage_engine_init.h"
 #include "mongo/dbtests/dbtests.h"
@@ -204,7 +208,12 @@ public:
                                   << background);
 
         ASSERT_OK(indexer.init(spec).getStatus());
-        const Status status = indexer.insertAllDocumentsInCollection();
+        Status status = indexer.insertAllDocumentsInCollection();
+        if (status.isOK()) {
+            // Hybrid background builds check unique constraints once concurrent writes have been
+            // applied.
+            status = indexer.checkConstraints();
+        }
         ASSERT_EQUALS(status.code(), ErrorCodes::DuplicateKey);
     }
 };
@@ -272,6 +281,328 @@ public:
     }
 };
 
+/**
+ * Fixture for hybrid background index builds on {a: 1}. The tests feed the bulk builder by hand
+ * with the documents a collection scan would have returned, so that writes can be made to the
+ * collection between the scan and the drain, as a concurrent writer would.
+ */
+class HybridIndexBuildBase : public IndexBuildBase {
+public:
+    HybridIndexBuildBase() {
+        ASSERT_OK(serverParameter("enableHybridIndexBuilds")->setFromString("true"));
+    }
+
+    ~HybridIndexBuildBase() {
+        serverParameter("enableHybridIndexBuilds")->setFromString("false").transitional_ignore();
+    }
+
+protected:
+    static ServerParameter* serverParameter(StringData name) {
+        const auto& parameters = ServerParameterSet::getGlobal()->getMap();
+        auto it = parameters.find(name.toString());
+        invariant(it != parameters.end());
+        return it->second;
+    }
+
+    BSONObj indexSpec(bool unique) {
+        return BSON("name"
+                    << "a"
+                    << "ns"
+                    << _ns
+                    << "key"
+                    << BSON("a" << 1)
+                    << "v"
+                    << static_cast<int>(kIndexVersion)
+                    << "unique"
+                    << unique
+                    << "background"
+                    << true);
+    }
+
+    RecordId insertDoc(const BSONObj& doc) {
+        WriteUnitOfWork wunit(&_opCtx);
+        OpDebug* const nullOpDebug = nullptr;
+        ASSERT_OK(collection()->insertDocument(&_opCtx, InsertStatement(doc), nullOpDebug, true));
+        wunit.commit();
+        return Helpers::findOne(&_opCtx, collection(), BSON("_id" << doc["_id"]), false);
+    }
+
+    void updateDoc(const RecordId& loc, const BSONObj& newDoc) {
+        WriteUnitOfWork wunit(&_opCtx);
+        auto oldDoc = collection()->docFor(&_opCtx, loc);
+        OplogUpdateEntryArgs args;
+        args.nss = collection()->ns();
+        collection()->updateDocument(&_opCtx, loc, oldDoc, newDoc, false, true, nullptr, &args);
+        wunit.commit();
+    }
+
+    void deleteDoc(const RecordId& loc) {
+        WriteUnitOfWork wunit(&_opCtx);
+        OpDebug* const nullOpDebug = nullptr;
+        collection()->deleteDocument(&_opCtx, kUninitializedStmtId, loc, nullOpDebug);
+        wunit.commit();
+    }
+
+    /**
+     * Feeds every document currently in the collection to the bulk builder.
+     */
+    void scanCollection(MultiIndexBlock* indexer) {
+        auto cursor = collection()->getCursor(&_opCtx);
+        while (auto record = cursor->next()) {
+            WriteUnitOfWork wunit(&_opCtx);
+            ASSERT_OK(indexer->insert(record->data.releaseToBson(), record->id));
+            wunit.commit();
+        }
+    }
+
+    /**
+     * Returns the values of 'a' in the index, in index order.
+     */
+    std::vector<int> indexedValues() {
+        auto descriptor = collection()->getIndexCatalog()->findIndexByName(&_opCtx, "a", true);
+        ASSERT(descriptor);
+        auto cursor = collection()->getIndexCatalog()->getIndex(descriptor)->newCursor(&_opCtx);
+        std::vector<int> values;
+        for (auto kv = cursor->seek(BSON("" << MINKEY), true); kv; kv = cursor->next()) {
+            values.push_back(kv->key.firstElement().numberInt());
+        }
+        return values;
+    }
+};
+
+/** Writes made during a hybrid index build are applied to the index before it is committed. */
+class HybridBuildAppliesConcurrentWrites : public HybridIndexBuildBase {
+public:
+    void run() {
+        std::vector<RecordId> locs;
+        for (int i = 0; i < 5; ++i) {
+            locs.push_back(insertDoc(BSON("_id" << i << "a" << i)));
+        }
+
+        MultiIndexBlock indexer(&_opCtx, collection());
+        indexer.allowBackgroundBuilding();
+        indexer.allowInterruption();
+        ASSERT_OK(indexer.init(indexSpec(false)).getStatus());
+        ASSERT(indexer.getBuildInBackground());
+
+        scanCollection(&indexer);
+
+        deleteDoc(locs[0]);
+        updateDoc(locs[1], BSON("_id" << 1 << "a" << 10));
+        insertDoc(BSON("_id" << 5 << "a" << 5));
+
+        // Nothing may reach the index before the bulk load.
+        ASSERT(indexedValues().empty());
+
+        ASSERT_OK(indexer.doneInserting());
+        ASSERT_OK(indexer.drainBackgroundWrites());
+        ASSERT_OK(indexer.checkConstraints());
+        {
+            WriteUnitOfWork wunit(&_opCtx);
+            indexer.commit();
+            wunit.commit();
+        }
+
+        ASSERT(indexedValues() == std::vector<int>({2, 3, 4, 5, 10}));
+
+        // Once committed, writes go straight to the index.
+        insertDoc(BSON("_id" << 6 << "a" << 6));
+        ASSERT(indexedValues() == std::vector<int>({2, 3, 4, 5, 6, 10}));
+    }
+};
+
+/** A duplicate seen by the scan of a hybrid build is allowed if a concurrent write resolves it. */
+class HybridBuildUniqueDuplicateResolvedByConcurrentWrite : public HybridIndexBuildBase {
+public:
+    void run() {
+        insertDoc(BSON("_id" << 0 << "a" << 1));
+        RecordId loc = insertDoc(BSON("_id" << 1 << "a" << 1));
+
+        MultiIndexBlock indexer(&_opCtx, collection());
+        indexer.allowBackgroundBuilding();
+        indexer.allowInterruption();
+        ASSERT_OK(indexer.init(indexSpec(true)).getStatus());
+
+        scanCollection(&indexer);
+        ASSERT_OK(indexer.doneInserting());
+
+        updateDoc(loc, BSON("_id" << 1 << "a" << 2));
+
+        ASSERT_OK(indexer.drainBackgroundWrites());
+        ASSERT_OK(indexer.checkConstraints());
+        {
+            WriteUnitOfWork wunit(&_opCtx);
+            indexer.commit();
+            wunit.commit();
+        }
+
+        ASSERT(indexedValues() == std::vector<int>({1, 2}));
+    }
+};
+
+/** A duplicate introduced by a concurrent write fails a hybrid build of a unique index. */
+class HybridBuildUniqueDuplicateFromConcurrentWrite : public HybridIndexBuildBase {
+public:
+    void run() {
+        insertDoc(BSON("_id" << 0 << "a" << 1));
+
+        MultiIndexBlock indexer(&_opCtx, collection());
+        indexer.allowBackgroundBuilding();
+        indexer.allowInterruption();
+        ASSERT_OK(indexer.init(indexSpec(true)).getStatus());
+
+        scanCollection(&indexer);
+        ASSERT_OK(indexer.doneInserting());
+
+        insertDoc(BSON("_id" << 1 << "a" << 1));
+
+        ASSERT_OK(indexer.drainBackgroundWrites());
+        ASSERT_EQUALS(ErrorCodes::DuplicateKey, indexer.checkConstraints());
+    }
+};
+
+/**
+ * A hybrid build whose concurrent writes outgrow the side writes buffer is failed at the drain,
+ * while the writers themselves succeed.
+ */
+class HybridBuildFailsWhenSideWritesExceedMemoryLimit : public HybridIndexBuildBase {
+public:
+    HybridBuildFailsWhenSideWritesExceedMemoryLimit() {
+        ASSERT_OK(limitParameter()->setFromString("0"));
+    }
+
+    ~HybridBuildFailsWhenSideWritesExceedMemoryLimit() {
+        limitParameter()->setFromString("200").transitional_ignore();
+    }
+
+    void run() {
+        insertDoc(BSON("_id" << 0 << "a" << 0));
+
+        MultiIndexBlock indexer(&_opCtx, collection());
+        indexer.allowBackgroundBuilding();
+        indexer.allowInterruption();
+        ASSERT_OK(indexer.init(indexSpec(false)).getStatus());
+
+        scanCollection(&indexer);
+
+        insertDoc(BSON("_id" << 1 << "a" << 1));
+        insertDoc(BSON("_id" << 2 << "a" << 2));
+        ASSERT_EQUALS(3LL, collection()->numRecords(&_opCtx));
+
+        ASSERT_OK(indexer.doneInserting());
+        ASSERT_EQUALS(ErrorCodes::ExceededMemoryLimit, indexer.drainBackgroundWrites());
+    }
+
+private:
+    static ServerParameter* limitParameter() {
+        return serverParameter("maxIndexBuildSideWritesMemoryUsageMegabytes");
+    }
+};
+
+/** With hybrid builds disabled, writes made during a background build go to the live index. */
+class NonHybridBackgroundBuildIndexesWritesDirectly : public HybridIndexBuildBase {
+public:
+    void run() {
+        ASSERT_OK(serverParameter("enableHybridIndexBuilds")->setFromString("false"));
+        insertDoc(BSON("_id" << 0 << "a" << 0));
+
+        MultiIndexBlock indexer(&_opCtx, collection());
+        indexer.allowBackgroundBuilding();
+        indexer.allowInterruption();
+        ASSERT_OK(indexer.init(indexSpec(false)).getStatus());
+        ASSERT(indexer.getBuildInBackground());
+
+        // Writes go straight to the index being built.
+        insertDoc(BSON("_id" << 1 << "a" << 1));
+        ASSERT(indexedValues() == std::vector<int>({1}));
+
+        ASSERT_OK(indexer.insertAllDocumentsInCollection());
+        ASSERT_OK(indexer.drainBackgroundWrites());
+        {
+            WriteUnitOfWork wunit(&_opCtx);
+            indexer.commit();
+            wunit.commit();
+        }
+        ASSERT(indexedValues() == std::vector<int>({0, 1}));
+    }
+};
+
+/** Keys generated on several threads are all merged into the indexes of the build. */
+class ParallelKeyGenerationBuildsAllKeys : public IndexBuildBase {
+public:
+    ParallelKeyGenerationBuildsAllKeys() {
+        ASSERT_OK(threadsParameter()->setFromString("4"));
+    }
+
+    ~ParallelKeyGenerationBuildsAllKeys() {
+        threadsParameter()->setFromString("0").transitional_ignore();
+    }
+
+    void run() {
+        const int kNumDocs = 3000;
+        {
+            WriteUnitOfWork wunit(&_opCtx);
+            OpDebug* const nullOpDebug = nullptr;
+            for (int i = 0; i < kNumDocs; ++i) {
+                // Even documents index two keys into {b: 1}.
+                BSONObj doc = i % 2 == 0
+                    ? BSON("_id" << i << "a" << i << "b" << BSON_ARRAY(i << i + kNumDocs))
+                    : BSON("_id" << i << "a" << i << "b" << i);
+                ASSERT_OK(collection()->insertDocument(
+                    &_opCtx, InsertStatement(doc), nullOpDebug, true));
+            }
+            wunit.commit();
+        }
+
+        MultiIndexBlock indexer(&_opCtx, collection());
+        std::vector<BSONObj> specs;
+        for (auto field : {"a", "b"}) {
+            specs.push_back(BSON("name" << field << "ns" << _ns << "key" << BSON(field << 1) << "v"
+                                        << static_cast<int>(kIndexVersion)));
+        }
+        ASSERT_OK(indexer.init(specs).getStatus());
+        ASSERT_OK(indexer.insertAllDocumentsInCollection());
+        {
+            WriteUnitOfWork wunit(&_opCtx);
+            indexer.commit();
+            wunit.commit();
+        }
+
+        ASSERT_EQUALS(kNumDocs, countKeys("a"));
+        ASSERT_EQUALS(kNumDocs / 2 * 3, countKeys("b"));
+
+        auto indexCatalog = collection()->getIndexCatalog();
+        ASSERT_FALSE(indexCatalog->getEntry(indexCatalog->findIndexByName(&_opCtx, "a"))
+                         ->isMultikey(&_opCtx));
+        ASSERT_TRUE(indexCatalog->getEntry(indexCatalog->findIndexByName(&_opCtx, "b"))
+                        ->isMultikey(&_opCtx));
+    }
+
+private:
+    static ServerParameter* threadsParameter() {
+        const auto& parameters = ServerParameterSet::getGlobal()->getMap();
+        auto it = parameters.find("indexBuildKeyGenerationThreads");
+        invariant(it != parameters.end());
+        return it->second;
+    }
+
+    int countKeys(StringData indexName) {
+        auto indexCatalog = collection()->getIndexCatalog();
+        auto descriptor = indexCatalog->findIndexByName(&_opCtx, indexName);
+        ASSERT(descriptor);
+        auto cursor = indexCatalog->getIndex(descriptor)->newCursor(&_opCtx);
+        int numKeys = 0;
+        BSONObj previousKey;
+        for (auto kv = cursor->seek(BSON("" << MINKEY), true); kv; kv = cursor->next()) {
+            // Keys merged from the threads' partitions must come back in order.
+            ASSERT_LTE(previousKey.woCompare(kv->key, BSONObj(), false), 0);
+            previousKey = kv->key.getOwned();
+            ++numKeys;
+        }
+        return numKeys;
+    }
+};
+
 /** Index creation is killed if mayInterrupt is true. */
 class InsertBuildIndexInterrupt : public IndexBuildBase {
 public:
@@ -827,11 +1158,17 @@ public:
             // tests are disabled.
             add<InsertBuildIgnoreUnique<true>>();
             add<InsertBuildIgnoreUnique<false>>();
+            add<HybridBuildUniqueDuplicateResolvedByConcurrentWrite>();
+            add<HybridBuildUniqueDuplicateFromConcurrentWrite>();
         }
         add<InsertBuildEnforceUnique<true>>();
         add<InsertBuildEnforceUnique<false>>();
         add<InsertBuildFillDups<true>>();
         add<InsertBuildFillDups<false>>();
+        add<HybridBuildAppliesConcurrentWrites>();
+        add<HybridBuildFailsWhenSideWritesExceedMemoryLimit>();
+        add<NonHybridBackgroundBuildIndexesWritesDirectly>();
+        add<ParallelKeyGenerationBuildsAllKeys>();
         add<InsertBuildIndexInterrupt>();
         add<InsertBuildIndexInterruptDisallowed>();
         add<InsertBuildIdIndexInterrupt>();
@@ -39,6 +39,8 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace QueryStageIxscan {
@@ -316,6 +318,127 @@ public:
     }
 };
 
+/**
+ * Scans of the index {x: 1, y: 1} whose parent reads only a prefix of each key.
+ */
+class IndexScanKeyPrefixTest : public IndexScanTest {
+public:
+    void setup() override {
+        IndexScanTest::setup();
+
+        WriteUnitOfWork wunit(&_opCtx);
+        ASSERT_OK(_coll->getIndexCatalog()->createIndexOnEmptyCollection(
+            &_opCtx,
+            BSON("ns" << ns() << "key" << kKeyPattern << "name"
+                      << DBClientBase::genIndexName(kKeyPattern)
+                      << "v"
+                      << static_cast<int>(kIndexVersion))));
+        wunit.commit();
+
+        insert(fromjson("{_id: 1, x: 5, y: 'a'}"));
+        insert(fromjson("{_id: 2, x: 6, y: 'b'}"));
+    }
+
+    /**
+     * Returns the parameters of a scan for x in 'xValues' which asks the cursor to decode only
+     * 'numKeyFieldsToDecode' fields of each key.
+     */
+    IndexScanParams makeParams(const std::vector<double>& xValues, size_t numKeyFieldsToDecode) {
+        std::vector<IndexDescriptor*> indexes;
+        _coll->getIndexCatalog()->findIndexesByKeyPattern(&_opCtx, kKeyPattern, false, &indexes);
+        ASSERT_EQ(indexes.size(), 1U);
+
+        IndexScanParams params;
+        params.descriptor = indexes[0];
+        params.numKeyFieldsToDecode = numKeyFieldsToDecode;
+
+        OrderedIntervalList xList("x");
+        for (double x : xValues) {
+            xList.intervals.push_back(IndexBoundsBuilder::makePointInterval(x));
+        }
+        params.bounds.fields.push_back(xList);
+
+        OrderedIntervalList yList("y");
+        yList.intervals.push_back(IndexBoundsBuilder::allValues());
+        params.bounds.fields.push_back(yList);
+
+        return params;
+    }
+
+    /**
+     * Returns the first key returned by a scan with 'params' and 'filter'.
+     */
+    BSONObj getFirstKey(const IndexScanParams& params, const MatchExpression* filter = nullptr) {
+        IndexScan ixscan(&_opCtx, params, &_ws, filter);
+        WorkingSetMember* member = getNext(&ixscan);
+        ASSERT_EQ(WorkingSetMember::RID_AND_IDX, member->getState());
+        return member->keyData[0].keyData.getOwned();
+    }
+
+protected:
+    const BSONObj kKeyPattern = BSON("x" << 1 << "y" << 1);
+    const BSONObj kFullKey = BSON("" << 5 << ""
+                                     << "a");
+};
+
+class QueryStageIxscanDecodesKeyPrefix : public IndexScanKeyPrefixTest {
+public:
+    void run() {
+        setup();
+        ASSERT_BSONOBJ_EQ(BSON("" << 5), getFirstKey(makeParams({5}, 1)));
+    }
+};
+
+// Zero asks for the whole key, as do values which cover all of the key's fields.
+class QueryStageIxscanKeyPrefixOutOfRange : public IndexScanKeyPrefixTest {
+public:
+    void run() {
+        setup();
+        ASSERT_BSONOBJ_EQ(kFullKey, getFirstKey(makeParams({5}, 0)));
+        ASSERT_BSONOBJ_EQ(kFullKey, getFirstKey(makeParams({5}, 2)));
+        ASSERT_BSONOBJ_EQ(kFullKey, getFirstKey(makeParams({5}, 3)));
+    }
+};
+
+// A filter looks at fields past the prefix, so the whole key is decoded.
+class QueryStageIxscanKeyPrefixDisabledByFilter : public IndexScanKeyPrefixTest {
+public:
+    void run() {
+        setup();
+
+        const CollatorInterface* collator = nullptr;
+        const boost::intrusive_ptr<ExpressionContext> expCtx(
+            new ExpressionContext(&_opCtx, collator));
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(fromjson("{y: 'a'}"), expCtx);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        std::unique_ptr<MatchExpression> filter = std::move(statusWithMatcher.getValue());
+
+        ASSERT_BSONOBJ_EQ(kFullKey, getFirstKey(makeParams({5}, 1), filter.get()));
+    }
+};
+
+// Key metadata is the whole key, so it is decoded.
+class QueryStageIxscanKeyPrefixDisabledByKeyMetadata : public IndexScanKeyPrefixTest {
+public:
+    void run() {
+        setup();
+
+        IndexScanParams params = makeParams({5}, 1);
+        params.addKeyMetadata = true;
+        ASSERT_BSONOBJ_EQ(kFullKey, getFirstKey(params));
+    }
+};
+
+// Bounds of more than one interval are checked against the whole key, so it is decoded.
+class QueryStageIxscanKeyPrefixDisabledByBoundsChecker : public IndexScanKeyPrefixTest {
+public:
+    void run() {
+        setup();
+        ASSERT_BSONOBJ_EQ(kFullKey, getFirstKey(makeParams({5, 6}, 1)));
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_ixscan") {}
@@ -326,6 +449,11 @@ public:
         add<QueryStageIxscanInsertDuringSaveExclusive>();
         add<QueryStageIxscanInsertDuringSaveExclusive2>();
         add<QueryStageIxscanInsertDuringSaveReverse>();
+        add<QueryStageIxscanDecodesKeyPrefix>();
+        add<QueryStageIxscanKeyPrefixOutOfRange>();
+        add<QueryStageIxscanKeyPrefixDisabledByFilter>();
+        add<QueryStageIxscanKeyPrefixDisabledByKeyMetadata>();
+        add<QueryStageIxscanKeyPrefixDisabledByBoundsChecker>();
     }
 } QueryStageIxscanAll;
 
@@ -35,11 +35,14 @@
 #include "mongo/s/async_requests_sender.h"
 
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/db/query/killcursors_request.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/host_latency_tracker.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/baton.h"
 #include "mongo/transport/transport_layer.h"
@@ -51,11 +54,110 @@ namespace mongo {
 
 MONGO_EXPORT_SERVER_PARAMETER(AsyncRequestsSenderUseBaton, bool, true);
 
+// Whether reads with a 'nearest' or 'secondaryPreferred' read preference are hedged.
+MONGO_EXPORT_SERVER_PARAMETER(AsyncRequestsSenderEnableHedgedReads, bool, false);
+
+// The percentile of the recent latencies of a host after which a request to it is hedged.
+MONGO_EXPORT_SERVER_PARAMETER(AsyncRequestsSenderHedgeDelayPercentile, int, 95)
+    ->withValidator([](const int& newVal) {
+        if (newVal > 0 && newVal <= 100) {
+            return Status::OK();
+        }
+        return Status(ErrorCodes::BadValue,
+                      "AsyncRequestsSenderHedgeDelayPercentile must be between 1 and 100");
+    });
+
+// Bounds on the delay before a request is hedged. The maximum is also used for hosts whose latency
+// has not been measured yet.
+MONGO_EXPORT_SERVER_PARAMETER(AsyncRequestsSenderHedgeMinDelayMS, int, 5)
+    ->withValidator([](const int& newVal) {
+        if (newVal >= 0) {
+            return Status::OK();
+        }
+        return Status(ErrorCodes::BadValue,
+                      "AsyncRequestsSenderHedgeMinDelayMS must be greater than or equal to 0");
+    });
+MONGO_EXPORT_SERVER_PARAMETER(AsyncRequestsSenderHedgeMaxDelayMS, int, 200)
+    ->withValidator([](const int& newVal) {
+        if (newVal >= 0) {
+            return Status::OK();
+        }
+        return Status(ErrorCodes::BadValue,
+                      "AsyncRequestsSenderHedgeMaxDelayMS must be greater than or equal to 0");
+    });
+
 namespace {
 
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+bool shouldHedgeReads(const ReadPreferenceSetting& readPref) {
+    return AsyncRequestsSenderEnableHedgedReads.load() &&
+        (readPref.pref == ReadPreference::Nearest ||
+         readPref.pref == ReadPreference::SecondaryPreferred);
+}
+
+/**
+ * Returns whether 'cmdObj' may be hedged. Commands which operate on an existing cursor are not,
+ * since the cursor only exists on the host which opened it.
+ */
+bool isHedgeableCommand(const BSONObj& cmdObj) {
+    const StringData cmdName = cmdObj.firstElementFieldName();
+    return cmdName != "getMore"_sd && cmdName != "killCursors"_sd;
+}
+
+/**
+ * If 'response' opened a cursor on 'host', schedules a killCursors for it. The response belongs
+ * to a request which lost to its hedged counterpart, so the cursor will never be iterated.
+ */
+void killAbandonedCursor(executor::TaskExecutor* executor,
+                         const HostAndPort& host,
+                         const executor::RemoteCommandResponse& response) {
+    if (!response.isOK()) {
+        return;
+    }
+
+    auto swCursorResponse = CursorResponse::parseFromBSON(response.data);
+    if (!swCursorResponse.isOK() || swCursorResponse.getValue().getCursorId() == 0) {
+        return;
+    }
+
+    const auto& cursorResponse = swCursorResponse.getValue();
+    const auto& nss = cursorResponse.getNSS();
+
+    LOG(2) << "Killing cursor " << cursorResponse.getCursorId() << " on " << nss << " at host "
+           << host << " opened by a request which lost to its hedged counterpart";
+
+    BSONObj cmdObj = KillCursorsRequest(nss, {cursorResponse.getCursorId()}).toBSON();
+    executor::RemoteCommandRequest request(host, nss.db().toString(), cmdObj, nullptr);
+
+    // We do not process the response to the killCursors request (we make a good-faith attempt at
+    // cleaning up the cursor, but ignore any returned errors).
+    executor
+        ->scheduleRemoteCommand(
+            request, [](const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData) {})
+        .status_with_transitional_ignore();
+}
+
+/**
+ * Returns how long to wait for a response from 'host' before hedging the request.
+ */
+Milliseconds getHedgeDelay(ServiceContext* serviceContext, const HostAndPort& host) {
+    const Milliseconds minDelay(AsyncRequestsSenderHedgeMinDelayMS.load());
+    const Milliseconds maxDelay(AsyncRequestsSenderHedgeMaxDelayMS.load());
+
+    const auto latency = HostLatencyTracker::get(serviceContext)
+                             ->getLatencyPercentile(host,
+                                                    AsyncRequestsSenderHedgeDelayPercentile.load());
+    if (!latency) {
+        return std::max(minDelay, maxDelay);
+    }
+
+    // Round up, so that sub-millisecond latencies do not cause every request to be hedged.
+    const Milliseconds delay((durationCount<Microseconds>(*latency) + 999) / 1000);
+    return std::max(minDelay, std::min(maxDelay, delay));
+}
+
 }  // namespace
 
 AsyncRequestsSender::AsyncRequestsSender(OperationContext* opCtx,
@@ -69,7 +171,8 @@ AsyncRequestsSender::AsyncRequestsSender(OperationContext* opCtx,
       _baton(opCtx),
       _db(dbName.toString()),
       _readPreference(readPreference),
-      _retryPolicy(retryPolicy) {
+      _retryPolicy(retryPolicy),
+      _hedgeReads(shouldHedgeReads(readPreference)) {
     for (const auto& request : requests) {
         _remotes.emplace_back(request.shardId, request.cmdObj);
     }
@@ -88,6 +191,11 @@ AsyncRequestsSender::~AsyncRequestsSender() {
     while (!done()) {
         next();
     }
+
+    // Wait on the callbacks of requests which lost to their hedged counterpart.
+    while (_hasOutstandingCallbacks()) {
+        _makeProgress(nullptr);
+    }
 }
 
 AsyncRequestsSender::Response AsyncRequestsSender::next() {
@@ -115,6 +223,20 @@ AsyncRequestsSender::Response AsyncRequestsSender::next() {
     return *readyResponse;
 }
 
+size_t AsyncRequestsSender::addRequest(const Request& request) {
+    _remotes.emplace_back(request.shardId, request.cmdObj);
+
+    if (_stopRetrying) {
+        _remotes.back().swResponse = !_interruptStatus.isOK()
+            ? _interruptStatus
+            : Status(ErrorCodes::CallbackCanceled, "request added after retries were stopped");
+    } else {
+        _scheduleRequests();
+    }
+
+    return _remotes.size() - 1;
+}
+
 void AsyncRequestsSender::stopRetrying() {
     _stopRetrying = true;
 }
@@ -132,12 +254,17 @@ void AsyncRequestsSender::_cancelPendingRequests() {
         if (remote.cbHandle.isValid()) {
             _executor->cancel(remote.cbHandle);
         }
+        if (remote.hedgeCbHandle.isValid()) {
+            _executor->cancel(remote.hedgeCbHandle);
+        }
+        remote.hedgeDeadline.reset();
     }
 }
 
 boost::optional<AsyncRequestsSender::Response> AsyncRequestsSender::_ready() {
     if (!_stopRetrying) {
         _scheduleRequests();
+        _scheduleHedgedRequests();
     }
 
     // If we have baton requests, we want to process those before proceeding
@@ -147,23 +274,28 @@ boost::optional<AsyncRequestsSender::Response> AsyncRequestsSender::_ready() {
 
     // Check if any remote is ready.
     invariant(!_remotes.empty());
-    for (auto& remote : _remotes) {
+    for (size_t i = 0; i < _remotes.size(); ++i) {
+        auto& remote = _remotes[i];
         if (remote.swResponse && !remote.done) {
             remote.done = true;
             if (remote.swResponse->isOK()) {
                 invariant(remote.shardHostAndPort);
-                return Response(std::move(remote.shardId),
-                                std::move(remote.swResponse->getValue()),
-                                std::move(*remote.shardHostAndPort));
+                Response response(std::move(remote.shardId),
+                                  std::move(remote.swResponse->getValue()),
+                                  std::move(*remote.shardHostAndPort));
+                response.requestIndex = i;
+                return response;
             } else {
                 // If _interruptStatus is set, promote CallbackCanceled errors to it.
                 if (!_interruptStatus.isOK() &&
                     ErrorCodes::CallbackCanceled == remote.swResponse->getStatus().code()) {
                     remote.swResponse = _interruptStatus;
                 }
-                return Response(std::move(remote.shardId),
-                                std::move(remote.swResponse->getStatus()),
-                                std::move(remote.shardHostAndPort));
+                Response response(std::move(remote.shardId),
+                                  std::move(remote.swResponse->getStatus()),
+                                  std::move(remote.shardHostAndPort));
+                response.requestIndex = i;
+                return response;
             }
         }
     }
@@ -215,7 +347,7 @@ void AsyncRequestsSender::_scheduleRequests() {
         }
 
         // If the remote does not have a response or pending request, schedule remote work for it.
-        if (!remote.swResponse && !remote.cbHandle.isValid()) {
+        if (!remote.swResponse && !remote.cbHandle.isValid() && !remote.hedgeCbHandle.isValid()) {
             auto scheduleStatus = _scheduleRequest(i);
             if (!scheduleStatus.isOK()) {
                 remote.swResponse = std::move(scheduleStatus);
@@ -244,26 +376,113 @@ Status AsyncRequestsSender::_scheduleRequest(size_t remoteIndex) {
         return resolveStatus;
     }
 
-    executor::RemoteCommandRequest request(
-        *remote.shardHostAndPort, _db, remote.cmdObj, _metadataObj, _opCtx);
+    auto callbackStatus = _scheduleCommand(remoteIndex, *remote.shardHostAndPort, false);
+    if (!callbackStatus.isOK()) {
+        return callbackStatus.getStatus();
+    }
+
+    remote.cbHandle = callbackStatus.getValue();
+    remote.sendDate = _now();
+
+    if (_hedgeReads && isHedgeableCommand(remote.cmdObj)) {
+        remote.hedgeDeadline =
+            remote.sendDate + getHedgeDelay(_opCtx->getServiceContext(), *remote.shardHostAndPort);
+    }
+
+    return Status::OK();
+}
 
-    auto callbackStatus = _executor->scheduleRemoteCommand(
+void AsyncRequestsSender::_scheduleHedgedRequests() {
+    invariant(!_stopRetrying);
+
+    if (!_hedgeReads) {
+        return;
+    }
+
+    const auto now = _now();
+    for (size_t i = 0; i < _remotes.size(); ++i) {
+        auto& remote = _remotes[i];
+
+        if (!remote.hedgeDeadline || *remote.hedgeDeadline > now) {
+            continue;
+        }
+
+        // Only one hedged request is sent per request.
+        remote.hedgeDeadline.reset();
+
+        invariant(remote.cbHandle.isValid());
+        invariant(!remote.hedgeCbHandle.isValid());
+
+        auto shard = remote.getShard();
+        if (!shard) {
+            continue;
+        }
+
+        const auto candidates = shard->getTargeter()->findAlternateHostsNoWait(
+            _readPreference, *remote.shardHostAndPort);
+        if (candidates.empty()) {
+            continue;
+        }
+
+        const auto host = HostLatencyTracker::get(_opCtx->getServiceContext())
+                              ->selectFastestHost(candidates);
+
+        auto callbackStatus = _scheduleCommand(i, host, true);
+        if (!callbackStatus.isOK()) {
+            // The original request is still outstanding, so there is nothing else to do.
+            LOG(1) << "Failed to send hedged request to remote " << remote.shardId << " at host "
+                   << host << causedBy(redact(callbackStatus.getStatus()));
+            continue;
+        }
+
+        LOG(2) << "Request to remote " << remote.shardId << " at host " << *remote.shardHostAndPort
+               << " was not answered after " << (now - remote.sendDate)
+               << ", sent hedged request to host " << host;
+
+        remote.hedgeCbHandle = callbackStatus.getValue();
+        remote.hedgeHostAndPort = host;
+        remote.hedgeSendDate = now;
+    }
+}
+
+StatusWith<executor::TaskExecutor::CallbackHandle> AsyncRequestsSender::_scheduleCommand(
+    size_t remoteIndex, const HostAndPort& host, bool hedged) {
+    const auto& remote = _remotes[remoteIndex];
+
+    executor::RemoteCommandRequest request(host, _db, remote.cmdObj, _metadataObj, _opCtx);
+
+    return _executor->scheduleRemoteCommand(
         request,
-        [remoteIndex, this](const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData) {
+        [remoteIndex, hedged, this](
+            const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData) {
             if (_baton) {
                 _batonRequests++;
                 _baton->schedule([this] { _batonRequests--; });
             }
 
-            _responseQueue.push(Job{cbData, remoteIndex});
+            _responseQueue.push(Job{cbData, remoteIndex, hedged});
         },
         _baton);
-    if (!callbackStatus.isOK()) {
-        return callbackStatus.getStatus();
+}
+
+boost::optional<Date_t> AsyncRequestsSender::_nextHedgeDeadline() const {
+    boost::optional<Date_t> deadline;
+    for (const auto& remote : _remotes) {
+        if (remote.hedgeDeadline && (!deadline || *remote.hedgeDeadline < *deadline)) {
+            deadline = remote.hedgeDeadline;
+        }
     }
+    return deadline;
+}
 
-    remote.cbHandle = callbackStatus.getValue();
-    return Status::OK();
+bool AsyncRequestsSender::_hasOutstandingCallbacks() const {
+    return std::any_of(_remotes.begin(), _remotes.end(), [](const RemoteData& remote) {
+        return remote.cbHandle.isValid() || remote.hedgeCbHandle.isValid();
+    });
+}
+
+Date_t AsyncRequestsSender::_now() const {
+    return _opCtx->getServiceContext()->getPreciseClockSource()->now();
 }
 
 // Passing opCtx means you'd like to opt into opCtx interruption.  During cleanup we actually don't.
@@ -272,12 +491,25 @@ void AsyncRequestsSender::_makeProgress(OperationContext* opCtx) {
 
     boost::optional<Job> job;
 
+    // Stop waiting when the next hedged request is due.
+    const auto hedgeDeadline = _stopRetrying ? boost::none : _nextHedgeDeadline();
+
     if (_baton) {
         // If we're using a baton, we peek the queue, and block on the baton if it's empty
         if (boost::optional<boost::optional<Job>> tryJob = _responseQueue.tryPop()) {
             job = std::move(*tryJob);
         } else {
-            _baton->run(opCtx, boost::none);
+            _baton->run(opCtx, hedgeDeadline);
+        }
+    } else if (hedgeDeadline) {
+        try {
+            job = opCtx ? _responseQueue.pop(opCtx, *hedgeDeadline)
+                        : _responseQueue.pop(*hedgeDeadline);
+        } catch (const ExceptionFor<ErrorCodes::ExceededTimeLimit>&) {
+            // The operation's own deadline may have expired before the hedge deadline.
+            if (_now() < *hedgeDeadline) {
+                throw;
+            }
         }
     } else {
         // Otherwise we block on the queue
@@ -289,11 +521,68 @@ void AsyncRequestsSender::_makeProgress(OperationContext* opCtx) {
     }
 
     auto& remote = _remotes[job->remoteIndex];
-    invariant(!remote.swResponse);
+    const auto& response = job->cbData.response;
+
+    auto& cbHandle = job->hedged ? remote.hedgeCbHandle : remote.cbHandle;
+    auto& abandoned = job->hedged ? remote.hedgeCbAbandoned : remote.cbAbandoned;
+    auto& otherCbHandle = job->hedged ? remote.cbHandle : remote.hedgeCbHandle;
+    auto& otherAbandoned = job->hedged ? remote.cbAbandoned : remote.hedgeCbAbandoned;
 
-    // Clear the callback handle. This indicates that we are no longer waiting on a response from
+    // Clear the callback handle. This indicates that we are no longer waiting on this response from
     // 'remote'.
-    remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+    cbHandle = executor::TaskExecutor::CallbackHandle();
+
+    if (_hedgeReads && response.isOK() && response.elapsedMillis) {
+        HostLatencyTracker::get(_opCtx->getServiceContext())
+            ->recordLatency(job->cbData.request.target, *response.elapsedMillis);
+    }
+
+    if (abandoned) {
+        // The other request for this remote has already been answered. This one may still have
+        // opened a cursor if it completed before it could be canceled.
+        abandoned = false;
+        killAbandonedCursor(_executor, job->cbData.request.target, response);
+        return;
+    }
+
+    invariant(!remote.swResponse);
+
+    if (otherCbHandle.isValid()) {
+        // A command error, for example from a host which is stepping down, must not win the race
+        // against a request which may still succeed either.
+        auto status = response.status;
+        if (status.isOK()) {
+            status = getStatusFromCommandResult(response.data);
+        }
+        if (status.isOK()) {
+            status = getWriteConcernStatusFromCommandResult(response.data);
+        }
+
+        if (!status.isOK()) {
+            // Keep waiting for the other request, which may still succeed.
+            LOG(1) << "Request to remote " << remote.shardId << " at host "
+                   << job->cbData.request.target << " failed while another request is outstanding"
+                   << causedBy(redact(status));
+            return;
+        }
+
+        // This request won, so cancel the other one. It has been outstanding for at least as long
+        // as this one, which is recorded so that slow hosts are not measured only by their wins.
+        _executor->cancel(otherCbHandle);
+        otherAbandoned = true;
+
+        const auto& otherHost = job->hedged ? *remote.shardHostAndPort : *remote.hedgeHostAndPort;
+        const auto otherSendDate = job->hedged ? remote.sendDate : remote.hedgeSendDate;
+        HostLatencyTracker::get(_opCtx->getServiceContext())
+            ->recordLatency(otherHost, _now() - otherSendDate);
+    }
+
+    remote.hedgeDeadline.reset();
+
+    // Report the host which actually ran the command.
+    if (job->hedged) {
+        remote.shardHostAndPort = remote.hedgeHostAndPort;
+    }
 
     // Store the response or error.
     if (job->cbData.response.status.isOK()) {
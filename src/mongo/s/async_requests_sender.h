@@ -78,6 +78,15 @@ namespace mongo {
  *     }
  * }
  *
+ * If the AsyncRequestsSenderEnableHedgedReads server parameter is set and the read preference is
+ * 'nearest' or 'secondaryPreferred', the ARS hedges its reads: a request which has not been
+ * answered within a deadline derived from the recent latency of its target host is also sent to
+ * another eligible member of the shard, chosen by recent latency. The first successful response
+ * is used and the other request is canceled. A response is only successful if neither the
+ * transport, the command nor its write concern failed. If the losing request opened a cursor
+ * before it could be canceled, the cursor is killed on the host it was opened on. Commands which
+ * operate on an existing cursor, such as getMore, are never hedged.
+ *
  * Does not throw exceptions.
  */
 class AsyncRequestsSender {
@@ -116,6 +125,10 @@ public:
         // The exact host on which the remote command was run. Is unset if the shard could not be
         // found or no shard hosts matching the readPreference could be found.
         boost::optional<HostAndPort> shardHostAndPort;
+
+        // The position of the request among all the requests of the ARS, as returned by
+        // addRequest(). Tells apart the responses of several requests to the same shard.
+        size_t requestIndex = 0;
     };
 
     /**
@@ -152,6 +165,16 @@ public:
      */
     Response next();
 
+    /**
+     * Adds a request to those being sent and schedules it immediately. Returns its index, which
+     * the response for it carries. The requests given to the constructor have the first indexes,
+     * in order.
+     *
+     * A request added after stopRetrying() or after the operation was interrupted is not sent,
+     * and its response is an error.
+     */
+    size_t addRequest(const Request& request);
+
     /**
      * Stops the ARS from retrying requests.
      *
@@ -201,6 +224,24 @@ private:
         // The callback handle to an outstanding request for this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
+        // When the outstanding request was sent.
+        Date_t sendDate;
+
+        // The callback handle to an outstanding hedged request for this remote, the host it was
+        // sent to and when it was sent.
+        executor::TaskExecutor::CallbackHandle hedgeCbHandle;
+        boost::optional<HostAndPort> hedgeHostAndPort;
+        Date_t hedgeSendDate;
+
+        // When to send a hedged request if the outstanding request has not been answered yet. Is
+        // unset if no hedged request should be sent.
+        boost::optional<Date_t> hedgeDeadline;
+
+        // Set on a request which was canceled because the other request for this remote won. Its
+        // callback has yet to run and its response will be discarded.
+        bool cbAbandoned = false;
+        bool hedgeCbAbandoned = false;
+
         // Whether this remote's result has been returned.
         bool done = false;
     };
@@ -212,6 +253,9 @@ private:
     struct Job {
         executor::TaskExecutor::RemoteCommandCallbackArgs cbData;
         size_t remoteIndex;
+
+        // Whether this is the response to the hedged request of the remote.
+        bool hedged;
     };
 
     /**
@@ -280,6 +324,38 @@ private:
      */
     Status _scheduleRequest(size_t remoteIndex);
 
+    /**
+     * For each remote whose outstanding request has not been answered by its hedge deadline, sends
+     * a hedged request to the fastest other host of the shard which can serve the read.
+     */
+    void _scheduleHedgedRequests();
+
+    /**
+     * Helper to schedule the command of the remote at 'remoteIndex' on 'host'. The 'hedged'
+     * argument is passed back in the Job for the response.
+     *
+     * Returns the callback handle of the request if it was scheduled successfully.
+     */
+    StatusWith<executor::TaskExecutor::CallbackHandle> _scheduleCommand(size_t remoteIndex,
+                                                                        const HostAndPort& host,
+                                                                        bool hedged);
+
+    /**
+     * Returns the earliest hedge deadline of any remote, or boost::none if no hedged requests are
+     * pending.
+     */
+    boost::optional<Date_t> _nextHedgeDeadline() const;
+
+    /**
+     * Returns true if the callback of any request, including the abandoned ones, has yet to run.
+     */
+    bool _hasOutstandingCallbacks() const;
+
+    /**
+     * Returns the current time, as used for hedge deadlines.
+     */
+    Date_t _now() const;
+
     /**
      * Waits for forward progress in gathering responses from a remote.
      *
@@ -308,6 +384,9 @@ private:
     // The policy to use when deciding whether to retry on an error.
     Shard::RetryPolicy _retryPolicy;
 
+    // Whether requests which are slow to be answered should be hedged.
+    const bool _hedgeReads;
+
     // Is set to a non-OK status if the client operation is interrupted.
     // When waiting for a remote to be ready, we only check for interrupt if the _interruptStatus
     // has not already been set to an error (so we can wait for callbacks for (canceled) outstanding
@@ -0,0 +1,373 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/async_requests_sender.h"
+
+#include "mongo/client/remote_command_targeter_factory_mock.h"
+#include "mongo/client/remote_command_targeter_mock.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/s/catalog/type_shard.h"
+#include "mongo/s/host_latency_tracker.h"
+#include "mongo/s/sharding_router_test_fixture.h"
+#include "mongo/stdx/future.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/clock_source_mock.h"
+
+namespace mongo {
+namespace {
+
+using executor::RemoteCommandRequest;
+using executor::RemoteCommandResponse;
+
+const HostAndPort kTestConfigShardHost = HostAndPort("FakeConfigHost", 12345);
+const ShardId kTestShardId("FakeShard");
+const HostAndPort kTestPrimaryHost("FakeShardPrimary", 12345);
+const HostAndPort kTestSecondaryHost("FakeShardSecondary", 12345);
+
+const ReadPreferenceSetting kNearest{ReadPreference::Nearest};
+
+void setServerParameter(StringData name, StringData value) {
+    const auto& parameters = ServerParameterSet::getGlobal()->getMap();
+    auto it = parameters.find(name.toString());
+    invariant(it != parameters.end());
+    ASSERT_OK(it->second->setFromString(value.toString()));
+}
+
+class AsyncRequestsSenderHedgingTest : public ShardingTestFixture {
+public:
+    void setUp() override {
+        ShardingTestFixture::setUp();
+
+        configTargeter()->setFindHostReturnValue(kTestConfigShardHost);
+
+        const ConnectionString connStr =
+            ConnectionString::forReplicaSet("FakeShardRS", {kTestPrimaryHost, kTestSecondaryHost});
+
+        ShardType shardType;
+        shardType.setName(kTestShardId.toString());
+        shardType.setHost(connStr.toString());
+
+        auto targeter = stdx::make_unique<RemoteCommandTargeterMock>();
+        targeter->setConnectionStringReturnValue(connStr);
+        targeter->setFindHostReturnValue(kTestPrimaryHost);
+        targeter->setAlternateHostsReturnValue({kTestPrimaryHost, kTestSecondaryHost});
+        targeterFactory()->addTargeterToReturn(connStr, std::move(targeter));
+
+        setupShards({shardType});
+
+        // Hedge every request as soon as it is sent unless a test says otherwise.
+        setServerParameter("AsyncRequestsSenderEnableHedgedReads", "true");
+        setServerParameter("AsyncRequestsSenderHedgeMinDelayMS", "0");
+        setServerParameter("AsyncRequestsSenderHedgeMaxDelayMS", "0");
+    }
+
+    void tearDown() override {
+        setServerParameter("AsyncRequestsSenderEnableHedgedReads", "false");
+        setServerParameter("AsyncRequestsSenderHedgeMinDelayMS", "5");
+        setServerParameter("AsyncRequestsSenderHedgeMaxDelayMS", "200");
+        setServerParameter("AsyncRequestsSenderHedgeDelayPercentile", "95");
+
+        ShardingTestFixture::tearDown();
+    }
+
+protected:
+    /**
+     * Sends 'cmdObj' to the test shard through an ARS and returns its only response. Sets
+     * 'responseReturned' once the response was returned, before the ARS is destroyed, which waits
+     * for the callbacks of all the requests it sent.
+     */
+    auto sendRequest(BSONObj cmdObj, stdx::promise<void>* responseReturned) {
+        return launchAsync([this, cmdObj, responseReturned] {
+            AsyncRequestsSender ars(operationContext(),
+                                    executor(),
+                                    "testdb",
+                                    {AsyncRequestsSender::Request(kTestShardId, cmdObj)},
+                                    kNearest,
+                                    Shard::RetryPolicy::kNoRetry);
+            auto response = ars.next();
+            ASSERT_TRUE(ars.done());
+            responseReturned->set_value();
+            return response;
+        });
+    }
+
+    /**
+     * Delivers the cancellation of the request which lost to its hedged counterpart.
+     */
+    void runCanceledRequests(stdx::future<void> responseReturned) {
+        responseReturned.wait();
+
+        network()->enterNetwork();
+        network()->runReadyNetworkOperations();
+        network()->exitNetwork();
+    }
+
+    ClockSourceMock* preciseClock() {
+        return static_cast<ClockSourceMock*>(getServiceContext()->getPreciseClockSource());
+    }
+
+    const BSONObj _countCmd = BSON("count"
+                                   << "testcoll");
+};
+
+TEST_F(AsyncRequestsSenderHedgingTest, HedgedRequestWinsAndOriginalIsCanceled) {
+    stdx::promise<void> responseReturned;
+    auto future = sendRequest(_countCmd, &responseReturned);
+
+    // The original request is never answered.
+    network()->enterNetwork();
+    auto original = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestPrimaryHost, original->getRequest().target);
+    network()->exitNetwork();
+
+    onCommand([&](const RemoteCommandRequest& request) {
+        ASSERT_EQ(kTestSecondaryHost, request.target);
+        ASSERT_BSONOBJ_EQ(_countCmd, request.cmdObj);
+        return BSON("ok" << 1 << "n" << 2);
+    });
+
+    // The ARS can only be destroyed once the original request was canceled.
+    runCanceledRequests(responseReturned.get_future());
+
+    auto response = future.timed_get(kFutureTimeout);
+    ASSERT_OK(response.swResponse.getStatus());
+    ASSERT_EQ(2, response.swResponse.getValue().data["n"].numberInt());
+    ASSERT_EQ(kTestSecondaryHost, *response.shardHostAndPort);
+}
+
+TEST_F(AsyncRequestsSenderHedgingTest, OriginalRequestWinsAndHedgedRequestIsCanceled) {
+    stdx::promise<void> responseReturned;
+    auto future = sendRequest(_countCmd, &responseReturned);
+
+    network()->enterNetwork();
+    auto original = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestPrimaryHost, original->getRequest().target);
+    auto hedged = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestSecondaryHost, hedged->getRequest().target);
+
+    // Only the original request is answered.
+    network()->scheduleSuccessfulResponse(
+        original, RemoteCommandResponse(BSON("ok" << 1 << "n" << 1), BSONObj(), Milliseconds(1)));
+    network()->runReadyNetworkOperations();
+    network()->exitNetwork();
+
+    runCanceledRequests(responseReturned.get_future());
+
+    auto response = future.timed_get(kFutureTimeout);
+    ASSERT_OK(response.swResponse.getStatus());
+    ASSERT_EQ(1, response.swResponse.getValue().data["n"].numberInt());
+    ASSERT_EQ(kTestPrimaryHost, *response.shardHostAndPort);
+}
+
+TEST_F(AsyncRequestsSenderHedgingTest, CommandErrorDoesNotWinAgainstOutstandingRequest) {
+    stdx::promise<void> responseReturned;
+    auto future = sendRequest(_countCmd, &responseReturned);
+
+    network()->enterNetwork();
+    auto original = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestPrimaryHost, original->getRequest().target);
+    auto hedged = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestSecondaryHost, hedged->getRequest().target);
+
+    // The original request fails first, with a command error rather than a transport error.
+    network()->scheduleSuccessfulResponse(
+        original,
+        RemoteCommandResponse(BSON("ok" << 0 << "code" << ErrorCodes::NotMasterOrSecondary
+                                        << "errmsg"
+                                        << "node is recovering"),
+                              BSONObj(),
+                              Milliseconds(1)));
+    network()->runReadyNetworkOperations();
+
+    network()->scheduleSuccessfulResponse(
+        hedged, RemoteCommandResponse(BSON("ok" << 1 << "n" << 2), BSONObj(), Milliseconds(1)));
+    network()->runReadyNetworkOperations();
+    network()->exitNetwork();
+
+    auto response = future.timed_get(kFutureTimeout);
+    ASSERT_OK(response.swResponse.getStatus());
+    ASSERT_OK(getStatusFromCommandResult(response.swResponse.getValue().data));
+    ASSERT_EQ(2, response.swResponse.getValue().data["n"].numberInt());
+    ASSERT_EQ(kTestSecondaryHost, *response.shardHostAndPort);
+}
+
+TEST_F(AsyncRequestsSenderHedgingTest, CursorOpenedByLosingRequestIsKilled) {
+    const NamespaceString nss("testdb.testcoll");
+    const CursorId losingCursorId = 123;
+
+    stdx::promise<void> responseReturned;
+    auto future = sendRequest(BSON("find" << nss.coll()), &responseReturned);
+
+    network()->enterNetwork();
+    auto original = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestPrimaryHost, original->getRequest().target);
+    auto hedged = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestSecondaryHost, hedged->getRequest().target);
+    ASSERT_EQ("find"_sd, hedged->getRequest().cmdObj.firstElementFieldName());
+
+    // Both requests are answered before the loser can be canceled, and the hedged one wins.
+    network()->scheduleSuccessfulResponse(
+        hedged,
+        RemoteCommandResponse(CursorResponse(nss, CursorId(0), {BSON("_id" << 1)})
+                                  .toBSON(CursorResponse::ResponseType::InitialResponse),
+                              BSONObj(),
+                              Milliseconds(1)));
+    network()->scheduleSuccessfulResponse(
+        original,
+        RemoteCommandResponse(CursorResponse(nss, losingCursorId, {BSON("_id" << 1)})
+                                  .toBSON(CursorResponse::ResponseType::InitialResponse),
+                              BSONObj(),
+                              Milliseconds(1)));
+    network()->runReadyNetworkOperations();
+    network()->exitNetwork();
+
+    responseReturned.get_future().wait();
+
+    // The cursor which the original request opened on the primary is killed.
+    onCommand([&](const RemoteCommandRequest& request) {
+        ASSERT_EQ(kTestPrimaryHost, request.target);
+        auto killCursorsRequest =
+            assertGet(KillCursorsRequest::parseFromBSON(request.dbname, request.cmdObj));
+        ASSERT_EQ(nss, killCursorsRequest.nss);
+        ASSERT_EQ(1U, killCursorsRequest.cursorIds.size());
+        ASSERT_EQ(losingCursorId, killCursorsRequest.cursorIds[0]);
+        return BSON("ok" << 1);
+    });
+
+    auto response = future.timed_get(kFutureTimeout);
+    ASSERT_OK(response.swResponse.getStatus());
+    ASSERT_EQ(kTestSecondaryHost, *response.shardHostAndPort);
+}
+
+TEST_F(AsyncRequestsSenderHedgingTest, GetMoreIsNotHedged) {
+    stdx::promise<void> responseReturned;
+    auto future = sendRequest(BSON("getMore" << CursorId(123) << "collection"
+                                             << "testcoll"),
+                              &responseReturned);
+
+    onCommand([&](const RemoteCommandRequest& request) {
+        ASSERT_EQ(kTestPrimaryHost, request.target);
+        return BSON("ok" << 1);
+    });
+
+    // A hedged request would still be outstanding, and keep the ARS from being destroyed.
+    auto response = future.timed_get(kFutureTimeout);
+    ASSERT_OK(response.swResponse.getStatus());
+    ASSERT_EQ(kTestPrimaryHost, *response.shardHostAndPort);
+
+    network()->enterNetwork();
+    ASSERT_FALSE(network()->hasReadyRequests());
+    network()->exitNetwork();
+}
+
+TEST_F(AsyncRequestsSenderHedgingTest, HedgeDelayFollowsLatencyPercentile) {
+    setServerParameter("AsyncRequestsSenderHedgeMaxDelayMS", "60000");
+    setServerParameter("AsyncRequestsSenderHedgeDelayPercentile", "90");
+
+    // Nine in ten requests to the primary took a second, the others a minute.
+    auto tracker = HostLatencyTracker::get(getServiceContext());
+    for (int i = 0; i < 90; ++i) {
+        tracker->recordLatency(kTestPrimaryHost, Seconds(1));
+    }
+    for (int i = 0; i < 10; ++i) {
+        tracker->recordLatency(kTestPrimaryHost, Minutes(1));
+    }
+
+    stdx::promise<void> responseReturned;
+    auto future = sendRequest(_countCmd, &responseReturned);
+
+    network()->enterNetwork();
+    auto original = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestPrimaryHost, original->getRequest().target);
+    network()->exitNetwork();
+
+    // The 90th percentile is a little over a second, so the request is not hedged yet.
+    preciseClock()->advance(Milliseconds(900));
+    network()->enterNetwork();
+    ASSERT_FALSE(network()->hasReadyRequests());
+    network()->exitNetwork();
+
+    // But it is hedged well before the minute which the slowest requests took. The clock is moved
+    // far enough for the hedge to be due even if the request was sent after it was first moved.
+    preciseClock()->advance(Seconds(10));
+    onCommand([&](const RemoteCommandRequest& request) {
+        ASSERT_EQ(kTestSecondaryHost, request.target);
+        return BSON("ok" << 1);
+    });
+
+    runCanceledRequests(responseReturned.get_future());
+
+    auto response = future.timed_get(kFutureTimeout);
+    ASSERT_OK(response.swResponse.getStatus());
+    ASSERT_EQ(kTestSecondaryHost, *response.shardHostAndPort);
+}
+
+TEST_F(AsyncRequestsSenderHedgingTest, HedgeDelayIsCappedByMaxDelay) {
+    setServerParameter("AsyncRequestsSenderHedgeMaxDelayMS", "1000");
+
+    auto tracker = HostLatencyTracker::get(getServiceContext());
+    for (int i = 0; i < 100; ++i) {
+        tracker->recordLatency(kTestPrimaryHost, Minutes(1));
+    }
+
+    stdx::promise<void> responseReturned;
+    auto future = sendRequest(_countCmd, &responseReturned);
+
+    network()->enterNetwork();
+    auto original = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestPrimaryHost, original->getRequest().target);
+    network()->exitNetwork();
+
+    preciseClock()->advance(Milliseconds(500));
+    network()->enterNetwork();
+    ASSERT_FALSE(network()->hasReadyRequests());
+    network()->exitNetwork();
+
+    preciseClock()->advance(Seconds(1));
+    onCommand([&](const RemoteCommandRequest& request) {
+        ASSERT_EQ(kTestSecondaryHost, request.target);
+        return BSON("ok" << 1);
+    });
+
+    runCanceledRequests(responseReturned.get_future());
+
+    auto response = future.timed_get(kFutureTimeout);
+    ASSERT_OK(response.swResponse.getStatus());
+    ASSERT_EQ(kTestSecondaryHost, *response.shardHostAndPort);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -54,6 +54,10 @@ const char kStopped[] = "stopped";
 const char kMode[] = "mode";
 const char kActiveWindow[] = "activeWindow";
 const char kWaitForDelete[] = "_waitForDelete";
+const char kMaxMigrationsPerShardPerRound[] = "maxMigrationsPerShardPerRound";
+
+// Upper bound on the number of migrations a shard may be given per balancing round
+const long long kMaxMigrationsPerShardPerRoundLimit = 100;
 
 const NamespaceString kSettingsNamespace("config", "settings");
 
@@ -131,6 +135,11 @@ bool BalancerConfiguration::waitForDelete() const {
     return _balancerSettings.waitForDelete();
 }
 
+int BalancerConfiguration::getMaxMigrationsPerShardPerRound() const {
+    stdx::lock_guard<stdx::mutex> lk(_balancerSettingsMutex);
+    return _balancerSettings.getMaxMigrationsPerShardPerRound();
+}
+
 Status BalancerConfiguration::refreshAndCheck(OperationContext* opCtx) {
     // Balancer configuration
     Status balancerSettingsStatus = _refreshBalancerSettings(opCtx);
@@ -321,6 +330,23 @@ StatusWith<BalancerSettingsType> BalancerSettingsType::fromBSON(const BSONObj& o
         settings._waitForDelete = waitForDelete;
     }
 
+    {
+        long long maxMigrationsPerShardPerRound;
+        Status status = bsonExtractIntegerFieldWithDefault(
+            obj, kMaxMigrationsPerShardPerRound, 1, &maxMigrationsPerShardPerRound);
+        if (!status.isOK())
+            return status;
+
+        if (maxMigrationsPerShardPerRound < 1 ||
+            maxMigrationsPerShardPerRound > kMaxMigrationsPerShardPerRoundLimit) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << kMaxMigrationsPerShardPerRound << " must be between 1 and "
+                                  << kMaxMigrationsPerShardPerRoundLimit};
+        }
+
+        settings._maxMigrationsPerShardPerRound = static_cast<int>(maxMigrationsPerShardPerRound);
+    }
+
     return settings;
 }
 
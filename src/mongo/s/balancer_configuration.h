@@ -54,7 +54,8 @@ class StatusWith;
  * balancer: {
  *  stopped: <true|false>,
  *  mode: <full|autoSplitOnly|off>,         // Only consulted if "stopped" is missing or false
- *  activeWindow: { start: "<HH:MM>", stop: "<HH:MM>" }
+ *  activeWindow: { start: "<HH:MM>", stop: "<HH:MM>" },
+ *  maxMigrationsPerShardPerRound: <number>  // Defaults to 1
  * }
  */
 class BalancerSettingsType {
@@ -109,6 +110,15 @@ public:
         return _waitForDelete;
     }
 
+    /**
+     * Returns how many migrations a shard may be given, as either donor or recipient, in a single
+     * balancing round. This does not raise how many migrations a shard runs concurrently, which is
+     * still one, but lets the shard start its next migration without waiting for the round to end.
+     */
+    int getMaxMigrationsPerShardPerRound() const {
+        return _maxMigrationsPerShardPerRound;
+    }
+
 private:
     BalancerSettingsType();
 
@@ -120,6 +130,8 @@ private:
     MigrationSecondaryThrottleOptions _secondaryThrottle;
 
     bool _waitForDelete{false};
+
+    int _maxMigrationsPerShardPerRound{1};
 };
 
 /**
@@ -236,6 +248,11 @@ public:
      */
     bool waitForDelete() const;
 
+    /**
+     * Returns how many migrations a shard may be given in a single balancing round.
+     */
+    int getMaxMigrationsPerShardPerRound() const;
+
     /**
      * Returns the max chunk size after which a chunk would be considered jumbo.
      */
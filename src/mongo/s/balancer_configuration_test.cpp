@@ -209,6 +209,27 @@ TEST(BalancerSettingsType, Defaults) {
     ASSERT_EQ(MigrationSecondaryThrottleOptions::kDefault,
               settings.getSecondaryThrottle().getSecondaryThrottle());
     ASSERT(!settings.getSecondaryThrottle().isWriteConcernSpecified());
+    ASSERT_EQ(1, settings.getMaxMigrationsPerShardPerRound());
+}
+
+TEST(BalancerSettingsType, MaxMigrationsPerShardPerRound) {
+    ASSERT_EQ(
+        4,
+        assertGet(BalancerSettingsType::fromBSON(BSON("maxMigrationsPerShardPerRound" << 4)))
+            .getMaxMigrationsPerShardPerRound());
+    ASSERT_EQ(ErrorCodes::BadValue,
+              BalancerSettingsType::fromBSON(BSON("maxMigrationsPerShardPerRound" << 0))
+                  .getStatus()
+                  .code());
+    ASSERT_EQ(ErrorCodes::BadValue,
+              BalancerSettingsType::fromBSON(BSON("maxMigrationsPerShardPerRound" << 1000))
+                  .getStatus()
+                  .code());
+    ASSERT_EQ(ErrorCodes::TypeMismatch,
+              BalancerSettingsType::fromBSON(BSON("maxMigrationsPerShardPerRound"
+                                                  << "4"))
+                  .getStatus()
+                  .code());
 }
 
 TEST(BalancerSettingsType, BalancerDisabledThroughStoppedOption) {
@@ -359,6 +359,57 @@ void CatalogCache::onStaleShardVersion(CachedCollectionRoutingInfo&& ccriToInval
     }
 }
 
+void CatalogCache::onRoutingTableChange(const NamespaceString& nss,
+                                        boost::optional<ChunkVersion> version) {
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+
+    auto itDb = _collectionsByDb.find(nss.db());
+    if (itDb == _collectionsByDb.end()) {
+        // The database is not cached, so neither is the collection.
+        return;
+    }
+
+    // The cache holds an entry for every sharded collection of a cached database, so a change to a
+    // collection without one means that it has just become sharded.
+    auto& collEntry = itDb->second[nss.ns()];
+    if (!collEntry) {
+        collEntry = std::make_shared<CollectionRoutingInfoEntry>();
+    }
+
+    // Changes which keep the epoch and the major version of the cached routing table, such as
+    // splits, cannot make a shard reject requests routed with it. The cached table is served until
+    // the refresh completes. Any other change makes requests wait for the refresh.
+    bool mustBlock = true;
+    if (!collEntry->needsRefresh && collEntry->routingInfo && version) {
+        const auto cachedVersion = collEntry->routingInfo->getVersion();
+        if (cachedVersion.epoch() == version->epoch()) {
+            if (!cachedVersion.isOlderThan(*version)) {
+                return;
+            }
+            mustBlock = cachedVersion.majorVersion() != version->majorVersion();
+        }
+    }
+
+    if (collEntry->refreshCompletionNotification) {
+        // A refresh is under way already. If it started before the change was made, the next
+        // StaleShardVersion will start another.
+        if (mustBlock) {
+            collEntry->needsRefresh = true;
+        }
+        return;
+    }
+
+    _stats.countRoutingTableChangeRefreshes.addAndFetch(1);
+
+    if (mustBlock) {
+        collEntry->needsRefresh = true;
+    } else {
+        _stats.countBackgroundRefreshes.addAndFetch(1);
+    }
+    collEntry->refreshCompletionNotification = std::make_shared<Notification<Status>>();
+    _scheduleCollectionRefresh(lg, collEntry, nss, 1);
+}
+
 void CatalogCache::invalidateDatabaseEntry(const StringData dbName) {
     stdx::lock_guard<stdx::mutex> lg(_mutex);
     auto itDbEntry = _databases.find(dbName);
@@ -492,7 +543,9 @@ void CatalogCache::_scheduleCollectionRefresh(WithLock lk,
                                               std::shared_ptr<CollectionRoutingInfoEntry> collEntry,
                                               NamespaceString const& nss,
                                               int refreshAttempt) {
-    const auto existingRoutingInfo = std::move(collEntry->routingInfo);
+    // The cached routing table is left in the entry, so that it can still be served while the
+    // refresh runs in the background unless the entry needs a refresh.
+    const auto existingRoutingInfo = collEntry->routingInfo;
 
     // If we have an existing chunk manager, the refresh is considered "incremental", regardless of
     // how many chunks are in the differential
@@ -550,8 +603,9 @@ void CatalogCache::_scheduleCollectionRefresh(WithLock lk,
             refreshAttempt < kMaxInconsistentRoutingInfoRefreshAttempts) {
             _scheduleCollectionRefresh(lk, collEntry, nss, refreshAttempt + 1);
         } else {
-            // Leave needsRefresh to true so that any subsequent get attempts will kick off
-            // another round of refresh
+            // Leave needsRefresh as it is, so that any subsequent get attempts will kick off
+            // another round of refresh if it was a blocking one, and otherwise keep being served
+            // the cached routing table
             collEntry->refreshCompletionNotification->set(status);
             collEntry->refreshCompletionNotification = nullptr;
         }
@@ -624,6 +678,8 @@ void CatalogCache::Stats::report(BSONObjBuilder* builder) const {
     builder->append("countFullRefreshesStarted", countFullRefreshesStarted.load());
 
     builder->append("countFailedRefreshes", countFailedRefreshes.load());
+    builder->append("countRoutingTableChangeRefreshes", countRoutingTableChangeRefreshes.load());
+    builder->append("countBackgroundRefreshes", countBackgroundRefreshes.load());
 }
 
 CachedDatabaseInfo::CachedDatabaseInfo(DatabaseType dbt, std::shared_ptr<Shard> primaryShard)
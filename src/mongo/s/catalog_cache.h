@@ -189,6 +189,17 @@ public:
     StatusWith<CachedCollectionRoutingInfo> getShardedCollectionRoutingInfoWithRefresh(
         OperationContext* opCtx, const NamespaceString& nss);
 
+    /**
+     * Non-blocking method to be called when the config server reports a change to the routing
+     * table of 'nss', which writes 'version' if known. Unless the cached routing table is already
+     * at 'version' or newer, starts refreshing it, so that requests are not routed with the old
+     * table and fail with StaleShardVersion. If 'version' only bumps the minor version of the
+     * cached table, as splits do, the cached table keeps being served until the refresh completes.
+     * Otherwise requests wait for the refresh. Does nothing for collections of databases which are
+     * not cached.
+     */
+    void onRoutingTableChange(const NamespaceString& nss, boost::optional<ChunkVersion> version);
+
     /**
      * Non-blocking method that marks the current cached database entry as needing refresh if the
      * entry's databaseVersion matches 'databaseVersion'.
@@ -254,11 +265,11 @@ private:
         // be relied on) or it doesn't, in which case there should be a non-null routingInfo.
         bool needsRefresh{true};
 
-        // Contains a notification to be waited on for the refresh to complete (only available if
-        // needsRefresh is true)
+        // Contains a notification to be waited on for the refresh to complete (available while a
+        // refresh is under way, which is a background refresh if needsRefresh is false)
         std::shared_ptr<Notification<Status>> refreshCompletionNotification;
 
-        // Contains the cached routing information (only available if needsRefresh is false)
+        // Contains the cached routing information (only to be relied on if needsRefresh is false)
         std::shared_ptr<RoutingTableHistory> routingInfo;
     };
 
@@ -367,6 +378,14 @@ private:
         // for whatever reason
         AtomicInt64 countFailedRefreshes{0};
 
+        // Cumulative, always-increasing counter of how many refreshes were started because the
+        // config server reported a change, rather than because a request found the cache stale
+        AtomicInt64 countRoutingTableChangeRefreshes{0};
+
+        // Cumulative, always-increasing counter of how many of those refreshes ran in the
+        // background, while the cached routing table kept being served
+        AtomicInt64 countBackgroundRefreshes{0};
+
         /**
          * Reports the accumulated statistics for serverStatus.
          */
@@ -38,6 +38,8 @@
 #include "mongo/s/catalog/type_database.h"
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/catalog_cache_test_fixture.h"
+#include "mongo/s/grid.h"
+#include "mongo/s/routing_table_change_listener.h"
 
 namespace mongo {
 namespace {
@@ -47,6 +49,41 @@ using unittest::assertGet;
 
 const NamespaceString kNss("TestDB", "TestColl");
 
+// Config server oplog entries, shaped like those written by the chunk commands and shardCollection
+BSONObj makeChunkUpdateEntry(const ChunkType& chunk) {
+    return BSON("op"
+                << "u"
+                << "ns"
+                << ChunkType::ConfigNS.ns()
+                << "o2"
+                << BSON(ChunkType::name(chunk.getName()))
+                << "o"
+                << chunk.toConfigBSON());
+}
+
+BSONObj makeChunkDeleteEntry(const ChunkType& chunk) {
+    return BSON("op"
+                << "d"
+                << "ns"
+                << ChunkType::ConfigNS.ns()
+                << "o"
+                << BSON(ChunkType::name(chunk.getName())));
+}
+
+BSONObj makeApplyOpsEntry(const std::vector<BSONObj>& ops) {
+    BSONArrayBuilder opsBuilder;
+    for (const auto& op : ops) {
+        opsBuilder.append(op);
+    }
+
+    return BSON("op"
+                << "c"
+                << "ns"
+                << "admin.$cmd"
+                << "o"
+                << BSON("applyOps" << opsBuilder.arr()));
+}
+
 class CatalogCacheRefreshTest : public CatalogCacheTestFixture {
 protected:
     void setUp() override {
@@ -73,6 +110,35 @@ protected:
             return std::vector<BSONObj>{collType.toBSON()};
         }());
     }
+
+    /**
+     * Extracts the routing table changes from the config server oplog entries 'entries' and
+     * reports them to the catalog cache, as the routing table change listener does.
+     */
+    std::vector<RoutingTableChange> reportRoutingTableChanges(const std::vector<BSONObj>& entries) {
+        std::vector<RoutingTableChange> changes;
+        for (const auto& entry : entries) {
+            extractRoutingTableChanges(entry, &changes);
+        }
+
+        auto const catalogCache = Grid::get(getServiceContext())->catalogCache();
+        for (const auto& change : changes) {
+            catalogCache->onRoutingTableChange(change.nss, change.version);
+        }
+
+        return changes;
+    }
+
+    std::shared_ptr<ChunkManager> getCachedRoutingTable() {
+        auto future = launchAsync([&] {
+            auto client = getServiceContext()->makeClient("Test");
+            auto opCtx = client->makeOperationContext();
+            auto const catalogCache = Grid::get(getServiceContext())->catalogCache();
+            return uassertStatusOK(catalogCache->getCollectionRoutingInfo(opCtx.get(), kNss)).cm();
+        });
+
+        return future.timed_get(kFutureTimeout);
+    }
 };
 
 TEST_F(CatalogCacheRefreshTest, FullLoad) {
@@ -612,5 +678,243 @@ TEST_F(CatalogCacheRefreshTest, IncrementalLoadAfterMoveLastChunk) {
     ASSERT_EQ(version, cm->getVersion({"1"}));
 }
 
+TEST_F(CatalogCacheRefreshTest, RoutingTableChangeAtCachedVersionDoesNotRefresh) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+
+    auto initialRoutingInfo(makeChunkManager(kNss, shardKeyPattern, nullptr, true, {}));
+    const ChunkVersion version = initialRoutingInfo->getVersion();
+
+    auto const catalogCache = Grid::get(getServiceContext())->catalogCache();
+    catalogCache->onRoutingTableChange(kNss, version);
+
+    // The cached routing table is returned without going to the config server
+    auto future = launchAsync([&] {
+        auto client = getServiceContext()->makeClient("Test");
+        auto opCtx = client->makeOperationContext();
+        return uassertStatusOK(catalogCache->getCollectionRoutingInfo(opCtx.get(), kNss))
+            .cm()
+            ->getVersion();
+    });
+
+    ASSERT_EQ(version, future.timed_get(kFutureTimeout));
+}
+
+TEST_F(CatalogCacheRefreshTest, RoutingTableChangeAtNewerVersionRefreshes) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+
+    auto initialRoutingInfo(makeChunkManager(kNss, shardKeyPattern, nullptr, true, {}));
+    ChunkVersion version = initialRoutingInfo->getVersion();
+    version.incMajor();
+
+    // The refresh starts as soon as the change is reported, before anyone asks for the collection
+    auto const catalogCache = Grid::get(getServiceContext())->catalogCache();
+    catalogCache->onRoutingTableChange(kNss, version);
+
+    expectGetCollection(version.epoch(), shardKeyPattern);
+    expectFindSendBSONObjVector(kConfigHostAndPort, [&]() {
+        ChunkType chunk1(
+            kNss, {shardKeyPattern.getKeyPattern().globalMin(), BSON("_id" << 0)}, version, {"0"});
+
+        version.incMinor();
+        ChunkType chunk2(
+            kNss, {BSON("_id" << 0), shardKeyPattern.getKeyPattern().globalMax()}, version, {"1"});
+
+        return std::vector<BSONObj>{chunk1.toConfigBSON(), chunk2.toConfigBSON()};
+    }());
+
+    auto future = launchAsync([&] {
+        auto client = getServiceContext()->makeClient("Test");
+        auto opCtx = client->makeOperationContext();
+        return uassertStatusOK(catalogCache->getCollectionRoutingInfo(opCtx.get(), kNss))
+            .cm()
+            ->getVersion();
+    });
+
+    ASSERT_EQ(version, future.timed_get(kFutureTimeout));
+}
+
+TEST_F(CatalogCacheRefreshTest, RoutingTableChangeFromSplit) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+
+    auto initialRoutingInfo(makeChunkManager(kNss, shardKeyPattern, nullptr, true, {}));
+    ChunkVersion version = initialRoutingInfo->getVersion();
+
+    version.incMinor();
+    ChunkType chunk1(
+        kNss, {shardKeyPattern.getKeyPattern().globalMin(), BSON("_id" << 0)}, version, {"0"});
+
+    version.incMinor();
+    ChunkType chunk2(
+        kNss, {BSON("_id" << 0), shardKeyPattern.getKeyPattern().globalMax()}, version, {"0"});
+
+    const auto changes = reportRoutingTableChanges(
+        {makeApplyOpsEntry({makeChunkUpdateEntry(chunk1), makeChunkUpdateEntry(chunk2)})});
+    ASSERT_EQ(2UL, changes.size());
+    ASSERT_EQ(kNss, changes[0].nss);
+    ASSERT_EQ(chunk1.getVersion(), *changes[0].version);
+    ASSERT_EQ(kNss, changes[1].nss);
+    ASSERT_EQ(chunk2.getVersion(), *changes[1].version);
+
+    // A split only bumps the minor version, so the cached routing table is still served while the
+    // refresh runs in the background
+    auto const catalogCache = Grid::get(getServiceContext())->catalogCache();
+    auto future = launchAsync([&] {
+        auto client = getServiceContext()->makeClient("Test");
+        auto opCtx = client->makeOperationContext();
+        return uassertStatusOK(catalogCache->getCollectionRoutingInfo(opCtx.get(), kNss));
+    });
+
+    auto staleRoutingInfo = future.timed_get(kFutureTimeout);
+    ASSERT_EQ(initialRoutingInfo->getVersion(), staleRoutingInfo.cm()->getVersion());
+
+    // A request which fails with the stale routing table joins the refresh under way
+    catalogCache->onStaleShardVersion(std::move(staleRoutingInfo));
+
+    expectGetCollection(version.epoch(), shardKeyPattern);
+    expectFindSendBSONObjVector(kConfigHostAndPort,
+                                {chunk1.toConfigBSON(), chunk2.toConfigBSON()});
+
+    auto cm = getCachedRoutingTable();
+    ASSERT_EQ(2, cm->numChunks());
+    ASSERT_EQ(version, cm->getVersion());
+    ASSERT_EQ(version, cm->getVersion({"0"}));
+}
+
+TEST_F(CatalogCacheRefreshTest, RoutingTableChangeFromMerge) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+
+    auto initialRoutingInfo(
+        makeChunkManager(kNss, shardKeyPattern, nullptr, true, {BSON("_id" << 0)}));
+    ChunkVersion version = initialRoutingInfo->getVersion();
+
+    // The chunk on shard 1 is first moved to shard 0, so that the two chunks can be merged
+    version.incMajor();
+    ChunkType movedChunk(
+        kNss, {BSON("_id" << 0), shardKeyPattern.getKeyPattern().globalMax()}, version, {"0"});
+
+    version.incMinor();
+    ChunkType mergedChunk(kNss,
+                          {shardKeyPattern.getKeyPattern().globalMin(),
+                           shardKeyPattern.getKeyPattern().globalMax()},
+                          version,
+                          {"0"});
+
+    // The deletion of the chunk merged away is not a change of its own
+    const auto changes = reportRoutingTableChanges(
+        {makeApplyOpsEntry({makeChunkUpdateEntry(movedChunk)}),
+         makeApplyOpsEntry({makeChunkUpdateEntry(mergedChunk), makeChunkDeleteEntry(movedChunk)})});
+    ASSERT_EQ(2UL, changes.size());
+    ASSERT_EQ(kNss, changes[0].nss);
+    ASSERT_EQ(movedChunk.getVersion(), *changes[0].version);
+    ASSERT_EQ(kNss, changes[1].nss);
+    ASSERT_EQ(mergedChunk.getVersion(), *changes[1].version);
+
+    expectGetCollection(version.epoch(), shardKeyPattern);
+    expectFindSendBSONObjVector(kConfigHostAndPort, {mergedChunk.toConfigBSON()});
+
+    auto cm = getCachedRoutingTable();
+    ASSERT_EQ(1, cm->numChunks());
+    ASSERT_EQ(version, cm->getVersion());
+    ASSERT_EQ(version, cm->getVersion({"0"}));
+    ASSERT_EQ(ChunkVersion(0, 0, version.epoch()), cm->getVersion({"1"}));
+}
+
+TEST_F(CatalogCacheRefreshTest, RoutingTableChangeFromMove) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+
+    auto initialRoutingInfo(
+        makeChunkManager(kNss, shardKeyPattern, nullptr, true, {BSON("_id" << 0)}));
+    ChunkVersion version = initialRoutingInfo->getVersion();
+    const ChunkVersion unchangedVersion = version;
+
+    version.incMajor();
+    ChunkType movedChunk(
+        kNss, {shardKeyPattern.getKeyPattern().globalMin(), BSON("_id" << 0)}, version, {"1"});
+
+    const auto changes =
+        reportRoutingTableChanges({makeApplyOpsEntry({makeChunkUpdateEntry(movedChunk)})});
+    ASSERT_EQ(1UL, changes.size());
+    ASSERT_EQ(kNss, changes[0].nss);
+    ASSERT_EQ(version, *changes[0].version);
+
+    expectGetCollection(version.epoch(), shardKeyPattern);
+    expectFindSendBSONObjVector(kConfigHostAndPort, [&]() {
+        ChunkType unchangedChunk(kNss,
+                                 {BSON("_id" << 0), shardKeyPattern.getKeyPattern().globalMax()},
+                                 unchangedVersion,
+                                 {"1"});
+
+        return std::vector<BSONObj>{unchangedChunk.toConfigBSON(), movedChunk.toConfigBSON()};
+    }());
+
+    auto cm = getCachedRoutingTable();
+    ASSERT_EQ(2, cm->numChunks());
+    ASSERT_EQ(version, cm->getVersion());
+    ASSERT_EQ(version, cm->getVersion({"1"}));
+    ASSERT_EQ(ChunkVersion(0, 0, version.epoch()), cm->getVersion({"0"}));
+}
+
+TEST_F(CatalogCacheRefreshTest, RoutingTableChangeFromEpochChange) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+
+    auto initialRoutingInfo(makeChunkManager(kNss, shardKeyPattern, nullptr, true, {}));
+    ASSERT_EQ(1, initialRoutingInfo->numChunks());
+
+    setupNShards(2);
+
+    // The collection is dropped and sharded again, which writes it and its first chunk anew
+    const ChunkVersion newVersion(1, 0, OID::gen());
+
+    CollectionType collType;
+    collType.setNs(kNss);
+    collType.setEpoch(newVersion.epoch());
+    collType.setKeyPattern(shardKeyPattern.toBSON());
+    collType.setUnique(false);
+
+    ChunkType chunk(kNss,
+                    {shardKeyPattern.getKeyPattern().globalMin(),
+                     shardKeyPattern.getKeyPattern().globalMax()},
+                    newVersion,
+                    {"1"});
+
+    const auto changes =
+        reportRoutingTableChanges({BSON("op"
+                                        << "u"
+                                        << "ns"
+                                        << CollectionType::ConfigNS.ns()
+                                        << "o2"
+                                        << BSON("_id" << kNss.ns())
+                                        << "o"
+                                        << collType.toBSON()),
+                                   BSON("op"
+                                        << "i"
+                                        << "ns"
+                                        << ChunkType::ConfigNS.ns()
+                                        << "o"
+                                        << chunk.toConfigBSON())});
+    ASSERT_EQ(2UL, changes.size());
+    ASSERT_EQ(kNss, changes[0].nss);
+    ASSERT(!changes[0].version);
+    ASSERT_EQ(kNss, changes[1].nss);
+    ASSERT_EQ(newVersion, *changes[1].version);
+
+    expectGetCollection(newVersion.epoch(), shardKeyPattern);
+    onFindCommand([&](const RemoteCommandRequest& request) {
+        // Ensure the whole routing table is loaded again
+        const auto diffQuery =
+            assertGet(QueryRequest::makeFromFindCommand(kNss, request.cmdObj, false));
+        ASSERT_BSONOBJ_EQ(BSON("ns" << kNss.ns() << "lastmod" << BSON("$gte" << Timestamp(0, 0))),
+                          diffQuery->getFilter());
+
+        return std::vector<BSONObj>{chunk.toConfigBSON()};
+    });
+
+    auto cm = getCachedRoutingTable();
+    ASSERT_EQ(1, cm->numChunks());
+    ASSERT_EQ(newVersion, cm->getVersion());
+    ASSERT_EQ(newVersion, cm->getVersion({"1"}));
+    ASSERT_EQ(ChunkVersion(0, 0, newVersion.epoch()), cm->getVersion({"0"}));
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,405 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_info_map.h"
+
+#include <algorithm>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+/**
+ * A node of the B+tree. Leaves hold the entries of the map in key order. Internal nodes hold their
+ * children together with the largest key stored under each child, which is what lookups descend
+ * by. Nodes are never empty, except for a root leaf, which is discarded as soon as it becomes so.
+ */
+struct ChunkInfoMap::Node {
+    bool isLeaf() const {
+        return children.empty();
+    }
+
+    size_t numSlots() const {
+        return isLeaf() ? entries.size() : children.size();
+    }
+
+    const std::string& maxKey() const {
+        return isLeaf() ? entries.back().first : maxKeys.back();
+    }
+
+    // Leaves only
+    std::vector<value_type> entries;
+
+    // Internal nodes only
+    std::vector<std::string> maxKeys;
+    std::vector<NodePtr> children;
+};
+
+namespace {
+
+// A child with fewer slots than this is merged with a neighbour whenever the result fits in a node
+constexpr size_t kMergeThreshold = ChunkInfoMap::kMaxNodeSize / 2;
+
+/**
+ * Returns the index of the first entry whose key is not less than (or, if 'strict' is set, greater
+ * than) 'key'.
+ */
+size_t entryIndex(const std::vector<ChunkInfoMap::value_type>& entries,
+                  const std::string& key,
+                  bool strict) {
+    const auto it = strict
+        ? std::upper_bound(entries.begin(),
+                           entries.end(),
+                           key,
+                           [](const std::string& k, const ChunkInfoMap::value_type& entry) {
+                               return k < entry.first;
+                           })
+        : std::lower_bound(entries.begin(),
+                           entries.end(),
+                           key,
+                           [](const ChunkInfoMap::value_type& entry, const std::string& k) {
+                               return entry.first < k;
+                           });
+    return std::distance(entries.begin(), it);
+}
+
+/**
+ * Same as above for the max keys of the children of an internal node.
+ */
+size_t childIndex(const std::vector<std::string>& maxKeys, const std::string& key, bool strict) {
+    const auto it = strict ? std::upper_bound(maxKeys.begin(), maxKeys.end(), key)
+                           : std::lower_bound(maxKeys.begin(), maxKeys.end(), key);
+    return std::distance(maxKeys.begin(), it);
+}
+
+}  // namespace
+
+const ChunkInfoMap::value_type& ChunkInfoMap::const_iterator::operator*() const {
+    const auto& leaf = _path.back();
+    return leaf.node->entries[leaf.pos];
+}
+
+ChunkInfoMap::const_iterator& ChunkInfoMap::const_iterator::operator++() {
+    invariant(!_path.empty());
+
+    if (++_path.back().pos < _path.back().node->entries.size()) {
+        return *this;
+    }
+
+    // Climb up to the closest ancestor which has a next child and descend into that child. If
+    // there is none, this was the last entry and the path is left empty, which is the end.
+    _path.pop_back();
+    while (!_path.empty()) {
+        auto& level = _path.back();
+        if (++level.pos < level.node->children.size()) {
+            _descendToFirst(level.node->children[level.pos].get());
+            break;
+        }
+        _path.pop_back();
+    }
+
+    return *this;
+}
+
+ChunkInfoMap::const_iterator& ChunkInfoMap::const_iterator::operator--() {
+    if (_path.empty()) {
+        invariant(_root);
+        _descendToLast(_root);
+        return *this;
+    }
+
+    if (_path.back().pos > 0) {
+        --_path.back().pos;
+        return *this;
+    }
+
+    _path.pop_back();
+    while (!_path.empty()) {
+        auto& level = _path.back();
+        if (level.pos > 0) {
+            --level.pos;
+            _descendToLast(level.node->children[level.pos].get());
+            return *this;
+        }
+        _path.pop_back();
+    }
+
+    // Decrementing the first entry is not allowed
+    MONGO_UNREACHABLE;
+}
+
+bool ChunkInfoMap::const_iterator::operator==(const const_iterator& other) const {
+    if (_path.empty() || other._path.empty()) {
+        return _path.empty() && other._path.empty();
+    }
+
+    const auto& level = _path.back();
+    const auto& otherLevel = other._path.back();
+    return level.node == otherLevel.node && level.pos == otherLevel.pos;
+}
+
+void ChunkInfoMap::const_iterator::_descendToFirst(const Node* node) {
+    while (true) {
+        _path.push_back({node, 0});
+        if (node->isLeaf()) {
+            return;
+        }
+        node = node->children.front().get();
+    }
+}
+
+void ChunkInfoMap::const_iterator::_descendToLast(const Node* node) {
+    while (true) {
+        _path.push_back({node, node->numSlots() - 1});
+        if (node->isLeaf()) {
+            return;
+        }
+        node = node->children.back().get();
+    }
+}
+
+ChunkInfoMap::const_iterator ChunkInfoMap::begin() const {
+    const_iterator it(_root.get());
+    if (_root) {
+        it._descendToFirst(_root.get());
+    }
+    return it;
+}
+
+ChunkInfoMap::const_iterator ChunkInfoMap::find(const std::string& key) const {
+    auto it = lower_bound(key);
+    if (it != end() && it->first == key) {
+        return it;
+    }
+    return end();
+}
+
+ChunkInfoMap::const_iterator ChunkInfoMap::lower_bound(const std::string& key) const {
+    return _seek(key, false);
+}
+
+ChunkInfoMap::const_iterator ChunkInfoMap::upper_bound(const std::string& key) const {
+    return _seek(key, true);
+}
+
+ChunkInfoMap::const_iterator ChunkInfoMap::_seek(const std::string& key, bool strict) const {
+    const_iterator it(_root.get());
+
+    const Node* node = _root.get();
+    while (node) {
+        if (node->isLeaf()) {
+            const auto pos = entryIndex(node->entries, key, strict);
+            if (pos == node->entries.size()) {
+                // Only possible at the root, since the max key of every other node led here
+                return end();
+            }
+            it._path.push_back({node, pos});
+            return it;
+        }
+
+        const auto pos = childIndex(node->maxKeys, key, strict);
+        if (pos == node->children.size()) {
+            return end();
+        }
+        it._path.push_back({node, pos});
+        node = node->children[pos].get();
+    }
+
+    return end();
+}
+
+bool ChunkInfoMap::insert(value_type entry) {
+    if (find(entry.first) != end()) {
+        return false;
+    }
+
+    if (!_root) {
+        _root = std::make_shared<Node>();
+        _root->entries.push_back(std::move(entry));
+        _size = 1;
+        return true;
+    }
+
+    if (auto sibling = _insert(_root, std::move(entry))) {
+        auto newRoot = std::make_shared<Node>();
+        newRoot->maxKeys.push_back(_root->maxKey());
+        newRoot->maxKeys.push_back(sibling->maxKey());
+        newRoot->children.push_back(std::move(_root));
+        newRoot->children.push_back(std::move(sibling));
+        _root = std::move(newRoot);
+    }
+
+    ++_size;
+    return true;
+}
+
+size_t ChunkInfoMap::erase(const std::string& key) {
+    if (find(key) == end()) {
+        return 0;
+    }
+
+    _erase(_root, key);
+
+    if (--_size == 0) {
+        _root.reset();
+        return 1;
+    }
+
+    // Merges may have left the root with a single child, in which case the tree shrinks
+    while (!_root->isLeaf() && _root->children.size() == 1) {
+        NodePtr onlyChild = _root->children.front();
+        _root = std::move(onlyChild);
+    }
+
+    return 1;
+}
+
+void ChunkInfoMap::erase(const_iterator first, const_iterator last) {
+    // Removing an entry invalidates all iterators, so the keys need to be collected upfront
+    std::vector<std::string> keys;
+    for (auto it = first; it != last; ++it) {
+        keys.push_back(it->first);
+    }
+
+    for (const auto& key : keys) {
+        invariant(erase(key) == 1);
+    }
+}
+
+ChunkInfoMap::Node& ChunkInfoMap::_makeMutable(NodePtr& node) {
+    // The node can only be referenced by other maps while its use count is above one. This map
+    // holds the only reference otherwise, so no other map can start sharing it concurrently.
+    if (node.use_count() > 1) {
+        node = std::make_shared<Node>(*node);
+    }
+    return *node;
+}
+
+ChunkInfoMap::NodePtr ChunkInfoMap::_insert(NodePtr& node, value_type&& entry) {
+    auto& n = _makeMutable(node);
+
+    if (n.isLeaf()) {
+        const auto pos = entryIndex(n.entries, entry.first, false);
+        n.entries.insert(n.entries.begin() + pos, std::move(entry));
+        if (n.entries.size() <= kMaxNodeSize) {
+            return {};
+        }
+
+        auto sibling = std::make_shared<Node>();
+        const auto mid = n.entries.begin() + n.entries.size() / 2;
+        sibling->entries.assign(std::make_move_iterator(mid),
+                                std::make_move_iterator(n.entries.end()));
+        n.entries.erase(mid, n.entries.end());
+        return sibling;
+    }
+
+    // Keys greater than every key in the map go into the last child
+    const auto pos = std::min(childIndex(n.maxKeys, entry.first, false), n.children.size() - 1);
+    auto childSibling = _insert(n.children[pos], std::move(entry));
+    n.maxKeys[pos] = n.children[pos]->maxKey();
+
+    if (childSibling) {
+        n.maxKeys.insert(n.maxKeys.begin() + pos + 1, childSibling->maxKey());
+        n.children.insert(n.children.begin() + pos + 1, std::move(childSibling));
+    }
+
+    if (n.children.size() <= kMaxNodeSize) {
+        return {};
+    }
+
+    auto sibling = std::make_shared<Node>();
+    const auto mid = n.children.size() / 2;
+    sibling->maxKeys.assign(std::make_move_iterator(n.maxKeys.begin() + mid),
+                            std::make_move_iterator(n.maxKeys.end()));
+    sibling->children.assign(std::make_move_iterator(n.children.begin() + mid),
+                             std::make_move_iterator(n.children.end()));
+    n.maxKeys.erase(n.maxKeys.begin() + mid, n.maxKeys.end());
+    n.children.erase(n.children.begin() + mid, n.children.end());
+    return sibling;
+}
+
+void ChunkInfoMap::_erase(NodePtr& node, const std::string& key) {
+    auto& n = _makeMutable(node);
+
+    if (n.isLeaf()) {
+        const auto pos = entryIndex(n.entries, key, false);
+        invariant(pos < n.entries.size() && n.entries[pos].first == key);
+        n.entries.erase(n.entries.begin() + pos);
+        return;
+    }
+
+    const auto pos = childIndex(n.maxKeys, key, false);
+    invariant(pos < n.children.size());
+    _erase(n.children[pos], key);
+
+    const auto childSlots = n.children[pos]->numSlots();
+    if (childSlots == 0) {
+        n.maxKeys.erase(n.maxKeys.begin() + pos);
+        n.children.erase(n.children.begin() + pos);
+        return;
+    }
+
+    n.maxKeys[pos] = n.children[pos]->maxKey();
+
+    if (childSlots >= kMergeThreshold) {
+        return;
+    }
+
+    // Merge the child into one of its neighbours, so that deletions do not leave the tree sparse
+    size_t left;
+    if (pos + 1 < n.children.size() &&
+        childSlots + n.children[pos + 1]->numSlots() <= kMaxNodeSize) {
+        left = pos;
+    } else if (pos > 0 && childSlots + n.children[pos - 1]->numSlots() <= kMaxNodeSize) {
+        left = pos - 1;
+    } else {
+        return;
+    }
+
+    auto& leftNode = _makeMutable(n.children[left]);
+    const auto& rightNode = *n.children[left + 1];
+    if (leftNode.isLeaf()) {
+        leftNode.entries.insert(
+            leftNode.entries.end(), rightNode.entries.begin(), rightNode.entries.end());
+    } else {
+        leftNode.maxKeys.insert(
+            leftNode.maxKeys.end(), rightNode.maxKeys.begin(), rightNode.maxKeys.end());
+        leftNode.children.insert(
+            leftNode.children.end(), rightNode.children.begin(), rightNode.children.end());
+    }
+
+    n.maxKeys[left] = n.maxKeys[left + 1];
+    n.maxKeys.erase(n.maxKeys.begin() + left + 1);
+    n.children.erase(n.children.begin() + left + 1);
+}
+
+}  // namespace mongo
@@ -0,0 +1,198 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/container/small_vector.hpp>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mongo {
+
+class ChunkInfo;
+
+/**
+ * Ordered map from the KeyString of the max of each chunk to an entry describing the chunk.
+ *
+ * The map is a persistent B+tree: copying it is O(1) and the copies share all of their nodes. A
+ * modification only copies the nodes on the path from the root to the modified leaf which are
+ * still shared with another copy, so applying a diff of k chunks to a routing table of n chunks
+ * costs O(k log n) and never touches the table from which the copy was made. Nodes owned by a
+ * single map are modified in place, which keeps building a new map from scratch cheap.
+ *
+ * Like std::map, concurrent reads of the same instance are safe, but modifying an instance
+ * requires exclusive access to it and invalidates all of its iterators. Modifying a copy does not
+ * affect other copies or their iterators.
+ */
+class ChunkInfoMap {
+public:
+    using key_type = std::string;
+    using mapped_type = std::shared_ptr<ChunkInfo>;
+    using value_type = std::pair<std::string, std::shared_ptr<ChunkInfo>>;
+
+    // Maximum number of entries in a leaf and of children of an internal node
+    static constexpr size_t kMaxNodeSize = 64;
+
+private:
+    struct Node;
+
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = ChunkInfoMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator() = default;
+
+        reference operator*() const;
+        pointer operator->() const {
+            return &**this;
+        }
+
+        const_iterator& operator++();
+        const_iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        const_iterator& operator--();
+        const_iterator operator--(int) {
+            auto old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class ChunkInfoMap;
+
+        struct Level {
+            const Node* node;
+            size_t pos;
+        };
+
+        explicit const_iterator(const Node* root) : _root(root) {}
+
+        // Extends '_path' from 'node' down to the first or last entry of its subtree
+        void _descendToFirst(const Node* node);
+        void _descendToLast(const Node* node);
+
+        const Node* _root{nullptr};
+
+        // Path from the root to the current leaf entry. Empty for the end iterator.
+        boost::container::small_vector<Level, 6> _path;
+    };
+
+    ChunkInfoMap() = default;
+
+    const_iterator begin() const;
+    const_iterator end() const {
+        return const_iterator(_root.get());
+    }
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+    const_iterator cend() const {
+        return end();
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * Same semantics as the respective std::map methods.
+     */
+    const_iterator find(const std::string& key) const;
+    const_iterator lower_bound(const std::string& key) const;
+    const_iterator upper_bound(const std::string& key) const;
+
+    /**
+     * Inserts 'entry' unless an entry with the same key is already present. Returns whether the
+     * entry was inserted.
+     */
+    bool insert(value_type entry);
+
+    /**
+     * Removes the entry with the given key, if any. Returns the number of removed entries.
+     */
+    size_t erase(const std::string& key);
+
+    /**
+     * Removes all entries in the range [first, last), which must be a valid range of this map.
+     * Costs O(k log n) for k removed entries.
+     */
+    void erase(const_iterator first, const_iterator last);
+
+private:
+    using NodePtr = std::shared_ptr<Node>;
+
+    /**
+     * Makes 'node' safe to modify by copying it if it is shared with another map.
+     */
+    static Node& _makeMutable(NodePtr& node);
+
+    /**
+     * Inserts 'entry', which must not be present, under 'node'. If 'node' overflows, it is split
+     * and the node holding its upper half is returned.
+     */
+    static NodePtr _insert(NodePtr& node, value_type&& entry);
+
+    /**
+     * Removes 'key', which must be present, from under 'node'.
+     */
+    static void _erase(NodePtr& node, const std::string& key);
+
+    // Positions an iterator at the first entry whose key is not less than (or, if 'strict' is
+    // set, greater than) 'key'
+    const_iterator _seek(const std::string& key, bool strict) const;
+
+    NodePtr _root;
+
+    size_t _size{0};
+};
+
+}  // namespace mongo
@@ -0,0 +1,194 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <map>
+
+#include "mongo/platform/random.h"
+#include "mongo/s/chunk.h"
+#include "mongo/s/chunk_info_map.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("TestDB", "TestColl");
+
+std::string makeKey(int i) {
+    // Zero-padded so that the keys sort numerically
+    return str::stream() << std::string(8 - std::to_string(i).size(), '0') << i;
+}
+
+ChunkInfoMap::value_type makeEntry(int i) {
+    ChunkType chunk(kNss,
+                    {BSON("_id" << i - 1), BSON("_id" << i)},
+                    ChunkVersion(1, i, OID::gen()),
+                    ShardId("shard0"));
+    return {makeKey(i), std::make_shared<ChunkInfo>(chunk)};
+}
+
+void assertSameContents(const std::map<std::string, std::shared_ptr<ChunkInfo>>& expected,
+                        const ChunkInfoMap& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    ASSERT_EQ(expected.empty(), actual.empty());
+
+    auto actualIt = actual.begin();
+    for (const auto& entry : expected) {
+        ASSERT(actualIt != actual.end());
+        ASSERT_EQ(entry.first, actualIt->first);
+        ASSERT_EQ(entry.second.get(), actualIt->second.get());
+        ++actualIt;
+    }
+    ASSERT(actualIt == actual.end());
+}
+
+TEST(ChunkInfoMapTest, EmptyMap) {
+    ChunkInfoMap map;
+    ASSERT(map.empty());
+    ASSERT_EQ(0U, map.size());
+    ASSERT(map.begin() == map.end());
+    ASSERT(map.find(makeKey(1)) == map.end());
+    ASSERT(map.lower_bound(makeKey(1)) == map.end());
+    ASSERT(map.upper_bound(makeKey(1)) == map.end());
+    ASSERT_EQ(0U, map.erase(makeKey(1)));
+}
+
+TEST(ChunkInfoMapTest, LookupsMatchStdMap) {
+    ChunkInfoMap map;
+    for (int i = 0; i < 1000; i += 2) {
+        ASSERT(map.insert(makeEntry(i)));
+    }
+    ASSERT_FALSE(map.insert(makeEntry(10)));
+    ASSERT_EQ(500U, map.size());
+
+    ASSERT_EQ(makeKey(10), map.find(makeKey(10))->first);
+    ASSERT(map.find(makeKey(11)) == map.end());
+
+    ASSERT_EQ(makeKey(10), map.lower_bound(makeKey(10))->first);
+    ASSERT_EQ(makeKey(12), map.lower_bound(makeKey(11))->first);
+    ASSERT_EQ(makeKey(12), map.upper_bound(makeKey(10))->first);
+    ASSERT_EQ(makeKey(0), map.upper_bound("")->first);
+    ASSERT(map.upper_bound(makeKey(998)) == map.end());
+    ASSERT(map.lower_bound(makeKey(999)) == map.end());
+
+    ASSERT_EQ(makeKey(998), std::prev(map.end())->first);
+    ASSERT_EQ(makeKey(8), std::prev(map.find(makeKey(10)))->first);
+}
+
+TEST(ChunkInfoMapTest, EraseRange) {
+    ChunkInfoMap map;
+    std::map<std::string, std::shared_ptr<ChunkInfo>> expected;
+    for (int i = 0; i < 1000; ++i) {
+        auto entry = makeEntry(i);
+        expected.insert(entry);
+        map.insert(std::move(entry));
+    }
+
+    map.erase(map.upper_bound(makeKey(100)), map.upper_bound(makeKey(900)));
+    expected.erase(expected.upper_bound(makeKey(100)), expected.upper_bound(makeKey(900)));
+    assertSameContents(expected, map);
+
+    map.erase(map.begin(), map.end());
+    ASSERT(map.empty());
+    ASSERT(map.begin() == map.end());
+}
+
+TEST(ChunkInfoMapTest, CopiesAreIndependent) {
+    ChunkInfoMap original;
+    std::map<std::string, std::shared_ptr<ChunkInfo>> expectedOriginal;
+    for (int i = 0; i < 5000; ++i) {
+        auto entry = makeEntry(i);
+        expectedOriginal.insert(entry);
+        original.insert(std::move(entry));
+    }
+
+    auto copy = original;
+    auto expectedCopy = expectedOriginal;
+
+    for (int i = 0; i < 5000; i += 7) {
+        copy.erase(makeKey(i));
+        expectedCopy.erase(makeKey(i));
+    }
+    for (int i = 5000; i < 6000; ++i) {
+        auto entry = makeEntry(i);
+        expectedCopy.insert(entry);
+        copy.insert(std::move(entry));
+    }
+
+    assertSameContents(expectedOriginal, original);
+    assertSameContents(expectedCopy, copy);
+
+    // Entries which were not modified are shared between the copies
+    ASSERT_EQ(original.find(makeKey(1))->second.get(), copy.find(makeKey(1))->second.get());
+}
+
+TEST(ChunkInfoMapTest, RandomizedOperationsMatchStdMap) {
+    PseudoRandom random(12345);
+
+    ChunkInfoMap map;
+    std::map<std::string, std::shared_ptr<ChunkInfo>> expected;
+    std::vector<std::pair<ChunkInfoMap, std::map<std::string, std::shared_ptr<ChunkInfo>>>>
+        snapshots;
+
+    for (int i = 0; i < 50000; ++i) {
+        const int keyNum = random.nextInt32(10000);
+        switch (random.nextInt32(4)) {
+            case 0:
+            case 1: {
+                auto entry = makeEntry(keyNum);
+                ASSERT_EQ(expected.insert(entry).second, map.insert(std::move(entry)));
+                break;
+            }
+            case 2:
+                ASSERT_EQ(expected.erase(makeKey(keyNum)), map.erase(makeKey(keyNum)));
+                break;
+            case 3: {
+                const auto upper = makeKey(keyNum + random.nextInt32(10));
+                map.erase(map.upper_bound(makeKey(keyNum)), map.upper_bound(upper));
+                expected.erase(expected.upper_bound(makeKey(keyNum)), expected.upper_bound(upper));
+                break;
+            }
+        }
+
+        if (i % 5000 == 0) {
+            snapshots.emplace_back(map, expected);
+        }
+    }
+
+    assertSameContents(expected, map);
+    for (const auto& snapshot : snapshots) {
+        assertSameContents(snapshot.second, snapshot.first);
+    }
+}
+
+}  // namespace
+}  // namespace mongo
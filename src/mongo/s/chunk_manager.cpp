@@ -34,6 +34,8 @@
 
 #include "mongo/s/chunk_manager.h"
 
+#include <numeric>
+
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/matcher/extensions_callback_noop.h"
@@ -76,7 +78,9 @@ RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
                                          std::unique_ptr<CollatorInterface> defaultCollator,
                                          bool unique,
                                          ChunkInfoMap chunkMap,
-                                         ChunkVersion collectionVersion)
+                                         ChunkVersion collectionVersion,
+                                         ShardVersionMap shardVersions,
+                                         ShardChunkCountMap shardChunkCounts)
     : _sequenceNumber(nextCMSequenceNumber.addAndFetch(1)),
       _nss(std::move(nss)),
       _uuid(uuid),
@@ -86,7 +90,8 @@ RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
       _unique(unique),
       _chunkMap(std::move(chunkMap)),
       _collectionVersion(collectionVersion),
-      _shardVersions(_constructShardVersionMap()) {}
+      _shardVersions(std::move(shardVersions)),
+      _shardChunkCounts(std::move(shardChunkCounts)) {}
 
 Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj& collation) const {
     const bool hasSimpleCollation = (collation.isEmpty() && !_rt->getDefaultCollator()) ||
@@ -108,6 +113,52 @@ Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj
     return Chunk(*(it->second), _clusterTime);
 }
 
+std::vector<boost::optional<Chunk>> ChunkManager::findIntersectingChunksWithSimpleCollation(
+    const std::vector<BSONObj>& shardKeys) const {
+    const auto& chunkMap = _rt->getChunkMap();
+
+    std::vector<std::string> keyStrings;
+    keyStrings.reserve(shardKeys.size());
+    for (const auto& shardKey : shardKeys) {
+        keyStrings.push_back(_rt->_extractKeyString(shardKey));
+    }
+
+    std::vector<size_t> sortedKeys(shardKeys.size());
+    std::iota(sortedKeys.begin(), sortedKeys.end(), 0);
+    std::sort(sortedKeys.begin(), sortedKeys.end(), [&keyStrings](size_t lhs, size_t rhs) {
+        return keyStrings[lhs] < keyStrings[rhs];
+    });
+
+    // Number of chunks to step over before the next chunk is looked up from the root instead
+    const int kMaxSweepSteps = 8;
+
+    std::vector<boost::optional<Chunk>> chunks(shardKeys.size());
+    auto it = chunkMap.end();
+    bool positioned = false;
+    for (const auto i : sortedKeys) {
+        const auto& keyString = keyStrings[i];
+
+        // The chunk containing a key is the first one whose max is greater than the key. Since
+        // the keys are visited in ascending order, that is either the chunk of the previous key
+        // or one after it, which is usually close by.
+        int steps = 0;
+        while (positioned && it != chunkMap.end() && !(keyString < it->first) &&
+               steps++ < kMaxSweepSteps) {
+            ++it;
+        }
+        if (!positioned || (it != chunkMap.end() && !(keyString < it->first))) {
+            it = chunkMap.upper_bound(keyString);
+            positioned = true;
+        }
+
+        if (it != chunkMap.end() && it->second->containsKey(shardKeys[i])) {
+            chunks[i].emplace(*it->second, _clusterTime);
+        }
+    }
+
+    return chunks;
+}
+
 bool ChunkManager::keyBelongsToShard(const BSONObj& shardKey, const ShardId& shardId) const {
     if (shardKey.isEmpty())
         return false;
@@ -398,87 +449,64 @@ std::string RoutingTableHistory::toString() const {
     return sb.str();
 }
 
-ShardVersionMap RoutingTableHistory::_constructShardVersionMap() const {
-    const OID& epoch = _collectionVersion.epoch();
-
-    ShardVersionMap shardVersions;
-    ChunkInfoMap::const_iterator current = _chunkMap.cbegin();
+void RoutingTableHistory::_checkContinuity(const ChunkInfoMap& chunkMap,
+                                           const std::vector<std::string>& changedChunkMaxKeys) {
+    // Checks that the chunk at 'next' starts where the chunk at 'prev' ends
+    const auto checkAdjacent = [](const ChunkInfoMap::value_type& prev,
+                                  const ChunkInfoMap::value_type& next) {
+        const auto& lastMax = prev.second->getMax();
+        const auto& rangeMin = next.second->getMin();
+        if (SimpleBSONObjComparator::kInstance.evaluate(lastMax == rangeMin)) {
+            return;
+        }
 
-    boost::optional<BSONObj> firstMin = boost::none;
-    boost::optional<BSONObj> lastMax = boost::none;
+        if (SimpleBSONObjComparator::kInstance.evaluate(lastMax < rangeMin))
+            uasserted(ErrorCodes::ConflictingOperationInProgress,
+                      str::stream() << "Gap exists in the routing table between chunks "
+                                    << prev.second->getRange().toString()
+                                    << " and "
+                                    << next.second->getRange().toString());
+        else
+            uasserted(ErrorCodes::ConflictingOperationInProgress,
+                      str::stream() << "Overlap exists in the routing table between chunks "
+                                    << prev.second->getRange().toString()
+                                    << " and "
+                                    << next.second->getRange().toString());
+    };
+
+    if (chunkMap.empty()) {
+        return;
+    }
 
-    while (current != _chunkMap.cend()) {
-        const auto& firstChunkInRange = current->second;
-        const auto& currentRangeShardId = firstChunkInRange->getShardIdAt(boost::none);
+    checkAllElementsAreOfType(MinKey, chunkMap.begin()->second->getMin());
+    checkAllElementsAreOfType(MaxKey, std::prev(chunkMap.end())->second->getMax());
 
-        // Tracks the max shard version for the shard on which the current range will reside
-        auto shardVersionIt = shardVersions.find(currentRangeShardId);
-        if (shardVersionIt == shardVersions.end()) {
-            shardVersionIt =
-                shardVersions.emplace(currentRangeShardId, ChunkVersion(0, 0, epoch)).first;
+    // When most of the map has changed, for example when it is built from scratch, a single pass
+    // over it is cheaper than looking up the neighbours of every changed chunk
+    if (changedChunkMaxKeys.size() >= chunkMap.size() / 2) {
+        for (auto prev = chunkMap.begin(), next = std::next(prev); next != chunkMap.end();
+             prev = next++) {
+            checkAdjacent(*prev, *next);
         }
+        return;
+    }
 
-        auto& maxShardVersion = shardVersionIt->second;
-
-        current =
-            std::find_if(current,
-                         _chunkMap.cend(),
-                         [&currentRangeShardId,
-                          &maxShardVersion](const ChunkInfoMap::value_type& chunkMapEntry) {
-                             const auto& currentChunk = chunkMapEntry.second;
-
-                             if (currentChunk->getShardIdAt(boost::none) != currentRangeShardId)
-                                 return true;
-
-                             if (currentChunk->getLastmod() > maxShardVersion)
-                                 maxShardVersion = currentChunk->getLastmod();
-
-                             return false;
-                         });
-
-        const auto rangeLast = std::prev(current);
-
-        const auto& rangeMin = firstChunkInRange->getMin();
-        const auto& rangeMax = rangeLast->second->getMax();
-
-        // Check the continuity of the chunks map
-        if (lastMax && !SimpleBSONObjComparator::kInstance.evaluate(*lastMax == rangeMin)) {
-            if (SimpleBSONObjComparator::kInstance.evaluate(*lastMax < rangeMin))
-                uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream()
-                              << "Gap exists in the routing table between chunks "
-                              << _chunkMap.at(_extractKeyString(*lastMax))->getRange().toString()
-                              << " and "
-                              << rangeLast->second->getRange().toString());
-            else
-                uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream()
-                              << "Overlap exists in the routing table between chunks "
-                              << _chunkMap.at(_extractKeyString(*lastMax))->getRange().toString()
-                              << " and "
-                              << rangeLast->second->getRange().toString());
+    for (const auto& maxKey : changedChunkMaxKeys) {
+        const auto it = chunkMap.find(maxKey);
+        if (it == chunkMap.end()) {
+            // The chunk was replaced by a later change, whose neighbours are checked instead
+            continue;
         }
 
-        if (!firstMin)
-            firstMin = rangeMin;
-
-        lastMax = rangeMax;
-
-        // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
-        // somewhere, which should have been caught at chunk load time
-        invariant(maxShardVersion.isSet());
-    }
-
-    if (!_chunkMap.empty()) {
-        invariant(!shardVersions.empty());
-        invariant(firstMin.is_initialized());
-        invariant(lastMax.is_initialized());
+        if (it != chunkMap.begin()) {
+            checkAdjacent(*std::prev(it), *it);
+        }
 
-        checkAllElementsAreOfType(MinKey, firstMin.get());
-        checkAllElementsAreOfType(MaxKey, lastMax.get());
+        const auto next = std::next(it);
+        if (next != chunkMap.end()) {
+            checkAdjacent(*it, *next);
+        }
     }
-
-    return shardVersions;
 }
 
 std::string RoutingTableHistory::_extractKeyString(const BSONObj& shardKeyValue) const {
@@ -499,7 +527,9 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeNew(
                                std::move(defaultCollator),
                                std::move(unique),
                                {},
-                               {0, 0, epoch})
+                               {0, 0, epoch},
+                               {},
+                               {})
         .makeUpdated(chunks);
 }
 
@@ -507,7 +537,20 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
 
     const auto startingCollectionVersion = getVersion();
+
+    // Copying the chunk map is O(1). The copy shares all of its nodes with '_chunkMap' and only
+    // the nodes on the paths to the changed chunks are copied as they get modified.
     auto chunkMap = _chunkMap;
+    auto shardVersions = _shardVersions;
+    auto shardChunkCounts = _shardChunkCounts;
+
+    // Shards which lost the chunk with their max version and still own other chunks, so their
+    // version has to be recomputed unless they also receive a newer chunk
+    std::set<ShardId> shardsToRecompute;
+
+    // The maxes of the chunks which were inserted, around which the map needs to be validated
+    std::vector<std::string> changedChunkMaxKeys;
+    changedChunkMaxKeys.reserve(changedChunks.size());
 
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
@@ -535,10 +578,32 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
         const auto high = chunkMap.upper_bound(chunkMaxKeyString);
 
         // Erase all chunks from the map, which overlap the chunk we got from the persistent store
+        for (auto it = low; it != high; ++it) {
+            const auto& erasedChunk = it->second;
+            const auto& shardId = erasedChunk->getShardIdAt(boost::none);
+
+            auto chunkCountIt = shardChunkCounts.find(shardId);
+            invariant(chunkCountIt != shardChunkCounts.end());
+            if (--chunkCountIt->second == 0) {
+                shardChunkCounts.erase(chunkCountIt);
+                shardVersions.erase(shardId);
+                shardsToRecompute.erase(shardId);
+            } else if (erasedChunk->getLastmod() == shardVersions.at(shardId)) {
+                shardsToRecompute.insert(shardId);
+            }
+        }
         chunkMap.erase(low, high);
 
-        // Insert only the chunk itself
-        chunkMap.insert(std::make_pair(chunkMaxKeyString, std::make_shared<ChunkInfo>(chunk)));
+        // Insert only the chunk itself. Its version is the highest of the collection so far, so
+        // it is also the new version of the shard which owns it.
+        auto chunkInfo = std::make_shared<ChunkInfo>(chunk);
+        const auto& shardId = chunkInfo->getShardIdAt(boost::none);
+        ++shardChunkCounts[shardId];
+        shardVersions[shardId] = chunkVersion;
+        shardsToRecompute.erase(shardId);
+
+        chunkMap.insert(std::make_pair(chunkMaxKeyString, std::move(chunkInfo)));
+        changedChunkMaxKeys.push_back(chunkMaxKeyString);
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -552,6 +617,31 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
         return shared_from_this();
     }
 
+    _checkContinuity(chunkMap, changedChunkMaxKeys);
+
+    // Chunk versions only ever increase, so a shard only loses its max version without receiving a
+    // newer chunk in unusual histories. Its version is then recomputed with a pass over the map.
+    if (!shardsToRecompute.empty()) {
+        for (const auto& shardId : shardsToRecompute) {
+            shardVersions[shardId] = ChunkVersion(0, 0, collectionVersion.epoch());
+        }
+
+        for (const auto& entry : chunkMap) {
+            const auto& chunkInfo = entry.second;
+            const auto& shardId = chunkInfo->getShardIdAt(boost::none);
+            if (shardsToRecompute.count(shardId) &&
+                chunkInfo->getLastmod() > shardVersions[shardId]) {
+                shardVersions[shardId] = chunkInfo->getLastmod();
+            }
+        }
+    }
+
+    // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
+    // somewhere, which should have been caught at chunk load time
+    for (const auto& shardVersion : shardVersions) {
+        invariant(shardVersion.second.isSet());
+    }
+
     return std::shared_ptr<RoutingTableHistory>(
         new RoutingTableHistory(_nss,
                                 _uuid,
@@ -559,7 +649,9 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
                                 CollatorInterface::cloneCollator(getDefaultCollator()),
                                 isUnique(),
                                 std::move(chunkMap),
-                                collectionVersion));
+                                collectionVersion,
+                                std::move(shardVersions),
+                                std::move(shardChunkCounts)));
 }
 
 }  // namespace mongo
@@ -39,6 +39,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/s/chunk.h"
+#include "mongo/s/chunk_info_map.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/shard_key_pattern.h"
@@ -51,12 +52,12 @@ struct QuerySolutionNode;
 class OperationContext;
 class ChunkManager;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-using ChunkInfoMap = std::map<std::string, std::shared_ptr<ChunkInfo>>;
-
 // Map from a shard is to the max chunk version on that shard
 using ShardVersionMap = std::map<ShardId, ChunkVersion>;
 
+// Map from a shard id to the number of chunks on that shard
+using ShardChunkCountMap = std::map<ShardId, size_t>;
+
 /**
  * In-memory representation of the routing table for a single sharded collection at various points
  * in time.
@@ -91,6 +92,10 @@ public:
      *
      * The changes in "changedChunks" must be sorted in ascending order by chunk version, and adhere
      * to the requirements of the routing table update algorithm.
+     *
+     * The new instance shares the unchanged parts of the chunk map with this one, so the cost of
+     * an update is proportional to the number of changed chunks rather than to the size of the
+     * routing table. This instance is not modified and remains usable by concurrent readers.
      */
     std::shared_ptr<RoutingTableHistory> makeUpdated(const std::vector<ChunkType>& changedChunks);
 
@@ -158,12 +163,18 @@ private:
                         std::unique_ptr<CollatorInterface> defaultCollator,
                         bool unique,
                         ChunkInfoMap chunkMap,
-                        ChunkVersion collectionVersion);
+                        ChunkVersion collectionVersion,
+                        ShardVersionMap shardVersions,
+                        ShardChunkCountMap shardChunkCounts);
 
     /**
-     * Does a single pass over the chunkMap and constructs the ShardVersionMap object.
+     * Checks that the chunks in "chunkMap" adjacent to the chunks whose max is in
+     * "changedChunkMaxKeys" cover a contiguous range, which starts at MinKey and ends at MaxKey.
+     * Throws ConflictingOperationInProgress otherwise. The rest of the map is expected to have been
+     * validated when it was first built.
      */
-    ShardVersionMap _constructShardVersionMap() const;
+    static void _checkContinuity(const ChunkInfoMap& chunkMap,
+                                 const std::vector<std::string>& changedChunkMaxKeys);
 
     std::string _extractKeyString(const BSONObj& shardKeyValue) const;
 
@@ -199,6 +210,10 @@ private:
     // chunks, it won't be present in this map.
     const ShardVersionMap _shardVersions;
 
+    // Map from shard id to the number of chunks on that shard, which is used to maintain
+    // '_shardVersions' incrementally. Contains the same shards as '_shardVersions'.
+    const ShardChunkCountMap _shardChunkCounts;
+
     // Auto-split throttling state (state mutable by write commands)
     struct AutoSplitThrottle {
     public:
@@ -354,6 +369,17 @@ public:
         return findIntersectingChunk(shardKey, CollationSpec::kSimpleSpec);
     }
 
+    /**
+     * Batched form of findIntersectingChunkWithSimpleCollation. Returns the chunk containing each
+     * of "shardKeys", in the same order, or boost::none for keys which cannot be targeted to a
+     * single chunk.
+     *
+     * The keys are encoded and sorted once and then resolved with a single ordered sweep over the
+     * routing table, which is cheaper than an independent lookup per key for large batches.
+     */
+    std::vector<boost::optional<Chunk>> findIntersectingChunksWithSimpleCollation(
+        const std::vector<BSONObj>& shardKeys) const;
+
     /**
      * Finds the shard IDs for a given filter and collation. If collation is empty, we use the
      * collection default collation for targeting.
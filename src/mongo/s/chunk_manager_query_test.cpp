@@ -489,5 +489,45 @@ TEST_F(ChunkManagerQueryTest, SimpleCollationNumbersMultiShard) {
         {ShardId("0")});
 }
 
+TEST_F(ChunkManagerQueryTest, FindIntersectingChunksMatchesSingleKeyLookups) {
+    const ShardKeyPattern shardKeyPattern(BSON("a" << 1));
+
+    std::vector<BSONObj> splitPoints;
+    for (int i = -1000; i < 1000; i += 10) {
+        splitPoints.push_back(BSON("a" << i));
+    }
+    auto chunkManager = makeChunkManager(kNss, shardKeyPattern, nullptr, false, splitPoints);
+
+    // Keys in no particular order, with duplicates, keys on chunk boundaries and keys far apart
+    std::vector<BSONObj> shardKeys;
+    for (int i = 0; i < 500; ++i) {
+        shardKeys.push_back(BSON("a" << ((i * 7919) % 2500) - 1250));
+    }
+    shardKeys.push_back(BSON("a" << MINKEY));
+    shardKeys.push_back(BSON("a" << 0));
+    shardKeys.push_back(BSON("a" << 0));
+
+    const auto chunks = chunkManager->findIntersectingChunksWithSimpleCollation(shardKeys);
+    ASSERT_EQ(shardKeys.size(), chunks.size());
+    for (size_t i = 0; i < shardKeys.size(); ++i) {
+        ASSERT(chunks[i]);
+        const auto expected = chunkManager->findIntersectingChunkWithSimpleCollation(shardKeys[i]);
+        ASSERT_BSONOBJ_EQ(expected.getMin(), chunks[i]->getMin());
+        ASSERT_EQ(expected.getShardId(), chunks[i]->getShardId());
+    }
+}
+
+TEST_F(ChunkManagerQueryTest, FindIntersectingChunksReportsKeysWhichCannotBeTargeted) {
+    const ShardKeyPattern shardKeyPattern(BSON("a" << 1));
+    auto chunkManager = makeChunkManager(kNss, shardKeyPattern, nullptr, false, {BSON("a" << 0)});
+
+    const auto chunks = chunkManager->findIntersectingChunksWithSimpleCollation(
+        {BSON("a" << MAXKEY), BSON("a" << 5), BSON("a" << -5)});
+    ASSERT_EQ(3U, chunks.size());
+    ASSERT_FALSE(chunks[0]);
+    ASSERT_BSONOBJ_EQ(BSON("a" << 0), chunks[1]->getMin());
+    ASSERT_BSONOBJ_EQ(BSON("a" << MINKEY), chunks[2]->getMin());
+}
+
 }  // namespace
 }  // namespace mongo
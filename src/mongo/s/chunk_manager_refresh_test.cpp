@@ -0,0 +1,143 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_manager.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("TestDB", "TestColl");
+const KeyPattern kShardKeyPattern(BSON("_id" << 1));
+
+/**
+ * Builds a routing table with chunks [MinKey, 0), [0, 100), ... [100 * (nChunks - 2), MaxKey),
+ * which are assigned to "shard0" and "shard1" in turns.
+ */
+std::shared_ptr<RoutingTableHistory> makeRoutingTable(const OID& epoch, int nChunks) {
+    std::vector<ChunkType> chunks;
+    for (int i = 0; i < nChunks; ++i) {
+        const auto min = (i == 0) ? kShardKeyPattern.globalMin() : BSON("_id" << (i - 1) * 100);
+        const auto max = (i + 1 == nChunks) ? kShardKeyPattern.globalMax() : BSON("_id" << i * 100);
+        chunks.emplace_back(kNss,
+                            ChunkRange{min, max},
+                            ChunkVersion(1, i, epoch),
+                            ShardId(i % 2 == 0 ? "shard0" : "shard1"));
+    }
+
+    return RoutingTableHistory::makeNew(
+        kNss, UUID::gen(), kShardKeyPattern, nullptr, false, epoch, chunks);
+}
+
+TEST(RoutingTableHistoryTest, IncrementalUpdateLeavesOriginalUnchanged) {
+    const auto epoch = OID::gen();
+    const auto original = makeRoutingTable(epoch, 1000);
+    const auto originalVersion = original->getVersion();
+    const auto originalShard1Version = original->getVersion(ShardId("shard1"));
+
+    // Move [0, 100) from shard1 to a new shard and bump a chunk on the donor
+    auto version = originalVersion;
+    version.incMajor();
+    std::vector<ChunkType> changedChunks;
+    changedChunks.emplace_back(
+        kNss, ChunkRange{BSON("_id" << 0), BSON("_id" << 100)}, version, ShardId("shard2"));
+    version.incMinor();
+    changedChunks.emplace_back(
+        kNss, ChunkRange{BSON("_id" << 200), BSON("_id" << 300)}, version, ShardId("shard1"));
+
+    const auto updated = original->makeUpdated(changedChunks);
+    ASSERT_NE(original.get(), updated.get());
+    ASSERT_EQ(version, updated->getVersion());
+    ASSERT_EQ(1000U, updated->getChunkMap().size());
+
+    ChunkManager updatedCm(updated, boost::none);
+    ASSERT_EQ(ShardId("shard2"),
+              updatedCm.findIntersectingChunkWithSimpleCollation(BSON("_id" << 50)).getShardId());
+    ASSERT_EQ(changedChunks[0].getVersion(), updated->getVersion(ShardId("shard2")));
+    ASSERT_EQ(version, updated->getVersion(ShardId("shard1")));
+
+    // The original routing table still describes the collection as it was
+    ChunkManager originalCm(original, boost::none);
+    ASSERT_EQ(ShardId("shard1"),
+              originalCm.findIntersectingChunkWithSimpleCollation(BSON("_id" << 50)).getShardId());
+    ASSERT_EQ(originalVersion, original->getVersion());
+    ASSERT_EQ(originalShard1Version, original->getVersion(ShardId("shard1")));
+    ASSERT_EQ(ChunkVersion(0, 0, epoch), original->getVersion(ShardId("shard2")));
+}
+
+TEST(RoutingTableHistoryTest, ShardWithoutChunksLosesItsVersion) {
+    const auto epoch = OID::gen();
+    const auto original = makeRoutingTable(epoch, 3);
+
+    // Move the only chunk of shard1 to shard0
+    auto version = original->getVersion();
+    version.incMajor();
+    const auto updated = original->makeUpdated(
+        {ChunkType(kNss, ChunkRange{BSON("_id" << 0), BSON("_id" << 100)}, version, {"shard0"})});
+
+    std::set<ShardId> shardIds;
+    updated->getAllShardIds(&shardIds);
+    ASSERT_EQ(1U, shardIds.size());
+    ASSERT_EQ(version, updated->getVersion(ShardId("shard0")));
+    ASSERT_EQ(ChunkVersion(0, 0, epoch), updated->getVersion(ShardId("shard1")));
+}
+
+TEST(RoutingTableHistoryTest, IncrementalUpdateDetectsGap) {
+    const auto epoch = OID::gen();
+    const auto original = makeRoutingTable(epoch, 1000);
+
+    // Replacing [0, 100) with [50, 100) leaves [0, 50) uncovered
+    auto version = original->getVersion();
+    version.incMajor();
+    ASSERT_THROWS_CODE(
+        original->makeUpdated({ChunkType(
+            kNss, ChunkRange{BSON("_id" << 50), BSON("_id" << 100)}, version, {"shard0"})}),
+        DBException,
+        ErrorCodes::ConflictingOperationInProgress);
+}
+
+TEST(RoutingTableHistoryTest, IncrementalUpdateDetectsOverlap) {
+    const auto epoch = OID::gen();
+    const auto original = makeRoutingTable(epoch, 1000);
+
+    // [0, 150) partially overlaps [100, 200), which remains in the routing table
+    auto version = original->getVersion();
+    version.incMajor();
+    ASSERT_THROWS_CODE(
+        original->makeUpdated({ChunkType(
+            kNss, ChunkRange{BSON("_id" << 0), BSON("_id" << 150)}, version, {"shard0"})}),
+        DBException,
+        ErrorCodes::ConflictingOperationInProgress);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -66,6 +66,7 @@
 #include "mongo/s/query/cluster_client_cursor_params.h"
 #include "mongo/s/query/cluster_cursor_manager.h"
 #include "mongo/s/query/cluster_query_knobs.h"
+#include "mongo/s/query/cluster_query_result_cache.h"
 #include "mongo/s/query/establish_cursors.h"
 #include "mongo/s/query/router_stage_update_on_add_shard.h"
 #include "mongo/s/query/store_possible_cursor.h"
@@ -939,6 +940,66 @@ Status ClusterAggregate::runAggregate(OperationContext* opCtx,
                           << "] cannot be set to 'true' when sent to mongos",
             !request.needsMerge() && !request.isFromMongos() && !request.mergeByPBRT());
     auto executionNsRoutingInfoStatus = getExecutionNsRoutingInfo(opCtx, namespaces.executionNss);
+
+    // Results are only cached for namespaces with a routing table, and are keyed by its version
+    // as of the start of the aggregation.
+    const auto cacheKey = executionNsRoutingInfoStatus.isOK()
+        ? ClusterQueryResultCache::makeAggregateKey(opCtx, namespaces.requestedNss, request)
+        : boost::optional<std::string>{};
+    if (!cacheKey) {
+        return runAggregateWithoutCaching(opCtx,
+                                          namespaces,
+                                          request,
+                                          cmdObj,
+                                          std::move(executionNsRoutingInfoStatus),
+                                          result);
+    }
+
+    auto& resultCache = ClusterQueryResultCache::get(opCtx);
+    const auto routingVersion =
+        ClusterQueryResultCache::makeRoutingVersion(executionNsRoutingInfoStatus.getValue());
+
+    auto cachedResults = resultCache.lookup(
+        *cacheKey, routingVersion, opCtx->getServiceContext()->getFastClockSource()->now());
+    if (cachedResults) {
+        CurOp::get(opCtx)->debug().nreturned = cachedResults->size();
+        CurOp::get(opCtx)->debug().cursorExhausted = true;
+        CursorResponse(namespaces.requestedNss, CursorId(0), std::move(*cachedResults))
+            .addToBSON(CursorResponse::ResponseType::InitialResponse, result);
+        return Status::OK();
+    }
+
+    BSONObjBuilder uncachedResult;
+    auto status = runAggregateWithoutCaching(opCtx,
+                                             namespaces,
+                                             request,
+                                             cmdObj,
+                                             std::move(executionNsRoutingInfoStatus),
+                                             &uncachedResult);
+    const auto reply = uncachedResult.obj();
+
+    // Only complete result sets, returned without a cursor to iterate further, are cached.
+    if (status.isOK()) {
+        auto cursorResponse = CursorResponse::parseFromBSON(reply);
+        if (cursorResponse.isOK() && cursorResponse.getValue().getCursorId() == CursorId(0)) {
+            resultCache.insert(*cacheKey,
+                               routingVersion,
+                               cursorResponse.getValue().getBatch(),
+                               opCtx->getServiceContext()->getFastClockSource()->now());
+        }
+    }
+
+    result->appendElements(reply);
+    return status;
+}
+
+Status ClusterAggregate::runAggregateWithoutCaching(
+    OperationContext* opCtx,
+    const Namespaces& namespaces,
+    const AggregationRequest& request,
+    BSONObj cmdObj,
+    StatusWith<CachedCollectionRoutingInfo> executionNsRoutingInfoStatus,
+    BSONObjBuilder* result) {
     boost::optional<CachedCollectionRoutingInfo> routingInfo;
     LiteParsedPipeline litePipe(request);
 
@@ -34,6 +34,7 @@
 #include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/pipeline/aggregation_request.h"
@@ -45,6 +46,7 @@
 
 namespace mongo {
 
+class CachedCollectionRoutingInfo;
 class LiteParsedPipeline;
 class OperationContext;
 class ShardId;
@@ -83,6 +85,19 @@ public:
                                BSONObjBuilder* result);
 
 private:
+    /**
+     * Executes the aggregation 'request' without consulting or populating the router's result
+     * cache. Takes the same arguments as runAggregate(), plus the routing info of the execution
+     * namespace which runAggregate() already looked up.
+     */
+    static Status runAggregateWithoutCaching(
+        OperationContext* opCtx,
+        const Namespaces& namespaces,
+        const AggregationRequest& request,
+        BSONObj cmdObj,
+        StatusWith<CachedCollectionRoutingInfo> executionNsRoutingInfoStatus,
+        BSONObjBuilder* result);
+
     static void uassertAllShardsSupportExplain(
         const std::vector<AsyncRequestsSender::Response>& shardResults);
 
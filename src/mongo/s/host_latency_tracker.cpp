@@ -0,0 +1,165 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/host_latency_tracker.h"
+
+#include <algorithm>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/bits.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+const auto getHostLatencyTracker = ServiceContext::declareDecoration<HostLatencyTracker>();
+
+// log2(HostLatencyTracker::kSubBucketsPerPowerOfTwo)
+const int kSubBucketBits = 2;
+
+MONGO_STATIC_ASSERT((1 << kSubBucketBits) == HostLatencyTracker::kSubBucketsPerPowerOfTwo);
+
+}  // namespace
+
+constexpr int HostLatencyTracker::kSubBucketsPerPowerOfTwo;
+constexpr int HostLatencyTracker::kNumBuckets;
+constexpr uint64_t HostLatencyTracker::kDecayThreshold;
+constexpr uint64_t HostLatencyTracker::kMinSamples;
+
+HostLatencyTracker* HostLatencyTracker::get(ServiceContext* serviceContext) {
+    return &getHostLatencyTracker(serviceContext);
+}
+
+int HostLatencyTracker::bucketForLatency(Microseconds latency) {
+    const uint64_t micros = std::max<int64_t>(0, durationCount<Microseconds>(latency));
+
+    // The first buckets are exact.
+    if (micros < kSubBucketsPerPowerOfTwo) {
+        return micros;
+    }
+
+    // Above that, every power of two is split into kSubBucketsPerPowerOfTwo equal ranges, selected
+    // by the bits which follow the most significant one.
+    const int log2 = 63 - countLeadingZeros64(micros);
+    const int subBucket = (micros >> (log2 - kSubBucketBits)) & (kSubBucketsPerPowerOfTwo - 1);
+    const int bucket = (log2 - kSubBucketBits + 1) * kSubBucketsPerPowerOfTwo + subBucket;
+
+    return std::min(bucket, kNumBuckets - 1);
+}
+
+Microseconds HostLatencyTracker::bucketUpperBound(int bucket) {
+    invariant(bucket >= 0 && bucket < kNumBuckets);
+
+    if (bucket < kSubBucketsPerPowerOfTwo) {
+        return Microseconds(bucket + 1);
+    }
+
+    const int log2 = bucket / kSubBucketsPerPowerOfTwo + kSubBucketBits - 1;
+    const int subBucket = bucket % kSubBucketsPerPowerOfTwo;
+    return Microseconds(static_cast<int64_t>(kSubBucketsPerPowerOfTwo + subBucket + 1)
+                        << (log2 - kSubBucketBits));
+}
+
+void HostLatencyTracker::recordLatency(const HostAndPort& host, Microseconds latency) {
+    const int bucket = bucketForLatency(latency);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto& histogram = _histograms[host];
+
+    histogram.buckets[bucket]++;
+    histogram.count++;
+
+    if (histogram.count >= kDecayThreshold) {
+        histogram.count = 0;
+        for (auto& bucketCount : histogram.buckets) {
+            bucketCount /= 2;
+            histogram.count += bucketCount;
+        }
+    }
+}
+
+boost::optional<Microseconds> HostLatencyTracker::getLatencyPercentile(const HostAndPort& host,
+                                                                       int percentile) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _getLatencyPercentile(lk, host, percentile);
+}
+
+HostAndPort HostLatencyTracker::selectFastestHost(const std::vector<HostAndPort>& candidates) const {
+    invariant(!candidates.empty());
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    const HostAndPort* fastestHost = nullptr;
+    Microseconds fastestLatency = Microseconds::max();
+
+    for (const auto& host : candidates) {
+        const auto latency = _getLatencyPercentile(lk, host, 50);
+        if (!latency) {
+            return host;
+        }
+
+        if (!fastestHost || *latency < fastestLatency) {
+            fastestHost = &host;
+            fastestLatency = *latency;
+        }
+    }
+
+    return *fastestHost;
+}
+
+boost::optional<Microseconds> HostLatencyTracker::_getLatencyPercentile(WithLock,
+                                                                        const HostAndPort& host,
+                                                                        int percentile) const {
+    invariant(percentile > 0 && percentile <= 100);
+
+    auto it = _histograms.find(host);
+    if (it == _histograms.end() || it->second.count < kMinSamples) {
+        return boost::none;
+    }
+
+    const auto& histogram = it->second;
+
+    // The rank of the sample below which 'percentile' percent of the samples fall, rounded up.
+    const uint64_t rank = (histogram.count * percentile + 99) / 100;
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < kNumBuckets; ++bucket) {
+        seen += histogram.buckets[bucket];
+        if (seen >= rank) {
+            return bucketUpperBound(bucket);
+        }
+    }
+
+    MONGO_UNREACHABLE;
+}
+
+}  // namespace mongo
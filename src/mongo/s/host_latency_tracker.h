@@ -0,0 +1,127 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class ServiceContext;
+
+/**
+ * Decoration on ServiceContext which keeps a histogram of the observed round-trip latencies of
+ * remote commands for each host. The histograms decay, so they reflect the recent behavior of a
+ * host rather than its whole history.
+ *
+ * The AsyncRequestsSender uses them to decide how long to wait before sending a hedged read and
+ * which member of a replica set the hedged read should go to.
+ *
+ * This class is thread-safe.
+ */
+class HostLatencyTracker {
+    MONGO_DISALLOW_COPYING(HostLatencyTracker);
+
+public:
+    // Every power of two of microseconds is split into this many buckets.
+    static constexpr int kSubBucketsPerPowerOfTwo = 4;
+
+    // Number of buckets in each histogram. The last bucket collects everything above two hours.
+    static constexpr int kNumBuckets = 128;
+
+    // Number of samples after which all the buckets of a host's histogram are halved.
+    static constexpr uint64_t kDecayThreshold = 1024;
+
+    // Minimum number of samples a host must have before its histogram is used for estimates.
+    static constexpr uint64_t kMinSamples = 16;
+
+    HostLatencyTracker() = default;
+
+    /**
+     * Retrieves the HostLatencyTracker associated with the given service context.
+     */
+    static HostLatencyTracker* get(ServiceContext* serviceContext);
+
+    /**
+     * Adds a round-trip latency observed for a command sent to 'host'.
+     */
+    void recordLatency(const HostAndPort& host, Microseconds latency);
+
+    /**
+     * Returns an upper bound for the given percentile, in the range (0, 100], of the latencies
+     * recently recorded for 'host'. Returns boost::none if fewer than kMinSamples latencies have
+     * been recorded for it.
+     */
+    boost::optional<Microseconds> getLatencyPercentile(const HostAndPort& host,
+                                                       int percentile) const;
+
+    /**
+     * Returns the host from 'candidates' with the lowest median latency. Hosts which do not have
+     * enough samples yet are preferred, so that their latency gets measured. Ties are broken by
+     * the order in 'candidates'.
+     *
+     * 'candidates' must not be empty.
+     */
+    HostAndPort selectFastestHost(const std::vector<HostAndPort>& candidates) const;
+
+    /**
+     * Maps a latency to the bucket which counts it and back to the (exclusive) upper bound of the
+     * latencies a bucket counts. Exposed for testing.
+     */
+    static int bucketForLatency(Microseconds latency);
+    static Microseconds bucketUpperBound(int bucket);
+
+private:
+    struct Histogram {
+        std::array<uint64_t, kNumBuckets> buckets{};
+        uint64_t count{0};
+    };
+
+    boost::optional<Microseconds> _getLatencyPercentile(WithLock,
+                                                        const HostAndPort& host,
+                                                        int percentile) const;
+
+    // Protects the state below
+    mutable stdx::mutex _mutex;
+
+    stdx::unordered_map<HostAndPort, Histogram> _histograms;
+};
+
+}  // namespace mongo
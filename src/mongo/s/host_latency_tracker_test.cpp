@@ -0,0 +1,141 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/host_latency_tracker.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const HostAndPort kHostA("HostA:27017");
+const HostAndPort kHostB("HostB:27017");
+const HostAndPort kHostC("HostC:27017");
+
+void recordSamples(HostLatencyTracker* tracker,
+                   const HostAndPort& host,
+                   Microseconds latency,
+                   uint64_t numSamples) {
+    for (uint64_t i = 0; i < numSamples; ++i) {
+        tracker->recordLatency(host, latency);
+    }
+}
+
+TEST(HostLatencyTrackerTest, BucketBoundsContainLatency) {
+    for (int64_t micros : {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 1000, 1023, 1024, 123456789}) {
+        const int bucket = HostLatencyTracker::bucketForLatency(Microseconds(micros));
+        ASSERT_LT(micros, durationCount<Microseconds>(HostLatencyTracker::bucketUpperBound(bucket)))
+            << micros;
+        if (bucket > 0) {
+            ASSERT_GTE(micros,
+                       durationCount<Microseconds>(
+                           HostLatencyTracker::bucketUpperBound(bucket - 1)))
+                << micros;
+        }
+    }
+}
+
+TEST(HostLatencyTrackerTest, BucketsAreMonotonic) {
+    int lastBucket = 0;
+    for (int64_t micros = 0; micros < 100000; ++micros) {
+        const int bucket = HostLatencyTracker::bucketForLatency(Microseconds(micros));
+        ASSERT_GTE(bucket, lastBucket);
+        ASSERT_LTE(bucket, lastBucket + 1);
+        lastBucket = bucket;
+    }
+}
+
+TEST(HostLatencyTrackerTest, VeryLargeLatencyGoesToLastBucket) {
+    ASSERT_EQ(HostLatencyTracker::kNumBuckets - 1,
+              HostLatencyTracker::bucketForLatency(Hours(24 * 365)));
+}
+
+TEST(HostLatencyTrackerTest, NoPercentileWithoutEnoughSamples) {
+    HostLatencyTracker tracker;
+    ASSERT_FALSE(tracker.getLatencyPercentile(kHostA, 50));
+
+    recordSamples(&tracker, kHostA, Milliseconds(1), HostLatencyTracker::kMinSamples - 1);
+    ASSERT_FALSE(tracker.getLatencyPercentile(kHostA, 50));
+
+    tracker.recordLatency(kHostA, Milliseconds(1));
+    ASSERT(tracker.getLatencyPercentile(kHostA, 50));
+}
+
+TEST(HostLatencyTrackerTest, PercentileIsUpperBoundOfBucket) {
+    HostLatencyTracker tracker;
+    recordSamples(&tracker, kHostA, Milliseconds(1), 90);
+    recordSamples(&tracker, kHostA, Milliseconds(100), 10);
+
+    const auto p50 = tracker.getLatencyPercentile(kHostA, 50);
+    ASSERT(p50);
+    ASSERT_GT(*p50, Microseconds(Milliseconds(1)));
+    ASSERT_LTE(*p50, Microseconds(Milliseconds(1)) * 5 / 4);
+
+    const auto p90 = tracker.getLatencyPercentile(kHostA, 90);
+    ASSERT(p90);
+    ASSERT_EQ(*p50, *p90);
+
+    const auto p95 = tracker.getLatencyPercentile(kHostA, 95);
+    ASSERT(p95);
+    ASSERT_GT(*p95, Microseconds(Milliseconds(100)));
+    ASSERT_LTE(*p95, Microseconds(Milliseconds(100)) * 5 / 4);
+}
+
+TEST(HostLatencyTrackerTest, OldSamplesDecay) {
+    HostLatencyTracker tracker;
+    recordSamples(&tracker, kHostA, Milliseconds(100), HostLatencyTracker::kDecayThreshold - 1);
+    ASSERT_GT(*tracker.getLatencyPercentile(kHostA, 50), Microseconds(Milliseconds(100)));
+
+    // After enough decay rounds the old samples only make up a small fraction of the histogram.
+    recordSamples(&tracker, kHostA, Milliseconds(1), HostLatencyTracker::kDecayThreshold * 4);
+    ASSERT_LTE(*tracker.getLatencyPercentile(kHostA, 90), Microseconds(Milliseconds(2)));
+}
+
+TEST(HostLatencyTrackerTest, SelectFastestHostUsesMedian) {
+    HostLatencyTracker tracker;
+    recordSamples(&tracker, kHostA, Milliseconds(50), 100);
+    recordSamples(&tracker, kHostB, Milliseconds(5), 100);
+    recordSamples(&tracker, kHostC, Milliseconds(20), 100);
+
+    ASSERT_EQ(kHostB, tracker.selectFastestHost({kHostA, kHostB, kHostC}));
+    ASSERT_EQ(kHostC, tracker.selectFastestHost({kHostA, kHostC}));
+}
+
+TEST(HostLatencyTrackerTest, SelectFastestHostPrefersUnmeasuredHosts) {
+    HostLatencyTracker tracker;
+    recordSamples(&tracker, kHostA, Milliseconds(1), 100);
+
+    ASSERT_EQ(kHostB, tracker.selectFastestHost({kHostA, kHostB, kHostC}));
+}
+
+}  // namespace
+}  // namespace mongo
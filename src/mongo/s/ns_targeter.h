@@ -99,6 +99,53 @@ public:
     virtual StatusWith<ShardEndpoint> targetInsert(OperationContext* opCtx,
                                                    const BSONObj& doc) const = 0;
 
+    /**
+     * The result of targeting one of the documents passed to targetInserts.
+     */
+    struct BatchInsertTarget {
+        BatchInsertTarget(StatusWith<ShardEndpoint> endpoint) : endpoint(std::move(endpoint)) {}
+
+        StatusWith<ShardEndpoint> endpoint;
+
+        // Min of the chunk the document was targeted at, for targeters which keep track of the
+        // data inserted into each chunk, see noteBatchInsertTargeted
+        BSONObj chunkMin;
+    };
+
+    /**
+     * Replaces the contents of 'targets' with the result of targeting each of a batch of single
+     * document inserts, in the same order as 'docs'. Implementations may target the batch as a
+     * whole more cheaply than one document at a time.
+     *
+     * Callers should target documents for which this returns !OK again with targetInsert, which
+     * reports the error for the document as it would have been reported without batching.
+     *
+     * Not all of the targeted documents are necessarily sent right away, so implementations should
+     * not account for them here, see noteBatchInsertTargeted.
+     */
+    virtual void targetInserts(OperationContext* opCtx,
+                               const std::vector<BSONObj>& docs,
+                               std::vector<BatchInsertTarget>* targets) const {
+        targets->clear();
+        targets->reserve(docs.size());
+        for (const auto& doc : docs) {
+            try {
+                targets->emplace_back(targetInsert(opCtx, doc));
+            } catch (const DBException& ex) {
+                targets->emplace_back(ex.toStatus());
+            }
+        }
+    }
+
+    /**
+     * Informs the targeter that the insert of 'doc', successfully targeted at 'target' with
+     * targetInserts, has been assigned to a batch which is about to be sent, so that it can
+     * account for its size.
+     */
+    virtual void noteBatchInsertTargeted(OperationContext* opCtx,
+                                         const BSONObj& doc,
+                                         const BatchInsertTarget& target) const {}
+
     /**
      * Returns a vector of ShardEndpoints for a potentially multi-shard update.
      *
@@ -40,6 +40,8 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/util/assert_util.h"
@@ -50,6 +52,15 @@ namespace mongo {
 constexpr StringData AsyncResultsMerger::kSortKeyField;
 const BSONObj AsyncResultsMerger::kWholeSortKeySortPattern = BSON(kSortKeyField << 1);
 
+MONGO_EXPORT_SERVER_PARAMETER(AsyncResultsMergerPrefetchBufferPercent, int, 0)
+    ->withValidator([](const int& newVal) {
+        if (newVal >= 0 && newVal <= 100) {
+            return Status::OK();
+        }
+        return Status(ErrorCodes::BadValue,
+                      "AsyncResultsMergerPrefetchBufferPercent must be between 0 and 100");
+    });
+
 namespace {
 
 // Maximum number of retries for network and replication notMaster errors (per host).
@@ -80,6 +91,18 @@ int compareSortKeys(BSONObj leftSortKey, BSONObj rightSortKey, BSONObj sortKeyPa
     return leftSortKey.woCompare(rightSortKey, sortKeyPattern, considerFieldName);
 }
 
+/**
+ * Returns the Ordering with which sort keys are encoded as KeyStrings for the given sort, or
+ * boost::none if sort keys should be compared as BSON.
+ */
+boost::optional<Ordering> makeSortKeyOrdering(const boost::optional<BSONObj>& sort) {
+    // An Ordering can only describe the direction of the first 32 fields.
+    if (!sort || sort->nFields() > 32) {
+        return boost::none;
+    }
+    return Ordering::make(*sort);
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
@@ -93,8 +116,11 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
       _tailableMode(params.getTailableMode() ? *params.getTailableMode()
                                              : TailableModeEnum::kNormal),
       _params(std::move(params)),
-      _mergeQueue(MergingComparator(
-          _remotes, _params.getSort().value_or(BSONObj()), _params.getCompareWholeSortKey())),
+      _sortKeyOrdering(makeSortKeyOrdering(_params.getSort())),
+      _mergeQueue(MergingComparator(_remotes,
+                                    _params.getSort().value_or(BSONObj()),
+                                    _params.getCompareWholeSortKey(),
+                                    static_cast<bool>(_sortKeyOrdering))),
       _promisedMinSortKeys(PromisedMinSortKeyComparator(_params.getSort().value_or(BSONObj()))) {
     if (params.getTxnNumber()) {
         invariant(params.getSessionId());
@@ -292,7 +318,7 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return _params.getSort() ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_tailableMode != TailableModeEnum::kTailable);
 
@@ -312,9 +338,11 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
     // next result.
     if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
+        _pushToMergeQueue(lk, smallestRemote);
     }
 
+    _prefetchIfNeeded(lk, smallestRemote);
+
     // For sorted tailable awaitData cursors, update the high water mark to the document's sort key.
     if (_tailableMode == TailableModeEnum::kTailableAndAwaitData) {
         _highWaterMark =
@@ -324,7 +352,7 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     return front;
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock lk) {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
         // It is illegal to call this method if there is an error received from any shard.
@@ -342,6 +370,8 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
                 _eofNext = true;
             }
 
+            _prefetchIfNeeded(lk, _gettingFromRemote);
+
             return front;
         }
 
@@ -409,6 +439,51 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     return Status::OK();
 }
 
+bool AsyncResultsMerger::_shouldAskForNextBatch(WithLock, const RemoteCursorData& remote) const {
+    if (!remote.status.isOK() || remote.exhausted() || remote.cbHandle.isValid()) {
+        return false;
+    }
+
+    if (!remote.hasNext()) {
+        return true;
+    }
+
+    // Batches from tailable cursors are passed through to the client as they arrive.
+    if (_tailableMode != TailableModeEnum::kNormal) {
+        return false;
+    }
+
+    const auto prefetchPercent = AsyncResultsMergerPrefetchBufferPercent.load();
+    return remote.docBuffer.size() * 100 < remote.lastBatchSize * prefetchPercent;
+}
+
+void AsyncResultsMerger::_prefetchIfNeeded(WithLock lk, size_t remoteIndex) {
+    if (!_opCtx || _lifecycleState != kAlive || _tailableMode != TailableModeEnum::kNormal ||
+        AsyncResultsMergerPrefetchBufferPercent.load() == 0) {
+        return;
+    }
+
+    auto& remote = _remotes[remoteIndex];
+    if (_shouldAskForNextBatch(lk, remote)) {
+        remote.status = _askForNextBatch(lk, remoteIndex);
+    }
+}
+
+void AsyncResultsMerger::_pushToMergeQueue(WithLock, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+    invariant(remote.hasNext());
+
+    if (_sortKeyOrdering) {
+        const KeyString sortKey(
+            KeyString::Version::V1,
+            extractSortKey(*remote.docBuffer.front().getResult(), _params.getCompareWholeSortKey()),
+            *_sortKeyOrdering);
+        remote.frontSortKey.assign(sortKey.getBuffer(), sortKey.getSize());
+    }
+
+    _mergeQueue.push(remoteIndex);
+}
+
 Status AsyncResultsMerger::scheduleGetMores() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     return _scheduleGetMores(lk);
@@ -423,9 +498,9 @@ Status AsyncResultsMerger::_scheduleGetMores(WithLock lk) {
             return remote.status;
         }
 
-        if (!remote.hasNext() && !remote.exhausted() && !remote.cbHandle.isValid()) {
-            // If this remote is not exhausted and there is no outstanding request for it, schedule
-            // work to retrieve the next batch.
+        if (_shouldAskForNextBatch(lk, remote)) {
+            // If this remote is not exhausted, is running low on results and there is no
+            // outstanding request for it, schedule work to retrieve the next batch.
             auto nextBatchStatus = _askForNextBatch(lk, i);
             if (!nextBatchStatus.isOK()) {
                 return nextBatchStatus;
@@ -580,9 +655,8 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
     if (_params.getAllowPartialResults()) {
         remote.status = Status::OK();
 
-        // Clear the results buffer and cursor id.
-        std::queue<ClusterQueryResult> emptyBuffer;
-        std::swap(remote.docBuffer, emptyBuffer);
+        // Clear the cursor id. Results which were already buffered are kept: if the failed request
+        // was a prefetch, the remote may still be on the merge queue.
         remote.cursorId = 0;
     }
 }
@@ -620,8 +694,8 @@ void AsyncResultsMerger::_processBatchResults(WithLock lk,
     if (_tailableMode == TailableModeEnum::kTailable && !remote.hasNext()) {
         invariant(_remotes.size() == 1);
         _eofNext = true;
-    } else if (!remote.hasNext() && !remote.exhausted() && _lifecycleState == kAlive && _opCtx) {
-        // If this is normal or tailable-awaitData cursor and we still don't have anything buffered
+    } else if (_lifecycleState == kAlive && _opCtx && _shouldAskForNextBatch(lk, remote)) {
+        // If this is normal or tailable-awaitData cursor and we still don't have enough buffered
         // after receiving this batch, we can schedule work to retrieve the next batch right away.
         // Be careful only to do this when '_opCtx' is non-null, since it is illegal to schedule a
         // remote command on a user's behalf without a non-null OperationContext.
@@ -634,6 +708,10 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
                                            const CursorResponse& response) {
     auto& remote = _remotes[remoteIndex];
     _updateRemoteMetadata(lk, remoteIndex, response);
+
+    // A remote is on the merge queue exactly when it has buffered results.
+    const bool needsMergeQueueEntry = !remote.hasNext();
+
     for (const auto& obj : response.getBatch()) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
         if (_params.getSort()) {
@@ -659,11 +737,12 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
         remote.docBuffer.push(result);
         ++remote.fetchedCount;
     }
+    remote.lastBatchSize = response.getBatch().size();
 
     // If we're doing a sorted merge, then we have to make sure to put this remote onto the merge
     // queue.
-    if (_params.getSort() && !response.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+    if (_params.getSort() && needsMergeQueueEntry && !response.getBatch().empty()) {
+        _pushToMergeQueue(lk, remoteIndex);
     }
     return true;
 }
@@ -775,6 +854,11 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
 //
 
 bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
+    if (_compareEncodedSortKeys) {
+        // KeyStrings compare bytewise in the order of the sort pattern.
+        return _remotes[lhs].frontSortKey > _remotes[rhs].frontSortKey;
+    }
+
     const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
     const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
 
@@ -37,8 +37,10 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/query/async_results_merger_params_gen.h"
 #include "mongo/s/query/cluster_query_result.h"
 #include "mongo/stdx/mutex.h"
@@ -50,6 +52,12 @@ namespace mongo {
 
 class CursorResponse;
 
+// Percentage of a remote's last batch which may still be buffered when the AsyncResultsMerger
+// requests the remote's next batch, so that the merge does not stall waiting for it. Zero, the
+// default, means a getMore is only sent once the remote's buffer is empty. Applies only to
+// non-tailable cursors.
+extern AtomicInt32 AsyncResultsMergerPrefetchBufferPercent;
+
 /**
  * Given a set of cursorIds across one or more shards, the AsyncResultsMerger calls getMore on the
  * cursors to present a single sorted or unsorted stream of documents.
@@ -68,6 +76,11 @@ class CursorResponse;
  * must be sorted, we pass the sort through to the remote nodes and then merge the sorted streams.
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
+ * If AsyncResultsMergerPrefetchBufferPercent is set, the next batch for a remote is requested as
+ * soon as its buffer runs low rather than once it is empty.
+ *
+ * For sorted merges, the sort key of the next document of each remote is encoded as a KeyString,
+ * so that the remotes on the merge queue can be ordered with a plain memory comparison.
  *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
@@ -311,14 +324,27 @@ private:
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
+
+        // Number of documents in the last batch received from this remote. Used to decide when to
+        // prefetch the next batch.
+        size_t lastBatchSize = 0;
+
+        // The sort key of the first document in 'docBuffer', encoded as a KeyString. Only
+        // maintained while this remote is on the merge queue, and only if the sort pattern can be
+        // represented as an Ordering.
+        std::string frontSortKey;
     };
 
     class MergingComparator {
     public:
         MergingComparator(const std::vector<RemoteCursorData>& remotes,
                           const BSONObj& sort,
-                          bool compareWholeSortKey)
-            : _remotes(remotes), _sort(sort), _compareWholeSortKey(compareWholeSortKey) {}
+                          bool compareWholeSortKey,
+                          bool compareEncodedSortKeys)
+            : _remotes(remotes),
+              _sort(sort),
+              _compareWholeSortKey(compareWholeSortKey),
+              _compareEncodedSortKeys(compareEncodedSortKeys) {}
 
         bool operator()(const size_t& lhs, const size_t& rhs);
 
@@ -331,6 +357,10 @@ private:
         // We extract the sort key {$sortKey: <value>}. The sort key pattern '_sort' is verified to
         // be {$sortKey: 1}.
         const bool _compareWholeSortKey;
+
+        // When '_compareEncodedSortKeys' is true, remotes are compared by their 'frontSortKey'
+        // rather than by the sort keys of their buffered documents.
+        const bool _compareEncodedSortKeys;
     };
 
     using MinSortKeyRemoteIdPair = std::pair<BSONObj, size_t>;
@@ -365,6 +395,25 @@ private:
      */
     Status _askForNextBatch(WithLock, size_t remoteIndex);
 
+    /**
+     * Returns true if the next batch should be requested from the given remote: it is not
+     * exhausted, has no error and no request outstanding, and it either has no buffered results or,
+     * if prefetching is enabled, its buffer has fallen below the prefetch watermark.
+     */
+    bool _shouldAskForNextBatch(WithLock, const RemoteCursorData& remote) const;
+
+    /**
+     * Called after a result was consumed from the given remote. If prefetching is enabled and the
+     * remote's buffer has fallen below the prefetch watermark, asks for the next batch.
+     */
+    void _prefetchIfNeeded(WithLock, size_t remoteIndex);
+
+    /**
+     * Encodes the sort key of the first buffered document of the given remote, if needed, and
+     * pushes the remote onto the merge queue. The remote must have a buffered result.
+     */
+    void _pushToMergeQueue(WithLock, size_t remoteIndex);
+
     /**
      * Checks whether or not the remote cursors are all exhausted.
      */
@@ -459,6 +508,10 @@ private:
     TailableModeEnum _tailableMode;
     AsyncResultsMergerParams _params;
 
+    // The ordering used to encode sort keys as KeyStrings. Unset if there is no sort or if the sort
+    // pattern has too many fields to be represented as an Ordering.
+    const boost::optional<Ordering> _sortKeyOrdering;
+
     // Must be acquired before accessing any data members (other than _params, which is read-only).
     stdx::mutex _mutex;
 
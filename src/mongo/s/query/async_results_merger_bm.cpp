@@ -0,0 +1,124 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/query/async_results_merger.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kTestNss("test.foo");
+
+/**
+ * Builds the parameters for an ARM over 'nRemotes' exhausted remote cursors, each of which has
+ * buffered a single batch of 'batchSize' results carrying a sort key with 'nSortFields' fields.
+ * Since every remote cursor is exhausted the ARM never has to contact the network.
+ */
+AsyncResultsMergerParams makeParams(int nRemotes, int batchSize, int nSortFields) {
+    BSONObjBuilder sortBuilder;
+    for (int field = 0; field < nSortFields; ++field) {
+        sortBuilder.append(str::stream() << "f" << field, (field % 2 == 0) ? 1 : -1);
+    }
+
+    PseudoRandom rand(12345);
+    std::vector<RemoteCursor> remotes;
+    remotes.reserve(nRemotes);
+    for (int i = 0; i < nRemotes; ++i) {
+        // Each remote returns its results in sort order, so the leading sort key field ascends.
+        std::vector<BSONObj> batch;
+        batch.reserve(batchSize);
+        int64_t value = 0;
+        for (int doc = 0; doc < batchSize; ++doc) {
+            value += 1 + rand.nextInt32(8);
+            BSONObjBuilder docBuilder;
+            docBuilder.append("_id", i * batchSize + doc);
+            BSONObjBuilder sortKeyBuilder(docBuilder.subobjStart(AsyncResultsMerger::kSortKeyField));
+            sortKeyBuilder.append("", value);
+            for (int field = 1; field < nSortFields; ++field) {
+                sortKeyBuilder.append("", (field % 2 == 0) ? i : -i);
+            }
+            sortKeyBuilder.doneFast();
+            batch.push_back(docBuilder.obj());
+        }
+
+        RemoteCursor remote;
+        remote.setShardId(ShardId(str::stream() << "shard" << i));
+        remote.setHostAndPort(HostAndPort(str::stream() << "shard" << i << "host", 12345));
+        remote.setCursorResponse(CursorResponse(kTestNss, CursorId(0), std::move(batch)));
+        remotes.push_back(std::move(remote));
+    }
+
+    AsyncResultsMergerParams params;
+    params.setNss(kTestNss);
+    params.setRemotes(std::move(remotes));
+    params.setSort(sortBuilder.obj());
+    return params;
+}
+
+void BM_SortedMerge(benchmark::State& state) {
+    const int nRemotes = state.range(0);
+    const int batchSize = state.range(1);
+    const int nSortFields = state.range(2);
+
+    for (auto keepRunning : state) {
+        // Remote cursor responses are move-only, so the parameters are rebuilt for every run.
+        state.PauseTiming();
+        AsyncResultsMerger arm(nullptr, nullptr, makeParams(nRemotes, batchSize, nSortFields));
+        state.ResumeTiming();
+
+        while (true) {
+            invariant(arm.ready());
+            auto next = uassertStatusOK(arm.nextReady());
+            if (next.isEOF()) {
+                break;
+            }
+            benchmark::DoNotOptimize(next);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * nRemotes * batchSize);
+}
+
+BENCHMARK(BM_SortedMerge)
+    ->Args({16, 101, 1})
+    ->Args({128, 101, 1})
+    ->Args({256, 101, 1})
+    ->Args({128, 101, 3});
+
+}  // namespace
+}  // namespace mongo
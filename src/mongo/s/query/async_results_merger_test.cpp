@@ -50,6 +50,7 @@
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -663,6 +664,79 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortedMergePrefetchesNextBatchBeforeBufferIsEmpty) {
+    const auto originalPrefetchPercent = AsyncResultsMergerPrefetchBufferPercent.load();
+    AsyncResultsMergerPrefetchBufferPercent.store(50);
+    ON_BLOCK_EXIT([&] { AsyncResultsMergerPrefetchBufferPercent.store(originalPrefetchPercent); });
+
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    std::vector<RemoteCursor> cursors;
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': 1}}"),
+                                   fromjson("{$sortKey: {'': 2}}"),
+                                   fromjson("{$sortKey: {'': 3}}"),
+                                   fromjson("{$sortKey: {'': 10}}")};
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, batch1)));
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: {'': 4}}"),
+                                   fromjson("{$sortKey: {'': 5}}"),
+                                   fromjson("{$sortKey: {'': 6}}"),
+                                   fromjson("{$sortKey: {'': 7}}")};
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[1], kTestShardHosts[1], CursorResponse(kTestNss, 6, batch2)));
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    // Consuming results from the first shard does not schedule a getMore while at least half of
+    // its last batch is still buffered.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 2}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    // Once the buffer drops below half of the last batch, the next batch is requested even though
+    // the ARM can still return results.
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 3}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    auto getMoreRequest = getNthPendingRequest(0u);
+    ASSERT_EQ(kTestShardHosts[0], getMoreRequest.target);
+    ASSERT_EQ(5,
+              unittest::assertGet(GetMoreRequest::parseFromBSON("testdb", getMoreRequest.cmdObj))
+                  .cursorid);
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch3 = {fromjson("{$sortKey: {'': 11}}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch3);
+    scheduleNetworkResponses(std::move(responses));
+
+    // The second shard is prefetched in the same way.
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 4}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 5}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(networkHasReadyRequests());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 6}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    getMoreRequest = getNthPendingRequest(0u);
+    ASSERT_EQ(kTestShardHosts[1], getMoreRequest.target);
+
+    responses.clear();
+    std::vector<BSONObj> batch4 = {fromjson("{$sortKey: {'': 8}}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch4);
+    scheduleNetworkResponses(std::move(responses));
+
+    // Prefetched results are merged with those which were still buffered.
+    ASSERT_TRUE(arm->remotesExhausted());
+    for (auto expected : {7, 8, 10, 11}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("$sortKey" << BSON("" << expected)),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<RemoteCursor> cursors;
@@ -168,6 +168,13 @@ public:
      */
     virtual boost::optional<ReadPreferenceSetting> getReadPreference() const = 0;
 
+    /**
+     * Adds the metrics of a batch returned by this cursor to the execution of its query which is
+     * recorded in the query shape statistics when the cursor is killed. Only cursors created with
+     * a query shape are recorded, and only once a batch has been added.
+     */
+    virtual void incQueryShapeMetrics(const QueryShapeStats::ExecutionMetrics& batch) = 0;
+
     //
     // maxTimeMS support.
     //
@@ -121,6 +121,11 @@ StatusWith<ClusterQueryResult> ClusterClientCursorImpl::next(
 
 void ClusterClientCursorImpl::kill(OperationContext* opCtx) {
     _root->kill(opCtx);
+
+    if (_queryShapeMetrics) {
+        QueryShapeStats::get(opCtx).record(opCtx, *_params.queryShape, *_queryShapeMetrics);
+        _queryShapeMetrics = boost::none;
+    }
 }
 
 void ClusterClientCursorImpl::reattachToOperationContext(OperationContext* opCtx) {
@@ -189,6 +194,23 @@ boost::optional<ReadPreferenceSetting> ClusterClientCursorImpl::getReadPreferenc
     return _params.readPreference;
 }
 
+void ClusterClientCursorImpl::incQueryShapeMetrics(
+    const QueryShapeStats::ExecutionMetrics& batch) {
+    if (!_params.queryShape) {
+        return;
+    }
+
+    if (!_queryShapeMetrics) {
+        _queryShapeMetrics = batch;
+        return;
+    }
+
+    _queryShapeMetrics->latency += batch.latency;
+    _queryShapeMetrics->nReturned += batch.nReturned;
+    _queryShapeMetrics->shardsTargeted += batch.shardsTargeted;
+    _queryShapeMetrics->bytesSent += batch.bytesSent;
+}
+
 namespace {
 
 bool isSkipOrLimit(const boost::intrusive_ptr<DocumentSource>& stage) {
@@ -125,6 +125,8 @@ public:
 
     boost::optional<ReadPreferenceSetting> getReadPreference() const final;
 
+    void incQueryShapeMetrics(const QueryShapeStats::ExecutionMetrics& batch) final;
+
 public:
     /** private for tests */
     /**
@@ -165,6 +167,10 @@ private:
     // Stores the logical session id for this cursor.
     boost::optional<LogicalSessionId> _lsid;
 
+    // The metrics of the batches returned so far, recorded for _params.queryShape when the cursor
+    // is killed.
+    boost::optional<QueryShapeStats::ExecutionMetrics> _queryShapeMetrics;
+
     // The OperationContext that we're executing within. This can be updated if necessary by using
     // detachFromOperationContext() and reattachToOperationContext().
     OperationContext* _opCtx = nullptr;
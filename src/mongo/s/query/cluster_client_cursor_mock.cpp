@@ -130,4 +130,7 @@ boost::optional<ReadPreferenceSetting> ClusterClientCursorMock::getReadPreferenc
     return boost::none;
 }
 
+void ClusterClientCursorMock::incQueryShapeMetrics(
+    const QueryShapeStats::ExecutionMetrics& batch) {}
+
 }  // namespace mongo
@@ -88,6 +88,8 @@ public:
 
     boost::optional<ReadPreferenceSetting> getReadPreference() const final;
 
+    void incQueryShapeMetrics(const QueryShapeStats::ExecutionMetrics& batch) final;
+
     /**
      * Returns true unless marked as having non-exhausted remote cursors via
      * markRemotesNotExhausted().
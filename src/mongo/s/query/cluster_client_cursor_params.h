@@ -42,6 +42,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/cursor_response.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/query/tailable_mode.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/query/async_results_merger_params_gen.h"
@@ -150,6 +151,10 @@ struct ClusterClientCursorParams {
 
     // The transaction number of the command that created the cursor.
     boost::optional<TxnNumber> txnNumber;
+
+    // The shape of the find query which created the cursor, if the query is recorded in the query
+    // shape statistics once the cursor is killed.
+    boost::optional<QueryShapeStats::Shape> queryShape;
 };
 
 }  // mongo
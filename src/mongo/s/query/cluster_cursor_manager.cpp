@@ -168,6 +168,12 @@ long long ClusterCursorManager::PinnedCursor::getNumReturnedSoFar() const {
     return _cursor->getNumReturnedSoFar();
 }
 
+void ClusterCursorManager::PinnedCursor::incQueryShapeMetrics(
+    const QueryShapeStats::ExecutionMetrics& batch) {
+    invariant(_cursor);
+    _cursor->incQueryShapeMetrics(batch);
+}
+
 void ClusterCursorManager::PinnedCursor::queueResult(const ClusterQueryResult& result) {
     invariant(_cursor);
     _cursor->queueResult(result);
@@ -223,6 +223,12 @@ public:
          */
         long long getNumReturnedSoFar() const;
 
+        /**
+         * Adds the metrics of a batch returned by this cursor to the execution of its query which
+         * is recorded in the query shape statistics. A cursor must be owned.
+         */
+        void incQueryShapeMetrics(const QueryShapeStats::ExecutionMetrics& batch);
+
         /**
          * Stashes 'obj' to be returned later by this cursor. A cursor must be owned.
          */
@@ -50,6 +50,7 @@
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/executor/task_executor_pool.h"
 #include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/s/catalog_cache.h"
@@ -60,6 +61,7 @@
 #include "mongo/s/query/cluster_client_cursor_impl.h"
 #include "mongo/s/query/cluster_cursor_manager.h"
 #include "mongo/s/query/cluster_query_knobs.h"
+#include "mongo/s/query/cluster_query_result_cache.h"
 #include "mongo/s/query/establish_cursors.h"
 #include "mongo/s/query/store_possible_cursor.h"
 #include "mongo/s/stale_exception.h"
@@ -216,6 +218,23 @@ std::vector<std::pair<ShardId, BSONObj>> constructRequestsForShards(
     return requests;
 }
 
+/**
+ * Returns the query shape statistics metrics of the batch 'results' returned by the current
+ * operation, which targeted 'shardsTargeted' shards.
+ */
+QueryShapeStats::ExecutionMetrics makeQueryShapeMetrics(OperationContext* opCtx,
+                                                        const std::vector<BSONObj>& results,
+                                                        long long shardsTargeted) {
+    QueryShapeStats::ExecutionMetrics metrics;
+    metrics.latency = CurOp::get(opCtx)->elapsedTimeExcludingPauses();
+    metrics.nReturned = results.size();
+    metrics.shardsTargeted = shardsTargeted;
+    for (const auto& obj : results) {
+        metrics.bytesSent += obj.objsize();
+    }
+    return metrics;
+}
+
 CursorId runQueryWithoutRetrying(OperationContext* opCtx,
                                  const CanonicalQuery& query,
                                  const ReadPreferenceSetting& readPref,
@@ -249,6 +268,10 @@ CursorId runQueryWithoutRetrying(OperationContext* opCtx,
     params.lsid = opCtx->getLogicalSessionId();
     params.txnNumber = opCtx->getTxnNumber();
 
+    if (QueryShapeStats::isEnabled(opCtx)) {
+        params.queryShape.emplace(query);
+    }
+
     // This is the batchSize passed to each subsequent getMore command issued by the cursor. We
     // usually use the batchSize associated with the initial find, but as it is illegal to send a
     // getMore with a batchSize of 0, we set it to use the default batchSize logic.
@@ -351,6 +374,18 @@ CursorId runQueryWithoutRetrying(OperationContext* opCtx,
     CurOp::get(opCtx)->debug().nShards = ccc->getNumRemotes();
     CurOp::get(opCtx)->debug().nreturned = results->size();
 
+    // A query which is exhausted by its first batch is recorded in the query shape statistics right
+    // away, since its cursor is never registered and is not killed if its remotes are exhausted.
+    // Otherwise the query is recorded when its cursor is killed, once its last getMore is done.
+    if (QueryShapeStats::isEnabled(opCtx)) {
+        auto metrics = makeQueryShapeMetrics(opCtx, *results, ccc->getNumRemotes());
+        if (cursorState == ClusterCursorManager::CursorState::Exhausted) {
+            QueryShapeStats::get(opCtx).record(opCtx, QueryShapeStats::Shape(query), metrics);
+        } else {
+            ccc->incQueryShapeMetrics(metrics);
+        }
+    }
+
     // If the cursor is exhausted, then there are no more results to return and we don't need to
     // allocate a cursor id.
     if (cursorState == ClusterCursorManager::CursorState::Exhausted) {
@@ -425,6 +460,8 @@ CursorId ClusterFind::runQuery(OperationContext* opCtx,
     }
 
     auto const catalogCache = Grid::get(opCtx)->catalogCache();
+    auto& resultCache = ClusterQueryResultCache::get(opCtx);
+    const auto cacheKey = ClusterQueryResultCache::makeFindKey(opCtx, query, readPref);
 
     // Re-target and re-send the initial find command to the shards until we have established the
     // shard version.
@@ -438,8 +475,36 @@ CursorId ClusterFind::runQuery(OperationContext* opCtx,
 
         auto routingInfo = uassertStatusOK(routingInfoStatus);
 
+        // The routing version is captured before running the query, so that results read while
+        // the routing table changes are invalidated by the next lookup.
+        BSONObj routingVersion;
+        if (cacheKey) {
+            routingVersion = ClusterQueryResultCache::makeRoutingVersion(routingInfo);
+            auto cachedResults = resultCache.lookup(
+                *cacheKey, routingVersion, opCtx->getServiceContext()->getFastClockSource()->now());
+            if (cachedResults) {
+                *results = std::move(*cachedResults);
+                CurOp::get(opCtx)->debug().nreturned = results->size();
+                CurOp::get(opCtx)->debug().cursorExhausted = true;
+                if (QueryShapeStats::isEnabled(opCtx)) {
+                    QueryShapeStats::get(opCtx).record(opCtx,
+                                                       QueryShapeStats::Shape(query),
+                                                       makeQueryShapeMetrics(opCtx, *results, 0));
+                }
+                return CursorId(0);
+            }
+        }
+
         try {
-            return runQueryWithoutRetrying(opCtx, query, readPref, routingInfo, results);
+            const auto cursorId =
+                runQueryWithoutRetrying(opCtx, query, readPref, routingInfo, results);
+            if (cacheKey && cursorId == CursorId(0)) {
+                resultCache.insert(*cacheKey,
+                                   routingVersion,
+                                   *results,
+                                   opCtx->getServiceContext()->getFastClockSource()->now());
+            }
+            return cursorId;
         } catch (DBException& ex) {
             if (retries >= kMaxRetries) {
                 // Check if there are no retries remaining, so the last received error can be
@@ -666,6 +731,10 @@ StatusWith<CursorResponse> ClusterFind::runGetMore(OperationContext* opCtx,
         postBatchResumeToken = pinnedCursor.getValue().getPostBatchResumeToken();
     }
 
+    if (QueryShapeStats::isEnabled(opCtx)) {
+        pinnedCursor.getValue().incQueryShapeMetrics(makeQueryShapeMetrics(opCtx, batch, 0));
+    }
+
     pinnedCursor.getValue().setLeftoverMaxTimeMicros(opCtx->getRemainingMaxTimeMicros());
     // Upon successful completion, transfer ownership of the cursor back to the cursor manager. If
     // the cursor has been exhausted, the cursor manager will clean it up for us.
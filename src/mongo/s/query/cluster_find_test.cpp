@@ -34,6 +34,7 @@
 #include "mongo/db/logical_clock.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/query_request.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/s/catalog_cache_test_fixture.h"
 #include "mongo/s/query/cluster_find.h"
 #include "mongo/unittest/unittest.h"
@@ -282,5 +283,22 @@ TEST_F(ClusterFindTest, SnapshotReadConcernWithAfterClusterTime) {
                                   false);
 }
 
+// A find which returns all of its results in its first batch never registers its cursor, so it is
+// recorded in the query shape statistics before the cursor is discarded.
+TEST_F(ClusterFindTest, SingleBatchFindIsRecordedInQueryShapeStats) {
+    loadRoutingTableWithTwoChunksAndTwoShards(kNss);
+    QueryShapeStats::get(getServiceContext()).clear();
+
+    // Target all shards, which return one document each with a closed cursor.
+    runFindCommandSuccessful(kFindCmdScatterGather, false);
+
+    auto stats = QueryShapeStats::get(getServiceContext()).getStats(false);
+    ASSERT_EQ(1U, stats.size());
+    ASSERT_EQ(kNss.ns(), stats[0]["ns"].String());
+    ASSERT_EQ(1, stats[0]["execCount"].numberLong());
+    ASSERT_EQ(2, stats[0]["nReturned"].numberLong());
+    ASSERT_EQ(2, stats[0]["shardsTargeted"].numberLong());
+}
+
 }  // namespace
 }  // namespace mongo
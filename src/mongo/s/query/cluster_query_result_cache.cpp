@@ -0,0 +1,355 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/cluster_query_result_cache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/client/read_preference.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/pipeline/aggregation_request.h"
+#include "mongo/db/pipeline/lite_parsed_pipeline.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/repl/read_concern_args.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/s/catalog_cache.h"
+#include "mongo/s/chunk_manager.h"
+
+namespace mongo {
+
+AtomicInt64 clusterQueryResultCacheSizeBytes(0);
+MONGO_EXPORT_SERVER_PARAMETER(clusterQueryResultCacheMaxStalenessMS, int, 1000);
+
+namespace {
+
+const auto getClusterQueryResultCache =
+    ServiceContext::declareDecoration<ClusterQueryResultCache>();
+
+/**
+ * Releases the cached results when the cache is disabled at runtime. Lowering the size bound
+ * otherwise takes effect at the next insertion.
+ */
+class ExportedClusterQueryResultCacheSizeBytesParameter
+    : public ExportedServerParameter<long long, ServerParameterType::kStartupAndRuntime> {
+    using Base = ExportedServerParameter<long long, ServerParameterType::kStartupAndRuntime>;
+
+public:
+    ExportedClusterQueryResultCacheSizeBytesParameter()
+        : Base(ServerParameterSet::getGlobal(),
+               "clusterQueryResultCacheSizeBytes",
+               &clusterQueryResultCacheSizeBytes) {}
+
+    // Don't hide Base::set(const BSONElement&)
+    using Base::set;
+
+    Status set(const long long& newValue) override {
+        Status status = Base::set(newValue);
+        if (status.isOK() && newValue <= 0 && hasGlobalServiceContext()) {
+            ClusterQueryResultCache::get(getGlobalServiceContext()).clear();
+        }
+        return status;
+    }
+} exportedClusterQueryResultCacheSizeBytesParameter;
+
+// An entry may take at most this fraction of the total cache size.
+const long long kMaxEntrySizeFraction = 16;
+
+// Stages whose output is not a function of the contents of the aggregated collection alone, or
+// which have side effects.
+const StringData kUncacheableStages[] = {"$changeStream"_sd,
+                                         "$collStats"_sd,
+                                         "$currentOp"_sd,
+                                         "$indexStats"_sd,
+                                         "$listLocalSessions"_sd,
+                                         "$listSessions"_sd,
+                                         "$out"_sd,
+                                         "$sample"_sd};
+
+/**
+ * Returns true if the results of reads performed by 'opCtx' may be served from the cache.
+ */
+bool isCacheableOperation(OperationContext* opCtx) {
+    if (clusterQueryResultCacheSizeBytes.load() <= 0 || opCtx->getTxnNumber()) {
+        return false;
+    }
+
+    const auto& readConcernArgs = repl::ReadConcernArgs::get(opCtx);
+    const auto level = readConcernArgs.getLevel();
+    if (level != repl::ReadConcernLevel::kLocalReadConcern &&
+        level != repl::ReadConcernLevel::kAvailableReadConcern) {
+        return false;
+    }
+
+    // Causally consistent reads must observe the client's own writes.
+    return !readConcernArgs.getArgsOpTime() && !readConcernArgs.getArgsAfterClusterTime() &&
+        !readConcernArgs.getArgsAtClusterTime();
+}
+
+/**
+ * Appends the parts of the cache key which depend on the operation rather than on the request.
+ */
+void appendOperationToKey(OperationContext* opCtx,
+                          const ReadPreferenceSetting& readPref,
+                          BSONObjBuilder* keyBuilder) {
+    keyBuilder->append("readPreference", readPref.toInnerBSON());
+    keyBuilder->append("readConcernLevel",
+                       static_cast<int>(repl::ReadConcernArgs::get(opCtx).getLevel()));
+}
+
+/**
+ * Appends to 'keyBuilder' the fields of the serialized command 'cmdObj' which affect its results.
+ */
+void appendCommandToKey(const BSONObj& cmdObj, BSONObjBuilder* keyBuilder) {
+    BSONObjBuilder cmdBuilder(keyBuilder->subobjStart("command"));
+    for (auto&& elem : cmdObj) {
+        const auto fieldName = elem.fieldNameStringData();
+        if (fieldName == QueryRequest::cmdOptionMaxTimeMS || fieldName == "comment"_sd ||
+            fieldName == repl::ReadConcernArgs::kReadConcernFieldName ||
+            fieldName == QueryRequest::kUnwrappedReadPrefField) {
+            continue;
+        }
+        cmdBuilder.append(elem);
+    }
+}
+
+std::string keyToString(const BSONObj& key) {
+    return std::string(key.objdata(), key.objsize());
+}
+
+bool isCacheableStage(const BSONObj& stageSpec) {
+    const StringData stageName = stageSpec.firstElementFieldName();
+    if (std::find(std::begin(kUncacheableStages), std::end(kUncacheableStages), stageName) !=
+        std::end(kUncacheableStages)) {
+        return false;
+    }
+
+    if (stageName != "$facet"_sd) {
+        return true;
+    }
+
+    // Check the sub-pipelines of $facet. Malformed specifications are left for the pipeline parser
+    // to report.
+    const auto facets = stageSpec.firstElement();
+    if (facets.type() != Object) {
+        return false;
+    }
+    for (auto&& facet : facets.Obj()) {
+        if (facet.type() != Array) {
+            return false;
+        }
+        for (auto&& subStage : facet.Obj()) {
+            if (subStage.type() != Object || !isCacheableStage(subStage.Obj())) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+ClusterQueryResultCache::ClusterQueryResultCache()
+    : _entries(std::numeric_limits<std::size_t>::max()) {}
+
+ClusterQueryResultCache& ClusterQueryResultCache::get(ServiceContext* serviceContext) {
+    return getClusterQueryResultCache(serviceContext);
+}
+
+ClusterQueryResultCache& ClusterQueryResultCache::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+boost::optional<std::string> ClusterQueryResultCache::makeFindKey(
+    OperationContext* opCtx, const CanonicalQuery& query, const ReadPreferenceSetting& readPref) {
+    if (!isCacheableOperation(opCtx)) {
+        return boost::none;
+    }
+
+    // Partial results must not be handed out to clients which did not ask for them.
+    const auto& qr = query.getQueryRequest();
+    if (qr.isTailable() || qr.isAllowPartialResults() || qr.isExhaust() || qr.isOplogReplay()) {
+        return boost::none;
+    }
+
+    BSONObjBuilder keyBuilder;
+    keyBuilder.append("find", query.nss().ns());
+    appendCommandToKey(qr.asFindCommand(), &keyBuilder);
+    appendOperationToKey(opCtx, readPref, &keyBuilder);
+    return keyToString(keyBuilder.done());
+}
+
+boost::optional<std::string> ClusterQueryResultCache::makeAggregateKey(
+    OperationContext* opCtx,
+    const NamespaceString& requestedNss,
+    const AggregationRequest& request) {
+    if (!isCacheableOperation(opCtx)) {
+        return boost::none;
+    }
+
+    LiteParsedPipeline litePipe(request);
+
+    // Pipelines which read from more than one namespace are not cached, because the cache only
+    // tracks the routing version of the namespace being aggregated.
+    if (request.getExplain() || request.getNamespaceString().isCollectionlessAggregateNS() ||
+        litePipe.hasChangeStream() || !litePipe.getInvolvedNamespaces().empty()) {
+        return boost::none;
+    }
+
+    for (auto&& stageSpec : request.getPipeline()) {
+        if (!isCacheableStage(stageSpec)) {
+            return boost::none;
+        }
+    }
+
+    BSONObjBuilder keyBuilder;
+    keyBuilder.append("aggregate", requestedNss.ns());
+    keyBuilder.append("executionNs", request.getNamespaceString().ns());
+    appendCommandToKey(request.serializeToCommandObj().toBson(), &keyBuilder);
+    appendOperationToKey(opCtx, ReadPreferenceSetting::get(opCtx), &keyBuilder);
+    return keyToString(keyBuilder.done());
+}
+
+BSONObj ClusterQueryResultCache::makeRoutingVersion(
+    const CachedCollectionRoutingInfo& routingInfo) {
+    BSONObjBuilder builder;
+    if (auto cm = routingInfo.cm()) {
+        cm->getVersion().appendWithField(&builder, "collectionVersion");
+    } else {
+        builder.append("primaryShard", routingInfo.db().primaryId().toString());
+        if (auto dbVersion = routingInfo.db().databaseVersion()) {
+            builder.append("databaseVersion", dbVersion->toBSON());
+        }
+    }
+    return builder.obj();
+}
+
+boost::optional<std::vector<BSONObj>> ClusterQueryResultCache::lookup(
+    const std::string& key, const BSONObj& routingVersion, Date_t now) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        _numMisses.fetchAndAdd(1);
+        return boost::none;
+    }
+
+    if (!it->second.routingVersion.binaryEqual(routingVersion)) {
+        _erase(lk, it);
+        _numStaleVersion.fetchAndAdd(1);
+        _numMisses.fetchAndAdd(1);
+        return boost::none;
+    }
+
+    if (now - it->second.insertedAt >
+        Milliseconds(clusterQueryResultCacheMaxStalenessMS.load())) {
+        _erase(lk, it);
+        _numExpired.fetchAndAdd(1);
+        _numMisses.fetchAndAdd(1);
+        return boost::none;
+    }
+
+    _numHits.fetchAndAdd(1);
+    return it->second.results;
+}
+
+void ClusterQueryResultCache::insert(const std::string& key,
+                                     const BSONObj& routingVersion,
+                                     std::vector<BSONObj> results,
+                                     Date_t now) {
+    long long sizeBytes = key.size() + routingVersion.objsize();
+    for (auto& result : results) {
+        result = result.getOwned();
+        sizeBytes += result.objsize();
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        _erase(lk, it);
+    }
+
+    // Read under the mutex, so that an entry cannot be admitted after the cache was cleared for
+    // being disabled
+    const auto maxSizeBytes = clusterQueryResultCacheSizeBytes.load();
+
+    if (sizeBytes <= maxSizeBytes / kMaxEntrySizeFraction) {
+        _entries.add(key, Entry{routingVersion.getOwned(), std::move(results), now, sizeBytes});
+        _totalSizeBytes += sizeBytes;
+        _numInserted.fetchAndAdd(1);
+    }
+
+    // The size bound may have been lowered since the last insertion.
+    _evictToSize(lk, maxSizeBytes);
+}
+
+void ClusterQueryResultCache::clear() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _entries.clear();
+    _totalSizeBytes = 0;
+}
+
+void ClusterQueryResultCache::report(BSONObjBuilder* builder) const {
+    BSONObjBuilder cacheStatsBuilder(builder->subobjStart("queryResultCache"));
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        cacheStatsBuilder.append("numEntries", static_cast<long long>(_entries.size()));
+        cacheStatsBuilder.append("totalSizeBytes", _totalSizeBytes);
+    }
+
+    cacheStatsBuilder.append("numHits", _numHits.load());
+    cacheStatsBuilder.append("numMisses", _numMisses.load());
+    cacheStatsBuilder.append("numStaleVersion", _numStaleVersion.load());
+    cacheStatsBuilder.append("numExpired", _numExpired.load());
+    cacheStatsBuilder.append("numEvicted", _numEvicted.load());
+    cacheStatsBuilder.append("numInserted", _numInserted.load());
+}
+
+ClusterQueryResultCache::EntryMap::iterator ClusterQueryResultCache::_erase(
+    WithLock, EntryMap::iterator it) {
+    _totalSizeBytes -= it->second.sizeBytes;
+    return _entries.erase(it);
+}
+
+void ClusterQueryResultCache::_evictToSize(WithLock lk, long long maxSizeBytes) {
+    while (_totalSizeBytes > maxSizeBytes && !_entries.empty()) {
+        _erase(lk, std::prev(_entries.end()));
+        _numEvicted.fetchAndAdd(1);
+    }
+}
+
+}  // namespace mongo
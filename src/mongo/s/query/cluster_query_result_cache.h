@@ -0,0 +1,176 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/lru_cache.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class AggregationRequest;
+class BSONObjBuilder;
+class CachedCollectionRoutingInfo;
+class CanonicalQuery;
+class NamespaceString;
+class OperationContext;
+class ServiceContext;
+struct ReadPreferenceSetting;
+
+// Upper bound on the total size in bytes of the results cached by the router. A value of 0 (the
+// default) disables the result cache, and setting it to 0 at runtime removes all cached results.
+extern AtomicInt64 clusterQueryResultCacheSizeBytes;
+
+// Cached results older than this many milliseconds are never returned to clients.
+extern AtomicInt32 clusterQueryResultCacheMaxStalenessMS;
+
+/**
+ * Opt-in cache of the complete result sets of read-only finds and aggregations executed by mongos.
+ *
+ * Only reads whose results fit in the first batch (i.e. which returned a cursor id of 0) are
+ * cached. Each entry remembers the routing table version of the namespace it was read from as of
+ * the start of the operation; a lookup made with a different routing version discards the entry,
+ * so chunk migrations, splits, drops and movePrimary all invalidate dependent results. Writes do
+ * not bump the routing version, which is why entries also expire after
+ * 'clusterQueryResultCacheMaxStalenessMS' and why only operations with readConcern "local" or
+ * "available" outside of transactions may be served from the cache.
+ *
+ * The total size of the cached results is bounded by 'clusterQueryResultCacheSizeBytes'. When the
+ * bound is exceeded, the least recently used entries are evicted.
+ *
+ * This class is thread-safe.
+ */
+class ClusterQueryResultCache {
+    MONGO_DISALLOW_COPYING(ClusterQueryResultCache);
+
+public:
+    ClusterQueryResultCache();
+
+    static ClusterQueryResultCache& get(ServiceContext* serviceContext);
+    static ClusterQueryResultCache& get(OperationContext* opCtx);
+
+    /**
+     * Returns the cache key for the find 'query' if its results may be cached, or boost::none if
+     * caching is disabled or the query or the state of 'opCtx' makes it ineligible.
+     */
+    static boost::optional<std::string> makeFindKey(OperationContext* opCtx,
+                                                    const CanonicalQuery& query,
+                                                    const ReadPreferenceSetting& readPref);
+
+    /**
+     * Returns the cache key for the aggregation 'request' if its results may be cached, or
+     * boost::none if caching is disabled or the pipeline or the state of 'opCtx' makes it
+     * ineligible. 'requestedNss' is the namespace under which the results are reported to the
+     * client, which differs from the request's namespace for aggregations on views.
+     */
+    static boost::optional<std::string> makeAggregateKey(OperationContext* opCtx,
+                                                         const NamespaceString& requestedNss,
+                                                         const AggregationRequest& request);
+
+    /**
+     * Returns an object which identifies the version of 'routingInfo'. Two objects compare
+     * binary-equal if and only if no routing change happened between the two snapshots.
+     */
+    static BSONObj makeRoutingVersion(const CachedCollectionRoutingInfo& routingInfo);
+
+    /**
+     * Returns the results cached under 'key', provided they were read at 'routingVersion' and are
+     * not older than the staleness bound as of 'now'. Entries which fail either check are removed.
+     */
+    boost::optional<std::vector<BSONObj>> lookup(const std::string& key,
+                                                 const BSONObj& routingVersion,
+                                                 Date_t now);
+
+    /**
+     * Caches 'results' under 'key', replacing any previous entry. Results which would take more
+     * than a small fraction of the cache are not admitted, so that a single large query cannot
+     * flush the whole cache.
+     */
+    void insert(const std::string& key,
+                const BSONObj& routingVersion,
+                std::vector<BSONObj> results,
+                Date_t now);
+
+    /**
+     * Removes all entries from the cache.
+     */
+    void clear();
+
+    /**
+     * Appends the cache's statistics to 'builder' as a "queryResultCache" sub-object.
+     */
+    void report(BSONObjBuilder* builder) const;
+
+private:
+    struct Entry {
+        BSONObj routingVersion;
+        std::vector<BSONObj> results;
+        Date_t insertedAt;
+        long long sizeBytes;
+    };
+
+    using EntryMap = LRUCache<std::string, Entry>;
+
+    /**
+     * Removes the entry pointed to by 'it' and returns the next least recently used one.
+     */
+    EntryMap::iterator _erase(WithLock, EntryMap::iterator it);
+
+    /**
+     * Evicts least recently used entries until the cache holds at most 'maxSizeBytes' bytes.
+     */
+    void _evictToSize(WithLock, long long maxSizeBytes);
+
+    mutable stdx::mutex _mutex;
+
+    EntryMap _entries;
+
+    // Sum of the 'sizeBytes' of all entries in '_entries'
+    long long _totalSizeBytes{0};
+
+    AtomicInt64 _numHits{0};
+    AtomicInt64 _numMisses{0};
+    AtomicInt64 _numStaleVersion{0};
+    AtomicInt64 _numExpired{0};
+    AtomicInt64 _numEvicted{0};
+    AtomicInt64 _numInserted{0};
+};
+
+}  // namespace mongo
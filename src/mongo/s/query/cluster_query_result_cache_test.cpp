@@ -0,0 +1,224 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/cluster_query_result_cache.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/client/read_preference.h"
+#include "mongo/db/pipeline/aggregation_request.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/db/repl/read_concern_args.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test", "coll");
+
+const BSONObj kRoutingVersion = BSON("collectionVersion" << 1);
+const BSONObj kNewRoutingVersion = BSON("collectionVersion" << 2);
+
+class ClusterQueryResultCacheTest : public unittest::Test {
+protected:
+    void setUp() override {
+        _originalSizeBytes = clusterQueryResultCacheSizeBytes.load();
+        _originalMaxStalenessMS = clusterQueryResultCacheMaxStalenessMS.load();
+        clusterQueryResultCacheSizeBytes.store(16 * 1024 * 1024);
+        clusterQueryResultCacheMaxStalenessMS.store(1000);
+
+        _opCtx = _serviceContext.makeOperationContext();
+    }
+
+    void tearDown() override {
+        clusterQueryResultCacheSizeBytes.store(_originalSizeBytes);
+        clusterQueryResultCacheMaxStalenessMS.store(_originalMaxStalenessMS);
+    }
+
+    boost::optional<std::string> makeFindKey(const BSONObj& findCmd) {
+        auto qr = uassertStatusOK(QueryRequest::makeFromFindCommand(kNss, findCmd, false));
+        auto cq = uassertStatusOK(CanonicalQuery::canonicalize(_opCtx.get(), std::move(qr)));
+        return ClusterQueryResultCache::makeFindKey(
+            _opCtx.get(), *cq, ReadPreferenceSetting(ReadPreference::PrimaryOnly));
+    }
+
+    boost::optional<std::string> makeAggregateKey(const BSONObj& aggCmd) {
+        auto request = uassertStatusOK(AggregationRequest::parseFromBSON(kNss, aggCmd));
+        return ClusterQueryResultCache::makeAggregateKey(_opCtx.get(), kNss, request);
+    }
+
+    long long numEntries() {
+        BSONObjBuilder builder;
+        _cache.report(&builder);
+        return builder.obj()["queryResultCache"]["numEntries"].numberLong();
+    }
+
+    ClusterQueryResultCache _cache;
+
+    QueryTestServiceContext _serviceContext;
+    ServiceContext::UniqueOperationContext _opCtx;
+
+    const Date_t _now = Date_t::fromMillisSinceEpoch(100000);
+
+private:
+    long long _originalSizeBytes;
+    int _originalMaxStalenessMS;
+};
+
+TEST_F(ClusterQueryResultCacheTest, LookupReturnsInsertedResults) {
+    _cache.insert("key", kRoutingVersion, {BSON("_id" << 1), BSON("_id" << 2)}, _now);
+
+    auto results = _cache.lookup("key", kRoutingVersion, _now + Milliseconds(10));
+    ASSERT(results);
+    ASSERT_EQ(2U, results->size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1), results->at(0));
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2), results->at(1));
+
+    ASSERT(!_cache.lookup("otherKey", kRoutingVersion, _now));
+}
+
+TEST_F(ClusterQueryResultCacheTest, RoutingVersionChangeInvalidatesEntry) {
+    _cache.insert("key", kRoutingVersion, {BSON("_id" << 1)}, _now);
+
+    ASSERT(!_cache.lookup("key", kNewRoutingVersion, _now));
+    ASSERT_EQ(0, numEntries());
+
+    // The entry is gone even for lookups at the original routing version.
+    ASSERT(!_cache.lookup("key", kRoutingVersion, _now));
+}
+
+TEST_F(ClusterQueryResultCacheTest, EntriesExpireAfterMaxStaleness) {
+    _cache.insert("key", kRoutingVersion, {BSON("_id" << 1)}, _now);
+
+    ASSERT(_cache.lookup("key", kRoutingVersion, _now + Milliseconds(1000)));
+    ASSERT(!_cache.lookup("key", kRoutingVersion, _now + Milliseconds(1001)));
+    ASSERT_EQ(0, numEntries());
+}
+
+TEST_F(ClusterQueryResultCacheTest, LeastRecentlyUsedEntriesAreEvicted) {
+    clusterQueryResultCacheSizeBytes.store(16 * 1024);
+
+    // Each entry takes a little less than 1KB, so only some of them fit.
+    const std::string filler(900, 'x');
+    const auto doc = BSON("filler" << filler);
+    const int numInserted = 32;
+
+    _cache.insert("0", kRoutingVersion, {doc}, _now);
+    for (int i = 1; i < numInserted; ++i) {
+        _cache.insert(std::to_string(i), kRoutingVersion, {doc}, _now);
+
+        // Keep the first entry recently used.
+        ASSERT(_cache.lookup("0", kRoutingVersion, _now));
+    }
+
+    ASSERT_LT(numEntries(), numInserted);
+    ASSERT(_cache.lookup("0", kRoutingVersion, _now));
+    ASSERT(!_cache.lookup("1", kRoutingVersion, _now));
+    ASSERT(_cache.lookup(std::to_string(numInserted - 1), kRoutingVersion, _now));
+
+    BSONObjBuilder builder;
+    _cache.report(&builder);
+    ASSERT_LTE(builder.obj()["queryResultCache"]["totalSizeBytes"].numberLong(), 16 * 1024);
+}
+
+TEST_F(ClusterQueryResultCacheTest, OversizedResultsAreNotCached) {
+    clusterQueryResultCacheSizeBytes.store(16 * 1024);
+
+    const std::string filler(2 * 1024, 'x');
+    _cache.insert("key", kRoutingVersion, {BSON("filler" << filler)}, _now);
+    ASSERT_EQ(0, numEntries());
+    ASSERT(!_cache.lookup("key", kRoutingVersion, _now));
+}
+
+TEST_F(ClusterQueryResultCacheTest, FindKeyDependsOnQueryButNotOnComment) {
+    auto key = makeFindKey(BSON("find" << kNss.coll() << "filter" << BSON("a" << 1)));
+    ASSERT(key);
+
+    ASSERT_EQ(*key,
+              *makeFindKey(BSON("find" << kNss.coll() << "filter" << BSON("a" << 1) << "comment"
+                                       << "dashboard"
+                                       << "maxTimeMS"
+                                       << 100)));
+    ASSERT_NE(*key, *makeFindKey(BSON("find" << kNss.coll() << "filter" << BSON("a" << 2))));
+    ASSERT_NE(*key,
+              *makeFindKey(BSON("find" << kNss.coll() << "filter" << BSON("a" << 1) << "limit"
+                                       << 1)));
+}
+
+TEST_F(ClusterQueryResultCacheTest, NothingIsCachedWhenDisabled) {
+    clusterQueryResultCacheSizeBytes.store(0);
+    ASSERT(!makeFindKey(BSON("find" << kNss.coll())));
+    ASSERT(!makeAggregateKey(BSON("aggregate" << kNss.coll() << "pipeline" << BSONArray()
+                                              << "cursor"
+                                              << BSONObj())));
+}
+
+TEST_F(ClusterQueryResultCacheTest, ReadsWhichMustObserveRecentWritesAreNotCached) {
+    repl::ReadConcernArgs::get(_opCtx.get()) =
+        repl::ReadConcernArgs(repl::ReadConcernLevel::kMajorityReadConcern);
+    ASSERT(!makeFindKey(BSON("find" << kNss.coll())));
+
+    repl::ReadConcernArgs::get(_opCtx.get()) =
+        repl::ReadConcernArgs(repl::ReadConcernLevel::kLocalReadConcern);
+    ASSERT(makeFindKey(BSON("find" << kNss.coll())));
+}
+
+TEST_F(ClusterQueryResultCacheTest, TailableAndPartialFindsAreNotCached) {
+    ASSERT(!makeFindKey(BSON("find" << kNss.coll() << "tailable" << true)));
+    ASSERT(!makeFindKey(BSON("find" << kNss.coll() << "allowPartialResults" << true)));
+}
+
+TEST_F(ClusterQueryResultCacheTest, NonDeterministicPipelinesAreNotCached) {
+    ASSERT(makeAggregateKey(BSON("aggregate" << kNss.coll() << "pipeline"
+                                             << BSON_ARRAY(BSON("$match" << BSON("a" << 1)))
+                                             << "cursor"
+                                             << BSONObj())));
+    ASSERT(!makeAggregateKey(BSON("aggregate" << kNss.coll() << "pipeline"
+                                              << BSON_ARRAY(BSON("$sample" << BSON("size" << 1)))
+                                              << "cursor"
+                                              << BSONObj())));
+    const auto facetSpec =
+        BSON("$facet" << BSON("sampled" << BSON_ARRAY(BSON("$sample" << BSON("size" << 1)))));
+    ASSERT(!makeAggregateKey(BSON("aggregate" << kNss.coll() << "pipeline" << BSON_ARRAY(facetSpec)
+                                              << "cursor"
+                                              << BSONObj())));
+    ASSERT(!makeAggregateKey(
+        BSON("aggregate" << kNss.coll() << "pipeline"
+                         << BSON_ARRAY(BSON("$out"
+                                            << "other"))
+                         << "cursor"
+                         << BSONObj())));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,232 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/routing_table_change_listener.h"
+
+#include <vector>
+
+#include "mongo/client/connpool.h"
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/client.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/db/repl/read_concern_args.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/catalog/type_collection.h"
+#include "mongo/s/catalog_cache.h"
+#include "mongo/s/client/shard_registry.h"
+#include "mongo/s/grid.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(routingTableChangeListenerEnabled, bool, false);
+
+// How long to wait before reopening the oplog cursor after an error
+const Seconds kRetryInterval(1);
+
+// Socket timeout for the connection to the config server, which must outlast an awaitData getMore
+const double kSocketTimeoutSecs = 30;
+
+/**
+ * Waits until 'opTime' is majority committed on the config server behind 'conn'. The oplog is read
+ * with a plain tailable cursor, so its entries may still be rolled back until then.
+ */
+void waitUntilMajorityCommitted(DBClientBase* conn, const repl::OpTime& opTime) {
+    BSONObjBuilder cmdBuilder;
+    cmdBuilder.append("find", "version");
+    cmdBuilder.append("limit", 1);
+    repl::ReadConcernArgs(opTime, repl::ReadConcernLevel::kMajorityReadConcern)
+        .appendInfo(&cmdBuilder);
+
+    BSONObj result;
+    conn->runCommand("config", cmdBuilder.obj(), result);
+    uassertStatusOK(getStatusFromCommandResult(result));
+}
+
+/**
+ * Tails the config server's oplog from after 'lastSeen', or from its newest entry if 'lastSeen' is
+ * not set, and reports the routing table changes found in it to the catalog cache. Returns when
+ * the cursor dies or the server shuts down and throws on errors. Keeps 'lastSeen' at the optime of
+ * the last entry processed, so that a new cursor can take over where this one stopped.
+ */
+void tailRoutingTableChanges(boost::optional<repl::OpTime>* lastSeen) {
+    auto opCtx = cc().makeOperationContext();
+    auto const grid = Grid::get(opCtx.get());
+
+    ScopedDbConnection conn(grid->shardRegistry()->getConfigServerConnectionString(),
+                            kSocketTimeoutSecs);
+    ON_BLOCK_EXIT([&conn] { conn.kill(); });
+
+    if (!*lastSeen) {
+        const BSONObj newest = conn->findOne(NamespaceString::kRsOplogNamespace.ns(),
+                                             Query().sort(BSON("$natural" << -1)));
+        *lastSeen = uassertStatusOK(repl::OpTime::parseFromOplogEntry(newest));
+    }
+
+    const BSONArray watchedNamespaces =
+        BSON_ARRAY(ChunkType::ConfigNS.ns() << CollectionType::ConfigNS.ns());
+    const BSONObj filter =
+        BSON("ts" << BSON("$gt" << (*lastSeen)->getTimestamp()) << "$or"
+                  << BSON_ARRAY(BSON("ns" << BSON("$in" << watchedNamespaces))
+                                << BSON("op"
+                                        << "c"
+                                        << "o.applyOps.ns"
+                                        << BSON("$in" << watchedNamespaces))));
+
+    auto cursor = conn->query(NamespaceString::kRsOplogNamespace.ns(),
+                              Query(filter),
+                              0,
+                              0,
+                              nullptr,
+                              QueryOption_CursorTailable | QueryOption_OplogReplay |
+                                  QueryOption_AwaitData);
+    uassert(ErrorCodes::HostUnreachable, "could not query the config server's oplog", cursor);
+
+    while (!globalInShutdownDeprecated()) {
+        if (!cursor->more()) {
+            if (cursor->isDead()) {
+                return;
+            }
+            continue;
+        }
+
+        // Take in the whole batch first, so that a collection written by several of its entries
+        // is refreshed once
+        std::vector<RoutingTableChange> changes;
+        while (cursor->moreInCurrentBatch()) {
+            const BSONObj entry = cursor->nextSafe();
+            *lastSeen = uassertStatusOK(repl::OpTime::parseFromOplogEntry(entry));
+            extractRoutingTableChanges(entry, &changes);
+        }
+
+        if (changes.empty()) {
+            continue;
+        }
+
+        // Only report changes which cannot be rolled back. The config optime is not advanced to
+        // the entries read here: it is gossiped to the shards and must only ever move to optimes
+        // which the config server reported as majority committed. A refresh which reads from a
+        // config server node that has not caught up yet is completed later through
+        // StaleShardVersion, as it would be without the listener.
+        waitUntilMajorityCommitted(conn.get(), **lastSeen);
+
+        for (const auto& change : changes) {
+            LOG(1) << "Config server reported a change to the routing table of " << change.nss
+                   << (change.version ? " at version " + change.version->toString() : "");
+            grid->catalogCache()->onRoutingTableChange(change.nss, change.version);
+        }
+    }
+}
+
+}  // namespace
+
+void extractRoutingTableChanges(const BSONObj& entry, std::vector<RoutingTableChange>* changes) {
+    const auto op = entry["op"].str();
+    const auto ns = entry["ns"].str();
+    const BSONElement o = entry["o"];
+    if (o.type() != Object) {
+        return;
+    }
+
+    if (op == "c") {
+        const BSONElement applyOps = o.Obj()["applyOps"];
+        if (applyOps.type() == Array) {
+            for (const auto& innerEntry : applyOps.Obj()) {
+                if (innerEntry.type() == Object) {
+                    extractRoutingTableChanges(innerEntry.Obj(), changes);
+                }
+            }
+        }
+        return;
+    }
+
+    if (ns == ChunkType::ConfigNS.ns()) {
+        // Deletes carry only the chunk's _id. Whatever deletes a chunk also writes the chunks
+        // which replace it, or drops the collection, so they need not be looked at.
+        auto swChunk = ChunkType::fromConfigBSON(o.Obj());
+        if (swChunk.isOK()) {
+            changes->push_back({swChunk.getValue().getNS(), swChunk.getValue().getVersion()});
+        }
+        return;
+    }
+
+    if (ns == CollectionType::ConfigNS.ns()) {
+        const BSONElement id = (op == "u" ? entry["o2"].Obj() : o.Obj())["_id"];
+        if (id.type() == String) {
+            changes->push_back({NamespaceString(id.String()), boost::none});
+        }
+    }
+}
+
+RoutingTableChangeListener::RoutingTableChangeListener() = default;
+
+RoutingTableChangeListener::~RoutingTableChangeListener() {
+    // The thread must not be running when this object is destroyed
+    invariant(!_thread.joinable());
+}
+
+void RoutingTableChangeListener::startThread() {
+    invariant(!_thread.joinable());
+
+    if (!routingTableChangeListenerEnabled) {
+        return;
+    }
+
+    _thread = stdx::thread([] {
+        Client::initThread("RoutingTableChangeListener");
+
+        boost::optional<repl::OpTime> lastSeen;
+
+        while (!globalInShutdownDeprecated()) {
+            try {
+                tailRoutingTableChanges(&lastSeen);
+            } catch (const DBException& ex) {
+                warning() << "Error while tailing the config server for routing table changes"
+                          << causedBy(redact(ex.toStatus()));
+            }
+
+            MONGO_IDLE_THREAD_BLOCK;
+            sleepFor(kRetryInterval);
+        }
+    });
+}
+
+}  // namespace mongo
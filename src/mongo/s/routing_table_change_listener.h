@@ -0,0 +1,92 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/s/chunk_version.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+/**
+ * A write to the routing table of a collection, found in the config server's oplog.
+ */
+struct RoutingTableChange {
+    NamespaceString nss;
+
+    // The version written by the change, if it is a write of a whole chunk
+    boost::optional<ChunkVersion> version;
+};
+
+/**
+ * Appends to 'changes' the collections whose routing tables are written by the config server oplog
+ * entry 'entry', looking into applyOps, through which splits, merges and migrations are committed.
+ */
+void extractRoutingTableChanges(const BSONObj& entry, std::vector<RoutingTableChange>* changes);
+
+/**
+ * Keeps the routing tables cached by this router up to date as the config server changes them,
+ * rather than waiting for a shard to reject a request with StaleShardVersion. A background thread
+ * tails the config server's oplog for writes to config.chunks and config.collections, including
+ * those made through applyOps, and tells the catalog cache which collections changed and to which
+ * version, so that it can refresh them incrementally ahead of the next request. Changes are only
+ * reported once they are majority committed on the config server.
+ *
+ * This is only an optimization: changes missed while the cursor is being reopened after an error
+ * are still found through StaleShardVersion, as they would be without the listener. It is off by
+ * default.
+ *
+ * NOTE: Not thread-safe, so it should not be used from more than one thread at a time.
+ */
+class RoutingTableChangeListener {
+    MONGO_DISALLOW_COPYING(RoutingTableChangeListener);
+
+public:
+    RoutingTableChangeListener();
+    ~RoutingTableChangeListener();
+
+    /**
+     * Starts the thread which tails the config server's oplog, unless disabled through the
+     * routingTableChangeListenerEnabled startup parameter. The thread runs until shutdown.
+     */
+    void startThread();
+
+private:
+    // The background tailing thread (if started)
+    stdx::thread _thread;
+};
+
+}  // namespace mongo
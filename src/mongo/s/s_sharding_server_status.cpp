@@ -36,6 +36,7 @@
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/query/cluster_query_result_cache.h"
 
 namespace mongo {
 namespace {
@@ -84,6 +85,7 @@ public:
 
         BSONObjBuilder result;
         catalogCache->report(&result);
+        ClusterQueryResultCache::get(opCtx).report(&result);
         return result.obj();
     }
 
@@ -125,7 +125,7 @@ ShardingTestFixture::ShardingTestFixture() {
 
     auto netForPool = stdx::make_unique<executor::NetworkInterfaceMock>();
     netForPool->setEgressMetadataHook(makeMetadataHookList());
-    auto _mockNetworkForPool = netForPool.get();
+    _mockNetworkForPool = netForPool.get();
     auto execForPool = makeShardingTestExecutor(std::move(netForPool));
     _networkTestEnvForPool =
         stdx::make_unique<NetworkTestEnv>(execForPool.get(), _mockNetworkForPool);
@@ -260,6 +260,11 @@ void ShardingTestFixture::onCommandForPoolExecutor(NetworkTestEnv::OnCommandFunc
     _networkTestEnvForPool->onCommand(func);
 }
 
+executor::NetworkInterfaceMock* ShardingTestFixture::networkForPool() const {
+    invariant(_mockNetworkForPool);
+    return _mockNetworkForPool;
+}
+
 void ShardingTestFixture::addRemoteShards(
     const std::vector<std::tuple<ShardId, HostAndPort>>& shardInfos) {
     std::vector<ShardType> shards;
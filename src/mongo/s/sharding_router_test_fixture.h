@@ -86,6 +86,12 @@ public:
      */
     void onCommandForPoolExecutor(executor::NetworkTestEnv::OnCommandFunction func);
 
+    /**
+     * Returns the NetworkInterface of the arbitrary executor of the Grid's executorPool, for tests
+     * which need to answer its requests out of order.
+     */
+    executor::NetworkInterfaceMock* networkForPool() const;
+
     /**
      * Setup the shard registry to contain the given shards until the next reload.
      */
@@ -195,6 +201,7 @@ private:
     executor::TaskExecutor* _executor;
 
     // For the Grid's arbitrary executor in its executorPool.
+    executor::NetworkInterfaceMock* _mockNetworkForPool = nullptr;
     std::unique_ptr<executor::NetworkTestEnv> _networkTestEnvForPool;
 
     DistLockManagerMock* _distLockManager = nullptr;
@@ -34,12 +34,16 @@
 
 #include "mongo/s/write_ops/batch_write_exec.h"
 
+#include <deque>
+#include <memory>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/task_executor_pool.h"
 #include "mongo/s/async_requests_sender.h"
 #include "mongo/s/client/shard_registry.h"
@@ -49,6 +53,18 @@
 #include "mongo/util/log.h"
 
 namespace mongo {
+
+// How many child batches of an unordered batch write may be outstanding on one shard at a time. If
+// zero, unordered batch writes are executed in rounds, as ordered ones are.
+MONGO_EXPORT_SERVER_PARAMETER(maxInFlightWriteBatchesPerShard, int, 2)
+    ->withValidator([](const int& newVal) {
+        if (newVal >= 0) {
+            return Status::OK();
+        }
+        return Status(ErrorCodes::BadValue,
+                      "maxInFlightWriteBatchesPerShard must be greater than or equal to 0");
+    });
+
 namespace {
 
 const ReadPreferenceSetting kPrimaryOnlyReadPreference(ReadPreference::PrimaryOnly);
@@ -81,27 +97,145 @@ void noteStaleResponses(const std::vector<ShardError>& staleErrors, NSTargeter*
 // applies when no writes are occurring and metadata is not changing on reload.
 const int kMaxRoundsWithoutProgress(5);
 
-}  // namespace
+WriteErrorDetail noProgressError(const BatchedCommandRequest& clientRequest,
+                                 int numCompletedOps,
+                                 int rounds) {
+    return errorFromStatus({ErrorCodes::NoProgressMade,
+                            str::stream() << "no progress was made executing batch write op in "
+                                          << clientRequest.getNS().ns()
+                                          << " after "
+                                          << kMaxRoundsWithoutProgress
+                                          << " rounds ("
+                                          << numCompletedOps
+                                          << " ops completed in "
+                                          << rounds
+                                          << " rounds total)"});
+}
 
-void BatchWriteExec::executeBatch(OperationContext* opCtx,
-                                  NSTargeter& targeter,
-                                  const BatchedCommandRequest& clientRequest,
-                                  BatchedCommandResponse* clientResponse,
-                                  BatchWriteExecStats* stats) {
-    const auto& nss(clientRequest.getNS());
+/**
+ * Builds the command which sends 'batch' to its shard.
+ */
+BSONObj buildShardBatchCommand(OperationContext* opCtx,
+                               const BatchWriteOp& batchOp,
+                               const TargetedWriteBatch& batch) {
+    const auto shardBatchRequest(batchOp.buildBatchRequest(batch));
 
-    LOG(4) << "Starting execution of write batch of size "
-           << static_cast<int>(clientRequest.sizeWriteOps()) << " for " << nss.ns();
+    BSONObjBuilder requestBuilder;
+    shardBatchRequest.serialize(&requestBuilder);
 
-    BatchWriteOp batchOp(opCtx, clientRequest);
+    {
+        OperationSessionInfo sessionInfo;
+
+        if (opCtx->getLogicalSessionId()) {
+            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
+        }
+
+        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
+        sessionInfo.serialize(&requestBuilder);
+    }
+
+    return requestBuilder.obj();
+}
+
+/**
+ * Notes in 'batchOp' the response or error received for the child batch 'batch', and in the
+ * targeter whatever it reports as stale.
+ */
+void noteShardBatchResponse(const AsyncRequestsSender::Response& response,
+                            const TargetedWriteBatch& batch,
+                            BatchWriteOp* batchOp,
+                            NSTargeter* targeter,
+                            BatchWriteExecStats* stats) {
+    // First check if we were able to target a shard host.
+    if (!response.shardHostAndPort) {
+        invariant(!response.swResponse.isOK());
+
+        // Record a resolve failure
+        batchOp->noteBatchError(batch, errorFromStatus(response.swResponse.getStatus()));
+
+        // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel and
+        // retarget the batch
+        LOG(4) << "Unable to send write batch to " << batch.getEndpoint().shardName
+               << causedBy(response.swResponse.getStatus());
+        return;
+    }
+
+    const auto& shardHost = *response.shardHostAndPort;
+
+    // Then check if we successfully got a response.
+    Status responseStatus = response.swResponse.getStatus();
+    BatchedCommandResponse batchedCommandResponse;
+    if (responseStatus.isOK()) {
+        std::string errMsg;
+        if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data, &errMsg) ||
+            !batchedCommandResponse.isValid(&errMsg)) {
+            responseStatus = {ErrorCodes::FailedToParse, errMsg};
+        }
+    }
+
+    if (responseStatus.isOK()) {
+        TrackedErrors trackedErrors;
+        trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
+        trackedErrors.startTracking(ErrorCodes::CannotImplicitlyCreateCollection);
 
+        LOG(4) << "Write results received from " << shardHost.toString() << ": "
+               << redact(batchedCommandResponse.toString());
+
+        // Dispatch was ok, note response
+        batchOp->noteBatchResponse(batch, batchedCommandResponse, &trackedErrors);
+
+        // Note if anything was stale
+        const auto& staleErrors = trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
+        if (!staleErrors.empty()) {
+            noteStaleResponses(staleErrors, targeter);
+            ++stats->numStaleBatches;
+        }
+
+        const auto& cannotImplicitlyCreateErrors =
+            trackedErrors.getErrors(ErrorCodes::CannotImplicitlyCreateCollection);
+        if (!cannotImplicitlyCreateErrors.empty()) {
+            // This forces the chunk manager to reload so we can attach the correct version on
+            // retry and make sure we route to the correct shard.
+            targeter->noteCouldNotTarget();
+        }
+
+        // Remember that we successfully wrote to this shard
+        // NOTE: This will record lastOps for shards where we actually didn't update or delete
+        // any documents, which preserves old behavior but is conservative
+        stats->noteWriteAt(shardHost,
+                           batchedCommandResponse.isLastOpSet() ? batchedCommandResponse.getLastOp()
+                                                                : repl::OpTime(),
+                           batchedCommandResponse.isElectionIdSet()
+                               ? batchedCommandResponse.getElectionId()
+                               : OID());
+    } else {
+        // Error occurred dispatching, note it
+        const Status status = responseStatus.withContext(str::stream()
+                                                         << "Write results unavailable from "
+                                                         << shardHost);
+
+        batchOp->noteBatchError(batch, errorFromStatus(status));
+
+        LOG(4) << "Unable to receive write results from " << shardHost << causedBy(redact(status));
+    }
+}
+
+/**
+ * Executes a batch write in rounds: each round targets as many of the remaining writes as fit in
+ * one child batch per shard, sends them all and waits for all the responses before the next round.
+ */
+void executeBatchInRounds(OperationContext* opCtx,
+                          NSTargeter& targeter,
+                          const BatchedCommandRequest& clientRequest,
+                          BatchWriteOp* batchOp,
+                          BatchWriteExecStats* stats) {
     // Current batch status
     bool refreshedTargeter = false;
     int rounds = 0;
     int numCompletedOps = 0;
     int numRoundsWithoutProgress = 0;
 
-    while (!batchOp.isFinished()) {
+    while (!batchOp->isFinished()) {
         //
         // Get child batches to send using the targeter
         //
@@ -132,7 +266,7 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
         // If we've already had a targeting error, we've refreshed the metadata once and can
         // record target errors definitively.
         bool recordTargetErrors = refreshedTargeter;
-        Status targetStatus = batchOp.targetBatch(targeter, recordTargetErrors, &childBatches);
+        Status targetStatus = batchOp->targetBatch(targeter, recordTargetErrors, &childBatches);
         if (!targetStatus.isOK()) {
             // Don't do anything until a targeter refresh
             targeter.noteCouldNotTarget();
@@ -175,25 +309,7 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
 
                 stats->noteTargetedShard(targetShardId);
 
-                const auto request = [&] {
-                    const auto shardBatchRequest(batchOp.buildBatchRequest(*nextBatch));
-
-                    BSONObjBuilder requestBuilder;
-                    shardBatchRequest.serialize(&requestBuilder);
-
-                    {
-                        OperationSessionInfo sessionInfo;
-
-                        if (opCtx->getLogicalSessionId()) {
-                            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
-                        }
-
-                        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
-                        sessionInfo.serialize(&requestBuilder);
-                    }
-
-                    return requestBuilder.obj();
-                }();
+                const auto request = buildShardBatchCommand(opCtx, *batchOp, *nextBatch);
 
                 LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
 
@@ -229,88 +345,7 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
                 dassert(pendingBatches.find(response.shardId) != pendingBatches.end());
                 TargetedWriteBatch* batch = pendingBatches.find(response.shardId)->second;
 
-                // First check if we were able to target a shard host.
-                if (!response.shardHostAndPort) {
-                    invariant(!response.swResponse.isOK());
-
-                    // Record a resolve failure
-                    batchOp.noteBatchError(*batch,
-                                           errorFromStatus(response.swResponse.getStatus()));
-
-                    // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel
-                    // and retarget the batch
-                    LOG(4) << "Unable to send write batch to " << batch->getEndpoint().shardName
-                           << causedBy(response.swResponse.getStatus());
-
-                    // We're done with this batch. Clean up when we can't resolve a host.
-                    auto it = childBatches.find(batch->getEndpoint().shardName);
-                    invariant(it != childBatches.end());
-                    delete it->second;
-                    it->second = nullptr;
-                    continue;
-                }
-
-                const auto shardHost(std::move(*response.shardHostAndPort));
-
-                // Then check if we successfully got a response.
-                Status responseStatus = response.swResponse.getStatus();
-                BatchedCommandResponse batchedCommandResponse;
-                if (responseStatus.isOK()) {
-                    std::string errMsg;
-                    if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data,
-                                                          &errMsg) ||
-                        !batchedCommandResponse.isValid(&errMsg)) {
-                        responseStatus = {ErrorCodes::FailedToParse, errMsg};
-                    }
-                }
-
-                if (responseStatus.isOK()) {
-                    TrackedErrors trackedErrors;
-                    trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
-                    trackedErrors.startTracking(ErrorCodes::CannotImplicitlyCreateCollection);
-
-                    LOG(4) << "Write results received from " << shardHost.toString() << ": "
-                           << redact(batchedCommandResponse.toString());
-
-                    // Dispatch was ok, note response
-                    batchOp.noteBatchResponse(*batch, batchedCommandResponse, &trackedErrors);
-
-                    // Note if anything was stale
-                    const auto& staleErrors =
-                        trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
-                    if (!staleErrors.empty()) {
-                        noteStaleResponses(staleErrors, &targeter);
-                        ++stats->numStaleBatches;
-                    }
-
-                    const auto& cannotImplicitlyCreateErrors =
-                        trackedErrors.getErrors(ErrorCodes::CannotImplicitlyCreateCollection);
-                    if (!cannotImplicitlyCreateErrors.empty()) {
-                        // This forces the chunk manager to reload so we can attach the correct
-                        // version on retry and make sure we route to the correct shard.
-                        targeter.noteCouldNotTarget();
-                    }
-
-                    // Remember that we successfully wrote to this shard
-                    // NOTE: This will record lastOps for shards where we actually didn't update
-                    // or delete any documents, which preserves old behavior but is conservative
-                    stats->noteWriteAt(shardHost,
-                                       batchedCommandResponse.isLastOpSet()
-                                           ? batchedCommandResponse.getLastOp()
-                                           : repl::OpTime(),
-                                       batchedCommandResponse.isElectionIdSet()
-                                           ? batchedCommandResponse.getElectionId()
-                                           : OID());
-                } else {
-                    // Error occurred dispatching, note it
-                    const Status status = responseStatus.withContext(
-                        str::stream() << "Write results unavailable from " << shardHost);
-
-                    batchOp.noteBatchError(*batch, errorFromStatus(status));
-
-                    LOG(4) << "Unable to receive write results from " << shardHost
-                           << causedBy(redact(status));
-                }
+                noteShardBatchResponse(response, *batch, batchOp, &targeter, stats);
             }
         }
 
@@ -318,7 +353,7 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
         ++stats->numRounds;
 
         // If we're done, get out
-        if (batchOp.isFinished())
+        if (batchOp->isFinished())
             break;
 
         // MORE WORK TO DO
@@ -340,7 +375,7 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
         // Ensure progress is being made toward completing the batch op
         //
 
-        int currCompletedOps = batchOp.numWriteOpsIn(WriteOpState_Completed);
+        int currCompletedOps = batchOp->numWriteOpsIn(WriteOpState_Completed);
         if (currCompletedOps == numCompletedOps && !targeterChanged) {
             ++numRoundsWithoutProgress;
         } else {
@@ -349,20 +384,174 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
         numCompletedOps = currCompletedOps;
 
         if (numRoundsWithoutProgress > kMaxRoundsWithoutProgress) {
-            batchOp.abortBatch(errorFromStatus(
-                {ErrorCodes::NoProgressMade,
-                 str::stream() << "no progress was made executing batch write op in "
-                               << clientRequest.getNS().ns()
-                               << " after "
-                               << kMaxRoundsWithoutProgress
-                               << " rounds ("
-                               << numCompletedOps
-                               << " ops completed in "
-                               << rounds
-                               << " rounds total)"}));
+            batchOp->abortBatch(noProgressError(clientRequest, numCompletedOps, rounds));
             break;
         }
     }
+}
+
+/**
+ * Executes an unordered batch write without rounds. All the ready writes are targeted at once and
+ * their child batches queued per shard. Up to maxInFlightWriteBatchesPerShard child batches are
+ * outstanding on each shard, and the next one is sent as soon as a response comes back from that
+ * shard, so a slow shard delays only the writes which go to it.
+ *
+ * Writes which have to be retargeted, for example after a stale version error, are targeted again
+ * once everything targeted before them has been sent. Whether progress is being made is judged,
+ * as in rounds, whenever that happens with no child batch outstanding.
+ */
+void executeBatchPipelined(OperationContext* opCtx,
+                           NSTargeter& targeter,
+                           const BatchedCommandRequest& clientRequest,
+                           BatchWriteOp* batchOp,
+                           BatchWriteExecStats* stats) {
+    const size_t maxInFlightPerShard = maxInFlightWriteBatchesPerShard.load();
+
+    AsyncRequestsSender ars(opCtx,
+                            Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
+                            clientRequest.getTargetingNS().db().toString(),
+                            {},
+                            kPrimaryOnlyReadPreference,
+                            opCtx->getTxnNumber() ? Shard::RetryPolicy::kIdempotent
+                                                  : Shard::RetryPolicy::kNoRetry);
+
+    // Child batches which have been targeted but not sent yet
+    std::map<ShardId, std::deque<std::unique_ptr<TargetedWriteBatch>>> queuedBatches;
+    size_t numQueued = 0;
+
+    // Child batches awaiting a response, by the index of their request in the ARS
+    std::map<size_t, std::unique_ptr<TargetedWriteBatch>> inFlightBatches;
+    std::map<ShardId, size_t> numInFlight;
+
+    bool refreshedTargeter = false;
+    bool targeterChanged = false;
+    int rounds = 0;
+    int numCompletedOps = 0;
+    int numRoundsWithoutProgress = 0;
+
+    while (!batchOp->isFinished()) {
+        if (numQueued == 0 && batchOp->numWriteOpsIn(WriteOpState_Ready) > 0) {
+            if (rounds > 0) {
+                // Refresh the targeter if we need to (no-op if nothing stale)
+                bool changed = false;
+                Status refreshStatus = targeter.refreshIfNeeded(opCtx, &changed);
+                if (!refreshStatus.isOK()) {
+                    warning() << "could not refresh targeter" << causedBy(refreshStatus.reason());
+                }
+                targeterChanged = targeterChanged || changed;
+
+                // The batch can only be aborted while no child batch is outstanding
+                if (inFlightBatches.empty()) {
+                    int currCompletedOps = batchOp->numWriteOpsIn(WriteOpState_Completed);
+                    if (currCompletedOps == numCompletedOps && !targeterChanged) {
+                        ++numRoundsWithoutProgress;
+                    } else {
+                        numRoundsWithoutProgress = 0;
+                    }
+                    numCompletedOps = currCompletedOps;
+                    targeterChanged = false;
+
+                    if (numRoundsWithoutProgress > kMaxRoundsWithoutProgress) {
+                        batchOp->abortBatch(
+                            noProgressError(clientRequest, numCompletedOps, rounds));
+                        break;
+                    }
+                }
+            }
+
+            ++rounds;
+            ++stats->numRounds;
+
+            // Each call targets at most one child batch per shard, so call until all the ready
+            // writes are targeted. Targeting errors are handled as in executeBatchInRounds.
+            while (true) {
+                std::map<ShardId, TargetedWriteBatch*> childBatches;
+                Status targetStatus =
+                    batchOp->targetBatch(targeter, refreshedTargeter, &childBatches);
+                if (!targetStatus.isOK()) {
+                    targeter.noteCouldNotTarget();
+                    refreshedTargeter = true;
+                    ++stats->numTargetErrors;
+                    dassert(childBatches.size() == 0u);
+                    break;
+                }
+
+                if (childBatches.empty())
+                    break;
+
+                for (const auto& childBatch : childBatches) {
+                    queuedBatches[childBatch.first].emplace_back(childBatch.second);
+                    ++numQueued;
+                }
+            }
+        }
+
+        //
+        // Send as many of the queued child batches as the shards may have outstanding
+        //
+
+        for (auto& shardQueue : queuedBatches) {
+            const ShardId& shardId = shardQueue.first;
+            auto& batches = shardQueue.second;
+
+            while (!batches.empty() && numInFlight[shardId] < maxInFlightPerShard) {
+                std::unique_ptr<TargetedWriteBatch> batch = std::move(batches.front());
+                batches.pop_front();
+                --numQueued;
+
+                stats->noteTargetedShard(shardId);
+
+                const auto request = buildShardBatchCommand(opCtx, *batchOp, *batch);
+
+                LOG(4) << "Sending write batch to " << shardId << ": " << redact(request);
+
+                const size_t requestIndex = ars.addRequest({shardId, request});
+                inFlightBatches.emplace(requestIndex, std::move(batch));
+                ++numInFlight[shardId];
+            }
+        }
+
+        // Nothing is outstanding if the ready writes could not be targeted, in which case the next
+        // iteration refreshes the targeter and targets them again
+        if (inFlightBatches.empty())
+            continue;
+
+        //
+        // Receive the next response, whichever shard it comes from
+        //
+
+        auto response = ars.next();
+
+        auto it = inFlightBatches.find(response.requestIndex);
+        invariant(it != inFlightBatches.end());
+        const std::unique_ptr<TargetedWriteBatch> batch = std::move(it->second);
+        inFlightBatches.erase(it);
+        --numInFlight[batch->getEndpoint().shardName];
+
+        noteShardBatchResponse(response, *batch, batchOp, &targeter, stats);
+    }
+}
+
+}  // namespace
+
+void BatchWriteExec::executeBatch(OperationContext* opCtx,
+                                  NSTargeter& targeter,
+                                  const BatchedCommandRequest& clientRequest,
+                                  BatchedCommandResponse* clientResponse,
+                                  BatchWriteExecStats* stats) {
+    const auto& nss(clientRequest.getNS());
+
+    LOG(4) << "Starting execution of write batch of size "
+           << static_cast<int>(clientRequest.sizeWriteOps()) << " for " << nss.ns();
+
+    BatchWriteOp batchOp(opCtx, clientRequest);
+
+    if (!clientRequest.getWriteCommandBase().getOrdered() &&
+        maxInFlightWriteBatchesPerShard.load() > 0) {
+        executeBatchPipelined(opCtx, targeter, clientRequest, &batchOp, stats);
+    } else {
+        executeBatchInRounds(opCtx, targeter, clientRequest, &batchOp, stats);
+    }
 
     batchOp.buildClientResponse(clientResponse);
 
@@ -34,6 +34,7 @@
 #include "mongo/client/remote_command_targeter_mock.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/logical_session_id.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/sharding_router_test_fixture.h"
@@ -43,15 +44,25 @@
 #include "mongo/s/write_ops/mock_ns_targeter.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
 
 const HostAndPort kTestShardHost = HostAndPort("FakeHost", 12345);
+const HostAndPort kTestShardHost2 = HostAndPort("FakeHost2", 12345);
 const HostAndPort kTestConfigShardHost = HostAndPort("FakeConfigHost", 12345);
 const std::string shardName = "FakeShard";
+const std::string shardName2 = "FakeShard2";
 const int kMaxRoundsWithoutProgress = 5;
 
+void setServerParameter(StringData name, StringData value) {
+    const auto& parameters = ServerParameterSet::getGlobal()->getMap();
+    auto it = parameters.find(name.toString());
+    invariant(it != parameters.end());
+    ASSERT_OK(it->second->setFromString(value.toString()));
+}
+
 /**
  * Mimics a single shard backend for a particular collection which can be initialized with a
  * set of write command results to return.
@@ -68,19 +79,23 @@ public:
         // Set up the RemoteCommandTargeter for the config shard.
         configTargeter()->setFindHostReturnValue(kTestConfigShardHost);
 
-        // Add a RemoteCommandTargeter for the data shard.
-        std::unique_ptr<RemoteCommandTargeterMock> targeter(
-            stdx::make_unique<RemoteCommandTargeterMock>());
-        targeter->setConnectionStringReturnValue(ConnectionString(kTestShardHost));
-        targeter->setFindHostReturnValue(kTestShardHost);
-        targeterFactory()->addTargeterToReturn(ConnectionString(kTestShardHost),
-                                               std::move(targeter));
+        // Add a RemoteCommandTargeter for each of the data shards.
+        for (const auto& host : {kTestShardHost, kTestShardHost2}) {
+            std::unique_ptr<RemoteCommandTargeterMock> targeter(
+                stdx::make_unique<RemoteCommandTargeterMock>());
+            targeter->setConnectionStringReturnValue(ConnectionString(host));
+            targeter->setFindHostReturnValue(host);
+            targeterFactory()->addTargeterToReturn(ConnectionString(host), std::move(targeter));
+        }
 
-        // Set up the shard registry to contain the fake shard.
+        // Set up the shard registry to contain the fake shards.
         ShardType shardType;
         shardType.setName(shardName);
         shardType.setHost(kTestShardHost.toString());
-        std::vector<ShardType> shards{shardType};
+        ShardType shardType2;
+        shardType2.setName(shardName2);
+        shardType2.setHost(kTestShardHost2.toString());
+        std::vector<ShardType> shards{shardType, shardType2};
         setupShards(shards);
 
         // Set up the namespace targeter to target the fake shard.
@@ -90,6 +105,76 @@ public:
                                    BSON("x" << MAXKEY))});
     }
 
+    /**
+     * Makes the namespace targeter send the documents with negative 'x' to the first shard and the
+     * others to the second.
+     */
+    void targetTwoShards() {
+        nsTargeter.init(nss,
+                        {MockRange(ShardEndpoint(shardName, ChunkVersion::IGNORED()),
+                                   BSON("x" << MINKEY),
+                                   BSON("x" << 0)),
+                         MockRange(ShardEndpoint(shardName2, ChunkVersion::IGNORED()),
+                                   BSON("x" << 0),
+                                   BSON("x" << MAXKEY))});
+    }
+
+    /**
+     * Returns the documents of the insert request 'request'.
+     */
+    std::vector<BSONObj> getInsertedDocs(const executor::RemoteCommandRequest& request) {
+        ASSERT_EQUALS(nss.db(), request.dbname);
+
+        const auto opMsgRequest(OpMsgRequest::fromDBAndBody(request.dbname, request.cmdObj));
+        const auto actualBatchedInsert(BatchedCommandRequest::parseInsert(opMsgRequest));
+        ASSERT_EQUALS(nss.toString(), actualBatchedInsert.getNS().ns());
+
+        return actualBatchedInsert.getInsertRequest().getDocuments();
+    }
+
+    /**
+     * Answers the request 'noi' on the network of the arbitrary executor with 'response'. Must be
+     * called from within that network.
+     */
+    void scheduleResponseForPool(executor::NetworkInterfaceMock::NetworkOperationIterator noi,
+                                 const BSONObj& response) {
+        networkForPool()->scheduleSuccessfulResponse(
+            noi, executor::RemoteCommandResponse(response, BSONObj(), Milliseconds(1)));
+    }
+
+    static BSONObj makeSuccessResponse(size_t numWrites) {
+        BatchedCommandResponse response;
+        response.setStatus(Status::OK());
+        response.setN(numWrites);
+
+        return response.toBSON();
+    }
+
+    BSONObj makeStaleVersionResponse(size_t numWrites) {
+        BatchedCommandResponse staleResponse;
+        staleResponse.setStatus(Status::OK());
+        staleResponse.setN(0);
+
+        auto epoch = OID::gen();
+
+        // Report a stale version error for each write in the batch.
+        for (size_t i = 0; i < numWrites; ++i) {
+            WriteErrorDetail* error = new WriteErrorDetail;
+            error->setStatus({ErrorCodes::StaleShardVersion, "mock stale error"});
+            error->setErrInfo([&] {
+                StaleConfigInfo sci(nss, ChunkVersion(1, 0, epoch), ChunkVersion(2, 0, epoch));
+                BSONObjBuilder builder;
+                sci.serialize(&builder);
+                return builder.obj();
+            }());
+            error->setIndex(i);
+
+            staleResponse.addToErrDetails(error);
+        }
+
+        return staleResponse.toBSON();
+    }
+
     void expectInsertsReturnSuccess(const std::vector<BSONObj>& expected) {
         expectInsertsReturnSuccess(expected.begin(), expected.end());
     }
@@ -114,11 +199,7 @@ public:
                 ASSERT_BSONOBJ_EQ(*itExpected, *itInserted);
             }
 
-            BatchedCommandResponse response;
-            response.setStatus(Status::OK());
-            response.setN(inserted.size());
-
-            return response.toBSON();
+            return makeSuccessResponse(inserted.size());
         });
     }
 
@@ -140,30 +221,7 @@ public:
                 ASSERT_BSONOBJ_EQ(*itExpected, *itInserted);
             }
 
-            BatchedCommandResponse staleResponse;
-            staleResponse.setStatus(Status::OK());
-            staleResponse.setN(0);
-
-            auto epoch = OID::gen();
-
-            // Report a stale version error for each write in the batch.
-            int i = 0;
-            for (itInserted = inserted.begin(); itInserted != inserted.end(); ++itInserted) {
-                WriteErrorDetail* error = new WriteErrorDetail;
-                error->setStatus({ErrorCodes::StaleShardVersion, "mock stale error"});
-                error->setErrInfo([&] {
-                    StaleConfigInfo sci(nss, ChunkVersion(1, 0, epoch), ChunkVersion(2, 0, epoch));
-                    BSONObjBuilder builder;
-                    sci.serialize(&builder);
-                    return builder.obj();
-                }());
-                error->setIndex(i);
-
-                staleResponse.addToErrDetails(error);
-                ++i;
-            }
-
-            return staleResponse.toBSON();
+            return makeStaleVersionResponse(inserted.size());
         });
     }
 
@@ -273,6 +331,189 @@ TEST_F(BatchWriteExecTest, MultiOpLarge) {
     future.timed_get(kFutureTimeout);
 }
 
+TEST_F(BatchWriteExecTest, MultiOpLargeUnorderedPipelined) {
+    // Both child batches of an unordered write are outstanding at once, so they take one round
+    const int kNumDocsToInsert = 100'000;
+    const std::string kDocValue(200, 'x');
+
+    std::vector<BSONObj> docsToInsert;
+    docsToInsert.reserve(kNumDocsToInsert);
+    for (int i = 0; i < kNumDocsToInsert; i++) {
+        docsToInsert.push_back(BSON("_id" << i << "someLargeKeyToWasteSpace" << kDocValue));
+    }
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments(docsToInsert);
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+
+        ASSERT(response.getOk());
+        ASSERT_EQUALS(response.getN(), kNumDocsToInsert);
+        ASSERT_EQUALS(stats.numRounds, 1);
+    });
+
+    expectInsertsReturnSuccess(docsToInsert.begin(), docsToInsert.begin() + 66576);
+    expectInsertsReturnSuccess(docsToInsert.begin() + 66576, docsToInsert.end());
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(BatchWriteExecTest, UnorderedPipelinedLimitsInFlightBatchesPerShard) {
+    // The two child batches to the shard are sent one after the other
+    setServerParameter("maxInFlightWriteBatchesPerShard", "1");
+    ON_BLOCK_EXIT([] { setServerParameter("maxInFlightWriteBatchesPerShard", "2"); });
+
+    const int kNumDocsToInsert = 100'000;
+    const std::string kDocValue(200, 'x');
+
+    std::vector<BSONObj> docsToInsert;
+    docsToInsert.reserve(kNumDocsToInsert);
+    for (int i = 0; i < kNumDocsToInsert; i++) {
+        docsToInsert.push_back(BSON("_id" << i << "someLargeKeyToWasteSpace" << kDocValue));
+    }
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments(docsToInsert);
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+
+        ASSERT(response.getOk());
+        ASSERT_EQUALS(response.getN(), kNumDocsToInsert);
+        ASSERT_EQUALS(stats.numRounds, 1);
+    });
+
+    // The second child batch is only sent once the first one has been answered
+    networkForPool()->enterNetwork();
+    auto first = networkForPool()->getNextReadyRequest();
+    const size_t numInFirst = getInsertedDocs(first->getRequest()).size();
+    ASSERT_LT(numInFirst, docsToInsert.size());
+    ASSERT_FALSE(networkForPool()->hasReadyRequests());
+    scheduleResponseForPool(first, makeSuccessResponse(numInFirst));
+    networkForPool()->runReadyNetworkOperations();
+    networkForPool()->exitNetwork();
+
+    expectInsertsReturnSuccess(docsToInsert.begin() + numInFirst, docsToInsert.end());
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(BatchWriteExecTest, UnorderedPipelinedShardRespondsWhileAnotherIsOutstanding) {
+    targetTwoShards();
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments({BSON("x" << -1), BSON("x" << 1)});
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+
+        ASSERT(response.getOk());
+        ASSERT_EQUALS(2, response.getN());
+        ASSERT_EQUALS(1, stats.numRounds);
+    });
+
+    networkForPool()->enterNetwork();
+    auto toFirstShard = networkForPool()->getNextReadyRequest();
+    ASSERT_EQ(kTestShardHost, toFirstShard->getRequest().target);
+    auto toSecondShard = networkForPool()->getNextReadyRequest();
+    ASSERT_EQ(kTestShardHost2, toSecondShard->getRequest().target);
+
+    // The second shard answers first, and nothing else needs to be sent
+    scheduleResponseForPool(toSecondShard, makeSuccessResponse(1));
+    networkForPool()->runReadyNetworkOperations();
+    ASSERT_FALSE(networkForPool()->hasReadyRequests());
+
+    scheduleResponseForPool(toFirstShard, makeSuccessResponse(1));
+    networkForPool()->runReadyNetworkOperations();
+    networkForPool()->exitNetwork();
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(BatchWriteExecTest, UnorderedPipelinedRetargetsStaleWritesWhileAnotherBatchIsInFlight) {
+    targetTwoShards();
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments({BSON("x" << -1), BSON("x" << 1)});
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+
+        ASSERT(response.getOk());
+        ASSERT_EQUALS(2, response.getN());
+        ASSERT_EQUALS(1, stats.numStaleBatches);
+        ASSERT_EQUALS(2, stats.numRounds);
+    });
+
+    networkForPool()->enterNetwork();
+    auto toFirstShard = networkForPool()->getNextReadyRequest();
+    ASSERT_EQ(kTestShardHost, toFirstShard->getRequest().target);
+    auto toSecondShard = networkForPool()->getNextReadyRequest();
+    ASSERT_EQ(kTestShardHost2, toSecondShard->getRequest().target);
+
+    scheduleResponseForPool(toSecondShard, makeStaleVersionResponse(1));
+    networkForPool()->runReadyNetworkOperations();
+
+    // The stale write is retargeted and sent again before the first shard has answered
+    auto retryToSecondShard = networkForPool()->getNextReadyRequest();
+    ASSERT_EQ(kTestShardHost2, retryToSecondShard->getRequest().target);
+    const auto retried = getInsertedDocs(retryToSecondShard->getRequest());
+    ASSERT_EQ(1UL, retried.size());
+    ASSERT_BSONOBJ_EQ(BSON("x" << 1), retried.front());
+
+    scheduleResponseForPool(retryToSecondShard, makeSuccessResponse(1));
+    scheduleResponseForPool(toFirstShard, makeSuccessResponse(1));
+    networkForPool()->runReadyNetworkOperations();
+    networkForPool()->exitNetwork();
+
+    future.timed_get(kFutureTimeout);
+}
+
 TEST_F(BatchWriteExecTest, SingleOpError) {
     BatchedCommandResponse errResponse;
     errResponse.setStatus({ErrorCodes::UnknownError, "mock error"});
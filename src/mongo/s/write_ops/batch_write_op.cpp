@@ -32,6 +32,7 @@
 
 #include "mongo/s/write_ops/batch_write_op.h"
 
+#include <algorithm>
 #include <numeric>
 
 #include "mongo/base/error_codes.h"
@@ -256,6 +257,19 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
 
     const size_t numWriteOps = _clientRequest.sizeWriteOps();
 
+    // Regular inserts target a single shard each, which lets the targeter target them in batches
+    const bool targetBatchInserts =
+        _clientRequest.getBatchType() == BatchedCommandRequest::BatchType_Insert &&
+        !_clientRequest.isInsertIndexRequest();
+
+    // TargetedWrites need to be owned once returned. The vector is reused across write ops and
+    // is empty at the start of each iteration.
+    OwnedPointerVector<TargetedWrite> writesOwned;
+
+    // Inserts targeted ahead of time are checked through a TargetedWrite on the stack instead,
+    // which is only copied into its TargetedWriteBatch once the insert is known to be sent
+    vector<TargetedWrite*> insertWrites;
+
     for (size_t i = 0; i < numWriteOps; ++i) {
         WriteOp& writeOp = _writeOps[i];
 
@@ -266,12 +280,31 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         //
         // Get TargetedWrites from the targeter for the write operation
         //
-        // TargetedWrites need to be owned once returned
 
-        OwnedPointerVector<TargetedWrite> writesOwned;
-        vector<TargetedWrite*>& writes = writesOwned.mutableVector();
+        invariant(writesOwned.empty());
+
+        const NSTargeter::BatchInsertTarget* insertTarget = nullptr;
+        boost::optional<TargetedWrite> insertWrite;
+        if (targetBatchInserts) {
+            insertTarget = &_targetInsertInWindow(targeter, i);
+            if (insertTarget->endpoint.isOK()) {
+                insertWrite.emplace(writeOp.makeSingleWrite(insertTarget->endpoint.getValue()));
+            }
+        }
 
-        Status targetStatus = writeOp.targetWrites(_opCtx, targeter, &writes);
+        Status targetStatus = Status::OK();
+        if (!insertWrite) {
+            // Writes which could not be targeted as part of a batch are retargeted individually,
+            // so that their errors are reported exactly as without batching
+            targetStatus = writeOp.targetWrites(_opCtx, targeter, &writesOwned.mutableVector());
+        }
+
+        insertWrites.clear();
+        if (insertWrite) {
+            insertWrites.push_back(insertWrite.get_ptr());
+        }
+
+        const vector<TargetedWrite*>& writes = insertWrite ? insertWrites : writesOwned.vector();
 
         if (!targetStatus.isOK()) {
             WriteErrorDetail targetError;
@@ -280,6 +313,9 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
             if (!recordTargetErrors) {
                 // Cancel current batch state with an error
                 _cancelBatches(targetError, std::move(batchMap));
+
+                // The targeter is refreshed before the writes are targeted again
+                _insertTargetingWindow = InsertTargetingWindow();
                 return targetStatus;
             } else if (!ordered || batchMap.empty()) {
                 // Record an error for this batch
@@ -345,7 +381,13 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
             }
 
             TargetedWriteBatch* batch = batchIt->second;
-            batch->addWrite(write, writeSizeBytes);
+            if (insertWrite) {
+                writeOp.noteSingleWriteTargeted(batch->addWrite(*write, writeSizeBytes));
+                targeter.noteBatchInsertTargeted(
+                    _opCtx, writeOp.getWriteItem().getDocument(), *insertTarget);
+            } else {
+                batch->addWrite(write, writeSizeBytes);
+            }
         }
 
         // Relinquish ownership of TargetedWrites, now the TargetedBatches own them
@@ -519,6 +561,9 @@ void BatchWriteOp::noteBatchResponse(const TargetedWriteBatch& targetedBatch,
         itemErrors.insert(
             itemErrors.begin(), response.getErrDetails().begin(), response.getErrDetails().end());
 
+        // Errors may make the targeter refresh before the failed writes are targeted again
+        _insertTargetingWindow = InsertTargetingWindow();
+
         // Sort per-item errors by index
         std::sort(itemErrors.begin(), itemErrors.end(), WriteErrorDetailComp());
     }
@@ -775,6 +820,53 @@ void BatchWriteOp::_incBatchStats(const BatchedCommandResponse& response) {
     }
 }
 
+const NSTargeter::BatchInsertTarget& BatchWriteOp::_targetInsertInWindow(
+    const NSTargeter& targeter, size_t opIndex) {
+    auto& window = _insertTargetingWindow;
+
+    // Ops are usually targeted in the order of the window, and only go back to an earlier op at
+    // the start of a new round
+    size_t position;
+    if (window.next < window.opIndexes.size() && window.opIndexes[window.next] == opIndex) {
+        position = window.next;
+    } else if (window.next > 0 && window.opIndexes[window.next - 1] == opIndex) {
+        position = window.next - 1;
+    } else {
+        const auto it = std::lower_bound(window.opIndexes.begin(), window.opIndexes.end(), opIndex);
+        if (it != window.opIndexes.end() && *it == opIndex) {
+            position = it - window.opIndexes.begin();
+        } else {
+            _fillInsertTargetingWindow(targeter, opIndex);
+            position = 0;
+        }
+    }
+
+    window.next = position + 1;
+    return window.targets[position];
+}
+
+void BatchWriteOp::_fillInsertTargetingWindow(const NSTargeter& targeter, size_t opIndex) {
+    auto& window = _insertTargetingWindow;
+
+    if (!window.opIndexes.empty() && window.next == window.opIndexes.size()) {
+        window.size *= 2;
+    }
+
+    vector<BSONObj> docs;
+    window.opIndexes.clear();
+    for (size_t i = opIndex; i < _writeOps.size() && window.opIndexes.size() < window.size; ++i) {
+        if (_writeOps[i].getWriteState() == WriteOpState_Ready) {
+            window.opIndexes.push_back(i);
+            docs.push_back(_writeOps[i].getWriteItem().getDocument());
+        }
+    }
+    invariant(!window.opIndexes.empty() && window.opIndexes.front() == opIndex);
+
+    targeter.targetInserts(_opCtx, docs, &window.targets);
+    invariant(window.targets.size() == docs.size());
+    window.next = 0;
+}
+
 void BatchWriteOp::_cancelBatches(const WriteErrorDetail& why,
                                   TargetedBatchMap&& batchMapToCancel) {
     TargetedBatchMap batchMap(batchMapToCancel);
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <deque>
 #include <map>
 #include <set>
 #include <vector>
@@ -201,6 +202,40 @@ private:
      */
     void _cancelBatches(const WriteErrorDetail& why, TargetedBatchMap&& batchMapToCancel);
 
+    /**
+     * Returns the result of targeting the ready insert at 'opIndex', from the insert targeting
+     * window, which is refilled through 'targeter' starting at 'opIndex' if it is not there. The
+     * result stays valid until the next call.
+     */
+    const NSTargeter::BatchInsertTarget& _targetInsertInWindow(const NSTargeter& targeter,
+                                                               size_t opIndex);
+
+    /**
+     * Replaces the insert targeting window with the ready inserts starting at 'opIndex'.
+     */
+    void _fillInsertTargetingWindow(const NSTargeter& targeter, size_t opIndex);
+
+    /**
+     * Inserts of the batch which were targeted ahead of time by targetBatch.
+     *
+     * A round of targeting may stop early, for example because an ordered batch needs to switch
+     * shards, and the ops after that are targeted again in the next round, where they are found
+     * in the window. The window starts small and only grows when it is used up, which bounds the
+     * work wasted on ops which are not sent, for example because an ordered batch fails.
+     */
+    struct InsertTargetingWindow {
+        // Ready ops in the window in increasing order and the result of targeting each of them
+        std::vector<size_t> opIndexes;
+        std::vector<NSTargeter::BatchInsertTarget> targets;
+
+        // Position in the window of the op expected to be targeted next
+        size_t next{0};
+
+        // Number of ops to target the next time the window is filled
+        static constexpr size_t kInitialSize = 16;
+        size_t size{kInitialSize};
+    };
+
     OperationContext* const _opCtx;
 
     // The incoming client request
@@ -212,6 +247,10 @@ private:
     // Array of ops being processed from the client request
     std::vector<WriteOp> _writeOps;
 
+    // Only valid for the routing info it was targeted with, so it is discarded whenever an error
+    // may cause the targeter to be refreshed
+    InsertTargetingWindow _insertTargetingWindow;
+
     // Current outstanding batch op write requests
     // Not owned here but tracked for reporting
     std::set<const TargetedWriteBatch*> _targeted;
@@ -248,7 +287,7 @@ public:
     }
 
     const std::vector<TargetedWrite*>& getWrites() const {
-        return _writes.vector();
+        return _writes;
     }
 
     size_t getNumOps() const {
@@ -263,17 +302,33 @@ public:
      * TargetedWrite is owned here once given to the TargetedWriteBatch.
      */
     void addWrite(TargetedWrite* targetedWrite, int estWriteSize) {
-        _writes.mutableVector().push_back(targetedWrite);
+        _ownedWrites.mutableVector().push_back(targetedWrite);
+        _writes.push_back(targetedWrite);
         _estimatedSizeBytes += estWriteSize;
     }
 
+    /**
+     * Stores a copy of 'targetedWrite' in the TargetedWriteBatch, without a separate allocation
+     * per write, and returns it.
+     */
+    TargetedWrite* addWrite(const TargetedWrite& targetedWrite, int estWriteSize) {
+        _storedWrites.push_back(targetedWrite);
+        _writes.push_back(&_storedWrites.back());
+        _estimatedSizeBytes += estWriteSize;
+        return _writes.back();
+    }
+
 private:
     // Where to send the batch
     const ShardEndpoint _endpoint;
 
-    // Where the responses go
-    // TargetedWrite*s are owned by the TargetedWriteBatch
-    OwnedPointerVector<TargetedWrite> _writes;
+    // Where the responses go, in the order they were added
+    std::vector<TargetedWrite*> _writes;
+
+    // TargetedWrites owned by the TargetedWriteBatch, either given to it or stored by value. The
+    // deque keeps the stored writes at stable addresses.
+    OwnedPointerVector<TargetedWrite> _ownedWrites;
+    std::deque<TargetedWrite> _storedWrites;
 
     // Conservatvely estimated size of the batch, for ensuring it doesn't grow past the maximum BSON
     // size
@@ -459,6 +459,54 @@ TEST_F(BatchWriteOpTest, MultiOpTwoShardsOrdered) {
     ASSERT_EQUALS(clientResponse.getN(), 2);
 }
 
+// Ordered insert batch whose documents alternate between shards, which requires many targeting
+// rounds. Inserts are targeted ahead of time through NSTargeter::targetInserts, so every round must
+// still yield exactly the next document and the batch must complete with all documents written.
+// Only the inserts which are actually sent may be reported to the targeter.
+TEST_F(BatchWriteOpTest, MultiOpTwoShardsOrderedManyInserts) {
+    NamespaceString nss("foo.bar");
+    ShardEndpoint endpointA(ShardId("shardA"), ChunkVersion::IGNORED());
+    ShardEndpoint endpointB(ShardId("shardB"), ChunkVersion::IGNORED());
+    MockNSTargeter targeter;
+    initTargeterSplitRange(nss, endpointA, endpointB, &targeter);
+
+    const int numDocs = 40;
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        std::vector<BSONObj> docs;
+        for (int i = 0; i < numDocs; ++i) {
+            docs.push_back(BSON("x" << (i % 2 == 0 ? -(i + 1) : i)));
+        }
+        insertOp.setDocuments(docs);
+        return insertOp;
+    }());
+
+    BatchWriteOp batchOp(operationContext(), request);
+
+    BatchedCommandResponse response;
+    buildResponse(1, &response);
+
+    for (int i = 0; i < numDocs; ++i) {
+        OwnedPointerMap<ShardId, TargetedWriteBatch> targetedOwned;
+        std::map<ShardId, TargetedWriteBatch*>& targeted = targetedOwned.mutableMap();
+        ASSERT_OK(batchOp.targetBatch(targeter, false, &targeted));
+        ASSERT_EQUALS(targeted.size(), 1u);
+        ASSERT_EQUALS(targeted.begin()->second->getWrites().size(), 1u);
+        ASSERT_EQUALS(targeted.begin()->second->getWrites().front()->writeOpRef.first, i);
+        assertEndpointsEqual(targeted.begin()->second->getEndpoint(),
+                             i % 2 == 0 ? endpointA : endpointB);
+        ASSERT_EQUALS(targeter.getNumInsertsTargeted(), static_cast<size_t>(i + 1));
+
+        batchOp.noteBatchResponse(*targeted.begin()->second, response, NULL);
+        ASSERT_EQUALS(batchOp.isFinished(), i == numDocs - 1);
+    }
+
+    BatchedCommandResponse clientResponse;
+    batchOp.buildClientResponse(&clientResponse);
+    ASSERT(clientResponse.getOk());
+    ASSERT_EQUALS(clientResponse.getN(), numDocs);
+}
+
 void verifyTargetedBatches(std::map<ShardId, size_t> expected,
                            const std::map<ShardId, TargetedWriteBatch*>& targeted) {
     // 'expected' contains each ShardId that was expected to be targeted and the size of the batch
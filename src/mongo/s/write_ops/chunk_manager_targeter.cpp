@@ -298,20 +298,11 @@ StatusWith<ShardEndpoint> ChunkManagerTargeter::targetInsert(OperationContext* o
         // Inserts must contain the exact shard key.
         //
 
-        shardKey = _routingInfo->cm()->getShardKeyPattern().extractShardKeyFromDoc(doc);
-
-        // Check shard key exists
-        if (shardKey.isEmpty()) {
-            return {ErrorCodes::ShardKeyNotFound,
-                    str::stream() << "document " << doc
-                                  << " does not contain shard key for pattern "
-                                  << _routingInfo->cm()->getShardKeyPattern().toString()};
-        }
+        auto swShardKey = _extractShardKeyForInsert(doc);
+        if (!swShardKey.isOK())
+            return swShardKey.getStatus();
 
-        // Check shard key size on insert
-        Status status = ShardKeyPattern::checkShardKeySize(shardKey);
-        if (!status.isOK())
-            return status;
+        shardKey = std::move(swShardKey.getValue());
     }
 
     // Target the shard key or database primary
@@ -330,6 +321,66 @@ StatusWith<ShardEndpoint> ChunkManagerTargeter::targetInsert(OperationContext* o
     return Status::OK();
 }
 
+void ChunkManagerTargeter::targetInserts(OperationContext* opCtx,
+                                         const std::vector<BSONObj>& docs,
+                                         std::vector<BatchInsertTarget>* targets) const {
+    if (!_routingInfo->cm()) {
+        NSTargeter::targetInserts(opCtx, docs, targets);
+        return;
+    }
+
+    targets->clear();
+    targets->reserve(docs.size());
+
+    // Documents with a valid shard key are targeted together once all keys have been extracted
+    std::vector<BSONObj> shardKeys;
+    std::vector<size_t> shardKeyDocs;
+    shardKeys.reserve(docs.size());
+    shardKeyDocs.reserve(docs.size());
+
+    for (size_t i = 0; i < docs.size(); ++i) {
+        auto swShardKey = _extractShardKeyForInsert(docs[i]);
+        if (!swShardKey.isOK()) {
+            targets->emplace_back(swShardKey.getStatus());
+            continue;
+        }
+
+        shardKeys.push_back(std::move(swShardKey.getValue()));
+        shardKeyDocs.push_back(i);
+
+        // Placeholder until the shard key is targeted below
+        targets->emplace_back(Status(ErrorCodes::ShardKeyNotFound, "shard key not yet targeted"));
+    }
+
+    const auto& cm = _routingInfo->cm();
+    const auto chunks = cm->findIntersectingChunksWithSimpleCollation(shardKeys);
+    for (size_t i = 0; i < shardKeys.size(); ++i) {
+        auto& target = (*targets)[shardKeyDocs[i]];
+        if (!chunks[i]) {
+            target.endpoint =
+                Status(ErrorCodes::ShardKeyNotFound,
+                       str::stream() << "Cannot target single shard using key " << shardKeys[i]);
+            continue;
+        }
+
+        const auto& chunk = *chunks[i];
+        target.endpoint = ShardEndpoint(chunk.getShardId(), cm->getVersion(chunk.getShardId()));
+        target.chunkMin = chunk.getMin();
+    }
+}
+
+void ChunkManagerTargeter::noteBatchInsertTargeted(OperationContext* opCtx,
+                                                   const BSONObj& doc,
+                                                   const BatchInsertTarget& target) const {
+    if (target.chunkMin.isEmpty()) {
+        return;
+    }
+
+    // Track autosplit stats for sharded collections
+    // Note: this is only best effort accounting and is not accurate.
+    _stats->chunkSizeDelta[target.chunkMin] += doc.objsize();
+}
+
 StatusWith<std::vector<ShardEndpoint>> ChunkManagerTargeter::targetUpdate(
     OperationContext* opCtx, const write_ops::UpdateOpEntry& updateDoc) const {
     //
@@ -589,6 +640,25 @@ StatusWith<std::vector<ShardEndpoint>> ChunkManagerTargeter::_targetQuery(
     return endpoints;
 }
 
+StatusWith<BSONObj> ChunkManagerTargeter::_extractShardKeyForInsert(const BSONObj& doc) const {
+    const auto& shardKeyPattern = _routingInfo->cm()->getShardKeyPattern();
+    BSONObj shardKey = shardKeyPattern.extractShardKeyFromDoc(doc);
+
+    // Check shard key exists
+    if (shardKey.isEmpty()) {
+        return {ErrorCodes::ShardKeyNotFound,
+                str::stream() << "document " << doc << " does not contain shard key for pattern "
+                              << shardKeyPattern.toString()};
+    }
+
+    // Check shard key size on insert
+    Status status = ShardKeyPattern::checkShardKeySize(shardKey);
+    if (!status.isOK())
+        return status;
+
+    return shardKey;
+}
+
 ShardEndpoint ChunkManagerTargeter::_targetShardKey(const BSONObj& shardKey,
                                                     const BSONObj& collation,
                                                     long long estDataSize) const {
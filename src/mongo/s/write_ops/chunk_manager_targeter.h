@@ -72,6 +72,15 @@ public:
     StatusWith<ShardEndpoint> targetInsert(OperationContext* opCtx,
                                            const BSONObj& doc) const override;
 
+    // Resolves the shard keys of all documents with a single sweep over the routing table.
+    void targetInserts(OperationContext* opCtx,
+                       const std::vector<BSONObj>& docs,
+                       std::vector<BatchInsertTarget>* targets) const override;
+
+    void noteBatchInsertTargeted(OperationContext* opCtx,
+                                 const BSONObj& doc,
+                                 const BatchInsertTarget& target) const override;
+
     // Returns ShardKeyNotFound if the update can't be targeted without a shard key.
     StatusWith<std::vector<ShardEndpoint>> targetUpdate(
         OperationContext* opCtx, const write_ops::UpdateOpEntry& updateDoc) const override;
@@ -108,6 +117,13 @@ private:
      */
     Status _refreshNow(OperationContext* opCtx);
 
+    /**
+     * Returns the shard key of a document to be inserted into a sharded collection.
+     *
+     * Returns !OK with message if the document does not contain a valid shard key.
+     */
+    StatusWith<BSONObj> _extractShardKeyForInsert(const BSONObj& doc) const;
+
     /**
      * Returns a vector of ShardEndpoints where a document might need to be placed.
      *
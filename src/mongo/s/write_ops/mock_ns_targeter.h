@@ -116,6 +116,19 @@ public:
         return endpoints;
     }
 
+    void noteBatchInsertTargeted(OperationContext* opCtx,
+                                 const BSONObj& doc,
+                                 const BatchInsertTarget& target) const override {
+        ++_numInsertsTargeted;
+    }
+
+    /**
+     * Returns the number of inserts reported through noteBatchInsertTargeted so far.
+     */
+    size_t getNumInsertsTargeted() const {
+        return _numInsertsTargeted;
+    }
+
     void noteCouldNotTarget() override {
         // No-op
     }
@@ -181,6 +194,8 @@ private:
     NamespaceString _nss;
 
     std::vector<MockRange> _mockRanges;
+
+    mutable size_t _numInsertsTargeted{0};
 };
 
 inline void assertEndpointsEqual(const ShardEndpoint& endpointA, const ShardEndpoint& endpointB) {
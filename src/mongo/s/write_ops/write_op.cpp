@@ -114,6 +114,26 @@ Status WriteOp::targetWrites(OperationContext* opCtx,
     return Status::OK();
 }
 
+TargetedWrite WriteOp::makeSingleWrite(ShardEndpoint endpoint) const {
+    invariant(_state == WriteOpState_Ready);
+    invariant(_childOps.empty());
+
+    WriteOpRef ref(_itemRef.getItemIndex(), 0);
+    return TargetedWrite(std::move(endpoint), ref);
+}
+
+void WriteOp::noteSingleWriteTargeted(TargetedWrite* targetedWrite) {
+    invariant(_state == WriteOpState_Ready);
+    invariant(_childOps.empty());
+    dassert(targetedWrite->writeOpRef.first == _itemRef.getItemIndex());
+    dassert(targetedWrite->writeOpRef.second == 0);
+
+    _childOps.emplace_back(this);
+    _childOps.back().pendingWrite = targetedWrite;
+    _childOps.back().state = WriteOpState_Pending;
+    _state = WriteOpState_Pending;
+}
+
 size_t WriteOp::getNumTargeted() {
     return _childOps.size();
 }
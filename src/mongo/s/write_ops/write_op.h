@@ -123,6 +123,23 @@ public:
                         const NSTargeter& targeter,
                         std::vector<TargetedWrite*>* targetedWrites);
 
+    /**
+     * Returns the TargetedWrite for a write which has already been targeted at the single shard
+     * endpoint 'endpoint', for example as part of a batch (see NSTargeter::targetInserts), without
+     * changing the state of this op. Unlike targetWrites, the caller decides where the
+     * TargetedWrite is stored and reports it with noteSingleWriteTargeted once it is assigned to a
+     * batch.
+     */
+    TargetedWrite makeSingleWrite(ShardEndpoint endpoint) const;
+
+    /**
+     * Tracks 'targetedWrite', returned by makeSingleWrite, as the pending child write of this op.
+     * The TargetedWrite is not owned here and must outlive the response to it.
+     *
+     * Can only be called when state is _Ready.
+     */
+    void noteSingleWriteTargeted(TargetedWrite* targetedWrite);
+
     /**
      * Returns the number of child writes that were last targeted.
      */
@@ -36,11 +36,147 @@
 
 #include <iostream>
 
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/bits.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
+constexpr uint64_t TicketHolder::kStride;
+
+void TicketHolder::waitForTicket(OperationContext* opCtx) {
+    waitForTicketUntil(opCtx, Date_t::max());
+}
+
+void TicketHolder::waitForTicket(OperationContext* opCtx, OperationPriority priority) {
+    waitForTicketUntil(opCtx, Date_t::max(), priority);
+}
+
+bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
+    return waitForTicketUntil(
+        opCtx, until, opCtx ? getOperationPriority(opCtx) : OperationPriority::kInteractive);
+}
+
+bool TicketHolder::waitForTicketUntil(OperationContext* opCtx,
+                                      Date_t until,
+                                      OperationPriority priority) {
+    // Newcomers only bypass the queue while it is empty, so that they cannot overtake waiters.
+    if (_waiting.load() == 0 && tryAcquire())
+        return true;
+
+    _waiting.fetchAndAdd(1);
+    Timer timer;
+    // Record the wait even when it ends with an interruption exception.
+    ON_BLOCK_EXIT([this, &timer, priority] {
+        const long long micros = timer.micros();
+        const int bucket = micros <= 0 ? 0 : std::min(64 - countLeadingZeros64(micros),
+                                                      kWaitHistogramBuckets - 1);
+        _waitHistogram[bucket].fetchAndAdd(1);
+        _totalWaitMicros.fetchAndAdd(micros);
+        _totalWaits.fetchAndAdd(1);
+        _waitMicrosByPriority[static_cast<int>(priority)].fetchAndAdd(micros);
+        _waitsByPriority[static_cast<int>(priority)].fetchAndAdd(1);
+        _waiting.fetchAndSubtract(1);
+    });
+    return _waitInQueue(opCtx, until, priority);
+}
+
+bool TicketHolder::_waitInQueue(OperationContext* opCtx,
+                                Date_t until,
+                                OperationPriority priority) {
+    const int cls = static_cast<int>(priority);
+    const uint64_t stride = kStride / getOperationPriorityWeight(priority);
+
+    stdx::unique_lock<stdx::mutex> lk(_queueMutex);
+    if (_queued[cls] == 0) {
+        // A class which had no waiters must not bank the turns it did not use.
+        const int next = _nextClass_inlock();
+        if (next >= 0)
+            _pass[cls] = std::max(_pass[cls], _pass[next]);
+    }
+    _queued[cls]++;
+
+    // Pass the turn on when leaving, since tickets may remain or this waiter may be giving up.
+    ON_BLOCK_EXIT([this, cls] {
+        _queued[cls]--;
+        _notifyNext_inlock();
+    });
+
+    // To support interrupting ticket acquisition, the wait is done on an interval to periodically
+    // check for interrupts.
+    const Milliseconds intervalMs(500);
+    while (true) {
+        if (_nextClass_inlock() == cls && tryAcquire()) {
+            _pass[cls] += stride;
+            return true;
+        }
+
+        const Date_t now = Date_t::now();
+        if (now >= until)
+            return false;
+
+        _queueCondVars[cls].wait_until(lk, std::min(until, now + intervalMs).toSystemTimePoint());
+
+        if (opCtx)
+            opCtx->checkForInterrupt();
+    }
+}
+
+int TicketHolder::_nextClass_inlock() const {
+    int next = -1;
+    for (int cls = 0; cls < kNumOperationPriorities; ++cls) {
+        if (_queued[cls] > 0 && (next < 0 || _pass[cls] < _pass[next]))
+            next = cls;
+    }
+    return next;
+}
+
+void TicketHolder::_notifyWaiters() {
+    // A waiter registers in '_waiting' before trying to acquire a ticket, so if its attempt failed
+    // before a ticket was returned, the returning thread is guaranteed to see it here.
+    if (_waiting.load() == 0)
+        return;
+
+    stdx::lock_guard<stdx::mutex> lk(_queueMutex);
+    _notifyNext_inlock();
+}
+
+void TicketHolder::_notifyNext_inlock() {
+    const int next = _nextClass_inlock();
+    if (next >= 0)
+        _queueCondVars[next].notify_one();
+}
+
+void TicketHolder::appendWaitStats(BSONObjBuilder* builder) const {
+    builder->append("waiting", waiting());
+    builder->append("totalWaits", totalWaits());
+    builder->append("totalWaitMicros", _totalWaitMicros.load());
+
+    {
+        BSONObjBuilder byPriority(builder->subobjStart("byPriority"));
+        for (int cls = 0; cls < kNumOperationPriorities; ++cls) {
+            BSONObjBuilder classBuilder(
+                byPriority.subobjStart(toString(static_cast<OperationPriority>(cls))));
+            classBuilder.append("totalWaits", _waitsByPriority[cls].load());
+            classBuilder.append("totalWaitMicros", _waitMicrosByPriority[cls].load());
+        }
+    }
+
+    // Bucket 0 holds waits shorter than a microsecond, bucket i > 0 those of [2^(i-1), 2^i) micros.
+    BSONArrayBuilder histogram(builder->subarrayStart("waitHistogram"));
+    for (int i = 0; i < kWaitHistogramBuckets; ++i) {
+        const long long count = _waitHistogram[i].load();
+        if (!count)
+            continue;
+        BSONObjBuilder entry(histogram.subobjStart());
+        entry.append("micros", i == 0 ? 0LL : 1LL << (i - 1));
+        entry.append("count", count);
+    }
+}
+
 #if defined(__linux__)
 namespace {
 
@@ -61,14 +197,6 @@ void check(int ret) {
         return;
     failWithErrno(errno);
 }
-
-/**
- * Takes a Date_t deadline and sets the appropriate values in a timespec structure.
- */
-void tsFromDate(const Date_t& deadline, struct timespec& ts) {
-    ts.tv_sec = deadline.toTimeT();
-    ts.tv_nsec = (deadline.toMillisSinceEpoch() % 1000) * 1'000'000;
-}
 }  // namespace
 
 TicketHolder::TicketHolder(int num) : _outof(num) {
@@ -89,43 +217,23 @@ bool TicketHolder::tryAcquire() {
     return true;
 }
 
-void TicketHolder::waitForTicket(OperationContext* opCtx) {
-    waitForTicketUntil(opCtx, Date_t::max());
-}
-
-bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
-    const Milliseconds intervalMs(500);
-    struct timespec ts;
-
-    // To support interrupting ticket acquisition while still benefiting from semaphores, we do a
-    // timed wait on an interval to periodically check for interrupts.
-    // The wait period interval is the smaller of the default interval and the provided
-    // deadline.
-    Date_t deadline = std::min(until, Date_t::now() + intervalMs);
-    tsFromDate(deadline, ts);
-
-    while (0 != sem_timedwait(&_sem, &ts)) {
-        if (errno == ETIMEDOUT) {
-            // If we reached the deadline without being interrupted, we have completely timed out.
-            if (deadline == until)
-                return false;
-
-            deadline = std::min(until, Date_t::now() + intervalMs);
-            tsFromDate(deadline, ts);
-        } else if (errno != EINTR) {
-            failWithErrno(errno);
-        }
+void TicketHolder::release() {
+    if (_tryUnretire())
+        return;
 
-        // To correctly handle errors from sem_timedwait, we should check for interrupts last.
-        // It is possible to unset 'errno' after a call to checkForInterrupt().
-        if (opCtx)
-            opCtx->checkForInterrupt();
-    }
-    return true;
+    check(sem_post(&_sem));
+    _notifyWaiters();
 }
 
-void TicketHolder::release() {
-    check(sem_post(&_sem));
+bool TicketHolder::_tryUnretire() {
+    int retiring = _retiring.load();
+    while (retiring > 0) {
+        const int observed = _retiring.compareAndSwap(retiring, retiring - 1);
+        if (observed == retiring)
+            return true;
+        retiring = observed;
+    }
+    return false;
 }
 
 Status TicketHolder::resize(int newSize) {
@@ -141,13 +249,21 @@ Status TicketHolder::resize(int newSize) {
                                     << "; given "
                                     << newSize);
 
+    // Growing first keeps tickets which are still retiring, rather than adding new ones.
     while (_outof.load() < newSize) {
-        release();
+        if (!_tryUnretire()) {
+            check(sem_post(&_sem));
+            _notifyWaiters();
+        }
         _outof.fetchAndAdd(1);
     }
 
+    // Take available tickets out of circulation directly on the semaphore, so that shrinking does
+    // not show up in the wait statistics of operations. Tickets in use are retired when released,
+    // so that shrinking never waits for the operations holding them.
     while (_outof.load() > newSize) {
-        waitForTicket();
+        if (!tryAcquire())
+            _retiring.fetchAndAdd(1);
         _outof.subtractAndFetch(1);
     }
 
@@ -162,7 +278,7 @@ int TicketHolder::available() const {
 }
 
 int TicketHolder::used() const {
-    return outof() - available();
+    return outof() + _retiring.load() - available();
 }
 
 int TicketHolder::outof() const {
@@ -180,60 +296,31 @@ bool TicketHolder::tryAcquire() {
     return _tryAcquire();
 }
 
-void TicketHolder::waitForTicket(OperationContext* opCtx) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    if (opCtx) {
-        opCtx->waitForConditionOrInterrupt(_newTicket, lk, [this] { return _tryAcquire(); });
-    } else {
-        _newTicket.wait(lk, [this] { return _tryAcquire(); });
-    }
-}
-
-bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    if (opCtx) {
-        return opCtx->waitForConditionOrInterruptUntil(
-            _newTicket, lk, until, [this] { return _tryAcquire(); });
-    } else {
-        return _newTicket.wait_until(
-            lk, until.toSystemTimePoint(), [this] { return _tryAcquire(); });
-    }
-}
-
 void TicketHolder::release() {
     {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
         _num++;
     }
-    _newTicket.notify_one();
+    _notifyWaiters();
 }
 
 Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-
-    int used = _outof.load() - _num;
-    if (used > newSize) {
-        std::stringstream ss;
-        ss << "can't resize since we're using (" << used << ") "
-           << "more than newSize(" << newSize << ")";
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
 
-        std::string errmsg = ss.str();
-        log() << errmsg;
-        return Status(ErrorCodes::BadValue, errmsg);
+        // When shrinking below the number of tickets in use, _num goes negative and the excess
+        // tickets are retired as they are released.
+        int used = _outof.load() - _num;
+        _outof.store(newSize);
+        _num = _outof.load() - used;
     }
 
-    _outof.store(newSize);
-    _num = _outof.load() - used;
-
-    // Potentially wasteful, but easier to see is correct
-    _newTicket.notify_all();
+    _notifyWaiters();
     return Status::OK();
 }
 
 int TicketHolder::available() const {
-    return _num;
+    return std::max(_num, 0);
 }
 
 int TicketHolder::used() const {
@@ -246,9 +333,6 @@ int TicketHolder::outof() const {
 
 bool TicketHolder::_tryAcquire() {
     if (_num <= 0) {
-        if (_num < 0) {
-            std::cerr << "DISASTER! in TicketHolder" << std::endl;
-        }
         return false;
     }
     _num--;
@@ -33,8 +33,11 @@
 #include <semaphore.h>
 #endif
 
+#include <array>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/operation_priority.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
@@ -42,6 +45,15 @@
 
 namespace mongo {
 
+class BSONObjBuilder;
+
+/**
+ * Counting semaphore which limits the number of concurrently active operations.
+ *
+ * When no ticket is available, waiters queue by OperationPriority. Tickets released while several
+ * classes have waiters are handed out by weighted fair queueing across the classes, in proportion
+ * to getOperationPriorityWeight(). A class which had no waiters does not accumulate credit.
+ */
 class TicketHolder {
     MONGO_DISALLOW_COPYING(TicketHolder);
 
@@ -55,8 +67,11 @@ public:
      * Attempts to acquire a ticket. Blocks until a ticket is acquired or the OperationContext
      * 'opCtx' is killed, throwing an AssertionException.
      * If 'opCtx' is not provided or equal to nullptr, the wait is not interruptible.
+     *
+     * Waiters are queued with the priority of 'opCtx', or with 'priority' if one is passed.
      */
     void waitForTicket(OperationContext* opCtx);
+    void waitForTicket(OperationContext* opCtx, OperationPriority priority);
     void waitForTicket() {
         waitForTicket(nullptr);
     }
@@ -67,13 +82,20 @@ public:
      * AssertionException if the OperationContext 'opCtx' is killed and no waits for tickets can
      * proceed.
      * If 'opCtx' is not provided or equal to nullptr, the wait is not interruptible.
+     *
+     * Waiters are queued with the priority of 'opCtx', or with 'priority' if one is passed.
      */
     bool waitForTicketUntil(OperationContext* opCtx, Date_t until);
+    bool waitForTicketUntil(OperationContext* opCtx, Date_t until, OperationPriority priority);
     bool waitForTicketUntil(Date_t until) {
         return waitForTicketUntil(nullptr, until);
     }
     void release();
 
+    /**
+     * Changes the number of tickets to 'newSize'. Never blocks: when shrinking below the number of
+     * tickets in use, the excess tickets are retired as their holders release them.
+     */
     Status resize(int newSize);
 
     int available() const;
@@ -82,20 +104,88 @@ public:
 
     int outof() const;
 
+    /**
+     * Number of threads currently blocked waiting for a ticket.
+     */
+    int waiting() const {
+        return _waiting.load();
+    }
+
+    /**
+     * Total number of acquisitions which could not be satisfied immediately and had to wait,
+     * whether or not they eventually obtained a ticket.
+     */
+    long long totalWaits() const {
+        return _totalWaits.load();
+    }
+
+    /**
+     * Appends the number of waiters, the totals of wait counts and time overall and per priority,
+     * and a histogram of the time spent waiting by acquisitions which could not obtain a ticket
+     * immediately.
+     */
+    void appendWaitStats(BSONObjBuilder* builder) const;
+
 private:
+    // Wait times are bucketed by powers of two microseconds, the last bucket being unbounded.
+    static constexpr int kWaitHistogramBuckets = 24;
+
+    // A class advances its pass by kStride / weight for each ticket it obtains while queued. The
+    // queued class with the smallest pass is served next.
+    static constexpr uint64_t kStride = 1 << 16;
+
+    /**
+     * Queues until a ticket is obtained in turn, the deadline passes or 'opCtx' is interrupted.
+     */
+    bool _waitInQueue(OperationContext* opCtx, Date_t until, OperationPriority priority);
+
+    /**
+     * Returns the queued priority class to serve next, or -1 if nobody is queued.
+     */
+    int _nextClass_inlock() const;
+
+    /**
+     * Wakes a waiter of the class to be served next, if there are any waiters.
+     */
+    void _notifyWaiters();
+    void _notifyNext_inlock();
+
+    AtomicInt32 _waiting;
+    AtomicInt64 _totalWaits;
+    AtomicInt64 _totalWaitMicros;
+    std::array<AtomicInt64, kWaitHistogramBuckets> _waitHistogram;
+    std::array<AtomicInt64, kNumOperationPriorities> _waitsByPriority;
+    std::array<AtomicInt64, kNumOperationPriorities> _waitMicrosByPriority;
+
+    // Protects the queue state below. Ordered before the mutex of the platform implementation.
+    stdx::mutex _queueMutex;
+    std::array<int, kNumOperationPriorities> _queued{};
+    std::array<uint64_t, kNumOperationPriorities> _pass{};
+    std::array<stdx::condition_variable, kNumOperationPriorities> _queueCondVars;
+
 #if defined(__linux__)
     mutable sem_t _sem;
 
     // You can read _outof without a lock, but have to hold _resizeMutex to change.
     AtomicInt32 _outof;
     stdx::mutex _resizeMutex;
+
+    // Tickets in use beyond _outof, left by shrinking the pool. Each is taken out of circulation
+    // when it is released instead of being returned to the semaphore.
+    AtomicInt32 _retiring;
+
+    /**
+     * Takes one ticket out of '_retiring' and returns true, or returns false if there are none.
+     */
+    bool _tryUnretire();
 #else
     bool _tryAcquire();
 
     AtomicInt32 _outof;
+
+    // Negative while the pool has been shrunk below the number of tickets in use.
     int _num;
     stdx::mutex _mutex;
-    stdx::condition_variable _newTicket;
 #endif
 };
 
@@ -33,6 +33,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/ticketholder.h"
 
@@ -73,4 +76,100 @@ TEST(TicketholderTest, BasicTimeout) {
     holder.release();
     ASSERT_EQ(holder.used(), 0);
 }
+
+TEST(TicketholderTest, WaitStatistics) {
+    TicketHolder holder(1);
+
+    // Acquisitions which are satisfied immediately are not counted as waits.
+    ASSERT(holder.waitForTicketUntil(Date_t::now() + Milliseconds(10)));
+    ASSERT_EQ(holder.totalWaits(), 0);
+
+    ASSERT_FALSE(holder.waitForTicketUntil(Date_t::now() + Milliseconds(5)));
+    ASSERT_EQ(holder.totalWaits(), 1);
+    ASSERT_EQ(holder.waiting(), 0);
+    holder.release();
+
+    BSONObjBuilder builder;
+    holder.appendWaitStats(&builder);
+    BSONObj stats = builder.obj();
+    ASSERT_EQ(stats["waiting"].numberInt(), 0);
+    ASSERT_EQ(stats["totalWaits"].numberLong(), 1);
+    ASSERT_GT(stats["totalWaitMicros"].numberLong(), 0);
+
+    // The single wait lands in one bucket whose lower bound is at most its length.
+    auto histogram = stats["waitHistogram"].Array();
+    ASSERT_EQ(histogram.size(), 1U);
+    ASSERT_EQ(histogram[0]["count"].numberLong(), 1);
+    ASSERT_LTE(histogram[0]["micros"].numberLong(), stats["totalWaitMicros"].numberLong());
+}
+
+TEST(TicketholderTest, ShrinkingBelowUsedTicketsRetiresThemOnRelease) {
+    TicketHolder holder(10);
+    for (int i = 0; i < 8; ++i)
+        ASSERT(holder.tryAcquire());
+
+    // Does not wait for the tickets in use to be released.
+    ASSERT_OK(holder.resize(5));
+    ASSERT_EQ(holder.outof(), 5);
+    ASSERT_EQ(holder.used(), 8);
+    ASSERT_EQ(holder.available(), 0);
+
+    // Growing while tickets are retiring keeps some of them in circulation.
+    ASSERT_OK(holder.resize(7));
+    ASSERT_EQ(holder.outof(), 7);
+    ASSERT_EQ(holder.used(), 8);
+    ASSERT_EQ(holder.available(), 0);
+
+    // The first ticket released is retired, the others are returned.
+    holder.release();
+    ASSERT_EQ(holder.available(), 0);
+    for (int i = 0; i < 7; ++i)
+        holder.release();
+    ASSERT_EQ(holder.outof(), 7);
+    ASSERT_EQ(holder.used(), 0);
+    ASSERT_EQ(holder.available(), 7);
+}
+
+TEST(TicketholderTest, HigherPriorityWaitersAreServedFirst) {
+    const int kTickets = 5;
+    TicketHolder holder(kTickets);
+    for (int i = 0; i < kTickets; ++i)
+        ASSERT(holder.tryAcquire());
+
+    AtomicBool backgroundAcquired(false);
+    AtomicBool interactiveAcquired(false);
+    stdx::thread background([&] {
+        holder.waitForTicket(nullptr, OperationPriority::kBackground);
+        backgroundAcquired.store(true);
+    });
+    while (holder.waiting() < 1)
+        sleepmillis(1);
+    stdx::thread interactive([&] {
+        holder.waitForTicket(nullptr, OperationPriority::kInteractive);
+        interactiveAcquired.store(true);
+    });
+    while (holder.waiting() < 2)
+        sleepmillis(1);
+
+    // The interactive waiter arrived last, but is served first.
+    holder.release();
+    interactive.join();
+    ASSERT(interactiveAcquired.load());
+    ASSERT_FALSE(backgroundAcquired.load());
+
+    // The background waiter is not starved: having been served, the interactive class is behind.
+    holder.release();
+    background.join();
+    ASSERT(backgroundAcquired.load());
+
+    BSONObjBuilder builder;
+    holder.appendWaitStats(&builder);
+    BSONObj byPriority = builder.obj()["byPriority"].Obj();
+    ASSERT_EQ(byPriority["interactive"]["totalWaits"].numberLong(), 1);
+    ASSERT_EQ(byPriority["batch"]["totalWaits"].numberLong(), 0);
+    ASSERT_EQ(byPriority["background"]["totalWaits"].numberLong(), 1);
+
+    for (int i = 0; i < kTickets; ++i)
+        holder.release();
+}
 }  // namespace